@@ -77,7 +77,7 @@
 
    [bloom options]
           -bloom        (1 arg) :    bloom type ('basic', 'cache', 'neighbor')  [default 'neighbor']
-          -debloom      (1 arg) :    debloom type ('none', 'original' or 'cascading')  [default 'cascading']
+          -debloom      (1 arg) :    debloom type ('none', 'original', 'cascading' or 'ribbon')  [default 'cascading']
           -debloom-impl (1 arg) :    debloom impl ('basic', 'minimizer')  [default 'minimizer']
 
    [branching options]
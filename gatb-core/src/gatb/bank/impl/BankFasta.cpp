@@ -21,6 +21,8 @@
 #include <gatb/bank/impl/BankComposite.hpp>
 
 #include <gatb/system/impl/System.hpp>
+#include <gatb/system/impl/Tracer.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
 #include <gatb/tools/misc/api/StringsRepository.hpp>
 #include <gatb/tools/misc/impl/Tokenizer.hpp>
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
@@ -391,6 +393,7 @@ void BankFasta::Iterator::next()
 inline bool rebuffer (buffered_file_t *bf)
 {
     if (bf->eof) return false;
+    TRACE_SPAN ("io", "read_bank");
     bf->buffer_start = 0;
     bf->buffer_end = gzread (bf->stream, bf->buffer, BUFFER_SIZE);
     if (bf->buffer_end < BUFFER_SIZE) bf->eof = 1;
@@ -650,6 +653,7 @@ void BankFasta::Iterator::init ()
         buffered_file_t** bf = (buffered_file_t **) buffered_file + i;
         *bf = (buffered_file_t *)  CALLOC (1, sizeof(buffered_file_t));
         (*bf)->buffer = (unsigned char*)  MALLOC (BUFFER_SIZE);
+        MemoryAccounting::singleton().add (MEMORY_BANK, BUFFER_SIZE);
         (*bf)->stream = gzopen (fname, "r");
 		
         /** We check that we can open the file. */
@@ -703,6 +707,7 @@ void BankFasta::Iterator::finalize ()
 
             /** We delete the buffer. */
             FREE (bf->buffer);
+            MemoryAccounting::singleton().remove (MEMORY_BANK, BUFFER_SIZE);
 
             /** We delete the buffered file itself. */
             FREE (bf);
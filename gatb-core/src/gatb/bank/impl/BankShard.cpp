@@ -0,0 +1,171 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#include <gatb/bank/impl/BankShard.hpp>
+#include <gatb/tools/misc/impl/Stringify.hpp>
+
+#include <gatb/system/impl/System.hpp>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+using namespace gatb::core::tools::misc::impl;
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace bank {  namespace impl {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankShard::BankShard (IBank* reference, size_t nbShards, size_t shardIndex, size_t blockSize)
+    : _reference (0), _nbShards(nbShards), _shardIndex(shardIndex), _blockSize(blockSize)
+{
+    setReference (reference);
+
+    if (nbShards == 0 || shardIndex >= nbShards)  { throw Exception ("BankShard: bad shard index %d for %d shards", shardIndex, nbShards); }
+    if (blockSize == 0)                           { throw Exception ("BankShard: the blocks size must be > 0"); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankShard::~BankShard ()
+{
+    setReference (0);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+std::string BankShard::getId ()
+{
+    return _reference->getId() + Stringify::format ("_shard%d", _shardIndex);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankShard::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize)
+{
+    _reference->estimate (number, totalSize, maxSize);
+
+    /** The blocks are dealt in turn, so each shard gets about the same part of the bank. */
+    number    = (number    + _nbShards - 1) / _nbShards;
+    totalSize = (totalSize + _nbShards - 1) / _nbShards;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankShard::Iterator::Iterator (const BankShard& bank)
+    : _itRef(0), _nbShards(bank._nbShards), _shardIndex(bank._shardIndex), _blockSize(bank._blockSize), _rank(0)
+{
+    setItRef (bank._reference->iterator());
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankShard::Iterator::~Iterator ()
+{
+    setItRef (0);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankShard::Iterator::first ()
+{
+    _rank = 0;
+    _itRef->first();
+    skip ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankShard::Iterator::next ()
+{
+    _rank++;
+    _itRef->next();
+    skip ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankShard::Iterator::skip ()
+{
+    while (!_itRef->isDone() && (_rank / _blockSize) % _nbShards != _shardIndex)
+    {
+        _rank++;
+        _itRef->next();
+    }
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
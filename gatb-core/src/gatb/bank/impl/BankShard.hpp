@@ -0,0 +1,159 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file BankShard.hpp
+ *  \brief Slice of a bank for counting it with several processes
+ */
+
+#ifndef _GATB_CORE_BANK_IMPL_BANK_SHARD_HPP_
+#define _GATB_CORE_BANK_IMPL_BANK_SHARD_HPP_
+
+/********************************************************************************/
+
+#include <gatb/bank/impl/AbstractBank.hpp>
+
+#include <string>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace bank      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Slice of a bank
+ *
+ * The sequences of the referred bank are dealt by blocks of consecutive sequences to N
+ * shards: block b belongs to shard b%N. Iterating a shard gives the sequences of its blocks
+ * only, so N processes, each one iterating a different shard, see each sequence exactly once.
+ *
+ * Note that each shard still parses the whole referred bank; only the processing of the
+ * sequences (ie. the kmers counting) is split.
+ *
+ * Sample of use (process 'i' out of 'n'):
+ * \code
+ * IBank* shard = new BankShard (Bank::open ("reads.fa"), n, i);
+ * \endcode
+ */
+class BankShard : public AbstractBank
+{
+public:
+
+    /** Returns the name of the bank format. */
+    static const char* name()  { return "shard"; }
+
+    /** Constructor.
+     * \param[in] reference : referred bank
+     * \param[in] nbShards : number of shards the referred bank is split into
+     * \param[in] shardIndex : index of the shard in [0..nbShards-1]
+     * \param[in] blockSize : number of consecutive sequences of a block
+     */
+    BankShard (IBank* reference, size_t nbShards, size_t shardIndex, size_t blockSize = 1024);
+
+    /** Destructor. */
+    ~BankShard ();
+
+    /** \copydoc IBank::getId. */
+    std::string getId ();
+
+    /** \copydoc IBank::iterator */
+    tools::dp::Iterator<Sequence>* iterator ()  { return new Iterator (*this); }
+
+    /** \copydoc IBank::getNbItems */
+    int64_t getNbItems () { return -1; }
+
+    /** \copydoc IBank::insert */
+    void insert (const Sequence& item) {}
+
+    /** \copydoc IBank::flush */
+    void flush ()  {}
+
+    /** \copydoc IBank::getSize */
+    u_int64_t getSize ()  { return _reference->getSize() / _nbShards; }
+
+    /** \copydoc IBank::estimate */
+    void estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize);
+
+    /** Get the number of shards.
+     * \return the number of shards. */
+    size_t getNbShards () const  { return _nbShards; }
+
+    /** Get the index of the shard.
+     * \return the shard index. */
+    size_t getShardIndex () const  { return _shardIndex; }
+
+    /************************************************************/
+
+    class Iterator : public tools::dp::Iterator<Sequence>
+    {
+    public:
+
+        /** Constructor.
+         * \param[in] bank : the shard to be iterated. */
+        Iterator (const BankShard& bank);
+
+        /** Destructor. */
+        ~Iterator ();
+
+        /** \copydoc tools::dp::Iterator::first */
+        void first();
+
+        /** \copydoc tools::dp::Iterator::next */
+        void next();
+
+        /** \copydoc tools::dp::Iterator::isDone */
+        bool isDone ()  { return _itRef->isDone(); }
+
+        /** \copydoc tools::dp::Iterator::item */
+        Sequence& item ()  { return _itRef->item(); }
+
+        /** \copydoc tools::dp::Iterator::setItem */
+        void setItem (Sequence& i)  { _itRef->setItem (i); }
+
+    private:
+
+        tools::dp::Iterator<Sequence>* _itRef;
+        void setItRef (tools::dp::Iterator<Sequence>* itRef)  { SP_SETATTR(itRef); }
+
+        size_t    _nbShards;
+        size_t    _shardIndex;
+        size_t    _blockSize;
+        u_int64_t _rank;
+
+        /** Skip the sequences of the other shards. */
+        void skip ();
+    };
+
+protected:
+
+    IBank* _reference;
+    void setReference (IBank* reference) { SP_SETATTR(reference); }
+
+    size_t _nbShards;
+    size_t _shardIndex;
+    size_t _blockSize;
+
+    friend class Iterator;
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_BANK_IMPL_BANK_SHARD_HPP_ */
@@ -29,6 +29,7 @@
 #include <gatb/bank/impl/BankBinary.hpp>
 #include <gatb/bank/impl/BankStrings.hpp>
 #include <gatb/bank/impl/BankSplitter.hpp>
+#include <gatb/bank/impl/BankShard.hpp>
 #include <gatb/bank/impl/BankRandom.hpp>
 #include <gatb/bank/impl/BankComposite.hpp>
 #include <gatb/bank/impl/BankAlbum.hpp>
@@ -136,7 +136,6 @@ namespace gatb { namespace core { namespace debruijn { namespace impl  {
         Model &model, &modelK1;
         std::atomic<unsigned long>  &nb_left_min_diff_right_min, &nb_kmers_in_partition;
         Repartitor &repart;
-        int _currentThreadIndex;
         std::vector<BankFasta*> &traveller_kmers_files;
         vector<std::mutex> &traveller_kmers_save_mutex;
 
@@ -175,7 +174,7 @@ namespace gatb { namespace core { namespace debruijn { namespace impl  {
             p(p), k(k), abundance_threshold(abundance_threshold), nb_threads(nb_threads),
             model(model), modelK1(modelK1),
         nb_left_min_diff_right_min(nb_left_min_diff_right_min), nb_kmers_in_partition(nb_kmers_in_partition),
-        repart(repart), _currentThreadIndex(-1), traveller_kmers_files(traveller_kmers_files),
+        repart(repart), traveller_kmers_files(traveller_kmers_files),
         traveller_kmers_save_mutex(traveller_kmers_save_mutex),  flat_bucket_queues(flat_bucket_queues) {}
 
         /* does the actual work of processing a kmer, computing its minimizers, saving it to the right queue (basically the queue corresponding to its thread) */
@@ -222,23 +221,8 @@ namespace gatb { namespace core { namespace debruijn { namespace impl  {
             {                printf("unexpected problem: repart bucket\n");                exit(1);            }
         }
 
-        /* neat trick taken from erwan's later work in gatb to find the thread id of a dispatched function */
-        int getThreadIndex()
-        {
-            if (_currentThreadIndex < 0)
-            {
-                std::pair<IThread*,size_t> info;
-                if (ThreadGroup::findThreadInfo (System::thread().getThreadSelf(), info) == true)
-                {
-                    _currentThreadIndex = info.second;
-                }
-                else
-                {
-                    throw Exception("Unable to find thread index during InsertIntoQueues");
-                }
-            }
-            return _currentThreadIndex;
-        }
+        /* index of the dispatcher worker running this functor */
+        int getThreadIndex()  {  return WorkerContext::get().getIndex();  }
 
     };
 
@@ -472,7 +456,6 @@ void bcalm2(Storage *storage,
        
             class InsertTravellerKmer
             {
-                int _currentThreadIndex;
                 vector<flat_vector_queue_t> &flat_bucket_queues;
                 Model &model, &modelK1;
                 int k;
@@ -480,20 +463,9 @@ void bcalm2(Storage *storage,
 
                 public:
                 InsertTravellerKmer(vector<flat_vector_queue_t> &flat_bucket_queues, Model& model, Model &modelK1, int k, std::atomic<unsigned long> &nb_traveller_kmers_loaded) 
-                    : _currentThreadIndex(-1), flat_bucket_queues(flat_bucket_queues), model(model), modelK1(modelK1), k(k), nb_traveller_kmers_loaded(nb_traveller_kmers_loaded) {}
+                    : flat_bucket_queues(flat_bucket_queues), model(model), modelK1(modelK1), k(k), nb_traveller_kmers_loaded(nb_traveller_kmers_loaded) {}
 
-                int getThreadIndex()
-                {
-                    if (_currentThreadIndex < 0)
-                    {
-                        std::pair<IThread*,size_t> info;
-                        if (ThreadGroup::findThreadInfo (System::thread().getThreadSelf(), info) == true)
-                            _currentThreadIndex = info.second;
-                        else
-                            throw Exception("Unable to find thread index during InsertIntoQueues");
-                    }
-                    return _currentThreadIndex;
-                }
+                int getThreadIndex()  {  return WorkerContext::get().getIndex();  }
                 void operator () (const Sequence &sequence)
                 {
                     string seq = sequence.toString();
@@ -5,7 +5,7 @@
 
 #include <unordered_map>
 #include "unionFind.hpp"
-#include <BooPHF/BooPHF.h>
+#include <gatb/tools/collections/impl/BooPHF.hpp> // defines the tracing hook of BooPHF.h (see Tracer.hpp)
 #include "ThreadPool.h"
 
 #include "logging.hpp"
@@ -37,8 +37,6 @@
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 #include <gatb/tools/collections/impl/BooPHF.hpp>
 
-#include <queue> // for priority_queue
-
 
 //heh at this point I could have maybe just included gatb_core.hpp but well, no circular dependencies, this file is part of gatb-core now.
 
@@ -491,11 +489,16 @@ void prepare_uf(std::string prefix, IBank *in, const int nb_threads, int& kmerSi
     std::atomic<unsigned long> nb_marked_extremities, nb_unmarked_extremities; 
     nb_marked_extremities = 0; nb_unmarked_extremities = 0;
 
-    std::vector<std::vector<partition_t >> uf_hashes_vectors(nb_threads);
+    // hashes are bucketed per thread, then per range of hash values: uf_hashes_vectors[thread][bucket].
+    // a bucket covers a contiguous range of hashes, so buckets can be uniquified independently (and in parallel),
+    // and writing them one after the other gives a sorted, unique list
+    int nb_buckets = nb_threads;
+    std::vector<std::vector<std::vector<partition_t >>> uf_hashes_vectors(nb_threads, std::vector<std::vector<partition_t>>(nb_buckets));
     
     // relatively accurate number of sequences to be inserted
     for (int i = 0; i < nb_threads; i++)
-        uf_hashes_vectors[i].reserve(estimated_nb_glue_sequences/(nb_passes*nb_threads));
+        for (int b = 0; b < nb_buckets; b++)
+            uf_hashes_vectors[i][b].reserve(estimated_nb_glue_sequences/(nb_passes*nb_threads*nb_buckets));
 
     /* class (formerly a simple lambda function) to process a kmer and decide which bucket(s) it should go to */
     /* needed to make it a class because i want it to remember its thread index */
@@ -508,16 +511,21 @@ void prepare_uf(std::string prefix, IBank *in, const int nb_threads, int& kmerSi
         ModelCanon modelCanon;
         Hasher_T<ModelCanon> hasher;
         std::atomic<unsigned long> &nb_marked_extremities, &nb_unmarked_extremities; 
-        std::vector<std::vector<partition_t >> &uf_hashes_vectors;
-        int _currentThreadIndex;
+        std::vector<std::vector<std::vector<partition_t >>> &uf_hashes_vectors;
+
+        // maps a hash to its bucket, buckets being ordered ranges of the hash space
+        uint64_t bucket(uint64_t h) const
+        {
+            return ((h >> 32) * (uint64_t)uf_hashes_vectors[0].size()) >> 32;
+        }
 
         public: 
         UniquifyKeys(int k, int pass, int nb_passes, int nb_threads,
                      std::atomic<unsigned long> &nb_marked_extremities, std::atomic<unsigned long> & nb_unmarked_extremities,
-                    std::vector<std::vector<partition_t >> &uf_hashes_vectors
+                    std::vector<std::vector<std::vector<partition_t >>> &uf_hashes_vectors
                      ) : k(k), pass(pass), nb_passes(nb_passes), nb_threads(nb_threads), modelCanon(k), hasher(modelCanon),
                         nb_marked_extremities(nb_marked_extremities), nb_unmarked_extremities(nb_unmarked_extremities),
-                         uf_hashes_vectors(uf_hashes_vectors), _currentThreadIndex(-1)
+                         uf_hashes_vectors(uf_hashes_vectors)
         {}
  
         void operator()     (const Sequence& sequence) {
@@ -536,7 +544,7 @@ void prepare_uf(std::string prefix, IBank *in, const int nb_threads, int& kmerSi
                 const uint64_t h1 = hasher(kmmerBegin);
                 if (h1 % (uint64_t)nb_passes == (uint64_t)pass)
                 {
-                    uf_hashes_vectors[thread].push_back(h1);
+                    uf_hashes_vectors[thread][bucket(h1)].push_back(h1);
                     nb_marked_extremities++;
                 }
             }
@@ -551,7 +559,7 @@ void prepare_uf(std::string prefix, IBank *in, const int nb_threads, int& kmerSi
 
                 if (h2 % (uint64_t)nb_passes == (uint64_t)pass)
                 {
-                    uf_hashes_vectors[thread].push_back(h2);
+                    uf_hashes_vectors[thread][bucket(h2)].push_back(h2);
                     nb_marked_extremities++;
                 }
             }
@@ -559,23 +567,8 @@ void prepare_uf(std::string prefix, IBank *in, const int nb_threads, int& kmerSi
                 nb_unmarked_extremities++;
         }
 
-        /* neat trick taken from erwan's later work in gatb to find the thread id of a dispatched function */
-        int getThreadIndex()
-        {
-            if (_currentThreadIndex < 0)
-            {
-                std::pair<IThread*,size_t> info;
-                if (ThreadGroup::findThreadInfo (System::thread().getThreadSelf(), info) == true)
-                {
-                    _currentThreadIndex = info.second;
-                }
-                else
-                {
-                    throw Exception("Unable to find thread index during InsertIntoQueues");
-                }
-            }
-            return _currentThreadIndex;
-        }
+        /* index of the dispatcher worker running this functor */
+        int getThreadIndex()  {  return WorkerContext::get().getIndex();  }
     };
 
 
@@ -599,66 +592,50 @@ void prepare_uf(std::string prefix, IBank *in, const int nb_threads, int& kmerSi
     ThreadPool uf_sort_pool(nb_threads); // ThreadPool
   //  ctpl::thread_pool uf_merge_pool(nb_threads);
 
-    // sort and uniquify UF vectors (from uf_hashes_vector). the uniquify is actually optional but doesn't cost much
-    for (int i = 0; i < nb_threads; i++)
+    // gather each bucket from all threads, then sort and uniquify it. the uniquify is needed now, because the same
+    // hash may have been seen by several threads. buckets are disjoint ranges of hashes, so no global merge is needed after that
+    // (formerly: per-thread sort/uniq followed by a single-threaded priority_queue merge)
+    std::vector<std::vector<partition_t>> uf_buckets(nb_buckets);
+    for (int b = 0; b < nb_buckets; b++)
     {
-        auto sortuniq = [&uf_hashes_vectors, i] (int thread_id)
+        auto gathersortuniq = [&uf_hashes_vectors, &uf_buckets, nb_threads, b] (int thread_id)
         {
-            std::vector<partition_t> &vec = uf_hashes_vectors[i];
+            std::vector<partition_t> &vec = uf_buckets[b];
+            size_t bucket_size = 0;
+            for (int i = 0; i < nb_threads; i++)
+                bucket_size += uf_hashes_vectors[i][b].size();
+            vec.reserve(bucket_size);
+            for (int i = 0; i < nb_threads; i++)
+            {
+                vec.insert(vec.end(), uf_hashes_vectors[i][b].begin(), uf_hashes_vectors[i][b].end());
+                free_memory_vector(uf_hashes_vectors[i][b]);
+            }
             sort( vec.begin(), vec.end() );
             vec.erase( unique( vec.begin(), vec.end() ), vec.end() );
         };
-        uf_sort_pool.enqueue(sortuniq);  // ThreadPool
-        //uf_sort_pool.push(sortuniq);  // ctpl
-        //sortuniq(0); // single-threaded
+        uf_sort_pool.enqueue(gathersortuniq);  // ThreadPool
+        //uf_sort_pool.push(gathersortuniq);  // ctpl
+        //gathersortuniq(0); // single-threaded
     }
 
     uf_sort_pool.join(); // ThreadPool
     
+    free_memory_vector(uf_hashes_vectors);
     
-    // a single-threaded merge and write to file before they're loaded again in bglue
+    // write buckets to file, in order, before they're loaded again in bglue
     BagFile<uint64_t> * bagf = new BagFile<uint64_t>( prefix+".glue.hashes."+ to_string(pass)); LOCAL(bagf); 
 	Bag<uint64_t> * currentbag =  new BagCache<uint64_t> (  bagf, 10000 ); LOCAL(currentbag);// really? we have to through these hoops to do a simple binary file in gatb? gotta change this.
     uint64_t nb_elts_pass = 0;
 
-    priority_queue<std::tuple<uint64_t,int>, std::vector<std::tuple<uint64_t,int>>, std::greater<std::tuple<uint64_t,int>> > pq; // http://stackoverflow.com/questions/2439283/how-can-i-create-min-stl-priority-queue
-    vector<uint64_t> hash_vector_idx(nb_threads);
-    vector<uint64_t> hash_vector_size(nb_threads);
-
-    // prime the pq
-    for (int i = 0; i < nb_threads; i++)
+    for (int b = 0; b < nb_buckets; b++)
     {
-        hash_vector_idx[i] = 0;
-        hash_vector_size[i] = uf_hashes_vectors[i].size();
-        if (hash_vector_size[i] > 0)
-            pq.emplace(make_tuple(uf_hashes_vectors[i][hash_vector_idx[i]++], i));
+        for (auto it = uf_buckets[b].begin(); it != uf_buckets[b].end(); it++)
+            currentbag->insert(*it);
+        nb_elts_pass += uf_buckets[b].size();
+        free_memory_vector(uf_buckets[b]);
     }
-
-    uint64_t prev = -1;
-    while (pq.size() > 0)
-    {
-        std::tuple<uint64_t, int> elt = pq.top(); pq.pop();
-        uint64_t cur = get<0>(elt);
-        //std::cout << "got " << cur << " queue " << get<1>(elt) << std::endl;
-        if (cur != prev)
-        {
-            currentbag->insert(cur);
-            nb_elts_pass ++;
-        }
-        prev = cur;
-        
-        int i = get<1>(elt);
-        if (hash_vector_idx[i] < hash_vector_size[i])
-            pq.emplace(make_tuple(uf_hashes_vectors[i][hash_vector_idx[i]++], i));
-    }
-
-    for (int i = 0; i < nb_threads; i++)
-    free_memory_vector(uf_hashes_vectors[i]);
-
     
     currentbag->flush();
-    
-    free_memory_vector(uf_hashes_vectors);
 
     logging("pass " + to_string(pass+1) + "/" + to_string(nb_passes) + ", " + std::to_string(nb_elts_pass) + " unique hashes written to disk, size " + to_string(nb_elts_pass* sizeof(partition_t) / 1024/1024) + " MB");
 
@@ -883,9 +860,13 @@ void bglue(Storage *storage,
     BagFile<uint64_t> *ufkmers_bagf = new BagFile<uint64_t>(prefix+".glue.uf");  LOCAL(ufkmers_bagf);
 	BagCache<uint64_t> *ufkmers_bag = new BagCache<uint64_t>(  ufkmers_bagf, 10000 );   LOCAL(ufkmers_bag);
 
+    // flatten the UF in parallel, so that the sequential dump below is a plain scan of the parent array
+    ufkmers.compress(nb_threads);
+    logging("UF compressed");
+
     for (unsigned long i = 0; i < nb_uf_keys; i++)
         //ufkmers_vector[i] = ufkmers.find(i); // just in-memory without the disk
-        ufkmers_bag->insert(ufkmers.find(i));
+        ufkmers_bag->insert(ufkmers.parent(i));
 
     uint64_t size_mdata = sizeof(std::atomic<uint64_t>) * ufkmers.mData.size();
     free_memory_vector(ufkmers.mData);
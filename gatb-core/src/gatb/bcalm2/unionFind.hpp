@@ -4,6 +4,8 @@
 #include <vector>
 #include <set>
 #include <atomic>
+#include <thread>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <unordered_map>
@@ -109,6 +111,41 @@ public:
     // compatibility with original unionFind.cpp
     uint32_t getSet(uint32_t key) { return find(key); }
 
+    // full path compression, done in parallel over contiguous ranges of elements.
+    // to be called once all union_() calls are finished: afterwards parent(i) == find(i) for all i,
+    // so the representants can be read without following any chain.
+    // each element is only written by the thread owning its range; concurrent find()'s from other threads
+    // may only CAS it towards an ancestor, which is harmless since roots don't change anymore.
+    // the rank of non-root elements is dropped, it's never read anyway.
+    void compress(int nb_threads)
+    {
+        if (nb_threads < 1)
+            nb_threads = 1;
+        uint64_t n = size();
+        uint64_t chunk = (n + nb_threads - 1) / nb_threads;
+
+        auto compressRange = [this](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                uint32_t root = find(i);
+                if (root != i)
+                    mData[i] = root;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nb_threads; t++)
+        {
+            uint64_t start = std::min(n, t * chunk);
+            uint64_t end   = std::min(n, start + chunk);
+            if (start < end)
+                threads.emplace_back(compressRange, (uint32_t) start, (uint32_t) end);
+        }
+        for (auto &thread : threads)
+            thread.join();
+    }
+
     void printStats(std::string prefix) 
     {
         std::unordered_map<uint32_t, std::set<uint32_t>> reverseData;
@@ -222,22 +222,15 @@ void BranchingAlgorithm<span, Node, Edge, Graph>::execute ()
         _branchingCollection
     );
 
-    /** We encapsulate this iterator with a potentially decorated iterated (for progress information). */
-    tools::dp::Iterator<Node>* iter = createIterator<Node> (
-        itNodes.get(),
-        itNodes.size(),
-        progressFormat1,
-        listener
-    );
-    LOCAL (iter);
+    LOCAL (listener);
 
     /** We get a synchronized object on the data handled by functors. */
     ThreadObject <FunctorData<Count,Type> > functorData;
 
     FunctorNodes<Count,Type, Node, Edge, Graph> functorNodes (this->_graph, functorData);
 
-    /** We iterate the nodes. */
-    tools::dp::IDispatcher::Status status = getDispatcher()->iterate (iter, functorNodes);
+    /** We iterate the nodes, each thread reading whole partitions of the solid kmers. */
+    tools::dp::IDispatcher::Status status = _graph->iterateNodes (*getDispatcher(), functorNodes, listener);
 
     /** Now, because we iterated with N threads, we have N vector of branching nodes. (N=nbcores used by the dispatcher)
      *  We need to merge them.
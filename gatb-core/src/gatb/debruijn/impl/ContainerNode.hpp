@@ -185,6 +185,71 @@ private:
 
 };
 
+/********************************************************************************/
+/** \brief IContainerNode implementation with cascading ribbon filters
+ *
+ * The cFP set is coded as with the cascading Bloom filters, with two ribbon filters: the
+ * first one holds the cFP, the second one the solid kmers that are false positives of the
+ * first one, and the cFP that are false positives of the second one are kept in an exact set.
+ * A Bloom positive item needs mostly one query of the first filter, which reads one small
+ * contiguous part of the filter.
+ */
+template <typename Item> class ContainerNodeRibbon : public IContainerNode<Item>, public system::SmartPointer
+{
+public:
+
+    /** Constructor.
+     * \param[in] bloom : the Bloom filter.
+     * \param[in] filter1 : ribbon filter of the cFP
+     * \param[in] filter2 : ribbon filter of the solid kmers that are false positives of filter1
+     * \param[in] falsePositives : the cFP that are false positives of filter2
+     */
+    ContainerNodeRibbon (
+        tools::collections::Container<Item>* bloom,
+        tools::collections::Container<Item>* filter1,
+        tools::collections::Container<Item>* filter2,
+        tools::collections::Container<Item>* falsePositives
+    ) : _bloom(0), _filter1(0), _filter2(0), _falsePositives(0)
+    {
+        setBloom          (bloom);
+        setFilter1        (filter1);
+        setFilter2        (filter2);
+        setFalsePositives (falsePositives);
+    }
+
+    /** Destructor */
+    ~ContainerNodeRibbon ()
+    {
+        setBloom          (0);
+        setFilter1        (0);
+        setFilter2        (0);
+        setFalsePositives (0);
+    }
+
+    /** \copydoc IContainerNode::contains */
+    bool contains (const Item& item)  {  return (_bloom->contains(item) && ! containsCFP(item));  }
+
+private:
+
+    tools::collections::Container<Item>* _bloom;
+    void setBloom (tools::collections::Container<Item>* bloom)  { SP_SETATTR(bloom); }
+
+    tools::collections::Container<Item>* _filter1;
+    void setFilter1 (tools::collections::Container<Item>* filter1)  { SP_SETATTR(filter1); }
+
+    tools::collections::Container<Item>* _filter2;
+    void setFilter2 (tools::collections::Container<Item>* filter2)  { SP_SETATTR(filter2); }
+
+    tools::collections::Container<Item>* _falsePositives;
+    void setFalsePositives (tools::collections::Container<Item>* falsePositives)  { SP_SETATTR(falsePositives); }
+
+    /** */
+    bool containsCFP (const Item& item)
+    {
+        return _filter1->contains(item) && (!_filter2->contains(item) || _falsePositives->contains(item));
+    }
+};
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
@@ -23,15 +23,19 @@
 
 #include <gatb/system/impl/System.hpp>
 #include <gatb/system/api/IThread.hpp> // for ISynchronizer 
+#include <gatb/system/impl/Tracer.hpp>
 
 #include <gatb/tools/collections/impl/ContainerSet.hpp>
 #include <gatb/tools/collections/impl/IterableHelpers.hpp>
+#include <gatb/tools/collections/impl/IteratorPrefetch.hpp>
 
 #include <gatb/tools/misc/impl/Property.hpp>
 #include <gatb/tools/misc/impl/LibraryInfo.hpp>
 #include <gatb/tools/misc/impl/HostInfo.hpp>
+#include <gatb/tools/misc/impl/MemoryInfo.hpp>
 #include <gatb/tools/misc/impl/Stringify.hpp>
 #include <gatb/tools/misc/impl/Tool.hpp>
+#include <gatb/tools/misc/impl/Progress.hpp>
 
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 #include <gatb/tools/designpattern/impl/Command.hpp>
@@ -48,6 +52,8 @@
 #include <gatb/kmer/impl/CountProcessor.hpp>
 #include <gatb/kmer/impl/MPHFAlgorithm.hpp>
 #include <gatb/kmer/impl/RepartitionAlgorithm.hpp>
+#include <gatb/kmer/impl/ShardCountAlgorithm.hpp>
+#include <gatb/kmer/impl/ShardMergeAlgorithm.hpp>
 
 #include <gatb/debruijn/impl/Simplifications.hpp>
 
@@ -77,6 +83,7 @@ using namespace gatb::core::tools::misc::impl;
 
 #undef NDEBUG
 #include <cassert>
+#include <limits>
 
 #define DEBUG(a)  //a
 
@@ -471,6 +478,9 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
     Group& dskGroup = (*solidStorage)("dsk"); 
     Partition<Count>* solidCounts = & dskGroup.getPartition<Count> ("solid");
 
+    /** The solid kmers storage may have been closed by build_visitor_solid: we use the one opened here. */
+    data.setSolid (solidCounts);
+
     /** We create an instance of the MPHF Algorithm class (I was wondering: why is that a class, and not a function?) and execute it. */
     bool  noMphf = props->get("-no-mphf") != 0;
     if ((!noMphf) && (!graph.checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE)))
@@ -613,6 +623,176 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
 
 
 
+/********************************************************************************/
+
+/* This visitor updates an existing graph (given by the -in option) with new reads (given by -update).
+ *
+ * Only the new reads are counted: the configuration of the counting is the one of the existing graph
+ * (minimizers repartition, number of partitions and passes), so the counted partitions match the stored
+ * solid partitions and can be merged one by one. The updated graph is written in a new storage (-out,
+ * by default the input name followed by "_updated"); build_visitor_postsolid then builds the MPHF,
+ * Bloom, debloom and branching structures of this new storage, all of them depending on the whole
+ * solid kmers set.
+ *
+ * Note that the existing graph holds only its solid kmers: a kmer that was not solid before is kept only
+ * if its abundance in the new reads (or the sum with its previous abundance) reaches the threshold.
+ */
+template<typename Node, typename Edge, typename GraphDataVariant>
+template <size_t span>
+void update_visitor_solid<Node,Edge,GraphDataVariant>::operator() (GraphData<span>& data) const
+{
+    typedef typename Kmer<span>::Count Count;
+    typedef GraphTemplate<Node, Edge, GraphDataVariant> Graph;
+
+    LOCAL (bank);
+
+    TimeInfo ti;
+
+    string input = props->getStr(STR_URI_INPUT);
+
+    /** We open the existing graph (read only). */
+    Storage* oldStorage = StorageFactory(graph._storageMode).create (input, false, false);
+    LOCAL (oldStorage);
+
+    int oldState = atol (oldStorage->root().getProperty ("state").c_str());
+    if ((oldState & Graph::STATE_SORTING_COUNT_DONE) == 0)
+    {
+        throw system::Exception ("Graph update: '%s' doesn't hold its solid kmers (was it built with -solid-kmers-out ?)", input.c_str());
+    }
+
+    size_t kmerSize = graph._kmerSize;
+
+    string output = props->get(STR_URI_OUTPUT) ?
+        props->getStr(STR_URI_OUTPUT)   :
+        (props->getStr(STR_URI_OUTPUT_DIR) + "/" + System::file().getBaseName (input) + "_updated");
+
+    if (System::file().getBaseName (output) == System::file().getBaseName (input))
+    {
+        throw system::Exception ("Graph update: the updated graph must not overwrite '%s'", input.c_str());
+    }
+
+    /** We create the kmer model. */
+    data.setModel (new typename Kmer<span>::ModelCanonical (kmerSize));
+
+    /** We add library and host information. */
+    graph.getInfo().add (1, & LibraryInfo::getInfo());
+    graph.getInfo().add (1, & HostInfo::getInfo());
+
+    /** We create the storage of the updated graph. */
+    Storage* mainStorage = StorageFactory(graph._storageMode).create (output, true, false);
+    graph.setStorage (mainStorage);
+
+    /** We reuse the minimizers repartition of the existing graph. */
+    Repartitor repartitor ((*oldStorage)("minimizers"));
+    repartitor.save ((*mainStorage)("minimizers"));
+
+    (*mainStorage)("configuration").setProperty ("xml", (*oldStorage)("configuration").getProperty ("xml"));
+
+    /************************************************************/
+    /*                 Counting of the new reads                */
+    /************************************************************/
+
+    /** The configuration is computed for the new reads, but the partitioning must be the one of the existing graph. */
+    props->setInt (STR_KMER_SIZE, kmerSize);
+
+    Configuration config = ShardCountAlgorithm<span>::getConfiguration (bank, repartitor, props);
+
+    graph.setState (Graph::STATE_CONFIGURATION_DONE);
+
+    /** All the kmers of the new reads are kept (in a temporary storage): the solidity is checked after the merge. */
+    Storage* countStorage = StorageFactory(graph._storageMode).create (output + "_update_counts", true, true);
+    LOCAL (countStorage);
+
+    vector<ICountProcessor<span>*> processors;
+    processors.push_back (new CountProcessorDump<span> ((*countStorage)("dsk"), kmerSize));
+
+    {
+        LocalTimeInfo local (ti, "count_new_reads");
+
+        SortingCountAlgorithm<span> sortingCount (bank, config, new Repartitor ((*mainStorage)("minimizers")), processors, props);
+        graph.executeAlgorithm (sortingCount, 0, props, graph._info);
+    }
+
+    /************************************************************/
+    /*                 Merge with the solid kmers               */
+    /************************************************************/
+
+    Partition<Count>& oldSolid  = (*oldStorage)  ("dsk").getPartition<Count> ("solid");
+    Partition<Count>& newCounts = (*countStorage)("dsk").getPartition<Count> ("solid");
+
+    if (oldSolid.size() != newCounts.size())
+    {
+        throw system::Exception ("Graph update: %d stored partitions but %d counted partitions", oldSolid.size(), newCounts.size());
+    }
+
+    /** We get the abundance range of the solid kmers; an automatic threshold is replaced by the lowest stored abundance. */
+    CountNumber abundanceMin = config._abundance.empty() ? 2 : config._abundance[0].getBegin();
+    CountNumber abundanceMax = config._abundance.empty() ? std::numeric_limits<CountNumber>::max() : config._abundance[0].getEnd();
+
+    if (abundanceMin < 0)
+    {
+        abundanceMin = std::numeric_limits<CountNumber>::max();
+        Iterator<Count>* it = oldSolid.iterator();  LOCAL (it);
+        for (it->first(); !it->isDone(); it->next())  { abundanceMin = std::min (abundanceMin, it->item().abundance); }
+    }
+
+    Group&            dskGroup = (*mainStorage)("dsk");
+    Partition<Count>& merged   = dskGroup.getPartition<Count> ("solid", oldSolid.size());
+
+    u_int64_t nbMerged = 0;
+    {
+        LocalTimeInfo local (ti, "merge");
+        for (size_t p=0; p<merged.size(); p++)
+        {
+            vector<Iterable<Count>*> inputs;
+            inputs.push_back (& oldSolid [p]);
+            inputs.push_back (& newCounts[p]);
+
+            nbMerged += ShardMergeAlgorithm<span>::merge (inputs, merged[p], abundanceMin, abundanceMax);
+        }
+    }
+
+    dskGroup.addProperty ("kmer_size", Stringify::format("%d", kmerSize));
+
+    /************************************************************/
+    /*                       Information                        */
+    /************************************************************/
+
+    /** A full build would count the reads of the existing graph again: we get the time it took from its information. */
+    Properties oldDsk;
+    stringstream ss; ss << (*oldStorage)("dsk").getProperty ("xml");
+    oldDsk.readXML (ss);
+
+    u_int64_t oldCountTime = 0;
+    if (IProperty* prop = oldDsk.get ("fill_partitions"))   { oldCountTime += prop->getInt(); }
+    if (IProperty* prop = oldDsk.get ("fill_solid_kmers"))  { oldCountTime += prop->getInt(); }
+
+    IProperties* update = new Properties ("update");
+    update->add (1, "input",           "%s",  input.c_str());
+    update->add (1, "nb_old_solid",    "%ld", oldSolid.getNbItems());
+    update->add (1, "nb_new_kmers",    "%ld", newCounts.getNbItems());
+    update->add (1, "nb_solid",        "%ld", nbMerged);
+    update->add (1, "abundance_min",   "%d",  abundanceMin);
+    update->add (1, "time_count_new",  "%d",  ti.getEntryByKey ("count_new_reads"));
+    update->add (1, "time_merge",      "%d",  ti.getEntryByKey ("merge"));
+    update->add (1, "time_count_old",  "%ld", oldCountTime);
+    update->add (1, "time_saved",      "%ld", (int64_t)oldCountTime - (int64_t)ti.getEntryByKey ("merge"));
+
+    dskGroup.setProperty ("xml", string("\n") + update->getXML());
+    graph.getInfo().add (1, update);
+
+    graph.setState (Graph::STATE_SORTING_COUNT_DONE);
+
+    /** We configure the variant. */
+    data.setSolid (&merged);
+
+    if (nbMerged == 0)  {  throw system::Exception ("The updated dataset has no solid kmers"); }
+
+    /** We save the state and kmer size at storage root level. */
+    graph.getGroup().setProperty ("state",     Stringify::format("%d", graph._state));
+    graph.getGroup().setProperty ("kmer_size", Stringify::format("%d", graph._kmerSize));
+}
+
 /********************************************************************************
                  #####   ######      #     ######   #     #
                 #     #  #     #    # #    #     #  #     #
@@ -648,8 +828,11 @@ IOptionsParser* GraphTemplate<Node, Edge, GraphDataVariant>::getOptionsParser (b
     IOptionsParser* parserGeneral  = new OptionsParser ("general");
     parserGeneral->push_front (new OptionOneParam (STR_INTEGER_PRECISION, "integers precision (0 for optimized value)", false, "0", false));
     parserGeneral->push_front (new OptionOneParam (STR_VERBOSE,           "verbosity level",      false, "1"  ));
+    parserGeneral->push_front (new OptionOneParam (STR_TRACE,             "dump a trace of the threads into a file (Chrome trace event format)", false));
+    parserGeneral->push_front (new OptionNoParam  (STR_NUMA,              "bind the threads and their memory to the NUMA nodes"));
     parserGeneral->push_front (new OptionOneParam (STR_NB_CORES,          "number of cores",      false, "0"  ));
     parserGeneral->push_front (new OptionNoParam  (STR_CONFIG_ONLY,       "dump config only"));
+    parserGeneral->push_front (new OptionOneParam (STR_URI_UPDATE,        "new reads to be added to the graph given by -in (h5 file); only these reads are counted", false));
     
     parser->push_back  (parserGeneral);
 
@@ -838,6 +1021,9 @@ GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (tools::misc::IProper
       _variant(new GraphDataVariant()), _kmerSize(0), _info("graph"),
       _state(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_INIT_DONE)
 {
+    /** The read-ahead statistics are global, so we keep them for computing those of the build. */
+    tools::collections::impl::PrefetchStats prefetchStart = tools::collections::impl::PrefetchSettings::totals();
+
     /** We get the kmer size from the user parameters. */
     _kmerSize = params->getInt (STR_KMER_SIZE);
 
@@ -852,12 +1038,35 @@ GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (tools::misc::IProper
     /** We configure the data variant according to the provided kmer size. */
     setVariant (_variant, _kmerSize, integerPrecision);
 
+    /** We may have to trace the execution. */
+    if (params->get(STR_TRACE) != 0)  {  Tracer::singleton().enable ();  }
+
     string input = params->getStr(STR_URI_INPUT);
 
     bool load_from_hdf5 = (system::impl::System::file().getExtension(input) == "h5");
     bool load_from_file = (system::impl::System::file().isFolderEndingWith(input,"_gatb"));
     bool load_graph = (load_from_hdf5 || load_from_file);
-    if (load_graph)
+    if (load_graph && params->get(STR_URI_UPDATE) != 0)
+    {
+        /* the graph is updated with new reads: only these reads are counted, then merged with the stored solid kmers */
+        _storageMode = load_from_hdf5 ? STORAGE_HDF5 : STORAGE_FILE;
+
+        /** We get the kmer size of the existing graph. */
+        {
+            Storage* storage = StorageFactory(_storageMode).create (input, false, false);  LOCAL (storage);
+            _kmerSize = atol (storage->root().getProperty ("kmer_size").c_str());
+        }
+
+        /** We configure the data variant according to the kmer size of the existing graph. */
+        setVariant (_variant, _kmerSize, integerPrecision);
+
+        /** We build a Bank instance for the new reads. */
+        bank::IBank* bank = Bank::open (params->getStr(STR_URI_UPDATE));
+
+        boost::apply_visitor (update_visitor_solid<Node, Edge, GraphDataVariant>(*this, bank, params),  *(GraphDataVariant*)_variant);
+        boost::apply_visitor (build_visitor_postsolid<Node, Edge, GraphDataVariant>(*this, params),  *(GraphDataVariant*)_variant);
+    }
+    else if (load_graph)
     {
         /* it's not a bank, but rather a h5 file (kmercounted or more), let's complete it to a graph */
         
@@ -907,6 +1116,25 @@ GraphTemplate<Node, Edge, GraphDataVariant>::GraphTemplate (tools::misc::IProper
         boost::apply_visitor (build_visitor_solid<Node, Edge, GraphDataVariant>(*this, bank,params),  *(GraphDataVariant*)_variant);
         boost::apply_visitor (build_visitor_postsolid<Node, Edge, GraphDataVariant>(*this, params),  *(GraphDataVariant*)_variant);
     }
+
+    /** We add the memory usage of the main data structures to the graph information. */
+    getInfo().add (1, MemoryInfo::getInfo ("memory"));
+
+    /** We add the read-ahead statistics of the files and HDF5 collections iterated during the build. */
+    tools::collections::impl::PrefetchStats prefetch = tools::collections::impl::PrefetchSettings::totals().since (prefetchStart);
+    getInfo().add (1, "prefetch");
+    getInfo().add (2, "nb_blocks",        "%lld", prefetch.nbBlocks);
+    getInfo().add (2, "nb_stalls",        "%lld", prefetch.nbStalls);
+    getInfo().add (2, "stall_time_(ms)",  "%lld", prefetch.stallTime/1000);
+    getInfo().add (2, "read_time_(ms)",   "%lld", prefetch.readTime/1000);
+
+    /** We may have to dump the trace of the execution and add its summary to the graph information. */
+    if (params->get(STR_TRACE) != 0)
+    {
+        Tracer::singleton().disable ();
+        Tracer::singleton().dump (params->getStr(STR_TRACE));
+        getInfo().add (1, TimeInfo::getTraceProperties ("trace"));
+    }
 }
 
 /*********************************************************************
@@ -2242,94 +2470,95 @@ template<typename Node, typename Edge, typename NodeType, typename GraphDataVari
     bool operator () (NodeType& item) { return graph.isBranching(item); }
 };
 
-template<typename Node, typename Edge, typename NodeType, typename GraphDataVariant>
-struct nodes_visitor : public boost::static_visitor<tools::dp::ISmartIterator<NodeType>*>
+/* Iterator over the nodes of a solid kmers collection (all the solid kmers, one partition of them, or the branching kmers). */
+template<typename NodeType, typename Count>
+class SolidNodeIterator : public tools::dp::ISmartIterator<NodeType>
 {
-    const GraphTemplate<Node, Edge, GraphDataVariant>& graph;
-    nodes_visitor (const GraphTemplate<Node, Edge, GraphDataVariant>& graph) : graph(graph) {}
+public:
+    SolidNodeIterator (tools::dp::Iterator<Count>* ref, u_int64_t nbItems)
+        : _ref(0),  _rank(0), _isDone(true), _nbItems(nbItems)   {  
+            setRef(ref);  
+            this->_item->strand = STRAND_FORWARD;  // iterated nodes are always in forward strand.
+        }
 
-    template<size_t span>  tools::dp::ISmartIterator<NodeType>* operator() (const GraphData<span>& data) const
-    {
-        /** Shortcuts. */
-        typedef typename Kmer<span>::Count Count;
+    ~SolidNodeIterator ()  { setRef(0);   }
 
-        // soo.. we're defining a iterator class inside a visitor. that's just what it is.
-        class NodeIterator : public tools::dp::ISmartIterator<NodeType>
-        {
-        public:
-            NodeIterator (tools::dp::Iterator<Count>* ref, u_int64_t nbItems)
-                : _ref(0),  _rank(0), _isDone(true), _nbItems(nbItems)   {  
-                    setRef(ref);  
-                    this->_item->strand = STRAND_FORWARD;  // iterated nodes are always in forward strand.
-                }
+    u_int64_t rank () const { return _rank; }
 
-            ~NodeIterator ()  { setRef(0);   }
+    /** \copydoc  Iterator::first */
+    void first()
+    {
+        _ref->first();
+        _rank   = 0;
+        _isDone = _ref->isDone();
 
-            u_int64_t rank () const { return _rank; }
+        if (!_isDone)
+        {
+            // NOTE: doesn't check if node is deleted (as it would be expensive to compute MPHF index)
+            this->_rank ++;
+            this->_item->kmer      = _ref->item().value;
+            this->_item->abundance = _ref->item().abundance;
+            this->_item->mphfIndex = 0;
+            this->_item->iterationRank = this->_rank;
+        }
+    }
 
-            /** \copydoc  Iterator::first */
-            void first()
-            {
-                _ref->first();
-                _rank   = 0;
-                _isDone = _ref->isDone();
+    /** \copydoc  Iterator::next */
+    void next()
+    {
+        _ref->next();
+        _isDone = _ref->isDone();
+        if (!_isDone)
+        {
+            // NOTE: doesn't check if node is deleted (as it would be expensive to compute MPHF index)
+            this->_rank ++;
+            this->_item->kmer      = _ref->item().value;
+            this->_item->abundance = _ref->item().abundance;
+            this->_item->mphfIndex = 0;
+            this->_item->iterationRank = this->_rank;
+        }
+    }
 
-                if (!_isDone)
-                {
-                    // NOTE: doesn't check if node is deleted (as it would be expensive to compute MPHF index)
-                    this->_rank ++;
-                    this->_item->kmer      = _ref->item().value;
-                    this->_item->abundance = _ref->item().abundance;
-                    this->_item->mphfIndex = 0;
-                    this->_item->iterationRank = this->_rank;
-                }
-            }
+    /** \copydoc  Iterator::isDone */
+    bool isDone() { return _isDone;  }
 
-            /** \copydoc  Iterator::next */
-            void next()
-            {
-                _ref->next();
-                _isDone = _ref->isDone();
-                if (!_isDone)
-                {
-                    // NOTE: doesn't check if node is deleted (as it would be expensive to compute MPHF index)
-                    this->_rank ++;
-                    this->_item->kmer      = _ref->item().value;
-                    this->_item->abundance = _ref->item().abundance;
-                    this->_item->mphfIndex = 0;
-                    this->_item->iterationRank = this->_rank;
-                }
-            }
+    /** \copydoc  Iterator::item */
+    NodeType& item ()  {  return *(this->_item);  }
 
-            /** \copydoc  Iterator::isDone */
-            bool isDone() { return _isDone;  }
+    /** */
+    void setItem (NodeType& i)
+    {
+        /** We set the node item to be set for the current iterator. */
+        this->_item = &i;
+        this->_item->strand = STRAND_FORWARD;
 
-            /** \copydoc  Iterator::item */
-            NodeType& item ()  {  return *(this->_item);  }
+        /** We set the kmer item to be set for the kmer iterator. */
+        // _ref->setItem (i.kmer.value.get<T>());
+        // TODO doc: uh, why is that commented?
+    }
 
-            /** */
-            void setItem (NodeType& i)
-            {
-                /** We set the node item to be set for the current iterator. */
-                this->_item = &i;
-                this->_item->strand = STRAND_FORWARD;
+    /** */
+    u_int64_t size () const { return _nbItems; }
 
-                /** We set the kmer item to be set for the kmer iterator. */
-                // _ref->setItem (i.kmer.value.get<T>());
-                // TODO doc: uh, why is that commented?
-            }
+private:
+    tools::dp::Iterator<Count>* _ref;
+    void setRef (tools::dp::Iterator<Count>* ref)  { SP_SETATTR(ref); }
 
-            /** */
-            u_int64_t size () const { return _nbItems; }
+    u_int64_t _rank;
+    bool      _isDone;
+    u_int64_t _nbItems;
+};
 
-        private:
-            tools::dp::Iterator<Count>* _ref;
-            void setRef (tools::dp::Iterator<Count>* ref)  { SP_SETATTR(ref); }
+template<typename Node, typename Edge, typename NodeType, typename GraphDataVariant>
+struct nodes_visitor : public boost::static_visitor<tools::dp::ISmartIterator<NodeType>*>
+{
+    const GraphTemplate<Node, Edge, GraphDataVariant>& graph;
+    nodes_visitor (const GraphTemplate<Node, Edge, GraphDataVariant>& graph) : graph(graph) {}
 
-            u_int64_t _rank;
-            bool      _isDone;
-            u_int64_t _nbItems;
-        };
+    template<size_t span>  tools::dp::ISmartIterator<NodeType>* operator() (const GraphData<span>& data) const
+    {
+        /** Shortcuts. */
+        typedef typename Kmer<span>::Count Count;
 
         // now this is the actual code for returning a node iterator, apparently
 
@@ -2337,7 +2566,7 @@ struct nodes_visitor : public boost::static_visitor<tools::dp::ISmartIterator<No
         {
             if (data._solid != 0)
             {
-                return new NodeIterator (data._solid->iterator (), data._solid->getNbItems());
+                return new SolidNodeIterator<NodeType,Count> (data._solid->iterator (), data._solid->getNbItems());
             }
             else
             {
@@ -2349,14 +2578,14 @@ struct nodes_visitor : public boost::static_visitor<tools::dp::ISmartIterator<No
             if (data._branching != 0)
             {
                 /** We have a branching container*/
-                return new NodeIterator (data._branching->iterator (), data._branching->getNbItems());
+                return new SolidNodeIterator<NodeType,Count> (data._branching->iterator (), data._branching->getNbItems());
             }
             else if (data._solid != 0)
             {
                 /** We don't have pre-computed branching nodes container. We have to compute them on the fly
                  * from the solid kmers. We can do that by filtering out all non branching nodes. */
                 return new FilterIterator<NodeType,BranchingFilter<Node, Edge, NodeType, GraphDataVariant> > (
-                    new NodeIterator (data._solid->iterator (), data._solid->getNbItems()),
+                    new SolidNodeIterator<NodeType,Count> (data._solid->iterator (), data._solid->getNbItems()),
                     BranchingFilter<Node, Edge, NodeType, GraphDataVariant> (graph)
                 );
             }
@@ -2397,6 +2626,54 @@ GraphIterator<BranchingNode_t<Node> > GraphTemplate<Node, Edge, GraphDataVariant
     return GraphIterator<BranchingNode_t<Node> > (boost::apply_visitor (nodes_visitor<Node, Edge, BranchingNode_t<Node>, GraphDataVariant>(*this),  *(GraphDataVariant*)_variant));
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<typename Node, typename Edge, typename GraphDataVariant>
+struct partition_nodes_visitor : public boost::static_visitor<std::vector<tools::dp::ISmartIterator<Node>*> >
+{
+    template<size_t span>  std::vector<tools::dp::ISmartIterator<Node>*> operator() (const GraphData<span>& data) const
+    {
+        /** Shortcuts. */
+        typedef typename Kmer<span>::Count Count;
+
+        if (data._solid == 0)  {  throw system::Exception("Iteration impossible (no solid nodes available)");  }
+
+        std::vector<tools::dp::ISmartIterator<Node>*> result;
+        for (size_t p=0; p<data._solid->size(); p++)
+        {
+            Collection<Count>& partition = (*data._solid)[p];
+            result.push_back (new SolidNodeIterator<Node,Count> (partition.iterator(), partition.getNbItems()));
+        }
+        return result;
+    }
+};
+
+template<typename Node, typename Edge, typename GraphDataVariant>
+std::vector<tools::dp::Iterator<Node>*> GraphTemplate<Node, Edge, GraphDataVariant>::iteratorPartitions (IteratorListener* listener) const
+{
+    std::vector<tools::dp::ISmartIterator<Node>*> partitions = boost::apply_visitor (partition_nodes_visitor<Node, Edge, GraphDataVariant>(),  *(GraphDataVariant*)_variant);
+
+    u_int64_t nbNodes = 0;
+    for (size_t p=0; p<partitions.size(); p++)  { nbNodes += partitions[p]->size(); }
+
+    /** The iterators of the partitions are iterated concurrently, so they share a synchronized listener. */
+    IteratorListener* shared = listener ? new ProgressShared (listener, System::thread().newSynchronizer()) : 0;
+
+    std::vector<tools::dp::Iterator<Node>*> result;
+    for (size_t p=0; p<partitions.size(); p++)
+    {
+        if (shared)  { result.push_back (new SubjectIterator<Node> (partitions[p], nbNodes/100, shared)); }
+        else         { result.push_back (partitions[p]); }
+    }
+    return result;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -3493,8 +3770,6 @@ struct allocateAdjacency_visitor : public boost::static_visitor<void>    {
 template<typename Node, typename Edge, typename GraphDataVariant> 
 void GraphTemplate<Node, Edge, GraphDataVariant>::precomputeAdjacency(unsigned int nbCores, bool verbose) 
 {
-    ProgressGraphIteratorTemplate<Node, ProgressTimerAndSystem> itNode (iterator(), "precomputing adjacency", verbose);
-    
     bool hasMPHF = getState() & GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE;
     if (!hasMPHF)
     {
@@ -3513,7 +3788,10 @@ void GraphTemplate<Node, Edge, GraphDataVariant>::precomputeAdjacency(unsigned i
     nt2bit[NUCL_T] = 4;
     nt2bit[NUCL_G] = 8;
 
-    dispatcher.iterate (itNode, [&] (Node& node)        {
+    /* the nodes are iterated partition by partition */
+    IteratorListener* listener = verbose ? new ProgressTimerAndSystem (iterator().size(), "precomputing adjacency") : 0;
+
+    iterateNodes (dispatcher, [&] (Node& node)        {
 
             unsigned char &value = boost::apply_visitor (getAdjacency_visitor<Node, Edge, GraphDataVariant>(node),  *(GraphDataVariant*)_variant);
             value = 0;
@@ -3533,7 +3811,7 @@ void GraphTemplate<Node, Edge, GraphDataVariant>::precomputeAdjacency(unsigned i
                 //std::cout << "node " << this->toString(node) << " has " << neighbors.size() << " neighbors in direction " << (dir == DIR_INCOMING ? "incoming" : "outcoming") << " value is now " << (int)value <<  std::endl;
             }
             
-    }); // end of parallel node iterate
+    }, listener); // end of parallel node iterate
 
     setState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_ADJACENCY_DONE);
     
@@ -3711,10 +3989,9 @@ bool GraphTemplate<Node, Edge, GraphDataVariant>::debugCompareNeighborhoods(Node
 template<typename Node, typename Edge, typename GraphDataVariant>
 void GraphTemplate<Node, Edge, GraphDataVariant>::deleteNodesByIndex(vector<bool> &bitmap, int nbCores, gatb::core::system::ISynchronizer* synchro) const
 {
-    GraphIterator<Node> itNode = this->iterator();
     Dispatcher dispatcher (nbCores); 
 
-    dispatcher.iterate (itNode, [&] (Node& node)        {
+    iterateNodes (dispatcher, [&] (Node& node)        {
 
         unsigned long i = this->nodeMPHFIndex(node); 
 
@@ -3813,11 +4090,10 @@ void GraphTemplate<Node, Edge, GraphDataVariant>::cacheNonSimpleNodes(unsigned i
 {
     boost::apply_visitor (allocateNonSimpleNodeCache_visitor<Node, Edge, GraphDataVariant>(),  *(GraphDataVariant*)_variant);
     setState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_NONSIMPLE_CACHE);
-    GraphIterator<Node> itNode = this->iterator();
     Dispatcher dispatcher (nbCores); 
     system::ISynchronizer* synchro = system::impl::System::thread().newSynchronizer();
     unsigned long nbCachedNodes = 0;
-    dispatcher.iterate (itNode, [&] (Node& node)        {
+    iterateNodes (dispatcher, [&] (Node& node)        {
         if (this->isNodeDeleted(node)) return; // test
         if (this->isBranching(node))
         {
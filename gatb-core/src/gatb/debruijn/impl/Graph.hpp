@@ -610,6 +610,38 @@ public:
     inline GraphIterator<BranchingNode_t<Node> > iteratorBranching () const  {  return getBranchingNodes ();           }
     GraphIterator<Node> iteratorCachedNodes () const;
 
+    /** Creates one iterator over the nodes of each partition of the solid kmers. The iterators are meant
+     * to be iterated at the same time by IDispatcher::iterate (vector version): a thread reads whole
+     * partitions instead of sharing a single iterator (and its lock) with the other threads.
+     * \param[in] listener : listener notified of the increments of all the iterators (init and finish are left to the caller)
+     * \return the iterators, one per partition. */
+    std::vector<tools::dp::Iterator<Node>*> iteratorPartitions (tools::dp::IteratorListener* listener = 0) const;
+
+    /** Iterate all the nodes of the graph in parallel, partition by partition (see iteratorPartitions).
+     * \param[in] dispatcher : dispatcher of the iteration
+     * \param[in] functor : called as 'functor (node)'; copied for each thread
+     * \param[in] listener : optional progress listener
+     * \return the status of the iteration. */
+    template<typename Functor>
+    tools::dp::IDispatcher::Status iterateNodes (tools::dp::IDispatcher& dispatcher, const Functor& functor, tools::dp::IteratorListener* listener = 0) const
+    {
+        /** The dispatcher also gives the index of the partition of the node; the functor doesn't need it. */
+        struct NodeFunctor
+        {
+            Functor f;
+            NodeFunctor (const Functor& f) : f(f) {}
+            void operator() (Node& node, size_t partition)  { f(node); }
+        };
+
+        LOCAL (listener);
+
+        if (listener)  { listener->init(); }
+        tools::dp::IDispatcher::Status status = dispatcher.iterate (iteratorPartitions (listener), NodeFunctor (functor));
+        if (listener)  { listener->finish(); }
+
+        return status;
+    }
+
 
     /**********************************************************************/
     /*                     ALL NEIGHBORS METHODS                          */
@@ -1113,6 +1145,7 @@ public: // was private: before, but had many compilation errors during the chang
     /** Friends. */
     template<typename, typename, typename> friend struct build_visitor_solid ; // i don't know why this template<typename, typename> trick works, but it does
     template<typename, typename, typename> friend struct build_visitor_postsolid ;
+    template<typename, typename, typename> friend struct update_visitor_solid ;
     template<typename, typename, typename> friend struct configure_visitor;
 
     // a late addition, because GraphUnitig wants to call it too
@@ -1335,6 +1368,19 @@ struct build_visitor_solid : public boost::static_visitor<>    {
     template<size_t span>  void operator() (GraphData<span>& data) const;
 };
 
+/* update the solid kmers of an existing graph with new reads (counting only the new reads) */
+template<typename Node, typename Edge, typename GraphDataVariant>
+struct update_visitor_solid : public boost::static_visitor<>    {
+
+    GraphTemplate<Node, Edge, GraphDataVariant>& graph;
+    bank::IBank* bank;
+    tools::misc::IProperties* props;
+
+    update_visitor_solid (GraphTemplate<Node, Edge, GraphDataVariant>& aGraph, bank::IBank* aBank, tools::misc::IProperties* aProps)  : graph(aGraph), bank(aBank), props(aProps) {}
+
+    template<size_t span>  void operator() (GraphData<span>& data) const;
+};
+
 /* now build the rest of the graph */
 template<typename Node, typename Edge, typename GraphDataVariant>
 struct build_visitor_postsolid : public boost::static_visitor<>    {
@@ -43,6 +43,7 @@
 #include <gatb/kmer/impl/SortingCountAlgorithm.hpp>
 #include <gatb/kmer/impl/CountProcessor.hpp>
 #include <gatb/kmer/impl/RepartitionAlgorithm.hpp>
+#include <gatb/kmer/impl/RollingKmers.hpp>
 
 #include <gatb/debruijn/impl/Simplifications.hpp>
 
@@ -511,6 +512,41 @@ void GraphUnitigsTemplate<span>::print_unitigs_mem_stats(uint64_t incoming_size,
 
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : memory of the unitigs structures
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+uint64_t GraphUnitigsTemplate<span>::unitigs_mem_size() const
+{
+    // same estimation as in print_unitigs_mem_stats, from the actual containers
+    uint64_t result = unitigs_sizes.capacity() * sizeof(uint32_t) + unitigs_mean_abundance.capacity() * sizeof(float) + (nb_unitigs*2)/8;
+
+    if (locator)
+        result += locator->size() * sizeof(uint64_t);
+
+    result += unitigs_original_ids.capacity() * sizeof(uint64_t);
+
+    result += sizeof(uint64_t) * (incoming.capacity() + outcoming.capacity());
+    if (compress_navigational_vectors)
+        result += dag_incoming_map.get_alloc_byte_num() + dag_outcoming_map.get_alloc_byte_num();
+    else
+        result += sizeof(uint64_t) * (incoming_map.capacity() + outcoming_map.capacity());
+
+    if (pack_unitigs)
+        result += packed_unitigs.capacity() + packed_unitigs_sizes.get_alloc_byte_num();
+    else
+    {
+        result += unitigs.capacity() * sizeof(string);
+        for (size_t i = 0; i < unitigs.size(); i++)
+            result += unitigs[i].capacity();
+    }
+    return result;
+}
 
 template<size_t span>
 void GraphUnitigsTemplate<span>::load_unitigs(string unitigs_filename)
@@ -531,7 +567,7 @@ void GraphUnitigsTemplate<span>::load_unitigs(string unitigs_filename)
     compress_navigational_vectors = true; //only a 10% speed hit but 2x less incoming/outcoming/incoming_map/outcoming_map memory usage, so, quite worth it.
     pack_unitigs = true;
 
-    nb_unitigs_extremities = 0; // will be used by NodeIterator (getNodes)
+    nb_unitigs_extremities = 0; // will be used by NodeIteratorGU (getNodes, iteratorRanges)
     uint64_t nb_utigs_nucl = 0;
     uint64_t nb_utigs_nucl_mem = 0;
     uint64_t total_unitigs_size = 0;
@@ -590,11 +626,15 @@ void GraphUnitigsTemplate<span>::load_unitigs(string unitigs_filename)
     nb_unitigs = unitigs_sizes.size();
 
 
-    unitigs_traversed.resize(0);
-    unitigs_traversed.resize(nb_unitigs, false); // resize "traversed" bitvector, setting it to zero as well
+    unitigs_traversed.resize(nb_unitigs); // resize "traversed" bitvector, setting it to zero as well
+
+    unitigs_deleted.resize(nb_unitigs); // resize "deleted" bitvector, setting it to zero as well
+
+    internal_set_locator(nullptr); // it indexed the previous unitigs
+    unitigs_original_ids.clear();
 
-    unitigs_deleted.resize(0);
-    unitigs_deleted.resize(nb_unitigs, false); // resize "traversed" bitvector, setting it to zero as well
+    unitigs_memory = system::impl::MemoryCharge (system::impl::MEMORY_UNITIGS);
+    unitigs_memory.set (unitigs_mem_size());
 
     // an estimation of memory usage
     if (verbose)
@@ -782,10 +822,14 @@ void GraphUnitigsTemplate<span>::load_unitigs_from_gfa(string gfa_filename, unsi
 	assert(nb_unitigs == unitigs_sizes.size()); // not sure if this is enforced
 	
     // code dupl
-    unitigs_traversed.resize(0);
-    unitigs_traversed.resize(nb_unitigs, false); // resize "traversed" bitvector, setting it to zero as well
-    unitigs_deleted.resize(0);
-    unitigs_deleted.resize(nb_unitigs, false); // resize "traversed" bitvector, setting it to zero as well
+    unitigs_traversed.resize(nb_unitigs); // resize "traversed" bitvector, setting it to zero as well
+    unitigs_deleted.resize(nb_unitigs); // resize "deleted" bitvector, setting it to zero as well
+
+    internal_set_locator(nullptr); // it indexed the previous unitigs
+    unitigs_original_ids.clear();
+
+    unitigs_memory = system::impl::MemoryCharge (system::impl::MEMORY_UNITIGS);
+    unitigs_memory.set (unitigs_mem_size());
 
 	if (verbose)
         print_unitigs_mem_stats(incoming_size, outcoming_size, total_unitigs_size);
@@ -1002,6 +1046,10 @@ GraphUnitigsTemplate<span>& GraphUnitigsTemplate<span>::operator= (GraphUnitigsT
         unitigs_deleted = graph.unitigs_deleted;
         nb_unitigs = graph.nb_unitigs;
         nb_unitigs_extremities = graph.nb_unitigs_extremities;
+        internal_set_locator(graph.locator);
+        locator_offset_bits = graph.locator_offset_bits;
+        unitigs_original_ids = graph.unitigs_original_ids;
+        unitigs_memory = graph.unitigs_memory;
         
     }
     return *this;
@@ -1051,6 +1099,12 @@ GraphUnitigsTemplate<span>& GraphUnitigsTemplate<span>::operator= (GraphUnitigsT
         unitigs_deleted = std::move(graph.unitigs_deleted);
         nb_unitigs = std::move(graph.nb_unitigs);
         nb_unitigs_extremities = std::move(graph.nb_unitigs_extremities);
+        internal_set_locator(graph.locator);
+        graph.internal_set_locator(nullptr);
+        locator_offset_bits = graph.locator_offset_bits;
+        unitigs_original_ids = std::move(graph.unitigs_original_ids);
+        unitigs_memory = graph.unitigs_memory;
+        graph.unitigs_memory.set (0); // the unitigs now belong to this graph
         
     }
     return *this;
@@ -1070,6 +1124,7 @@ GraphUnitigsTemplate<span>::~GraphUnitigsTemplate<span> ()
 {
     // base deleter already called
     //std::cout <<"unitigs graph destructor called" << std::endl;
+    internal_set_locator(nullptr);
 }
 
 /*********************************************************************
@@ -1288,84 +1343,115 @@ NodeGU GraphUnitigsTemplate<span>::getNode (const NodeGU& source, Direction dir,
     return NodeGU();
 }
 
+/* emulates iteration of nodes à la original GATB Graph */
+/* except that here, we only iterate the extremities of unitigs, in the unitigs range [first_unitig, last_unitig) */
 template<size_t span>
-GraphIterator<NodeGU> GraphUnitigsTemplate<span>::getNodes () const
+class NodeIteratorGU : public tools::dp::ISmartIterator<NodeGU>
 {
-    /* emulates iteration of nodes à la original GATB Graph */
-    /* except that here, we only iterate the extremities of unitigs */
-    class NodeIterator : public tools::dp::ISmartIterator<NodeGU>
-    {
-        public:
-            NodeIterator (const /*dag::dag_vector*/ std::vector<uint32_t>& unitigs_sizes, const std::vector<bool>& unitigs_deleted, unsigned int k, unsigned int nb_unitigs_extremities) 
-                :  _nbItems(nb_unitigs_extremities), _rank(0), _isDone(true), unitigs_sizes(unitigs_sizes), unitigs_deleted(unitigs_deleted), k(k), nb_unitigs(unitigs_sizes.size()) {  
-                    this->_item->strand = STRAND_FORWARD;  // iterated nodes are always in forward strand.
-                }
+    public:
+        NodeIteratorGU (const /*dag::dag_vector*/ std::vector<uint32_t>& unitigs_sizes, const AtomicBitset& unitigs_deleted, unsigned int k, uint64_t nb_extremities, uint64_t first_unitig, uint64_t last_unitig) 
+            :  _nbItems(nb_extremities), _rank(0), _isDone(true), unitigs_sizes(unitigs_sizes), unitigs_deleted(unitigs_deleted), k(k), it_begin(2*first_unitig), it_end(2*last_unitig) {  
+                this->_item->strand = STRAND_FORWARD;  // iterated nodes are always in forward strand.
+            }
 
-            ~NodeIterator ()  {  }
+        ~NodeIteratorGU ()  {  }
 
-            u_int64_t rank () const { return _rank; }
+        u_int64_t rank () const { return _rank; }
 
-            void update_item()
-            {
-                this->_rank ++;
-                this->_item->unitig = it/2;
-                this->_item->pos = (it&1)?UNITIG_END:UNITIG_BEGIN;
-            }
+        void update_item()
+        {
+            this->_rank ++;
+            this->_item->unitig = it/2;
+            this->_item->pos = (it&1)?UNITIG_END:UNITIG_BEGIN;
+        }
 
-            /** \copydoc  Iterator::first */
-            void first()
-            {
-                it = 0;
-                while (unitigs_deleted[it/2] && it < 2*nb_unitigs) it++;
-                _rank   = 0;
-                _isDone = it >= (2*nb_unitigs);
+        // a unitig that is just a kmer has a single node, its end
+        bool is_node() const
+        {
+            return !unitigs_deleted[it/2] && !((it&1) == 0 && unitigs_sizes[it/2] == k);
+        }
 
-                if (!_isDone)
-                    update_item();
-            }
+        /** \copydoc  Iterator::first */
+        void first()
+        {
+            it = it_begin;
+            while (it < it_end && !is_node()) it++;
+            _rank   = 0;
+            _isDone = it >= it_end;
 
-            /** \copydoc  Iterator::next */
-            void next()
+            if (!_isDone)
+                update_item();
+        }
+
+        /** \copydoc  Iterator::next */
+        void next()
+        {
+            do
             {
-                do
-                {
-                    it++;
-                    if ((it < 2*nb_unitigs) && unitigs_sizes[it/2] == k) // takes care of the case where the unitig is just a kmer
-                        it++;
-                } while ((it < 2*nb_unitigs) && unitigs_deleted[it/2]);
-                _isDone = it >= (2*nb_unitigs);
-                if (!_isDone)
-                    update_item();
-            }
+                it++;
+            } while (it < it_end && !is_node());
+            _isDone = it >= it_end;
+            if (!_isDone)
+                update_item();
+        }
 
-            /** \copydoc  Iterator::isDone */
-            bool isDone() { return _isDone;  }
+        /** \copydoc  Iterator::isDone */
+        bool isDone() { return _isDone;  }
 
-            /** \copydoc  Iterator::item */
-            NodeGU& item ()  {  return *(this->_item);  }
+        /** \copydoc  Iterator::item */
+        NodeGU& item ()  {  return *(this->_item);  }
 
-            void setItem (NodeGU& i)
-            {
-                /** We set the node item to be set for the current iterator. */
-                this->_item = &i;
-                this->_item->strand = STRAND_FORWARD;
-            }
+        void setItem (NodeGU& i)
+        {
+            /** We set the node item to be set for the current iterator. */
+            this->_item = &i;
+            this->_item->strand = STRAND_FORWARD;
+        }
 
-            /** */
-            u_int64_t size () const { return _nbItems; }
-
-        private:
-            uint64_t it;
-            u_int64_t _nbItems;
-            u_int64_t _rank;
-            bool      _isDone;
-            const /*dag::dag_vector*/ std::vector<uint32_t>& unitigs_sizes;
-            const std::vector<bool>& unitigs_deleted;
-            unsigned int k;
-            unsigned int nb_unitigs;
-    };
+        /** */
+        u_int64_t size () const { return _nbItems; }
+
+    private:
+        uint64_t it;
+        u_int64_t _nbItems;
+        u_int64_t _rank;
+        bool      _isDone;
+        const /*dag::dag_vector*/ std::vector<uint32_t>& unitigs_sizes;
+        const AtomicBitset& unitigs_deleted;
+        unsigned int k;
+        uint64_t it_begin, it_end;
+};
 
-    return new NodeIterator(unitigs_sizes, unitigs_deleted, BaseGraph::_kmerSize, nb_unitigs_extremities);
+template<size_t span>
+GraphIterator<NodeGU> GraphUnitigsTemplate<span>::getNodes () const
+{
+    return new NodeIteratorGU<span>(unitigs_sizes, unitigs_deleted, BaseGraph::_kmerSize, nb_unitigs_extremities, 0, nb_unitigs);
+}
+
+template<size_t span>
+std::vector<tools::dp::Iterator<NodeGU>*> GraphUnitigsTemplate<span>::iteratorRanges (IteratorListener* listener) const
+{
+    // enough ranges for the threads to balance the work, but not too many so that each range has a good amount of nodes
+    const uint64_t range_size = std::max((uint64_t)(1 << 16), nb_unitigs / 1024);
+
+    /** The iterators of the ranges are iterated concurrently, so they share a synchronized listener. */
+    IteratorListener* shared = listener ? new ProgressShared (listener, System::thread().newSynchronizer()) : 0;
+
+    std::vector<tools::dp::Iterator<NodeGU>*> result;
+    for (uint64_t first_unitig = 0; first_unitig < nb_unitigs; first_unitig += range_size)
+    {
+        uint64_t last_unitig = std::min(nb_unitigs, first_unitig + range_size);
+
+        uint64_t nb_extremities = 0;
+        for (uint64_t u = first_unitig; u < last_unitig; u++)
+            nb_extremities += (unitigs_sizes[u] == BaseGraph::_kmerSize) ? 1 : 2;
+
+        tools::dp::ISmartIterator<NodeGU>* it = new NodeIteratorGU<span>(unitigs_sizes, unitigs_deleted, BaseGraph::_kmerSize, nb_extremities, first_unitig, last_unitig);
+
+        if (shared)  { result.push_back (new SubjectIterator<NodeGU> (it, nb_unitigs_extremities/100, shared)); }
+        else         { result.push_back (it); }
+    }
+    return result;
 }
 
 template<size_t span> 
@@ -1564,7 +1650,7 @@ template<size_t span>
 void GraphUnitigsTemplate<span>::
 unitigDelete (NodeGU& node) 
 {
-    unitigs_deleted[node.unitig] = true;
+    unitigs_deleted.set(node.unitig);
     //std::cout << "GraphU deleted unitig " << node.unitig << " seq: "  << unitigs[node.unitig] << std::endl; 
 }
 
@@ -1574,11 +1660,31 @@ template<size_t span>
 void GraphUnitigsTemplate<span>::
 unitigDelete (NodeGU& node, Direction dir, NodesDeleter<NodeGU, EdgeGU, GraphUnitigsTemplate<span>>& nodesDeleter) 
 {
-    nodesDeleter.onlyListMethod = true; // a bit inefficient to always tell the deleter to be in that mode, but so be it for now. just 1 instruction, won't hurt.
     //std::cout << "GraphU queuing to delete unitig " << node.unitig << " seq: "  << unitigs[node.unitig] << " mean abundance " << unitigMeanAbundance(node) << std::endl; 
     nodesDeleter.markToDelete(node);
 }
 
+/* commits deferred deletions (see NodesDeleter): threads merge disjoint ranges of words of the bitsets */
+template<size_t span>
+uint64_t GraphUnitigsTemplate<span>::
+unitigsDelete (const AtomicBitset& toDelete, unsigned int nbCores) 
+{
+    const uint64_t words_per_chunk = 1024;
+    uint64_t nb_chunks = (toDelete.getNbWords() + words_per_chunk - 1) / words_per_chunk;
+    uint64_t nb_deleted = 0;
+
+    if (nb_chunks > 0)
+    {
+        tools::misc::Range<uint64_t>::Iterator it (0, nb_chunks-1);
+        tools::dp::impl::Dispatcher (nbCores, 1).iterate (it, [&] (uint64_t chunk)
+        {
+            uint64_t n = unitigs_deleted.merge (toDelete, chunk*words_per_chunk, (chunk+1)*words_per_chunk);
+            __sync_fetch_and_add (&nb_deleted, n);
+        });
+    }
+    return nb_deleted;
+}
+
 template<size_t span>
 void GraphUnitigsTemplate<span>::
 simplePathDelete (NodeGU& node, Direction dir, NodesDeleter<NodeGU, EdgeGU, GraphUnitigsTemplate<span>>& nodesDeleter) 
@@ -1781,14 +1887,13 @@ simplePathLongest_avance(const NodeGU& node, Direction dir, int& seqLength, int&
         
         //if (debug) std::cout << "seqlength add " << (unitigLength - (kmerSize-1)) << " added cov " << (unitigMeanAbundance(cur_node) * (unitigLength - kmerSize + 1)) << " mean ab " << unitigMeanAbundance(cur_node) << std::endl;
 
-        if (markDuringTraversal&& unitigIsMarked(cur_node)) // just a debug, can be removed
+        // claims the unitig: the traversal stops if it was already marked, either by a perfect loop
+        // or by another thread traversing the same simple path at the same time
+        if (markDuringTraversal && !unitigTryMark(cur_node))
         {
             //std::cout << "marked node during a simple path traversal, that shouldn't happen. Maybe it's a perfect loop." << std::endl;
             return;
         }
-
-        if (markDuringTraversal)
-            unitigMark(cur_node);
     }
 }
 
@@ -1833,7 +1938,14 @@ template<size_t span>
 void GraphUnitigsTemplate<span>::
 unitigMark            (const NodeGU& node) 
 {
-    unitigs_traversed[node.unitig] = true;
+    unitigs_traversed.set(node.unitig);
+} 
+
+template<size_t span>
+bool GraphUnitigsTemplate<span>::
+unitigTryMark         (const NodeGU& node) 
+{
+    return !unitigs_traversed.set(node.unitig);
 } 
 
 template<size_t span>
@@ -1886,6 +1998,17 @@ template<size_t span>
 NodeGU GraphUnitigsTemplate<span>::
 debugBuildNode(string startKmer) const
 {
+    if (hasLocator())
+    {
+        KmerLocationGU location;
+        if (locateKmer(startKmer, location))
+        {
+            NodeGU node = internal_location_to_node(location);
+            if (node.pos != UNITIG_INSIDE)
+                return node;
+        }
+    }
+
     bool debug=false;
     for (unsigned int i = 0; i < nb_unitigs; i++)
     {
@@ -1909,6 +2032,462 @@ debugBuildNode(string startKmer) const
     exit(1);
 }
 
+/*
+ *
+ * locator index: kmer -> (unitig, offset)
+ *
+ */
+
+/* Iterable over the canonical kmers of all the unitigs, for building the MPHF of the locator. */
+template<size_t span>
+class UnitigsKmersIterable : public tools::collections::Iterable<typename Kmer<span>::Type>, public system::SmartPointer
+{
+public:
+    typedef typename Kmer<span>::Type Type;
+
+    UnitigsKmersIterable (const GraphUnitigsTemplate<span>& graph, uint64_t nbKmers) : graph(graph), nbKmers(nbKmers) {}
+
+    tools::dp::Iterator<Type>* iterator ()  { return new KmersIterator (graph); }
+
+    int64_t getNbItems ()       { return nbKmers; }
+    int64_t estimateNbItems ()  { return nbKmers; }
+
+private:
+
+    class KmersIterator : public tools::dp::Iterator<Type>
+    {
+    public:
+        KmersIterator (const GraphUnitigsTemplate<span>& graph) : graph(graph), rolling(graph.getKmerSize()), unitig(0), idx(0), done(true) {}
+
+        void first ()  { unitig = 0; idx = 0; done = false; fill(); }
+
+        void next ()
+        {
+            if (++idx >= kmers.size())  { unitig++; idx = 0; fill(); }
+            else                        { *(this->_item) = kmers[idx]; }
+        }
+
+        bool isDone ()  { return done; }
+
+        Type& item ()  { return *(this->_item); }
+
+    private:
+        const GraphUnitigsTemplate<span>& graph;
+        RollingKmers<span> rolling;
+        PackedNucleotides packed;
+        std::vector<Type> kmers;
+        std::vector<u_int64_t> invalid;
+        uint64_t unitig;
+        size_t idx;
+        bool done;
+
+        void fill ()
+        {
+            for ( ; unitig < graph.nb_unitigs; unitig++)
+            {
+                string seq = graph.internal_get_unitig_sequence(unitig);
+                packed.encode (seq.c_str(), seq.size());
+                if (rolling.canonical (packed, kmers, invalid) > 0)
+                {
+                    *(this->_item) = kmers[0];
+                    return;
+                }
+            }
+            done = true;
+        }
+    };
+
+    const GraphUnitigsTemplate<span>& graph;
+    uint64_t nbKmers;
+};
+
+template<size_t span>
+void GraphUnitigsTemplate<span>::internal_set_locator (tools::collections::impl::MapMPHF<Type,uint64_t>* newLocator)
+{
+    if (newLocator)  { newLocator->use(); }
+    if (locator)     { locator->forget(); }
+    locator = newLocator;
+}
+
+/* the MPHF is built over the canonical kmers of all the unitigs, then each unitig writes its (unitig, offset) entries.
+ * unitigs have no duplicate kmers, so the threads never write the same entry. */
+template<size_t span>
+void GraphUnitigsTemplate<span>::buildLocator (unsigned int nbCores, bool verbose)
+{
+    unsigned int kmerSize = BaseGraph::_kmerSize;
+    ITime::Value t0 = System::time().getTimeStamp();
+
+    uint64_t nbKmers = 0, maxOffset = 0;
+    for (uint64_t i = 0; i < nb_unitigs; i++)
+    {
+        nbKmers += unitigs_sizes[i] - kmerSize + 1;
+        maxOffset = std::max(maxOffset, (uint64_t)(unitigs_sizes[i] - kmerSize));
+    }
+
+    locator_offset_bits = 0;
+    while ((maxOffset >> locator_offset_bits) != 0)
+        locator_offset_bits++;
+
+    if (locator_offset_bits > 0 && nb_unitigs > 0 && ((nb_unitigs - 1) >> (64 - locator_offset_bits)) != 0)
+        throw system::Exception ("GraphUnitigs locator: %ld unitigs with offsets on %d bits don't fit in 64 bits", nb_unitigs, locator_offset_bits);
+
+    tools::collections::impl::MapMPHF<Type,uint64_t>* newLocator = new tools::collections::impl::MapMPHF<Type,uint64_t>();
+    internal_set_locator(newLocator);
+
+    UnitigsKmersIterable<span> kmersIterable (*this, nbKmers);
+    locator->build (kmersIterable, nbCores);
+
+    ITime::Value t1 = System::time().getTimeStamp();
+
+    /* unitigs are dispatched by chunks, to amortize the decoding buffers */
+    const uint64_t chunkSize = 1024;
+    uint64_t nbChunks = (nb_unitigs + chunkSize - 1) / chunkSize;
+    if (nbChunks > 0)
+    {
+        tools::misc::Range<uint64_t>::Iterator it (0, nbChunks-1);
+        tools::dp::impl::Dispatcher (nbCores, 1).iterate (it, [&] (uint64_t chunk)
+        {
+            RollingKmers<span> rolling (kmerSize);
+            PackedNucleotides packed;
+            std::vector<Type> kmers;
+            std::vector<u_int64_t> invalid;
+
+            for (uint64_t u = chunk*chunkSize; u < std::min(nb_unitigs, (chunk+1)*chunkSize); u++)
+            {
+                string seq = internal_get_unitig_sequence(u);
+                packed.encode (seq.c_str(), seq.size());
+                size_t n = rolling.canonical (packed, kmers, invalid);
+                for (size_t offset = 0; offset < n; offset++)
+                    locator->at(kmers[offset]) = (u << locator_offset_bits) | offset;
+            }
+        });
+    }
+
+    unitigs_memory.set (unitigs_mem_size());
+
+    ITime::Value t2 = System::time().getTimeStamp();
+
+    if (verbose)
+    {
+        std::cout << "unitigs locator: " << nbKmers << " kmers, offsets on " << locator_offset_bits << " bits" << std::endl;
+        std::cout << "   MPHF built in " << (t1-t0) / 1000.0 << " s, entries filled in " << (t2-t1) / 1000.0 << " s" << std::endl;
+        std::cout << "   " << (nbKmers * sizeof(uint64_t)) / 1024 / 1024 << " MB entries (the MPHF is counted apart)" << std::endl;
+    }
+}
+
+/* renumbers the unitigs in a Cuthill-McKee-like order: BFS over the links, the neighbors of lower degree first.
+ * components are started from their unitigs of degree <= 1 (ends of paths, tips) when they have some.
+ * the BFS is sequential (linear time); the rewrite of the vectors is parallel, by chunks of new ids. */
+template<size_t span>
+void GraphUnitigsTemplate<span>::reorderUnitigs (unsigned int nbCores, bool verbose)
+{
+    ITime::Value t0 = System::time().getTimeStamp();
+
+    const uint64_t n = nb_unitigs;
+
+    /* offsets of the links of each unitig in incoming/outcoming, before renumbering */
+    std::vector<uint64_t> inc_off(n+1, 0), out_off(n+1, 0);
+    for (uint64_t u = 0; u < n; u++)
+    {
+        if (compress_navigational_vectors)
+        {
+            inc_off[u+1] = inc_off[u] + dag_incoming_map[u];
+            out_off[u+1] = out_off[u] + dag_outcoming_map[u];
+        }
+        else
+        {
+            inc_off[u+1] = (u+1 < n) ? incoming_map[u+1] : incoming.size();
+            out_off[u+1] = (u+1 < n) ? outcoming_map[u+1] : outcoming.size();
+        }
+    }
+
+    auto degree = [&] (uint64_t u) { return (inc_off[u+1] - inc_off[u]) + (out_off[u+1] - out_off[u]); };
+
+    /* the new order; it's also the BFS queue */
+    std::vector<uint64_t> old_of;  old_of.reserve(n);
+    std::vector<bool> visited(n, false);
+    std::vector<uint64_t> neighbors;
+
+    auto bfs = [&] (uint64_t seed)
+    {
+        visited[seed] = true;
+        old_of.push_back(seed);
+        for (uint64_t head = old_of.size() - 1; head < old_of.size(); head++)
+        {
+            uint64_t u = old_of[head];
+            neighbors.clear();
+            for (uint64_t i = inc_off[u]; i < inc_off[u+1]; i++)  neighbors.push_back(ExtremityInfo(incoming[i]).unitig);
+            for (uint64_t i = out_off[u]; i < out_off[u+1]; i++)  neighbors.push_back(ExtremityInfo(outcoming[i]).unitig);
+            std::sort(neighbors.begin(), neighbors.end(), [&] (uint64_t a, uint64_t b) { return degree(a) < degree(b) || (degree(a) == degree(b) && a < b); });
+            for (uint64_t v : neighbors)
+            {
+                if (visited[v])  continue;
+                visited[v] = true;
+                old_of.push_back(v);
+            }
+        }
+    };
+
+    for (uint64_t u = 0; u < n; u++)
+        if (!visited[u] && degree(u) <= 1)  bfs(u);
+    for (uint64_t u = 0; u < n; u++)
+        if (!visited[u])  bfs(u);
+
+    std::vector<uint64_t> new_of(n);
+    for (uint64_t i = 0; i < n; i++)
+        new_of[old_of[i]] = i;
+
+    ITime::Value t1 = System::time().getTimeStamp();
+
+    /* offsets of the links and of the packed unitigs, after renumbering */
+    std::vector<uint64_t> new_inc_off(n+1, 0), new_out_off(n+1, 0), old_packed_off, new_packed_off;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        new_inc_off[i+1] = new_inc_off[i] + (inc_off[old_of[i]+1] - inc_off[old_of[i]]);
+        new_out_off[i+1] = new_out_off[i] + (out_off[old_of[i]+1] - out_off[old_of[i]]);
+    }
+    if (pack_unitigs)
+    {
+        old_packed_off.resize(n+1, 0);  new_packed_off.resize(n+1, 0);
+        for (uint64_t u = 0; u < n; u++)
+            old_packed_off[u+1] = old_packed_off[u] + (unitigs_sizes[u]+3)/4;
+        for (uint64_t i = 0; i < n; i++)
+            new_packed_off[i+1] = new_packed_off[i] + (unitigs_sizes[old_of[i]]+3)/4;
+    }
+
+    std::vector<uint64_t> new_incoming(incoming.size()), new_outcoming(outcoming.size());
+    std::string new_packed_unitigs(packed_unitigs.size(), 0);
+    std::vector<std::string> new_unitigs(unitigs.size());
+    std::vector<uint32_t> new_sizes(n);
+    std::vector<float> new_abundances(n);
+    tools::collections::impl::AtomicBitset new_deleted(n), new_traversed(n);
+
+    auto remap = [&] (uint64_t link) { ExtremityInfo li(link); li.unitig = new_of[li.unitig]; return li.pack(); };
+
+    const uint64_t chunkSize = 1024;
+    uint64_t nbChunks = (n + chunkSize - 1) / chunkSize;
+    if (nbChunks > 0)
+    {
+        tools::misc::Range<uint64_t>::Iterator it (0, nbChunks-1);
+        tools::dp::impl::Dispatcher (nbCores, 1).iterate (it, [&] (uint64_t chunk)
+        {
+            for (uint64_t i = chunk*chunkSize; i < std::min(n, (chunk+1)*chunkSize); i++)
+            {
+                uint64_t u = old_of[i];
+                for (uint64_t j = 0; j < inc_off[u+1] - inc_off[u]; j++)  new_incoming [new_inc_off[i] + j] = remap(incoming [inc_off[u] + j]);
+                for (uint64_t j = 0; j < out_off[u+1] - out_off[u]; j++)  new_outcoming[new_out_off[i] + j] = remap(outcoming[out_off[u] + j]);
+
+                if (pack_unitigs)
+                    packed_unitigs.copy(&new_packed_unitigs[new_packed_off[i]], old_packed_off[u+1] - old_packed_off[u], old_packed_off[u]);
+                else
+                    new_unitigs[i] = std::move(unitigs[u]);
+
+                new_sizes[i] = unitigs_sizes[u];
+                new_abundances[i] = unitigs_mean_abundance[u];
+                if (unitigs_deleted[u])    new_deleted.set(i);
+                if (unitigs_traversed[u])  new_traversed.set(i);
+            }
+        });
+    }
+
+    /* the entries of the locator are (unitig, offset), only the unitig changes. The locator may be
+     * shared with copies of the graph (see operator=), which keep the previous unitig ids: the entries
+     * are remapped into a new locator using the same MPHF */
+    if (locator)
+    {
+        tools::collections::impl::MapMPHF<Type,uint64_t>* newLocator = new tools::collections::impl::MapMPHF<Type,uint64_t>();
+        LOCAL (newLocator);
+        newLocator->useHashFrom (locator);
+
+        uint64_t nbEntries = locator->size();
+        uint64_t nbEntriesChunks = (nbEntries + chunkSize*64 - 1) / (chunkSize*64);
+        if (nbEntriesChunks > 0)
+        {
+            tools::misc::Range<uint64_t>::Iterator it (0, nbEntriesChunks-1);
+            tools::dp::impl::Dispatcher (nbCores, 1).iterate (it, [&] (uint64_t chunk)
+            {
+                uint64_t offset_mask = (locator_offset_bits == 0) ? 0 : ((~0ULL) >> (64 - locator_offset_bits));
+                for (uint64_t code = chunk*chunkSize*64; code < std::min(nbEntries, (chunk+1)*chunkSize*64); code++)
+                {
+                    uint64_t entry = locator->at(code);
+                    newLocator->at(code) = (new_of[entry >> locator_offset_bits] << locator_offset_bits) | (entry & offset_mask);
+                }
+            });
+        }
+
+        internal_set_locator(newLocator);
+    }
+
+    incoming.swap(new_incoming);
+    outcoming.swap(new_outcoming);
+    if (compress_navigational_vectors)
+    {
+        dag::dag_vector inc_map, out_map;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            inc_map.push_back(new_inc_off[i+1] - new_inc_off[i]);
+            out_map.push_back(new_out_off[i+1] - new_out_off[i]);
+        }
+        dag_incoming_map.swap(inc_map);
+        dag_outcoming_map.swap(out_map);
+    }
+    else
+    {
+        incoming_map.assign(new_inc_off.begin(), new_inc_off.end() - 1);
+        outcoming_map.assign(new_out_off.begin(), new_out_off.end() - 1);
+    }
+
+    if (pack_unitigs)
+    {
+        packed_unitigs.swap(new_packed_unitigs);
+        dag::dag_vector sizes;
+        for (uint64_t i = 0; i < n; i++)
+            sizes.push_back(new_packed_off[i+1] - new_packed_off[i]);
+        packed_unitigs_sizes.swap(sizes);
+    }
+    else
+        unitigs.swap(new_unitigs);
+
+    unitigs_sizes.swap(new_sizes);
+    unitigs_mean_abundance.swap(new_abundances);
+    unitigs_deleted = std::move(new_deleted);
+    unitigs_traversed = std::move(new_traversed);
+
+    /* composes with a previous reordering */
+    std::vector<uint64_t> original_ids(n);
+    for (uint64_t i = 0; i < n; i++)
+        original_ids[i] = originalUnitigId(old_of[i]);
+    unitigs_original_ids.swap(original_ids);
+
+    unitigs_memory.set (unitigs_mem_size());
+
+    ITime::Value t2 = System::time().getTimeStamp();
+
+    if (verbose)
+    {
+        std::cout << "unitigs reordered: " << n << " unitigs" << std::endl;
+        std::cout << "   order computed in " << (t1-t0) / 1000.0 << " s, vectors rewritten in " << (t2-t1) / 1000.0 << " s" << std::endl;
+    }
+}
+
+/* forward kmer of the unitig at a given offset, straight from the 2-bit packed unitig */
+template<size_t span>
+typename GraphUnitigsTemplate<span>::Type GraphUnitigsTemplate<span>::internal_get_unitig_kmer (uint64_t unitig_id, uint32_t offset) const
+{
+    const char* packed;
+    if (pack_unitigs)
+        packed = packed_unitigs.data() + ((unitig_id == 0) ? 0 : packed_unitigs_sizes.prefix_sum(unitig_id));
+    else
+        packed = unitigs[unitig_id].data();
+
+    Type kmer;  kmer.setVal(0);
+    for (uint32_t i = offset; i < offset + BaseGraph::_kmerSize; i++)
+        kmer = (kmer << 2) + (u_int64_t)((((unsigned char)packed[i/4]) >> (2*(i % 4))) & 3);
+    return kmer;
+}
+
+template<size_t span>
+bool GraphUnitigsTemplate<span>::internal_locate_kmer (const typename Kmer<span>::KmerCanonical& kmer, KmerLocationGU& location) const
+{
+    uint64_t code = locator->getCode (kmer.value());
+    if (code >= locator->size())
+        return false;
+
+    uint64_t entry = locator->at(code);
+    uint64_t unitig = entry >> locator_offset_bits;
+    uint32_t offset = entry & ((((uint64_t)1) << locator_offset_bits) - 1);
+
+    /* entries of kmers that aren't in the graph are arbitrary */
+    if (unitig >= nb_unitigs || offset + BaseGraph::_kmerSize > unitigs_sizes[unitig])
+        return false;
+
+    Type inUnitig = internal_get_unitig_kmer(unitig, offset);
+    if (inUnitig != kmer.forward() && inUnitig != kmer.revcomp())
+        return false;
+
+    location.unitig = unitig;
+    location.offset = offset;
+    location.strand = (inUnitig == kmer.forward()) ? STRAND_FORWARD : STRAND_REVCOMP;
+    return true;
+}
+
+template<size_t span>
+bool GraphUnitigsTemplate<span>::locateKmer (const std::string& kmer, KmerLocationGU& location) const
+{
+    if (!hasLocator())
+        throw system::Exception ("GraphUnitigs: locateKmer called before buildLocator");
+
+    if (kmer.size() != BaseGraph::_kmerSize)
+        return false;
+
+    Model model (BaseGraph::_kmerSize);
+    return internal_locate_kmer (model.codeSeed(kmer.c_str(), Data::ASCII), location);
+}
+
+template<size_t span>
+void GraphUnitigsTemplate<span>::locateKmers (const std::vector<std::string>& kmers, std::vector<KmerLocationGU>& locations, std::vector<bool>& found, unsigned int nbCores) const
+{
+    if (!hasLocator())
+        throw system::Exception ("GraphUnitigs: locateKmers called before buildLocator");
+
+    locations.resize (kmers.size());
+    std::vector<u_int8_t> isFound (kmers.size(), 0); // vector<bool> can't be written by several threads
+
+    Model model (BaseGraph::_kmerSize);
+
+    const size_t chunkSize = 16*1024;
+    size_t nbChunks = (kmers.size() + chunkSize - 1) / chunkSize;
+    if (nbChunks > 0)
+    {
+        tools::misc::Range<size_t>::Iterator it (0, nbChunks-1);
+        tools::dp::impl::Dispatcher (nbCores, 1).iterate (it, [&] (size_t chunk)
+        {
+            for (size_t i = chunk*chunkSize; i < std::min(kmers.size(), (chunk+1)*chunkSize); i++)
+            {
+                if (kmers[i].size() == BaseGraph::_kmerSize)
+                    isFound[i] = internal_locate_kmer (model.codeSeed(kmers[i].c_str(), Data::ASCII), locations[i]);
+            }
+        });
+    }
+
+    found.assign (isFound.begin(), isFound.end());
+}
+
+/* same conventions as debugBuildNode: a kmer read as is at the start (resp. the end) of a unitig
+ * is the forward node at UNITIG_BEGIN (resp. UNITIG_END), and the reverse-complement nodes are at the
+ * extremity where the reverse complement of the kmer is. */
+template<size_t span>
+NodeGU GraphUnitigsTemplate<span>::internal_location_to_node (const KmerLocationGU& location) const
+{
+    uint32_t lastOffset = internal_get_unitig_length(location.unitig) - BaseGraph::_kmerSize;
+
+    if (location.strand == STRAND_FORWARD)
+    {
+        if (location.offset == 0)           return NodeGU(location.unitig, UNITIG_BEGIN, STRAND_FORWARD);
+        if (location.offset == lastOffset)  return NodeGU(location.unitig, UNITIG_END,   STRAND_FORWARD);
+    }
+    else
+    {
+        if (location.offset == lastOffset)  return NodeGU(location.unitig, UNITIG_END,   STRAND_REVCOMP);
+        if (location.offset == 0)           return NodeGU(location.unitig, UNITIG_BEGIN, STRAND_REVCOMP);
+    }
+    return NodeGU(location.unitig, UNITIG_INSIDE, location.strand);
+}
+
+template<size_t span>
+void GraphUnitigsTemplate<span>::buildNodes (const std::vector<std::string>& kmers, std::vector<NodeGU>& nodes, std::vector<bool>& found, unsigned int nbCores) const
+{
+    std::vector<KmerLocationGU> locations;
+    locateKmers (kmers, locations, found, nbCores);
+
+    nodes.resize (kmers.size());
+    for (size_t i = 0; i < kmers.size(); i++)
+    {
+        if (found[i])
+            nodes[i] = internal_location_to_node(locations[i]);
+    }
+}
+
 
 /*
  *
@@ -29,6 +29,9 @@
 #include <gatb/debruijn/impl/ExtremityInfo.hpp>
 
 #include <gatb/debruijn/impl/dag_vector.hpp> // TODO move it to 3rd party
+#include <gatb/system/impl/MemoryAccounting.hpp>
+#include <gatb/tools/collections/impl/MapMPHF.hpp>
+#include <gatb/tools/collections/impl/AtomicBitset.hpp>
 
 
 /********************************************************************************/
@@ -120,6 +123,22 @@ struct EdgeGU
     }
 };
 
+/* Location of a kmer in the unitigs, as given by the locator index of GraphUnitigs.
+ */
+struct KmerLocationGU
+{
+    /** Default constructor. */
+    KmerLocationGU() : unitig(0), offset(0), strand(kmer::STRAND_FORWARD)  {}
+
+    uint64_t unitig;
+
+    /** Position of the first nucleotide of the kmer in the unitig sequence. */
+    uint32_t offset;
+
+    /** STRAND_FORWARD if the kmer is read as is in the unitig sequence, STRAND_REVCOMP if its reverse complement is. */
+    kmer::Strand strand;
+};
+
 /********************************************************************************
                  #####   ######      #     ######   #     #
                 #     #  #     #    # #    #     #  #     #
@@ -208,6 +227,38 @@ public:
     inline GraphIterator<NodeGU> iterator () const  {  return getNodes ();           }
     inline GraphIterator<NodeGU> iteratorCachedNodes () const { return getNodes(); } /* cached nodes are just nodes in this case*/
 
+    /** Creates iterators over the nodes of ranges of unitigs ids; all together, they iterate the
+     * same nodes as 'iterator'. Each one is meant to be iterated by a single thread.
+     * \param[in] listener : optional progress listener, shared by the iterators
+     * \return the iterators, to be deleted by the caller. */
+    std::vector<tools::dp::Iterator<NodeGU>*> iteratorRanges (tools::dp::IteratorListener* listener = 0) const;
+
+    /** Iterate all the nodes of the graph in parallel (same interface as GraphTemplate::iterateNodes).
+     * The threads get ranges of unitigs ids (see iteratorRanges) instead of sharing a single iterator.
+     * \param[in] dispatcher : dispatcher of the iteration
+     * \param[in] functor : called as 'functor (node)'; copied for each thread
+     * \param[in] listener : optional progress listener
+     * \return the status of the iteration. */
+    template<typename Functor>
+    tools::dp::IDispatcher::Status iterateNodes (tools::dp::IDispatcher& dispatcher, const Functor& functor, tools::dp::IteratorListener* listener = 0) const
+    {
+        /** The dispatcher also gives the index of the range of the node; the functor doesn't need it. */
+        struct NodeFunctor
+        {
+            Functor f;
+            NodeFunctor (const Functor& f) : f(f) {}
+            void operator() (NodeGU& node, size_t range)  { f(node); }
+        };
+
+        LOCAL (listener);
+
+        if (listener)  { listener->init(); }
+        tools::dp::IDispatcher::Status status = dispatcher.iterate (iteratorRanges (listener), NodeFunctor (functor));
+        if (listener)  { listener->finish(); }
+
+        return status;
+    }
+
     /**********************************************************************/
     /*                     ALL NEIGHBORS METHODS                          */
     /**********************************************************************/
@@ -293,7 +344,9 @@ public:
     void         simplePathDelete          (NodeGU& node, Direction dir, NodesDeleter<NodeGU, EdgeGU, GraphUnitigsTemplate<span>>& nodesDeleter);
     std::string  unitigSequence            (const NodeGU& node, bool& isolatedLeft, bool& isolatedRight) const;
     void         unitigMark                (const NodeGU& node); // used to flag simple path as traversed, in minia
+    bool         unitigTryMark             (const NodeGU& node); // same, but tells whether this call marked it: only one thread gets true for a unitig (claims the unitigs of a simple path traversal)
     bool         unitigIsMarked        (const NodeGU& node) const;
+    uint64_t     unitigsDelete             (const tools::collections::impl::AtomicBitset& toDelete, unsigned int nbCores = 1); // parallel commit of deferred deletions, returns the number of newly deleted unitigs
     
     std::string simplePathBothDirections(const NodeGU& node, bool& isolatedLeft, bool& isolatedRight, bool dummy, float& coverage);
     // aux function, not meant to be called from outside, but maybe it could.
@@ -303,6 +356,63 @@ public:
 
     NodeGU debugBuildNode(std::string startKmer) const;
 
+    /**********************************************************************/
+    /*                         LOCATOR METHODS                            */
+    /**********************************************************************/
+
+    /** Build the locator index, which gives the unitig and the position of any kmer of the graph
+     * (not only the unitigs extremities). It's a MPHF over the canonical kmers of all the unitigs,
+     * with a 64 bits (unitig, offset) entry per kmer. The MPHF gives an arbitrary entry for a kmer
+     * that isn't in the graph, so the queries check the kmer against the unitig sequence.
+     * The index is dropped when the unitigs are loaded again.
+     * \param[in] nbCores : number of threads building the index
+     * \param[in] verbose : print the building time and the memory of the index */
+    void buildLocator (unsigned int nbCores = 1, bool verbose = false);
+
+    /** Tells whether the locator index is built.
+     * \return true if buildLocator was called. */
+    bool hasLocator () const  { return locator != nullptr; }
+
+    /** Locate a kmer in the unitigs. Deleted unitigs are located as well.
+     * \param[in] kmer : the kmer (in any strand)
+     * \param[out] location : unitig, offset and strand of the kmer
+     * \return false if the kmer isn't in the graph. */
+    bool locateKmer (const std::string& kmer, KmerLocationGU& location) const;
+
+    /** Locate a batch of kmers, in parallel.
+     * \param[in] kmers : the kmers
+     * \param[out] locations : location of each kmer
+     * \param[out] found : whether each kmer is in the graph
+     * \param[in] nbCores : number of threads */
+    void locateKmers (const std::vector<std::string>& kmers, std::vector<KmerLocationGU>& locations, std::vector<bool>& found, unsigned int nbCores = 1) const;
+
+    /** Build the nodes of a batch of kmers, in parallel. It gives the same nodes as debugBuildNode
+     * for the kmers at unitigs extremities; the other kmers of the graph give a UNITIG_INSIDE node.
+     * \param[in] kmers : the kmers
+     * \param[out] nodes : node of each kmer
+     * \param[out] found : whether each kmer is in the graph
+     * \param[in] nbCores : number of threads */
+    void buildNodes (const std::vector<std::string>& kmers, std::vector<NodeGU>& nodes, std::vector<bool>& found, unsigned int nbCores = 1) const;
+
+    /**********************************************************************/
+    /*                         LAYOUT METHODS                             */
+    /**********************************************************************/
+
+    /** Renumber the unitigs so that linked unitigs get close ids, and so close places in the packed
+     * unitigs and in the navigational vectors (the unitigs file order is rather random). The order is
+     * a Cuthill-McKee-like BFS over the links; all the per-unitig vectors, the links, the deleted and
+     * traversed flags and the locator are rewritten accordingly (the locator is rebuilt over the same
+     * MPHF, so copies of the graph keep theirs). Nodes and unitig ids obtained before the call are
+     * invalidated; originalUnitigId gives the id in the unitigs file.
+     * \param[in] nbCores : number of threads rewriting the vectors
+     * \param[in] verbose : print the time of the reordering */
+    void reorderUnitigs (unsigned int nbCores = 1, bool verbose = false);
+
+    /** Get the id of a unitig in the unitigs file, before any reorderUnitigs.
+     * \param[in] unitig : current id of the unitig
+     * \return the original id. */
+    uint64_t originalUnitigId (uint64_t unitig) const  { return unitigs_original_ids.empty() ? unitig : unitigs_original_ids[unitig]; }
+
     /**********************************************************************/
     /*                         NODE METHODS                               */
     /**********************************************************************/
@@ -400,6 +510,7 @@ public: // was private: before, but had many compilation errors during the chang
 
     void load_unitigs_from_gfa(std::string gfa_filename, unsigned int& kmerSize);
     void print_unitigs_mem_stats(uint64_t avg_incoming_size, uint64_t avg_outcoming_size, uint64_t total_unitigs_size, uint64_t nb_utigs_nucl = 0, uint64_t nb_utigs_nucl_mem = 0);
+    uint64_t unitigs_mem_size() const; // memory of the unitigs structures, declared to the memory accounting
 
     bool node_in_same_orientation_as_in_unitig(const NodeGU& node) const;
       
@@ -407,6 +518,12 @@ public: // was private: before, but had many compilation errors during the chang
     std::string internal_get_unitig_sequence(unsigned int unitig_id) const;
     unsigned int internal_get_unitig_length(unsigned int unitig_id) const;
     std::string internal_compress_unitig(std::string seq) const;
+    Type internal_get_unitig_kmer(uint64_t unitig_id, uint32_t offset) const; // forward kmer starting at offset
+
+    // locator index
+    NodeGU internal_location_to_node(const KmerLocationGU& location) const;
+    bool internal_locate_kmer(const typename kmer::impl::Kmer<span>::KmerCanonical& kmer, KmerLocationGU& location) const;
+    void internal_set_locator(tools::collections::impl::MapMPHF<Type,uint64_t>* newLocator);
 
     typedef typename kmer::impl::Kmer<span>::ModelCanonical Model;
     typedef typename kmer::impl::Kmer<span>::ModelDirect ModelDirect;
@@ -425,16 +542,59 @@ public: // was private: before, but had many compilation errors during the chang
     std::vector<float> unitigs_mean_abundance;
     //dag::dag_vector unitigs_sizes;// perf hit: from 45s to 74s in chr14; that's because unitigs_sizes is queried _a lot_ just to check if a unitig is just of length k. could save that space with a bit vector, and actually, just use packed_unitigs_sizes for the rest. so.. just to keep in mind that this is a "todo opt" in case we really want to save the space of unitigs_sizes
     //dag::dag_vector unitigs_mean_abundance; // not a big gain and different assembly quality, so i'm keeping it as vector<float>
-    std::vector<bool> unitigs_deleted; // could also be replaced by modifying incoming and outcoming vectors. careful not to affect the prefix sum scheme tho.
-    std::vector<bool> unitigs_traversed;
+    tools::collections::impl::AtomicBitset unitigs_deleted; // could also be replaced by modifying incoming and outcoming vectors. careful not to affect the prefix sum scheme tho.
+    tools::collections::impl::AtomicBitset unitigs_traversed; // both are atomic bitsets, so that threads can mark different unitigs at the same time
+    tools::collections::impl::MapMPHF<Type,uint64_t>* locator = nullptr; // kmer -> (unitig << locator_offset_bits | offset), see buildLocator
+    unsigned int locator_offset_bits = 0;
+    std::vector<uint64_t> unitigs_original_ids; // current unitig id -> id in the unitigs file; empty as long as reorderUnitigs isn't called
     uint64_t nb_unitigs, nb_unitigs_extremities;
     bool compress_navigational_vectors;
     bool pack_unitigs;
+    system::impl::MemoryCharge unitigs_memory;
     // !!!!
     // read above
     // !!!!
 };
 
+/********************************************************************************/
+
+/** \brief Deferred deletions of unitigs, for the simplifications of GraphUnitigs
+ *
+ * Specialization of NodesDeleter: deleting a node deletes its whole unitig, so the deletions
+ * are marked in an atomic bitset of unitigs instead of a locked set of nodes. The threads
+ * mark and query it during a simplification pass, then flush commits all the marked unitigs
+ * in parallel (see GraphUnitigsTemplate::unitigsDelete).
+ */
+template <size_t span>
+class NodesDeleter<NodeGU, EdgeGU, GraphUnitigsTemplate<span> >
+{
+public:
+
+    NodesDeleter (GraphUnitigsTemplate<span>& graph, uint64_t nbNodes, int nbCores, bool verbose=true)
+        : _graph(graph), _nbCores(nbCores), _verbose(verbose), unitigsToDelete(graph.nb_unitigs)  {}
+
+    /** Tells whether the unitig of a node is marked for deletion. */
+    bool get (NodeGU& node)  { return unitigsToDelete.get (node.unitig); }
+
+    /** Marks the unitig of a node for deletion; can be called by several threads. */
+    void markToDelete (NodeGU& node)  { unitigsToDelete.set (node.unitig); }
+
+    /** Deletes the marked unitigs. */
+    void flush ()
+    {
+        uint64_t nbDeleted = _graph.unitigsDelete (unitigsToDelete, _nbCores);
+        if (_verbose)
+            std::cout << "NodesDeleter deleted " << nbDeleted << " unitigs" << std::endl;
+    }
+
+private:
+
+    GraphUnitigsTemplate<span>& _graph;
+    int _nbCores;
+    bool _verbose;
+    tools::collections::impl::AtomicBitset unitigsToDelete;
+};
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
@@ -42,6 +42,9 @@
 #include <gatb/tools/misc/impl/Progress.hpp> // for ProgressTimerAndSystem
 
 #include <chrono>
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
 #define get_wtime() chrono::system_clock::now()
 #define diff_wtime(x,y) (unsigned long)chrono::duration_cast<chrono::nanoseconds>(y - x).count()
 
@@ -74,6 +77,11 @@ Simplifications<GraphType, Node, Edge>::Simplifications(GraphType *graph, int nb
     // by default; do everything
     _doTipRemoval = _doBulgeRemoval = _doECRemoval = true;
 
+    _useWorklist = true;
+    for (int kind = 0; kind < WORKLIST_NB; kind++)
+        _worklistReady[kind] = false;
+    _worklistSynchro = System::thread().newSynchronizer();
+
     if (graph) // may be called with graph==null in order just to get parameters
     {
         // this is just to get number of nodes
@@ -106,6 +114,228 @@ Simplifications<GraphType, Node, Edge>::Simplifications(GraphType *graph, int nb
     _ecRCTCcutoff = 4;
 }
 
+template<typename GraphType, typename Node, typename Edge>
+Simplifications<GraphType, Node, Edge>::~Simplifications()
+{
+    delete _worklistSynchro;
+}
+
+
+/* the unitigs graph has no MPHF index of its nodes: its nodes are the extremities of its unitigs */
+struct NodeGU;
+template<typename Node> inline bool hasNodeIndex (const Node*)    { return true;  }
+inline bool                         hasNodeIndex (const NodeGU*)  { return false; }
+
+/* iterates the nodes of a simplification pass in parallel: all the nodes of the graph in the first pass
+ * (read partition by partition, each thread reading its own partitions), the cached non-simple nodes afterwards.
+ * the unitigs graph has no cache of nodes, its passes always iterate the unitigs, each thread reading its own ranges of unitigs */
+template<typename GraphType, typename Node, typename Edge>
+template<typename Functor>
+void Simplifications<GraphType,Node,Edge>::iterateNodes (Dispatcher& dispatcher, ProgressGraphIteratorTemplate<Node,ProgressTimerAndSystem>& itNode, std::vector<Node>* worklist, const char* message, const Functor& functor)
+{
+    if (_firstNodeIteration || !hasNodeIndex ((const Node*)0))
+        _graph.iterateNodes (dispatcher, functor, _verbose ? new ProgressTimerAndSystem (itNode.size(), message) : 0);
+    else if (worklist)
+        dispatcher.iterate (VectorIterator2<Node> (*worklist), functor);
+    else
+        dispatcher.iterate (itNode, functor);
+}
+
+/* incremental rounds.
+ *
+ * the decision taken on a node by a simplification only depends on the graph around it: the simple
+ * paths it starts (at most max(tip, bulge, EC) length), the alternative paths of a bulge, and the
+ * whole simple paths met right after (RCTC coverage). Deleting a simple path only changes the
+ * adjacency of its alive neighbors (the seeds). So, after a full pass, a node has to be examined
+ * again only if it can reach a seed within that radius, the simple paths starting at the seed
+ * itself counting for nothing. Those nodes are collected after each pass, and the next pass of each
+ * simplification only examines the ones collected since its previous pass (or all the cached nodes,
+ * when they are too many).
+ *
+ * the unitigs graph only emulates the MPHF index of its nodes, so it keeps the full passes. */
+template<typename GraphType, typename Node, typename Edge>
+bool Simplifications<GraphType,Node,Edge>::worklistEnabled() const
+{
+    return _useWorklist && hasNodeIndex ((const Node*)0);
+}
+
+/* gets the nodes to examine by a pass; returns false if the pass has to examine all the cached nodes */
+template<typename GraphType, typename Node, typename Edge>
+bool Simplifications<GraphType,Node,Edge>::takeWorklist(WorklistKind kind, u_int64_t nbCachedNodes, vector<Node>& worklist)
+{
+    if (!worklistEnabled())
+        return false;
+
+    if (!_worklistReady[kind])
+    {
+        // first pass of that simplification: all nodes are examined, then we only need the next deletions
+        _worklistReady[kind] = true;
+        _worklist[kind].clear();
+        return false;
+    }
+
+    worklist.swap (_worklist[kind]);
+    _worklist[kind].clear();
+
+    // a node may have been collected after several passes
+    std::sort (worklist.begin(), worklist.end());
+    worklist.erase (std::unique (worklist.begin(), worklist.end()), worklist.end());
+
+    return worklist.size() < nbCachedNodes;
+}
+
+/* records the alive neighbors of a simple path that is deleted; called before simplePathDelete, in parallel */
+template<typename GraphType, typename Node, typename Edge>
+void Simplifications<GraphType,Node,Edge>::addWorklistSeeds(Node& simplePathStart, Node& lastNode, Direction dir)
+{
+    if (!worklistEnabled())
+        return;
+
+    if (_worklistMarks.size() == 0)
+    {
+        _worklistSynchro->lock();
+        if (_worklistMarks.size() == 0)
+            _worklistMarks.resize ((nbNodes + 63) / 64, 0);
+        _worklistSynchro->unlock();
+    }
+
+    GraphVector<Edge> neighbors[2] = { _graph.neighborsEdge(simplePathStart, reverse(dir)), _graph.neighborsEdge(lastNode, dir) };
+
+    for (size_t j = 0; j < 2; j++)
+    {
+        for (size_t i = 0; i < neighbors[j].size(); i++)
+        {
+            // a node is recorded once, whatever the number of deleted paths around it
+            u_int64_t index = _graph.nodeMPHFIndex(neighbors[j][i].to);
+            u_int64_t mask  = (u_int64_t)1 << (index & 63);
+            if (__sync_fetch_and_or (&_worklistMarks[index >> 6], mask) & mask)
+                continue;
+
+            _worklistSynchro->lock();
+            _worklistSeeds.push_back(neighbors[j][i].to);
+            _worklistSynchro->unlock();
+        }
+    }
+}
+
+/* collects the nodes around the seeds of the current pass, once its deletions are flushed */
+template<typename GraphType, typename Node, typename Edge>
+void Simplifications<GraphType,Node,Edge>::updateWorklists()
+{
+    vector<Node> seeds;
+    seeds.swap (_worklistSeeds);
+
+    for (size_t i = 0; i < seeds.size(); i++)
+        _worklistMarks[_graph.nodeMPHFIndex(seeds[i]) >> 6] = 0;
+
+    if (!worklistEnabled() || !(_worklistReady[WORKLIST_TIPS] || _worklistReady[WORKLIST_BULGES] || _worklistReady[WORKLIST_EC]))
+        return;
+
+    // the farthest a simplification looks from a node, apart from whole simple paths (RCTC coverage)
+    unsigned int k = _graph.getKmerSize();
+    unsigned int maxTipLength    = (unsigned int)(k * std::max(_tipLen_Topo_kMult, _tipLen_RCTC_kMult));
+    unsigned int maxBulgeLength  = std::max((unsigned int)((double)k * _bulgeLen_kMult), (unsigned int)(k + _bulgeLen_kAdd));
+    unsigned int maxECLength     = (unsigned int)((float)k * _ecLen_kMult);
+    unsigned int radius = std::max(std::max(maxTipLength, maxECLength), maxBulgeLength) + k;
+
+    // beyond that size, a pass over all the cached nodes costs the same
+    u_int64_t maxRegion = _graph.GraphType::iteratorCachedNodes().size() / 2;
+
+    // shortest distances (in nucleotides) from any seed, the simple paths of the seeds counting for nothing
+    typedef std::pair<unsigned int, size_t> Entry;
+    std::priority_queue<Entry, vector<Entry>, std::greater<Entry> > queue;
+    std::unordered_map<u_int64_t, unsigned int> distances;
+    vector<Node> nodes;
+    vector<Node> region;
+    bool tooLarge = false;
+
+    auto reach = [&] (Node& node, unsigned int distance)
+    {
+        if (distance > radius || _graph.isNodeDeleted(node))
+            return;
+        u_int64_t index = _graph.nodeMPHFIndex(node);
+        auto it = distances.find(index);
+        if (it != distances.end() && it->second <= distance)
+            return;
+        distances[index] = distance;
+        queue.push (Entry(distance, nodes.size()));
+        nodes.push_back (node);
+    };
+
+    for (size_t i = 0; i < seeds.size(); i++)
+        reach (seeds[i], 0);
+    size_t nbSeeds = nodes.size();
+
+    while (!queue.empty() && !tooLarge)
+    {
+        unsigned int distance = queue.top().first;
+        size_t       rank     = queue.top().second;
+        Node node = nodes[rank];
+        queue.pop();
+
+        if (distances[_graph.nodeMPHFIndex(node)] < distance)
+            continue;
+
+        unsigned inDegree = _graph.indegree(node), outDegree = _graph.outdegree(node);
+
+        // simple nodes are never examined by a simplification
+        if (!(inDegree == 1 && outDegree == 1))
+        {
+            Node item = node;
+            item.strand = kmer::STRAND_FORWARD; // as the cached nodes
+            region.push_back(item);
+            tooLarge = region.size() > maxRegion;
+        }
+
+        bool isSeed = (rank < nbSeeds);
+
+        for (Direction dir = DIR_OUTCOMING; dir < DIR_END; dir = (Direction)((int)dir + 1))
+        {
+            if ((dir == DIR_OUTCOMING ? outDegree : inDegree) == 0)
+                continue;
+
+            // walk the simple path, not farther than the radius (but all along for a seed)
+            Node lastNode = node;
+            unsigned int length = 0, maxLength = isSeed ? ~0u : radius - distance;
+            GraphIterator<Node> itNodes = _graph.simplePath(node, dir);
+            for (itNodes.first(); !itNodes.isDone() && length <= maxLength; itNodes.next())
+            {
+                if (*itNodes == node) // a cycle
+                    break;
+                lastNode = *itNodes;
+                length++;
+            }
+            if (length > maxLength)
+                continue;
+            if (isSeed)
+                length = 0;
+
+            reach (lastNode, distance + length);
+
+            GraphVector<Edge> neighbors = _graph.neighborsEdge(lastNode, dir);
+            for (size_t i = 0; i < neighbors.size(); i++)
+                reach (neighbors[i].to, distance + length + 1);
+        }
+    }
+
+    for (int kind = 0; kind < WORKLIST_NB; kind++)
+    {
+        if (!_worklistReady[kind])
+            continue;
+        if (tooLarge)
+            _worklistReady[kind] = false; // next pass examines all the cached nodes
+        else
+            _worklist[kind].insert (_worklist[kind].end(), region.begin(), region.end());
+    }
+
+    if (_verbose)
+    {
+        if (tooLarge)
+            std::cout << "incremental rounds: " << seeds.size() << " nodes next to deleted paths, too many nodes around them, next passes examine all cached nodes" << std::endl;
+        else
+            std::cout << "incremental rounds: " << seeds.size() << " nodes next to deleted paths, " << region.size() << " nodes to examine again" << std::endl;
+    }
+}
 
 /* this functions performs many rounds of all available graph simplifications 
  * this is what Minia does by default */
@@ -417,13 +647,18 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeTips()
             std::cout << "iterating on " << itNode->size() << " cached nodes" << std::endl;
     }
 
+    std::vector<Node> worklist;
+    bool incremental = takeWorklist (WORKLIST_TIPS, itNode->size(), worklist);
+    if (_verbose && incremental)
+        std::cout << "examining " << worklist.size() << " of them, close to the previous deletions" << std::endl;
+
     // parallel stuff: create a dispatcher ; support atomic operations
     Dispatcher dispatcher (_nbCores);
 
     // nodes deleter stuff
     NodesDeleter<Node,Edge,GraphType> nodesDeleter(_graph, nbNodes, _nbCores, _verbose);
 
-    dispatcher.iterate (*itNode, [&] (Node& node)
+    iterateNodes (dispatcher, *itNode, incremental ? &worklist : 0, buffer, [&] (Node& node)
     {
          /* just a quick note, which was observed in the context of flagging some node as uninteresting (not used anymore).
           * property: "a tip (detected at some point after some rounds of simplifications) is not necessarily a branching node initially in the original graph"
@@ -556,6 +791,7 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeTips()
 
             if (isTip)
             {
+                addWorklistSeeds(simplePathStart, lastNode, simplePathDir);
                 if (nodesDeleter.get(simplePathStart))
                     {
                         // not double-counting that delete
@@ -595,6 +831,8 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeTips()
     if (_firstNodeIteration)
         _graph.cacheNonSimpleNodes(_nbCores, true);
 
+    updateWorklists();
+
     TIME(auto end_nodescache_t=get_wtime()); 
     TIME(__sync_fetch_and_add(&timeCache, diff_wtime(start_nodescache_t,end_nodescache_t)));
  
@@ -1318,6 +1556,11 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeBulges()
             std::cout << "iterating on " << itNode->size() << " cached nodes" << std::endl;
     }
 
+    std::vector<Node> worklist;
+    bool incremental = takeWorklist (WORKLIST_BULGES, itNode->size(), worklist);
+    if (_verbose && incremental)
+        std::cout << "examining " << worklist.size() << " of them, close to the previous deletions" << std::endl;
+
 
     // parallel stuff: create a dispatcher ; support atomic operations
     Dispatcher dispatcher (_nbCores);
@@ -1325,7 +1568,7 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeBulges()
     NodesDeleter<Node,Edge,GraphType> nodesDeleter(_graph, nbNodes, _nbCores, _verbose);
 
 #ifdef SIMPLIFICATION_LAMBDAS 
-    dispatcher.iterate (itNode, [&] (Node& node) {
+    iterateNodes (dispatcher, *itNode, incremental ? &worklist : 0, buffer, [&] (Node& node) {
 #else
     for (itNode->first(); !itNode->isDone(); itNode->next())
     {
@@ -1510,6 +1753,7 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeBulges()
                         continue;
                     }
 
+                    addWorklistSeeds(simplePathStart, lastNode, simplePathDir);
                     if (nodesDeleter.get(simplePathStart))
                     {
                         // not double-counting that delete
@@ -1548,6 +1792,7 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeBulges()
     TIME(auto start_nodedelete_t=get_wtime());
 
     nodesDeleter.flush();
+    updateWorklists();
 
     TIME(auto end_nodedelete_t=get_wtime());
     TIME(__sync_fetch_and_add(&timeDelete, diff_wtime(start_nodedelete_t,end_nodedelete_t)));
@@ -1641,6 +1886,11 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeErroneousConnections()
             std::cout << "iterating on " << itNode->size() << " cached nodes" << std::endl;
     }
 
+    std::vector<Node> worklist;
+    bool incremental = takeWorklist (WORKLIST_EC, itNode->size(), worklist);
+    if (_verbose && incremental)
+        std::cout << "examining " << worklist.size() << " of them, close to the previous deletions" << std::endl;
+
     // parallel stuff: create a dispatcher ; support atomic operations
     Dispatcher dispatcher (_nbCores);
 
@@ -1648,7 +1898,7 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeErroneousConnections()
     NodesDeleter<Node,Edge,GraphType> nodesDeleter(_graph, nbNodes, _nbCores, _verbose);
 
 #ifdef SIMPLIFICATION_LAMBDAS 
-    dispatcher.iterate (itNode, [&] (Node& node) {
+    iterateNodes (dispatcher, *itNode, incremental ? &worklist : 0, buffer, [&] (Node& node) {
 #else
     for (itNode->first(); !itNode->isDone(); itNode->next())
     {
@@ -1776,6 +2026,7 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeErroneousConnections()
 
                             if (isEC)
                             {
+                                addWorklistSeeds(simplePathStart, lastNode, simplePathDir);
                                 if (nodesDeleter.get(simplePathStart))
                                 {
                                     // not double-counting that delete
@@ -1809,6 +2060,7 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeErroneousConnections()
     TIME(auto start_nodesdel_t=get_wtime());
 
     nodesDeleter.flush();
+    updateWorklists();
 
     TIME(auto end_nodesdel_t=get_wtime()); 
     TIME(__sync_fetch_and_add(&timeDelete, diff_wtime(start_nodesdel_t,end_nodesdel_t)));
@@ -23,6 +23,8 @@
 /********************************************************************************/
 
 #include <gatb/debruijn/impl/Graph.hpp>
+#include <gatb/tools/misc/impl/Progress.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
 #include <vector>
 #include <set>
 #include <string>
@@ -40,6 +42,8 @@ public:
 
     Simplifications (/*const, removed because of cacheNonSimpleNodes calling a setStats */ GraphType * /* set as a pointer because could be null*/ graph, int nbCores, bool verbose = false);
 
+    ~Simplifications ();
+
     void simplify(); // perform many rounds of all simplifications, as in Minia
 
     unsigned long removeTips();
@@ -71,6 +75,11 @@ public:
     double _ecLen_kMult;
     double _ecRCTCcutoff;
 
+    /* incremental rounds: once a simplification has examined all the (cached) nodes, its next passes
+     * only examine the nodes close to the simple paths deleted in the meantime; same results as
+     * full passes. Default: true. Ignored with GraphUnitigs, whose nodes have no true MPHF index. */
+    bool _useWorklist;
+
 protected:
     /*const*/ GraphType &  _graph;
     int _nbCores;
@@ -80,6 +89,22 @@ protected:
     bool _firstNodeIteration;
     bool _verbose;
 
+    /* incremental rounds: for each simplification, the nodes to examine in its next pass */
+    enum WorklistKind { WORKLIST_TIPS = 0, WORKLIST_BULGES, WORKLIST_EC, WORKLIST_NB };
+    bool                   _worklistReady[WORKLIST_NB]; // false until a full pass of that simplification
+    std::vector<Node>      _worklist[WORKLIST_NB];
+    std::vector<Node>      _worklistSeeds;              // alive neighbors of the simple paths deleted in the current pass
+    std::vector<u_int64_t> _worklistMarks;              // recorded seeds, bitmap indexed by MPHF index, set atomically
+    system::ISynchronizer* _worklistSynchro;
+
+    bool worklistEnabled () const;
+    bool takeWorklist (WorklistKind kind, u_int64_t nbCachedNodes, std::vector<Node>& worklist);
+    void addWorklistSeeds (Node& simplePathStart, Node& lastNode, Direction dir);
+    void updateWorklists ();
+
+    template<typename Functor>
+    void iterateNodes (tools::dp::impl::Dispatcher& dispatcher, ProgressGraphIteratorTemplate<Node,tools::misc::impl::ProgressTimerAndSystem>& itNode, std::vector<Node>* worklist, const char* message, const Functor& functor);
+
     std::string path2string(Direction dir, Path_t<Node> p, Node endNode);
     double path2abundance(Direction dir, Path_t<Node> p, Node endNode, unsigned int skip_first = 0, unsigned int skip_last = 0);
 
@@ -152,6 +152,37 @@ public:
      */
     virtual bool process (size_t partId, const Type& kmer, const CountVector& count, CountNumber sum=0) = 0;
 
+    /** Notification that a batch of [kmer,counts] is available, ie. consecutive kmers of a sorted run
+     * of a partition. The counts are given as a columnar matrix: one column of nbKmers counts per bank.
+     *
+     * The 'selected' array plays the role of the result of 'process': only the kmers whose flag
+     * is set have to be handled, and the count processor resets the flag of the kmers that have to
+     * be discarded by the next count processors (in a CountProcessorChain for instance).
+     *
+     * The default implementation is an adapter that calls 'process' for each selected kmer, so
+     * existing count processors work unchanged with batches; built-in count processors override it.
+     *
+     * \param[in] partId : index of the current partition
+     * \param[in] kmers : the kmers of the batch
+     * \param[in] nbKmers : number of kmers in the batch
+     * \param[in] counts : counts matrix, counts[b*nbKmers+i] being the count of the ith kmer in the bank b
+     * \param[in] nbBanks : number of banks, ie. number of columns of the counts matrix
+     * \param[in] sums : sum of the occurrences for all banks of each kmer, may be null if not computed yet.
+     * \param[in,out] selected : flags of the kmers to be handled, reset for the discarded kmers.
+     */
+    virtual void processBatch (size_t partId, const Type* kmers, size_t nbKmers, const CountNumber* counts, size_t nbBanks,
+        const CountNumber* sums, u_int8_t* selected
+    )
+    {
+        CountVector count (nbBanks);
+        for (size_t i=0; i<nbKmers; i++)
+        {
+            if (selected[i] == 0)  { continue; }
+            for (size_t b=0; b<nbBanks; b++)  { count[b] = counts[b*nbKmers+i]; }
+            selected[i] = this->process (partId, kmers[i], count, sums ? sums[i] : 0);
+        }
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
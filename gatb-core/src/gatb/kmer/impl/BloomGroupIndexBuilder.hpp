@@ -0,0 +1,153 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file BloomGroupIndexBuilder.hpp
+ *  \brief Build of a multi samples Bloom index from kmer countings
+ */
+
+#ifndef _GATB_CORE_KMER_IMPL_BLOOM_GROUP_INDEX_BUILDER_HPP_
+#define _GATB_CORE_KMER_IMPL_BLOOM_GROUP_INDEX_BUILDER_HPP_
+
+/********************************************************************************/
+
+#include <gatb/kmer/impl/Model.hpp>
+
+#include <gatb/tools/collections/impl/BloomGroupIndex.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/misc/api/Range.hpp>
+#include <gatb/tools/storage/impl/Storage.hpp>
+
+#include <algorithm>
+#include <vector>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Builder of a BloomGroupIndex from the kmer countings of several samples.
+ *
+ * Each sample is a storage holding the "dsk" group of a kmer counting (ie. the output
+ * of a SortingCountAlgorithm); the solid kmers of sample i are inserted in the ith
+ * Bloom filter of the index.
+ *
+ * All the (sample,partition) couples are dispatched on the cores; since the insertions
+ * into the index are atomic, the partitions of the samples are inserted concurrently.
+ *
+ * The index is sized from the biggest sample: each Bloom filter gets 'nbBitsPerKmer'
+ * slots per solid kmer of this sample.
+ *
+ * The kmers queried in the index must be given in the same form as the counted ones,
+ * ie. canonical kmers (unless NONCANONICAL is defined).
+ *
+ * Sample of use:
+ * \code
+ * std::vector<Storage*> samples = ...;
+ * BloomGroupIndexBuilder<> builder (samples);
+ * BloomGroupIndex<Kmer<>::Type>* index = builder.build ();
+ * index->save ("samples.bgi");
+ * \endcode
+ */
+template<size_t span=KMER_DEFAULT_SPAN>
+class BloomGroupIndexBuilder
+{
+public:
+
+    /** Shortcuts. */
+    typedef typename Kmer<span>::Type   Type;
+    typedef typename Kmer<span>::Count  Count;
+    typedef tools::collections::impl::BloomGroupIndex<Type>  Index;
+
+    /** Constructor.
+     * \param[in] samples : storages of the kmer countings of the samples
+     * \param[in] nbBitsPerKmer : number of slots of a Bloom filter per kmer of the biggest sample
+     * \param[in] nbHash : number of hash functions
+     * \param[in] nbCores : number of cores used for the build (0 means all) */
+    BloomGroupIndexBuilder (const std::vector<tools::storage::impl::Storage*>& samples,
+        size_t nbBitsPerKmer=12, size_t nbHash=4, size_t nbCores=0
+    )
+        : _samples(samples), _nbBitsPerKmer(nbBitsPerKmer), _nbHash(nbHash), _nbCores(nbCores), _kmerSize(0)  {}
+
+    /** Build the index.
+     * \return the index, to be released by the caller. */
+    Index* build ()
+    {
+        if (_samples.empty())  { throw system::Exception ("BloomGroupIndexBuilder: no sample"); }
+
+        /** We retrieve the solid kmers partitions of the samples. */
+        std::vector<std::pair<size_t,tools::collections::Collection<Count>*> > items;
+        u_int64_t maxNbKmers = 0;
+
+        for (size_t s=0; s<_samples.size(); s++)
+        {
+            tools::storage::impl::Group& dskGroup = _samples[s]->getGroup("dsk");
+
+            size_t kmerSize = atol (dskGroup.getProperty ("kmer_size").c_str());
+            if (kmerSize == 0)  { throw system::Exception ("BloomGroupIndexBuilder: no kmer counting found for sample %d", s); }
+
+            if (s == 0)  { _kmerSize = kmerSize; }
+            else if (kmerSize != _kmerSize)
+            {
+                throw system::Exception ("BloomGroupIndexBuilder: kmer size %d for sample %d (%d expected)", kmerSize, s, _kmerSize);
+            }
+
+            tools::storage::impl::Partition<Count>& solid = dskGroup.getPartition<Count> ("solid");
+            for (size_t p=0; p<solid.size(); p++)  {  items.push_back (std::make_pair (s, & solid[p]));  }
+
+            maxNbKmers = std::max (maxNbKmers, (u_int64_t) solid.getNbItems());
+        }
+
+        Index* index = new Index (maxNbKmers*_nbBitsPerKmer, _samples.size(), _nbHash);
+
+        /** We insert the partitions in parallel. */
+        if (!items.empty())
+        {
+            tools::misc::Range<size_t>::Iterator it (0, items.size()-1);
+            tools::dp::impl::Dispatcher (_nbCores, 1).iterate (it, [&] (size_t i)
+            {
+                tools::dp::Iterator<Count>* itKmers = items[i].second->iterator();
+                LOCAL (itKmers);
+
+                for (itKmers->first(); !itKmers->isDone(); itKmers->next())  {  index->insert (itKmers->item().value, items[i].first);  }
+            });
+        }
+
+        return index;
+    }
+
+    /** Get the kmer size of the samples (known after the build).
+     * \return the kmer size. */
+    size_t getKmerSize () const  { return _kmerSize; }
+
+private:
+
+    std::vector<tools::storage::impl::Storage*> _samples;
+    size_t _nbBitsPerKmer;
+    size_t _nbHash;
+    size_t _nbCores;
+    size_t _kmerSize;
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_KMER_IMPL_BLOOM_GROUP_INDEX_BUILDER_HPP_ */
@@ -73,6 +73,17 @@ Properties Configuration::getProperties() const
     result.add (1, "estimated_sequence_volume",   "%ld", _estimateSeqTotalSize / system::MBYTE);
     result.add (1, "estimated_kmers_number",      "%ld", _kmersNb);
     result.add (1, "estimated_kmers_volume",      "%ld", _volume);
+
+    if (_estimateDistinctKmerNb > 0)
+    {
+        std::stringstream ssDistinct;
+        for (size_t i=0; i<_estimateDistinctKmerNbPerBank.size(); i++)  {  ssDistinct << (i==0 ? "" : " ") << _estimateDistinctKmerNbPerBank[i]; }
+
+        result.add (1, "estimated_distinct_kmers_number",  "%ld",  _estimateDistinctKmerNb);
+        result.add (1, "estimated_distinct_kmers_per_bank", ssDistinct.str());
+        result.add (1, "estimated_distinct_kmers_ratio",   "%.3f", _estimateDistinctKmerRatio);
+        result.add (1, "estimated_distinct_kmers_error",   "%.4f", _estimateDistinctKmerError);
+    }
     result.add (1, "max_disk_space",    "%ld", _max_disk_space);
     result.add (1, "max_memory",        "%ld", _max_memory);
     result.add (1, "nb_passes",         "%d",  _nb_passes);
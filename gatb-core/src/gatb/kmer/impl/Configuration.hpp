@@ -47,7 +47,8 @@ public:
       _nbCores(0), _nb_partitions_in_parallel(0), _abundanceUserNb(0), _storage_type(tools::storage::impl::STORAGE_HDF5) ,
       _isComputed(false), _nbCores_per_partition(0),
       _estimateSeqNb(0), _estimateSeqTotalSize(0), _estimateSeqMaxSize(0),
-      _available_space(0), _volume(0), _kmersNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0) {}
+      _available_space(0), _volume(0), _kmersNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0),
+      _estimateDistinctKmerNb(0), _estimateDistinctKmerRatio(0), _estimateDistinctKmerError(0) {}
 
     /****************************************/
     /**             PROVIDED                */
@@ -99,6 +100,13 @@ public:
     
     u_int32_t   _nb_cached_items_per_core_per_part;
 
+    /** Estimation of the number of distinct kmers (0 if not estimated), for all the banks and for each bank,
+     * ratio of distinct kmers to the kmers occurrences, and relative standard error of the estimations. */
+    u_int64_t               _estimateDistinctKmerNb;
+    std::vector<u_int64_t>  _estimateDistinctKmerNbPerBank;
+    double                  _estimateDistinctKmerRatio;
+    double                  _estimateDistinctKmerError;
+
 
     /****************************************/
     /**               MISC                  */
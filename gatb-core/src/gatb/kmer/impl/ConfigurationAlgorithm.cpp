@@ -19,10 +19,12 @@
 
 #include <gatb/kmer/impl/ConfigurationAlgorithm.hpp>
 #include <gatb/system/impl/System.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
 #include <gatb/tools/collections/impl/OAHash.hpp>
 #include <gatb/tools/misc/api/StringsRepository.hpp>
 #include <gatb/tools/misc/impl/Tokenizer.hpp>
-#include <gatb/kmer/impl/LinearCounter.hpp>
+#include <gatb/kmer/impl/HyperLogLog.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
 
 #include <cmath>
 
@@ -45,6 +47,8 @@ using namespace gatb::core::kmer::impl;
 using namespace gatb::core::tools::collections;
 using namespace gatb::core::tools::collections::impl;
 
+using namespace gatb::core::tools::dp;
+
 using namespace gatb::core::tools::misc;
 using namespace gatb::core::tools::misc::impl;
 
@@ -61,10 +65,9 @@ using namespace gatb::core::tools::misc::impl;
 ** REMARKS :
 *********************************************************************/
 
-// estimated the number of distinct kmers in a dataset
-// wrapper around a Linear Counter. Adapted from Kmergenie code.
-// why not a hyperloglog? it seems that the transition from the 32bit-hash initial implementation to 64bits, and supporting billions of elements, is nontrivial, so i didn't bother
-// probably deserves to be in its own file
+// estimates the number of distinct kmers of sequences with a HyperLogLog sketch.
+// each clone of the functor (ie. each thread of the dispatcher) fills its own sketch,
+// merged into the shared one when the clone is destroyed.
 template<size_t span>
 class EstimateNbDistinctKmers
 {
@@ -72,108 +75,73 @@ public:
 
     /** Shortcut. */
     typedef typename Kmer<span>::Type  Type;
-    typedef typename Kmer<span>::ModelDirect     ModelDirect;
-    typedef typename Kmer<span>::ModelCanonical  ModelCanonical;
-#ifdef NONCANONICAL 
-    typedef typename Kmer<span>::template ModelMinimizer <ModelDirect>   Model;
+#ifdef NONCANONICAL
+    typedef typename Kmer<span>::ModelDirect     Model;
 #else
-    typedef typename Kmer<span>::template ModelMinimizer <ModelCanonical>   Model;
+    typedef typename Kmer<span>::ModelCanonical  Model;
 #endif
-    typedef typename Model::Kmer                        KmerType;
-
-    /** */
-    void estimate()
-    {
-        nb_distinct_kmers =(unsigned long)( (float)(linearCounter->count( )) * ((float)nbKmersTotal / (float)nbProcessedKmers)); // dubious linear extrapolation, that's all I got
-
-        abs_error = abs((long)(nb_distinct_kmers-previous_nb_distinct_kmers));
-
-        previous_nb_distinct_kmers = nb_distinct_kmers;
-    }
+    typedef typename Model::Kmer                 KmerType;
 
     /** */
     void operator() (Sequence& sequence)
     {
         /** We build the kmers from the current sequence. */
-        if (model.build (sequence.getData(), kmers) == false)  {  throw "reached EOF"; return; }
+        if (model.build (sequence.getData(), kmers) == false)  {  return; }
 
-        /** We loop over the kmers. */
+        /** We hash the kmers of the sequence in one batch, then insert the hash values. As hash1 does,
+         * the hash of a kmer is the xor of the hash values of its 64 bits words, which are hashed by
+         * columns with the vectorized NativeInt64::hash64. */
+        words.resize  (kmers.size() * NB_WORDS);
+        hashes.resize (kmers.size());
+        column.resize (kmers.size());
+
+        size_t nb = 0;
         for (size_t i=0; i<kmers.size(); i++)
         {
-            linearCounter->add((kmers[i].value()));
-
-
-            // heuristics to stop early, i found that it's inaccurate with low coverage (e.g. on dsk/test/FiftyK.fastq)
-            /*
-            if (nbProcessedReads % eval_every_N_reads == 0 )
-            {
-
-                // let's see if the estimation converges..
-                // the following stopping condition will grossly over-estimate the number of distinct kmers
-                // but I expect the correct result to be in the same order of magnitude
-                // and better to overestimate than underestimate (for both dsk and kmergenie)
-                   estimate();
-                   bool debug = true;
-                   if (debug)
-                       printf("linear estimator at %ld kmers, number of distinct kmers estimated now: %ld, abs error: %ld\n",nbProcessedKmers, nb_distinct_kmers, abs_error);
-                   if (abs_error < previous_nb_distinct_kmers/20) // 5% error
-                   {
-                       throw "LinearCounter converged"; // well, "converged" is a big word
-                       return;
-                   }
-                   if (!linearCounter->is_accurate())
-                   {
-                   printf("LinearCounter is inaccurate";
-                   return;
-                   }
-
-            }*/
+            if (kmers[i].isValid())  {  memcpy (&words[nb++ * NB_WORDS], &kmers[i].value(), sizeof(Type));  }
+        }
+
+        for (size_t w=0; w<NB_WORDS; w++)
+        {
+            for (size_t i=0; i<nb; i++)  {  column[i] = words[i*NB_WORDS + w];  }
+
+            tools::math::NativeInt64::hash64 (column.data(), nb, HASH_SEED, w==0 ? hashes.data() : column.data());
 
+            if (w > 0)  {  for (size_t i=0; i<nb; i++)  {  hashes[i] ^= column[i];  }  }
         }
-        nbProcessedKmers += kmers.size();
-        nbProcessedReads++;
-        //if (nbProcessedReads % 100000 == 0) printf("nb: %ld\n",nbProcessedReads);
 
-        // disabled progress
-        //if (nbCurProgressKmers > 500000)   {  _progress.inc (nbCurProgressKmers);  nbCurProgressKmers = 0;  }
+        sketch.add (hashes.data(), nb);
+        nbKmers += nb;
     }
 
-    EstimateNbDistinctKmers (Model& model, u_int32_t max_memory, unsigned long nb_kmers_total, tools::dp::IteratorListener* progress)
-        : model(model),  eval_every_N_reads(10000000),   nbKmersTotal(nb_kmers_total),
-        nbProcessedKmers(0), nbCurProgressKmers(0), previous_nb_distinct_kmers(0), nbProcessedReads(0), abs_error(0)
-        //, _progress  (progress,System::thread().newSynchronizer())
-    {
-        unsigned long size_linearCounter; // (in bits)
-        /* let's set it to just use half of all memory available at most, ok? this isn't very robust for huge dataset, so to be tested*/
-        /* if it's a tiny dataset, let's set it to total number of kmers */
-        size_linearCounter = std::min( nb_kmers_total, (unsigned long) (max_memory*8*1024*1024/2) );
-        linearCounter =  new LinearCounter<span>(size_linearCounter);
-    }
+    EstimateNbDistinctKmers (size_t kmerSize, HyperLogLog& result, u_int64_t& resultNbKmers, ISynchronizer* synchro)
+        : model(kmerSize), sketch(result.getPrecision()), nbKmers(0), result(result), resultNbKmers(resultNbKmers), synchro(synchro)  {}
 
-    unsigned long getEstimation()
+    ~EstimateNbDistinctKmers ()
     {
-        estimate();
-        // soo.. if it's not accurate, let's assume we have a hugeload of kmers, and let's be safe, we return the total number of kmers
-        if (!linearCounter->is_accurate())
-        {
-            cout << "Warning: linear counter was not accurate, returning worst-case estimation of number of distinct kmers";
-            return nbKmersTotal;
-        }
-        return nb_distinct_kmers;
+        LocalSynchronizer ls (synchro);
+        result.merge (sketch);
+        resultNbKmers += nbKmers;
     }
 
 private:
 
-    /** Local resources. */
-    Model&    model;
-    unsigned long nbProcessedReads, nbProcessedKmers;
-    unsigned long nbCurProgressKmers;
-    unsigned long nbKmersTotal;
-    unsigned long abs_error;
-    vector<KmerType> kmers;
-    LinearCounter<span> *linearCounter;
-    int eval_every_N_reads;
-    unsigned long previous_nb_distinct_kmers, nb_distinct_kmers;
+    static const u_int64_t HASH_SEED = 0x5f3759df;
+
+    /** Number of 64 bits words of a kmer. */
+    static const size_t NB_WORDS = sizeof(Type) / sizeof(u_int64_t);
+
+    Model             model;
+    vector<KmerType>  kmers;
+    vector<u_int64_t> words;
+    vector<u_int64_t> column;
+    vector<u_int64_t> hashes;
+    HyperLogLog       sketch;
+    u_int64_t         nbKmers;
+
+    HyperLogLog&      result;
+    u_int64_t&        resultNbKmers;
+    ISynchronizer*    synchro;
 };
 
 
@@ -345,6 +313,16 @@ void ConfigurationAlgorithm<span>::execute ()
         }
     }
 
+    /** The max memory is the budget of the memory accounting; the structures that are still alive at this
+     * point (Bloom filters or unitigs of another graph for instance) are taken out of the memory used for
+     * sizing the partitions, so we get more partitions (or more passes) instead of exceeding the budget.
+     * We keep at least half of the max memory for the counting anyway. */
+    MemoryAccounting::singleton().setBudget ((u_int64_t)_config._max_memory * MBYTE);
+
+    u_int64_t usedMemory     = MemoryAccounting::singleton().getCurrentUsage() / MBYTE;
+    u_int64_t countingMemory = usedMemory < _config._max_memory/2 ? _config._max_memory - usedMemory : _config._max_memory/2;
+    if (countingMemory == 0)  { countingMemory = 1; }
+
     assert (_config._max_disk_space > 0);
 
     _config._nb_passes = ( (_config._volume/4) / _config._max_disk_space ) + 1; //minim, approx volume /switched to approx /4 (was/3) because of more efficient superk storage
@@ -361,40 +339,13 @@ void ConfigurationAlgorithm<span>::execute ()
         max_open_files /= 3; // will need to open twice in STORAGE_FILE instead of HDF5, so this adjustment is needed. needs to be fixed later by putting partitions inside the same file. but i'd rather not do it in the current messy collection/group/partition hdf5-inspired system. overall, that's a FIXME
     }
 
-#if 0
-    /* disabled by default; this was an experiment */
-    float est_volume_distinct_ratio;
-    if (_flagEstimateNbDistinctKmers)
+    /** We may estimate the number of distinct kmers, for each bank and for the union of the banks. */
+    if (_input->get(STR_ESTIMATE_DISTINCT_KMERS))
     {
-        /* we estimate the volume of distinct kmers vs total number of kmers.
-         * we store it in the variable "est_volume_distinct_ratio"
-         * to compute it, we need a linear counter, let's call it now */
-
         TIME_INFO (getTimeInfo(), "estimate_distinct_kmers");
-        Iterator<Sequence>* itSeq = _bank->iterator();
-        LOCAL (itSeq);
-
-        //_progress->setMessage (progressFormat0); // not touching progress here anymore
-        Model model (_kmerSize, _minim_size);
-        EstimateNbDistinctKmers<span> estimate_nb_distinct_kmers_function(model, _max_memory, kmersNb, _progress);
-
-        /** We launch the iteration of the sequences iterator with the created functors. */
-        try {
-            itSeq->iterate (estimate_nb_distinct_kmers_function);
-        }
-        catch (const char* except)
-        {
-
-        }
-        _estimatedDistinctKmerNb = estimate_nb_distinct_kmers_function.getEstimation();
-        est_volume_distinct_ratio = (float) _estimatedDistinctKmerNb / (float)kmersNb;
-        //est_volume_distinct_ratio = 1; // for debug
-        /* est_volume_distinct_ratio == 1 mean that we guarantee worst case the memory usage,
-           the value mean that, on average, a k-mer will be seen 'est_volume_distinct_ratio' times */
-        // if wrongly estimated, the error 'OAHash: max rehashes..' can happen
-        printf ("LinearCounter done, estimated %ld number of distinct kmers, ratio to total number of kmers: %.2f\n", (long)_estimatedDistinctKmerNb, est_volume_distinct_ratio);
+        estimateDistinctKmers ();
     }
-#endif
+
     u_int64_t volume_per_pass;
     do  {
 
@@ -405,7 +356,7 @@ void ConfigurationAlgorithm<span>::execute ()
         //printf("volume_per_pass %lli  _nbCores %zu _max_memory %i \n",volume_per_pass, _nbCores,_max_memory);
 
         // _nb_partitions  = ( (volume_per_pass*_nbCores) / _max_memory ) + 1;
-        _config._nb_partitions  = ( ( volume_per_pass* _config._nb_partitions_in_parallel) / _config._max_memory ) + 1;
+        _config._nb_partitions  = ( ( volume_per_pass* _config._nb_partitions_in_parallel) / countingMemory ) + 1;
 
         //printf("nb passes  %i  (nb part %i / %zu)\n",_nb_passes,_nb_partitions,max_open_files);
         //_nb_partitions = max_open_files; break;
@@ -452,7 +403,7 @@ void ConfigurationAlgorithm<span>::execute ()
         _config._nb_cached_items_per_core_per_part *= 2;
         memoryUsageCachedItems = 1LL * _config._nb_cached_items_per_core_per_part *_config._nb_partitions * _config._nbCores * sizeof(Type); 
     }
-    while (memoryUsageCachedItems < _config._max_memory * MBYTE / 10);
+    while (memoryUsageCachedItems < countingMemory * MBYTE / 10);
         
     DEBUG (("ConfigurationAlgorithm<span>::execute  _config._nb_cached_items_per_core_per_part : %zu ; total memory usage of cached items : %lld MB \n",
         _config._nb_cached_items_per_core_per_part, memoryUsageCachedItems / MBYTE
@@ -466,6 +417,49 @@ void ConfigurationAlgorithm<span>::execute ()
     getInfo()->add (1, _config.getProperties());
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the kmers are read in parallel, one bank after the other
+*********************************************************************/
+template<size_t span>
+void ConfigurationAlgorithm<span>::estimateDistinctKmers ()
+{
+    ISynchronizer* synchro = System::thread().newSynchronizer();
+    LOCAL (synchro);
+
+    HyperLogLog total;
+    u_int64_t   totalNbKmers = 0;
+
+    Iterator<Sequence>* it = _bank->iterator();
+    LOCAL (it);
+    std::vector<Iterator<Sequence>*> itBanks = it->getComposition();
+
+    _config._estimateDistinctKmerNbPerBank.clear();
+
+    /** Each bank has its own sketch, merged afterwards into the sketch of the union of the banks. */
+    for (size_t i=0; i<itBanks.size(); i++)
+    {
+        HyperLogLog sketch (total.getPrecision());
+        u_int64_t   nbKmers = 0;
+
+        getDispatcher()->iterate (itBanks[i], EstimateNbDistinctKmers<span> (_config._kmerSize, sketch, nbKmers, synchro));
+        itBanks[i]->finalize();
+
+        _config._estimateDistinctKmerNbPerBank.push_back (sketch.estimate());
+
+        total.merge (sketch);
+        totalNbKmers += nbKmers;
+    }
+
+    _config._estimateDistinctKmerNb    = total.estimate();
+    _config._estimateDistinctKmerError = total.getRelativeError();
+    _config._estimateDistinctKmerRatio = totalNbKmers > 0 ? std::min (1.0, (double)_config._estimateDistinctKmerNb / totalNbKmers) : 0;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
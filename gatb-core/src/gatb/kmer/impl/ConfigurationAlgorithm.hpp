@@ -55,6 +55,10 @@ public:
     const Configuration&  getConfiguration() const { return _config; }
 
 private:
+
+    /** Estimate the number of distinct kmers of each bank and of all the banks (HyperLogLog sketches). */
+    void estimateDistinctKmers ();
+
     /** */
     static std::vector<tools::misc::CountRange> getSolidityThresholds (tools::misc::IProperties* params);
 
@@ -100,6 +100,31 @@ public:
         return res;
     }
 
+protected:
+
+    /** Get the sums of the counts of a batch: the provided sums if any, otherwise the sums over all the banks.
+     * \param[in] counts : counts matrix of the batch (one column per bank)
+     * \param[in] nbKmers : number of kmers in the batch
+     * \param[in] nbBanks : number of banks
+     * \param[in] sums : sums provided with the batch, may be null
+     * \return the sums of the batch. */
+    const CountNumber* getSums (const CountNumber* counts, size_t nbKmers, size_t nbBanks, const CountNumber* sums)
+    {
+        if (sums    != 0)  { return sums;   }
+        if (nbBanks == 1)  { return counts; }
+
+        _sums.assign (nbKmers, 0);
+        for (size_t b=0; b<nbBanks; b++)
+        {
+            const CountNumber* column = counts + b*nbKmers;
+            for (size_t i=0; i<nbKmers; i++)  { _sums[i] += column[i]; }
+        }
+        return _sums.data();
+    }
+
+    /** Buffer for the sums of a batch. */
+    std::vector<CountNumber> _sums;
+
 private:
 
     std::string _name;
@@ -133,6 +133,31 @@ public:
         return res;
     }
 
+    /** \copydoc ICountProcessor<span>::processBatch */
+    void processBatch (size_t partId, const Type* kmers, size_t nbKmers, const CountNumber* counts, size_t nbBanks,
+        const CountNumber* sums, u_int8_t* selected
+    )
+    {
+        /** The sums are computed once for the whole chain, only with the banks used for solidity. */
+        if (sums == 0)
+        {
+            if (nbBanks == 1 && _solidVec.at(0))  { sums = counts; }
+            else
+            {
+                this->_sums.assign (nbKmers, 0);
+                for (size_t b=0; b<nbBanks; b++)
+                {
+                    if (_solidVec.at(b) == false)  { continue; }
+                    const CountNumber* column = counts + b*nbKmers;
+                    for (size_t i=0; i<nbKmers; i++)  { this->_sums[i] += column[i]; }
+                }
+                sums = this->_sums.data();
+            }
+        }
+
+        for (size_t i=0; i<_items.size(); i++)  {  _items[i]->processBatch (partId, kmers, nbKmers, counts, nbBanks, sums, selected);  }
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
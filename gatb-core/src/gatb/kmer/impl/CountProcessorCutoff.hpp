@@ -123,6 +123,28 @@ public:
         return true;
     }
 
+    /** \copydoc ICountProcessor<span>::processBatch */
+    void processBatch (size_t partId, const Type* kmers, size_t nbKmers, const CountNumber* counts, size_t nbBanks,
+        const CountNumber* sums, u_int8_t* selected
+    )
+    {
+        /** Same convention as 'process': sum of all the banks for one histogram, the bank column otherwise.
+         * Nothing is discarded, so the histograms work on a copy of the selection flags. */
+        _selected.assign (selected, selected+nbKmers);
+
+        if (_histogramProcessors.size()==1)
+        {
+            _histogramProcessors[0]->processBatch (partId, kmers, nbKmers, counts, nbBanks, this->getSums (counts, nbKmers, nbBanks, 0), _selected.data());
+        }
+        else
+        {
+            for (size_t i=0; i<_histogramProcessors.size(); i++)
+            {
+                _histogramProcessors[i]->processBatch (partId, kmers, nbKmers, counts, nbBanks, counts + i*nbKmers, _selected.data());
+            }
+        }
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
@@ -146,6 +168,9 @@ private:
     std::vector<CountProcessorHistogram<span>* > _histogramProcessors;
 
     std::vector<CountNumber> _cutoffs;
+
+    /** Selection flags of a batch given to the histograms. */
+    std::vector<u_int8_t> _selected;
 };
 
 /********************************************************************************/
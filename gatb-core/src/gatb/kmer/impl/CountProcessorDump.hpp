@@ -151,6 +151,19 @@ public:
         return true;
     }
 
+    /** \copydoc ICountProcessor<span>::processBatch */
+    void processBatch (size_t partId, const Type* kmers, size_t nbKmers, const CountNumber* counts, size_t nbBanks,
+        const CountNumber* sums, u_int8_t* selected
+    )
+    {
+        sums = this->getSums (counts, nbKmers, nbBanks, sums);
+
+        _batch.clear();
+        for (size_t i=0; i<nbKmers; i++)  {  if (selected[i])  { _batch.push_back (Count(kmers[i],sums[i])); }  }
+
+        if (!_batch.empty())  {  this->_solidKmers->insert (_batch.data(), _batch.size());  }
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
@@ -215,6 +228,9 @@ private:
     void setSolidKmers (tools::collections::Bag<Count>* solidKmers)  {  SP_SETATTR(solidKmers);  }
 
     std::map<std::string,size_t> _namesOccur;
+
+    /** Selected kmers of the current batch. */
+    std::vector<Count> _batch;
 };
 
 /********************************************************************************/
@@ -183,6 +183,24 @@ public:
         return true;
     }
 
+    /** \copydoc ICountProcessor<span>::processBatch */
+    void processBatch (size_t partId, const Type* kmers, size_t nbKmers, const CountNumber* counts, size_t nbBanks,
+        const CountNumber* sums, u_int8_t* selected
+    )
+    {
+        sums = this->getSums (counts, nbKmers, nbBanks, sums);
+
+        _histogram->inc (sums, selected, nbKmers);
+
+        if (_histo2Dmode)
+        {
+            for (size_t i=0; i<nbKmers; i++)
+            {
+                if (selected[i])  {  _histogram->inc2D (sums[i] - counts[i], counts[i]);  }
+            }
+        }
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
@@ -83,6 +83,12 @@ public:
     bool process (size_t partId, const Type& kmer, const CountVector& count, CountNumber sum=0)
     {  return _ref->process (partId, kmer, count, sum);  }
 
+    /** \copydoc ICountProcessor<span>::processBatch */
+    void processBatch (size_t partId, const Type* kmers, size_t nbKmers, const CountNumber* counts, size_t nbBanks,
+        const CountNumber* sums, u_int8_t* selected
+    )
+    {  _ref->processBatch (partId, kmers, nbKmers, counts, nbBanks, sums, selected);  }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
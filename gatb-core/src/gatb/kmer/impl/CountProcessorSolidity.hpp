@@ -142,6 +142,40 @@ public:
         return result;
     }
 
+    /** \copydoc ICountProcessor<span>::processBatch */
+    void processBatch (size_t partId, const typename Kmer<span>::Type* kmers, size_t nbKmers, const CountNumber* counts, size_t nbBanks,
+        const CountNumber* sums, u_int8_t* selected
+    )
+    {
+        size_t nbIn = 0;  for (size_t i=0; i<nbKmers; i++)  { nbIn += selected[i]; }
+
+        /** We use static polymorphism here. */
+        static_cast<Derived*>(this)->checkBatch (counts, nbKmers, nbBanks, this->getSums (counts, nbKmers, nbBanks, sums), selected);
+
+        size_t nbOut = 0;  for (size_t i=0; i<nbKmers; i++)  { nbOut += selected[i]; }
+
+        _total += nbIn;
+        _ok    += nbOut;
+    }
+
+    /** Check the solidity of a batch of kmers, the columnar way. This generic version calls 'check'
+     * for each kmer; subclasses provide their own version working on whole columns of counts.
+     * \param[in] counts : counts matrix of the batch (one column per bank)
+     * \param[in] nbKmers : number of kmers in the batch
+     * \param[in] nbBanks : number of banks
+     * \param[in] sums : sums of the counts of each kmer
+     * \param[in,out] selected : flags of the kmers to be checked, reset for the non solid ones. */
+    void checkBatch (const CountNumber* counts, size_t nbKmers, size_t nbBanks, const CountNumber* sums, u_int8_t* selected)
+    {
+        CountVector count (nbBanks);
+        for (size_t i=0; i<nbKmers; i++)
+        {
+            if (selected[i] == 0)  { continue; }
+            for (size_t b=0; b<nbBanks; b++)  { count[b] = counts[b*nbKmers+i]; }
+            selected[i] = static_cast<Derived*>(this)->check (count, sums[i]);
+        }
+    }
+
     /*****************************************************************/
     /*                          MISCELLANEOUS.                       */
     /*****************************************************************/
@@ -169,6 +203,9 @@ protected:
 
     u_int64_t _total;
     u_int64_t _ok;
+
+    /** Per kmer values (min or max over the banks) of a batch. */
+    std::vector<CountNumber> _values;
 };
 
 /********************************************************************************/
@@ -188,6 +225,12 @@ public:
         return this->_thresholds[0].includes (sum);
     }
 
+    void checkBatch (const CountNumber* counts, size_t nbKmers, size_t nbBanks, const CountNumber* sums, u_int8_t* selected)
+    {
+        CountNumber lo = this->_thresholds[0].getBegin(), hi = this->_thresholds[0].getEnd();
+        for (size_t i=0; i<nbKmers; i++)  {  selected[i] &= (sums[i] >= lo) & (sums[i] <= hi);  }
+    }
+
     std::string getName() const  { return std::string("sum"); }
 };
 
@@ -208,6 +251,20 @@ public:
         return this->_thresholds[0].includes (*std::max_element (count.begin(),count.end()));
     }
 
+    void checkBatch (const CountNumber* counts, size_t nbKmers, size_t nbBanks, const CountNumber* sums, u_int8_t* selected)
+    {
+        std::vector<CountNumber>& values = this->_values;
+        values.assign (counts, counts+nbKmers);
+        for (size_t b=1; b<nbBanks; b++)
+        {
+            const CountNumber* column = counts + b*nbKmers;
+            for (size_t i=0; i<nbKmers; i++)  {  values[i] = std::max (values[i], column[i]);  }
+        }
+
+        CountNumber lo = this->_thresholds[0].getBegin(), hi = this->_thresholds[0].getEnd();
+        for (size_t i=0; i<nbKmers; i++)  {  selected[i] &= (values[i] >= lo) & (values[i] <= hi);  }
+    }
+
     std::string getName() const  { return std::string("max"); }
 };
 
@@ -228,6 +285,20 @@ public:
         return this->_thresholds[0].includes (*std::min_element (count.begin(),count.end()));
     }
 
+    void checkBatch (const CountNumber* counts, size_t nbKmers, size_t nbBanks, const CountNumber* sums, u_int8_t* selected)
+    {
+        std::vector<CountNumber>& values = this->_values;
+        values.assign (counts, counts+nbKmers);
+        for (size_t b=1; b<nbBanks; b++)
+        {
+            const CountNumber* column = counts + b*nbKmers;
+            for (size_t i=0; i<nbKmers; i++)  {  values[i] = std::min (values[i], column[i]);  }
+        }
+
+        CountNumber lo = this->_thresholds[0].getBegin(), hi = this->_thresholds[0].getEnd();
+        for (size_t i=0; i<nbKmers; i++)  {  selected[i] &= (values[i] >= lo) & (values[i] <= hi);  }
+    }
+
     std::string getName() const  { return std::string("min"); }
 };
 
@@ -249,6 +320,16 @@ public:
         return true;
     }
 
+    void checkBatch (const CountNumber* counts, size_t nbKmers, size_t nbBanks, const CountNumber* sums, u_int8_t* selected)
+    {
+        for (size_t b=0; b<nbBanks; b++)
+        {
+            const CountNumber* column = counts + b*nbKmers;
+            CountNumber lo = this->_thresholds[b].getBegin(), hi = this->_thresholds[b].getEnd();
+            for (size_t i=0; i<nbKmers; i++)  {  selected[i] &= (column[i] >= lo) & (column[i] <= hi);  }
+        }
+    }
+
     std::string getName() const  { return std::string("all"); }
 };
 
@@ -270,6 +351,19 @@ public:
         return false;
     }
 
+    void checkBatch (const CountNumber* counts, size_t nbKmers, size_t nbBanks, const CountNumber* sums, u_int8_t* selected)
+    {
+        std::vector<CountNumber>& any = this->_values;
+        any.assign (nbKmers, 0);
+        for (size_t b=0; b<nbBanks; b++)
+        {
+            const CountNumber* column = counts + b*nbKmers;
+            CountNumber lo = this->_thresholds[b].getBegin(), hi = this->_thresholds[b].getEnd();
+            for (size_t i=0; i<nbKmers; i++)  {  any[i] |= (column[i] >= lo) & (column[i] <= hi);  }
+        }
+        for (size_t i=0; i<nbKmers; i++)  {  selected[i] &= any[i];  }
+    }
+
     std::string getName() const  { return std::string("one"); }
 };
 	
@@ -299,6 +393,17 @@ public:
 			return true;
 		}
 		
+		void checkBatch (const CountNumber* counts, size_t nbKmers, size_t nbBanks, const CountNumber* sums, u_int8_t* selected)
+		{
+			for (size_t b=0; b<nbBanks; b++)
+			{
+				const CountNumber* column = counts + b*nbKmers;
+				CountNumber lo = this->_thresholds[b].getBegin(), hi = this->_thresholds[b].getEnd();
+				u_int8_t    solid = this->_solidVec.at(b) ? 1 : 0;
+				for (size_t i=0; i<nbKmers; i++)  {  selected[i] &= (((column[i] >= lo) & (column[i] <= hi)) == solid);  }
+			}
+		}
+		
 		std::string getName() const  { return std::string("custom"); }
 		
 	};
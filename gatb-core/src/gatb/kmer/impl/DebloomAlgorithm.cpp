@@ -84,6 +84,32 @@ using namespace gatb::core::tools::math;
 namespace gatb  {  namespace core  {   namespace kmer  {   namespace impl {
 /********************************************************************************/
 
+/** Size (in bits) of the ribbon filters coding a cFP set: the first filter codes the cFP, the
+ * second one the solid kmers that are false positives of the first one, and the cFP that are
+ * false positives of the second one are kept in an exact set of items of 'itemBits' bits. */
+static double getRibbonCascadeSize (double nbKmers, double nbCFP, size_t itemBits, size_t nbBits1, size_t nbBits2)
+{
+    static const double slotsPerItem = 1.12;
+
+    return slotsPerItem * nbBits1 * nbCFP
+        +  slotsPerItem * nbBits2 * nbKmers * ldexp (1.0, -(int)nbBits1)
+        +  itemBits * nbCFP * ldexp (1.0, -(int)nbBits2);
+}
+
+/** Number of bits of the fingerprints of the two ribbon filters giving the smallest size. */
+static void getRibbonCascadeBits (double nbKmers, double nbCFP, size_t itemBits, size_t& nbBits1, size_t& nbBits2)
+{
+    double best = -1;
+    for (size_t b1=1; b1<=RibbonFilter<NativeInt64>::MAX_NB_BITS; b1++)
+    {
+        for (size_t b2=1; b2<=RibbonFilter<NativeInt64>::MAX_NB_BITS; b2++)
+        {
+            double size = getRibbonCascadeSize (nbKmers, nbCFP, itemBits, b1, b2);
+            if (best < 0 || size < best)  { best = size;  nbBits1 = b1;  nbBits2 = b2; }
+        }
+    }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -182,7 +208,7 @@ IOptionsParser* DebloomAlgorithm<span>::getOptionsParser ()
     IOptionsParser* parser = new OptionsParser ("bloom");
 
     parser->push_back (new OptionOneParam (STR_BLOOM_TYPE,        "bloom type ('basic', 'cache', 'neighbor')",false, "neighbor"));
-    parser->push_back (new OptionOneParam (STR_DEBLOOM_TYPE,      "debloom type ('none', 'original' or 'cascading')", false, "cascading"));
+    parser->push_back (new OptionOneParam (STR_DEBLOOM_TYPE,      "debloom type ('none', 'original', 'cascading' or 'ribbon')", false, "cascading"));
     parser->push_back (new OptionOneParam (STR_DEBLOOM_IMPL,      "debloom impl ('basic', 'minimizer')",      false, "minimizer"));
 
     return parser;
@@ -582,6 +608,93 @@ void DebloomAlgorithm<span>::createCFP (
             break;
         }
 
+        case DEBLOOM_RIBBON:
+        {
+            /** We define an iterator for 4 tasks. */
+            size_t nbTasks = 4;
+            Iterator<int>* itTask = createIterator<int> (new Range<int>::Iterator (1,nbTasks), nbTasks, progressFormat6());
+            LOCAL (itTask);
+            itTask->first ();
+
+            /** We choose the fingerprints sizes of the two filters from the actual numbers of kmers. */
+            size_t nbBits1 = 0, nbBits2 = 0;
+            getRibbonCascadeBits (_solidIterable->getNbItems(), _criticalNb, 8*sizeof(Type), nbBits1, nbBits2);
+
+            // **** Build the first filter with the cFP
+            ThreadObject<vector<u_int64_t> > cfpKeys;
+
+            getDispatcher()->iterate (criticalCollection->iterator(), [&] (const Type& t) {
+                cfpKeys().push_back (RibbonFilter<Type>::hashItem (t));
+            });
+
+            vector<u_int64_t> keys;
+            for (size_t i=0; i<cfpKeys.size(); i++)
+            {
+                keys.insert (keys.end(), cfpKeys[i].begin(), cfpKeys[i].end());
+                vector<u_int64_t>().swap (cfpKeys[i]);
+            }
+
+            RibbonFilter<Type>* filter1 = new RibbonFilter<Type> (keys.size(), nbBits1);
+            LOCAL (filter1);
+            filter1->build (keys);
+            keys.clear();
+            itTask->next();
+
+            // **** Build the second filter with the solid kmers that are false positives of the first one
+            ThreadObject<vector<u_int64_t> > solidKeys;
+
+            getDispatcher()->iterate (_solidIterable->iterator(), [&] (const Count& t)
+            {
+                if (filter1->contains(t.value))  {  solidKeys().push_back (RibbonFilter<Type>::hashItem (t.value));  }
+            });
+
+            for (size_t i=0; i<solidKeys.size(); i++)
+            {
+                keys.insert (keys.end(), solidKeys[i].begin(), solidKeys[i].end());
+                vector<u_int64_t>().swap (solidKeys[i]);
+            }
+
+            RibbonFilter<Type>* filter2 = new RibbonFilter<Type> (keys.size(), nbBits2);
+            LOCAL (filter2);
+            filter2->build (keys);
+            vector<u_int64_t>().swap (keys);
+            itTask->next();
+
+            // **** The cFP that are false positives of the second filter make the final cfp set
+            ThreadObject<vector<Type> > itemsPerThread;
+
+            getDispatcher()->iterate (criticalCollection->iterator(), [&] (const Type& t)
+            {
+                if (filter1->contains(t) && filter2->contains(t))  {  itemsPerThread().push_back (t);  }
+            });
+
+            vector<Type> cfpItems;
+            for (size_t i=0; i<itemsPerThread.size(); i++)  {  cfpItems.insert (cfpItems.end(), itemsPerThread[i].begin(), itemsPerThread[i].end());  }
+            std::sort (cfpItems.begin(), cfpItems.end());
+
+            finalCriticalCollection->insert (cfpItems.data(), cfpItems.size());
+            finalCriticalCollection->flush ();
+            itTask->next();
+
+            /** We save the filters into the storage. */
+            StorageTools::singleton().saveRibbonFilter<Type> (_groupDebloom, "ribbon1", filter1);
+            StorageTools::singleton().saveRibbonFilter<Type> (_groupDebloom, "ribbon2", filter2);
+            itTask->next();
+            itTask->isDone(); // force to finish progress dump
+
+            totalSize_bits = filter1->getBitSize() + filter2->getBitSize() + 8*cfpItems.size()*sizeof(Type);
+
+            /** Some statistics. */
+            props->add (0, "cfp",     "%ld", totalSize_bits);
+            props->add (1, "ribbon1", "%ld", filter1->getBitSize());
+            props->add (2, "nb_bits", "%ld", filter1->getNbBits());
+            props->add (1, "ribbon2", "%ld", filter2->getBitSize());
+            props->add (2, "nb_bits", "%ld", filter2->getNbBits());
+            props->add (1, "set",     "%ld", 8*cfpItems.size()*sizeof(Type));
+
+            break;
+        }
+
         case DEBLOOM_ORIGINAL:
         case DEBLOOM_DEFAULT:
         default:
@@ -626,6 +739,7 @@ float DebloomAlgorithm<span>::getNbBitsPerKmer (size_t kmerSize, DebloomKind deb
 {
     static double lg2 = log(2);
     float nbitsPerKmer = 0;
+    double bestTotal  = 0;
 
     if (kmerSize > 128 && debloomKind==DEBLOOM_CASCADING)  {  throw Exception ("kmer size %d too big for cascading bloom filters", kmerSize); }
 
@@ -635,6 +749,25 @@ float DebloomAlgorithm<span>::getNbBitsPerKmer (size_t kmerSize, DebloomKind deb
         nbitsPerKmer = rvalues[kmerSize][1];
         break;
 
+    case DEBLOOM_RIBBON:
+    {
+        /** Same optimum as for the original cFP set, a cFP costing the bits of the ribbon filters
+         * instead of the 2k bits of a kmer; we keep the best fingerprints sizes. */
+        for (size_t b1=1; b1<=RibbonFilter<Type>::MAX_NB_BITS; b1++)
+        {
+            for (size_t b2=1; b2<=RibbonFilter<Type>::MAX_NB_BITS; b2++)
+            {
+                /** Cost of the ribbon filters per cFP, and per solid kmer. */
+                double costCFP   = getRibbonCascadeSize (0, 1, 8*sizeof(Type), b1, b2);
+                double costKmer  = getRibbonCascadeSize (1, 0, 8*sizeof(Type), b1, b2);
+                double nbits     = log (8*costCFP*(lg2*lg2))/(lg2*lg2);
+
+                if (nbitsPerKmer == 0 || nbits + costKmer < bestTotal)  {  nbitsPerKmer = nbits;  bestTotal = nbits + costKmer;  }
+            }
+        }
+        break;
+    }
+
     case DEBLOOM_ORIGINAL:
     case DEBLOOM_DEFAULT:
     default:
@@ -683,6 +816,19 @@ void DebloomAlgorithm<span>::loadDebloomStructures ()
             break;
         }
 
+        case DEBLOOM_RIBBON:
+        {
+            IBloom<Type>*        bloom    = StorageTools::singleton().loadBloom<Type>        (_groupBloom,   "bloom");
+            RibbonFilter<Type>*  filter1  = StorageTools::singleton().loadRibbonFilter<Type> (_groupDebloom, "ribbon1");
+            RibbonFilter<Type>*  filter2  = StorageTools::singleton().loadRibbonFilter<Type> (_groupDebloom, "ribbon2");
+            Container<Type>*     cFP      = StorageTools::singleton().loadContainer<Type>    (_groupDebloom, "cfp");
+
+            /** We build the set of critical false positive kmers. */
+            setDebloomStructures (new debruijn::impl::ContainerNodeRibbon<Type> (bloom, filter1, filter2, cFP));
+
+            break;
+        }
+
         case DEBLOOM_CASCADING:
         {
             IBloom<Type>*     bloom   = StorageTools::singleton().loadBloom<Type>     (_groupBloom,   "bloom");
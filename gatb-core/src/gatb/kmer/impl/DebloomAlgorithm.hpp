@@ -201,6 +201,7 @@ protected:
     static const char* progressFormat3() { return "Debloom: finalization                  "; }
     static const char* progressFormat4() { return "Debloom: cascading                     "; }
     static const char* progressFormat5() { return "Debloom: save                          "; }
+    static const char* progressFormat6() { return "Debloom: ribbon filters                "; }
 };
 
 /********************************************************************************/
@@ -110,7 +110,6 @@ struct FunctorKmersExtensionMinimizer
         Repartitor&          _repart;
         size_t               _nbPass;
         size_t               _nbPartsPerPass;
-        int                  _currentThreadIndex;
 		vector<PartitionCache<Type>*>& _partCacheVec;
 
         FunctorNeighbors (
@@ -122,7 +121,7 @@ struct FunctorKmersExtensionMinimizer
 			vector<PartitionCache<Type>*>& partCacheVec
         )
             : bloom(bloom), _modelMini(modelMini), _solids(solids),
-			  _repart(repart), _currentThreadIndex(-1),
+			  _repart(repart),
 			  _partCacheVec(partCacheVec)
         {
             _nbPass = _repart.getNbPasses();
@@ -149,8 +148,8 @@ struct FunctorKmersExtensionMinimizer
                  * several passes (see FillPartitions in SortingCountAlgorithm). */
                 mm += (mini % _nbPass) * _nbPartsPerPass;
 
-                /** We retrieve the partition of interest. Note that we have a lazy accessor for the thread index
-                 * within the ThreadGroup, because this value wouldn't be known during the constructor of the functor. */
+                /** We retrieve the partition of interest. Note that the thread index is given by the worker context
+                 * at each call, because this value wouldn't be known during the constructor of the functor. */
                 PartitionCache<Type>* partition = _partCacheVec[getThreadIndex()];
 
                 /** We add the neighbor to the correct debloom partition. */
@@ -158,22 +157,7 @@ struct FunctorKmersExtensionMinimizer
             }
         }
 
-        int getThreadIndex()
-        {
-        	if (_currentThreadIndex < 0)
-        	{
-				std::pair<IThread*,size_t> info;
-				if (ThreadGroup::findThreadInfo (System::thread().getThreadSelf(), info) == true)
-				{
-					_currentThreadIndex = info.second;
-				}
-				else
-				{
-					throw Exception("Unable to find thread index during debloom(minimizer)");
-				}
-        	}
-        	return _currentThreadIndex;
-        }
+        int getThreadIndex()  {  return WorkerContext::get().getIndex();  }
 
     } functorNeighbors;
 
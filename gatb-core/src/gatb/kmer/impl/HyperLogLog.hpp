@@ -0,0 +1,139 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file HyperLogLog.hpp
+ *  \brief HyperLogLog sketch for estimating a number of distinct items
+ */
+
+#ifndef _GATB_CORE_KMER_IMPL_HYPERLOGLOG_HPP_
+#define _GATB_CORE_KMER_IMPL_HYPERLOGLOG_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/types.hpp>
+#include <gatb/system/api/Exception.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief HyperLogLog cardinality estimator (Flajolet et al. 2007) over 64 bits hash values.
+ *
+ * The sketch holds 2^precision registers of one byte. The relative standard error of the
+ * estimation is 1.04/sqrt(2^precision), ie. 0.8% with the default precision (16 KBytes of
+ * registers). Small cardinalities are estimated by linear counting on the empty registers;
+ * with 64 bits hash values, no correction is needed for large cardinalities.
+ *
+ * Sketches with the same precision can be merged, the result being the sketch of the union
+ * of the inserted items. This allows to fill one sketch per thread without synchronization
+ * and to merge them at the end.
+ *
+ * The inserted values must be hash values, ie. uniformly distributed over 64 bits; for kmers,
+ * one can insert hash1(kmer,seed) for instance.
+ */
+class HyperLogLog
+{
+public:
+
+    /** Constructor.
+     * \param[in] precision : log2 of the number of registers, in [4..18] */
+    HyperLogLog (size_t precision=14) : _precision(precision), _registers ((size_t)1 << precision, 0)
+    {
+        if (precision < 4 || precision > 18)  { throw system::Exception ("HyperLogLog: bad precision %ld (should be in [4..18])", precision); }
+    }
+
+    /** Insert an item given by its hash value.
+     * \param[in] hash : hash value of the item */
+    void add (u_int64_t hash)
+    {
+        /** The first bits give the register, the rank of the first 1 in the remaining bits is kept.
+         * A guard bit bounds the rank when the remaining bits are all 0. */
+        size_t    idx  = hash >> (64 - _precision);
+        u_int64_t rest = (hash << _precision) | ((u_int64_t)1 << (_precision-1));
+        u_int8_t  rank = __builtin_clzll (rest) + 1;
+
+        if (rank > _registers[idx])  { _registers[idx] = rank; }
+    }
+
+    /** Insert items given by their hash values.
+     * \param[in] hashes : hash values of the items
+     * \param[in] nb : number of hash values */
+    void add (const u_int64_t* hashes, size_t nb)  {  for (size_t i=0; i<nb; i++)  { add (hashes[i]); }  }
+
+    /** Merge another sketch into this one; the sketch then estimates the union of both sets of items.
+     * \param[in] other : sketch with the same precision */
+    void merge (const HyperLogLog& other)
+    {
+        if (other._precision != _precision)  { throw system::Exception ("HyperLogLog: can't merge sketches of precision %ld and %ld", _precision, other._precision); }
+
+        for (size_t i=0; i<_registers.size(); i++)  {  if (other._registers[i] > _registers[i])  { _registers[i] = other._registers[i]; }  }
+    }
+
+    /** Reset the sketch. */
+    void clear ()  {  std::fill (_registers.begin(), _registers.end(), 0);  }
+
+    /** Estimate the number of distinct inserted items.
+     * \return the estimation. */
+    u_int64_t estimate () const
+    {
+        double m     = _registers.size();
+        double sum   = 0;
+        size_t nbZero = 0;
+
+        for (size_t i=0; i<_registers.size(); i++)
+        {
+            sum += ldexp (1.0, -_registers[i]);
+            if (_registers[i] == 0)  { nbZero++; }
+        }
+
+        double alpha  = 0.7213 / (1.0 + 1.079/m);
+        double result = alpha * m * m / sum;
+
+        /** Small range correction: linear counting on the empty registers. */
+        if (result <= 2.5*m && nbZero > 0)  {  result = m * log (m / nbZero);  }
+
+        return (u_int64_t) (result + 0.5);
+    }
+
+    /** Get the relative standard error of the estimation.
+     * \return the relative error. */
+    double getRelativeError () const  { return 1.04 / sqrt ((double)_registers.size()); }
+
+    /** Get the precision of the sketch.
+     * \return log2 of the number of registers. */
+    size_t getPrecision () const  { return _precision; }
+
+private:
+
+    size_t                 _precision;
+    std::vector<u_int8_t>  _registers;
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_KMER_IMPL_HYPERLOGLOG_HPP_ */
@@ -0,0 +1,270 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file KmerCountIndex.hpp
+ *  \brief Exact count queries over the solid kmers partitions
+ */
+
+#ifndef _GATB_CORE_KMER_IMPL_KMER_COUNT_INDEX_HPP_
+#define _GATB_CORE_KMER_IMPL_KMER_COUNT_INDEX_HPP_
+
+/********************************************************************************/
+
+#include <gatb/kmer/impl/Model.hpp>
+#include <gatb/kmer/impl/PartiInfo.hpp>
+
+#include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/misc/api/Range.hpp>
+#include <gatb/tools/storage/impl/Storage.hpp>
+
+#include <algorithm>
+#include <vector>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Index answering the abundance of arbitrary kmers from the solid kmers partitions.
+ *
+ * The SortingCountAlgorithm dumps the solid kmers into the "solid" partition of the "dsk"
+ * group; each collection of this partition is sorted by kmer value, and the collection
+ * holding a given kmer is known from its minimizer through the Repartitor saved in the
+ * "minimizers" group.
+ *
+ * The KmerCountIndex only keeps in memory one kmer out of 'samplingRate' of each partition,
+ * the sample i being the item at offset i*samplingRate. A query is routed to its partition
+ * through the minimizer, the samples give the block of the partition where the kmer may be,
+ * this block is read from the storage (positional getItems) and a binary search in it gives
+ * the exact count (0 if the kmer is not solid).
+ *
+ * The storage must thus outlive the index; its collections must support concurrent getItems
+ * calls (as the file and HDF5 ones) for the batch lookups.
+ *
+ * Queried kmers must be given in the same form as the counted ones, ie. canonical kmers
+ * (unless NONCANONICAL is defined).
+ *
+ * Sample of use:
+ * \code
+ * Storage* storage = StorageFactory(STORAGE_HDF5).create ("reads.h5", false, false);
+ * KmerCountIndex<> index (*storage);
+ * CountNumber abundance = index.lookup (kmer);
+ * \endcode
+ */
+template<size_t span=KMER_DEFAULT_SPAN>
+class KmerCountIndex : public system::SmartPointer
+{
+public:
+
+    /** Shortcuts. */
+    typedef typename Kmer<span>::Type           Type;
+    typedef typename Kmer<span>::Count          Count;
+    typedef typename Kmer<span>::ModelDirect    ModelDirect;
+    typedef typename Kmer<span>::ModelCanonical ModelCanonical;
+#ifdef NONCANONICAL
+    typedef typename Kmer<span>::template ModelMinimizer <ModelDirect>   Model;
+#else
+    typedef typename Kmer<span>::template ModelMinimizer <ModelCanonical>   Model;
+#endif
+
+    /** Constructor. The solid kmers partitions are read once for sampling them.
+     * \param[in] storage : storage holding the "dsk" and "minimizers" groups of a kmer counting.
+     * \param[in] nbCores : number of cores used for sampling the partitions and for the batch lookups (0 means all)
+     * \param[in] samplingRate : one kmer out of samplingRate is kept in the sparse index of a partition */
+    KmerCountIndex (tools::storage::impl::Storage& storage, size_t nbCores=0, size_t samplingRate=64)
+        : _kmerSize(0), _nbCores(nbCores), _samplingRate(std::max (samplingRate, (size_t)1)),
+          _nbPasses(0), _nbPartsPerPass(0), _model(0), _nbKmers(0)
+    {
+        tools::storage::impl::Group& dskGroup = storage.getGroup("dsk");
+
+        _kmerSize = atol (dskGroup.getProperty ("kmer_size").c_str());
+        if (_kmerSize == 0)  { throw system::Exception ("KmerCountIndex: no kmer counting found in storage"); }
+
+        /** We retrieve the minimizer repartition used during the counting. */
+        _repartitor.load (storage.getGroup("minimizers"));
+        _nbPasses       = _repartitor.getNbPasses();
+        _nbPartsPerPass = _repartitor.getNbPartitions();
+
+        /** We need the same minimizer model as the one used for the counting. */
+        _model = new Model (_kmerSize, _repartitor.getMinimizerSize(),
+            typename Kmer<span>::ComparatorMinimizerFrequencyOrLex(), _repartitor.getMinimizerFrequencies()
+        );
+
+        tools::storage::impl::Partition<Count>& solid = dskGroup.getPartition<Count> ("solid");
+
+        if (solid.size() != _nbPasses*_nbPartsPerPass)
+        {
+            throw system::Exception ("KmerCountIndex: %ld solid partitions found, %ld expected from repartition",
+                solid.size(), _nbPasses*_nbPartsPerPass
+            );
+        }
+
+        /** We keep the collections for the queries. */
+        _collections.resize (solid.size());
+        for (size_t p=0; p<solid.size(); p++)  {  (_collections[p] = & solid[p])->use();  }
+
+        /** We sample the partitions in parallel. */
+        _sizes.resize   (solid.size());
+        _samples.resize (solid.size());
+
+        tools::misc::Range<size_t>::Iterator it (0, solid.size()-1);
+        tools::dp::impl::Dispatcher (_nbCores, 1).iterate (it, SampleFunctor (*this));
+
+        for (size_t p=0; p<_sizes.size(); p++)  { _nbKmers += _sizes[p]; }
+    }
+
+    /** Destructor. */
+    ~KmerCountIndex ()
+    {
+        for (size_t p=0; p<_collections.size(); p++)  { _collections[p]->forget(); }
+        delete _model;
+    }
+
+    /** Get the kmer size of the counted kmers.
+     * \return the kmer size. */
+    size_t getKmerSize () const  { return _kmerSize; }
+
+    /** Get the number of indexed (solid) kmers.
+     * \return the number of kmers. */
+    u_int64_t getNbKmers () const  { return _nbKmers; }
+
+    /** Get the minimizer model used for routing kmers to their partition.
+     * \return the model. */
+    const Model& getModel () const  { return *_model; }
+
+    /** Get the abundance of a kmer.
+     * \param[in] kmer : the (canonical) kmer value
+     * \return the abundance of the kmer, 0 if the kmer is not a solid one. */
+    CountNumber lookup (const Type& kmer) const
+    {
+        std::vector<Count> block;
+        return lookup (kmer, block);
+    }
+
+    /** Get the abundances of a set of kmers. The lookups are dispatched on the cores given at construction.
+     * \param[in] kmers : the (canonical) kmer values
+     * \param[out] counts : abundance of each kmer, 0 for a non solid kmer */
+    void lookup (const std::vector<Type>& kmers, std::vector<CountNumber>& counts) const
+    {
+        counts.resize (kmers.size());
+        if (kmers.empty())  { return; }
+
+        size_t nbChunks = (kmers.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+        if (nbChunks == 1)  { lookup (kmers, counts, 0);  return; }
+
+        tools::misc::Range<size_t>::Iterator it (0, nbChunks-1);
+        tools::dp::impl::Dispatcher (_nbCores, 1).iterate (it, [&] (size_t chunk)  {  lookup (kmers, counts, chunk);  });
+    }
+
+private:
+
+    static const size_t CHUNK_SIZE = 16*1024;
+
+    /** Order of the Count items by kmer value, as in the sorted partitions. */
+    struct CountLess
+    {
+        bool operator() (const Count& a, const Type& b) const  { return a.value < b; }
+    };
+
+    /** Reads one partition and keeps one kmer out of _samplingRate. */
+    struct SampleFunctor
+    {
+        KmerCountIndex& ref;
+
+        SampleFunctor (KmerCountIndex& ref) : ref(ref)  {}
+
+        void operator() (size_t partId)
+        {
+            std::vector<Type>& samples = ref._samples[partId];
+
+            tools::dp::Iterator<Count>* it = ref._collections[partId]->iterator();  LOCAL (it);
+
+            u_int64_t nbItems = 0;
+            for (it->first(); !it->isDone(); it->next(), nbItems++)
+            {
+                if (nbItems % ref._samplingRate == 0)  {  samples.push_back (it->item().value);  }
+            }
+
+            ref._sizes[partId] = nbItems;
+        }
+    };
+
+    /** Get the abundance of a kmer.
+     * \param[in] kmer : the (canonical) kmer value
+     * \param[in] block : buffer for the block read from the storage, reused from one query to another
+     * \return the abundance of the kmer, 0 if the kmer is not a solid one. */
+    CountNumber lookup (const Type& kmer, std::vector<Count>& block) const
+    {
+        u_int64_t minimizer = _model->getMinimizerValue (kmer);
+        size_t    partId    = _repartitor (minimizer) + (minimizer % _nbPasses) * _nbPartsPerPass;
+
+        const std::vector<Type>& samples = _samples[partId];
+
+        /** The sampled kmers give the block [(i-1)*S, i*S) holding the kmer. */
+        size_t i = std::upper_bound (samples.begin(), samples.end(), kmer) - samples.begin();
+        if (i == 0)  { return 0; }
+
+        u_int64_t start = (u_int64_t)(i-1) * _samplingRate;
+        size_t    nb    = std::min ((u_int64_t)_samplingRate, _sizes[partId] - start);
+
+        block.resize (nb);
+        Count* buffer = block.data();
+        nb = _collections[partId]->getItems (buffer, start, nb);
+
+        Count* found = std::lower_bound (buffer, buffer + nb, kmer, CountLess());
+
+        return (found != buffer + nb && found->value == kmer) ? found->abundance : 0;
+    }
+
+    /** Lookup of one chunk of a batch. */
+    void lookup (const std::vector<Type>& kmers, std::vector<CountNumber>& counts, size_t chunk) const
+    {
+        std::vector<Count> block;
+
+        size_t end = std::min (kmers.size(), (chunk+1)*CHUNK_SIZE);
+        for (size_t i=chunk*CHUNK_SIZE; i<end; i++)  {  counts[i] = lookup (kmers[i], block);  }
+    }
+
+    size_t     _kmerSize;
+    size_t     _nbCores;
+    size_t     _samplingRate;
+    size_t     _nbPasses;
+    size_t     _nbPartsPerPass;
+    Repartitor _repartitor;
+    Model*     _model;
+    u_int64_t  _nbKmers;
+
+    /** Solid kmers partitions of the storage, sorted by kmer value. */
+    std::vector<tools::collections::Collection<Count>*> _collections;
+
+    /** Number of kmers of each partition. */
+    std::vector<u_int64_t> _sizes;
+
+    /** One kmer out of _samplingRate for each partition: the sample i is the kmer at offset i*_samplingRate. */
+    std::vector<std::vector<Type> >  _samples;
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_KMER_IMPL_KMER_COUNT_INDEX_HPP_ */
@@ -37,6 +37,7 @@
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 #include <gatb/tools/misc/api/Data.hpp>
 #include <gatb/tools/misc/api/Abundance.hpp>
+#include <gatb/tools/misc/impl/NucleotideEncoder.hpp>
 
 #include <gatb/tools/math/Integer.hpp>
 
@@ -711,10 +712,49 @@ struct Kmer
             Functor_iterate (tools::misc::Data& data, Callback callback) : data(data), callback(callback) {}
             template<class Convert>  Result operator() (const ModelAbstract* model)
             {
-                return static_cast<const ModelImpl*>(model)->template iterate<Callback, Convert> (data.getBuffer(), data.size(), callback);
+                return static_cast<const ModelImpl*>(model)->template iterateData<Callback> (data.getBuffer(), data.size(), callback, (Convert*)0);
             }
         };
 
+        /** Iterates the kmers of a sequence whose encoding is given by the type of the last (dummy) argument;
+         * this generic version uses the per nucleotide conversion. */
+        template<typename Callback, typename Convert>
+        bool iterateData (const char* seq, size_t length, Callback callback, Convert*) const
+        {
+            return this->template iterate<Callback, Convert> (seq, length, callback);
+        }
+
+        /** Iterates the kmers of an ASCII sequence. The validity of the whole sequence is first checked at once
+         * (see tools::misc::impl::PackedNucleotides::isValid, 16 nucleotides per step with SSE2); most reads have
+         * no invalid nucleotide, so all their kmers are valid and the rolling loop doesn't need to check each character.
+         * Otherwise we use the per nucleotide conversion. */
+        template<typename Callback>
+        bool iterateData (const char* seq, size_t length, Callback callback, ConvertASCII*) const
+        {
+            if (tools::misc::impl::PackedNucleotides::isValid (seq, length) == false)
+            {
+                return this->template iterate<Callback, ConvertASCII> (seq, length, callback);
+            }
+
+            int32_t nbKmers = length - _kmerSize + 1;
+            if (nbKmers <= 0)  { return false; }
+
+            typename ModelImpl::Kmer result;
+            static_cast<const ModelImpl*>(this)->template first<ConvertASCII> (seq, result, 0);
+
+            size_t idxComputed = 0;
+            this->notification<Callback> (result, idxComputed, callback);
+
+            for (size_t idx=_kmerSize; idx<length; idx++)
+            {
+                static_cast<const ModelImpl*>(this)->template next<ConvertASCII> ((seq[idx]>>1) & 3, result, true);
+
+                this->notification<Callback> (result, ++idxComputed, callback);
+            }
+
+            return true;
+        }
+
         /** Template method that iterates the kmer of a given sequence (provided as a buffer and its length).
          *  Note : we use static polymorphism here (http://en.wikipedia.org/wiki/Template_metaprogramming)
          *  \param[in] seq : the sequence to be iterated
@@ -352,7 +352,7 @@ public:
     /** Returns the hash value for the given minimizer value.
      * \param[in] minimizerValue : minimizer value as an integer.
      * \return hash value for the given minimizer. */
-    Value operator() (u_int64_t minimizerValue)  { return getRepartTable() [minimizerValue]; }
+    Value operator() (u_int64_t minimizerValue) const  { return getRepartTable() [minimizerValue]; }
 
     /** Load the repartition table from a storage object.
      * \param[in] group : group where the repartition table has to be loaded */
@@ -368,6 +368,12 @@ public:
     /** Get the number of passes used to split the input bank. */
     size_t getNbPasses() const { return _nbPass; }
 
+    /** Get the number of partitions per pass, ie. the range of the hash values. */
+    size_t getNbPartitions() const { return _nbpart; }
+
+    /** Get the size of the minimizers used for the repartition. */
+    size_t getMinimizerSize() const { return _mm; }
+
     /** Get a buffer on minimizer frequencies. */
     uint32_t* getMinimizerFrequencies () { return _freq_order; }
 
@@ -404,7 +410,7 @@ private:
     typedef std::vector<Value> Table;
 
     /** Get the repartition table. It is built at first call. */
-    const Table& getRepartTable()
+    const Table& getRepartTable() const
     {
 		// if (_repart_table.empty()) { throw system::Exception ("Repartitor : table has not been initialized"); }
         return _repart_table;
@@ -21,6 +21,7 @@
 #include <gatb/tools/collections/impl/OAHash.hpp>
 #include <gatb/tools/collections/impl/Hash16.hpp>
 #include <gatb/tools/misc/impl/Stringify.hpp>
+#include <gatb/system/impl/Tracer.hpp>
 
 
 using namespace std;
@@ -81,6 +82,7 @@ PartitionsCommand<span>:: PartitionsCommand (
       _kmerSize(kmerSize),
       _cacheSize(cacheSize),
       _pool(pool),
+      _batchNbBanks(0),
       _globalTimeInfo(timeInfo),
       _processor(0),
 	  _superKstorage(superKstorage)
@@ -115,61 +117,56 @@ PartitionsCommand<span>::~PartitionsCommand()
 template<size_t span>
 void PartitionsCommand<span>::insert (const Type& kmer, const CounterBuilder& counter)
 {
-    /** We call the count processor instance with the information collected for the current kmer. */
-    _processor->process (_parti_num, kmer, counter.get());
-}
+    const CountVector& count = counter.get();
 
-	
+    /** The batch buffers are allocated for the first inserted kmer. */
+    if (_batchKmers.capacity() == 0)
+    {
+        _batchNbBanks = count.size();
+        _batchKmers.reserve  (BATCH_SIZE);
+        _batchCounts.resize  (BATCH_SIZE * _batchNbBanks);
+    }
 
-/////////   multibank version  with old partition system//////////////
-template<size_t span>
-PartitionsCommand_multibank<span>:: PartitionsCommand_multibank (
-											 Iterable<Type>&     partition,
-											 CountProcessor*     processor,
-											 size_t              cacheSize,
-											 IteratorListener*   progress,
-											 TimeInfo&           timeInfo,
-											 PartiInfo<5>&       pInfo,
-											 int                 passi,
-											 int                 parti,
-											 size_t              nbCores,
-											 size_t              kmerSize,
-											 MemAllocator&       pool
-											 )
-:
-_partition(partition),
-_progress(progress),
-_pInfo(pInfo),
-_pass_num(passi),
-_parti_num(parti),
-_nbCores(nbCores),
-_kmerSize(kmerSize),
-_cacheSize(cacheSize),
-_pool(pool),
-_globalTimeInfo(timeInfo),
-_processor(0)
-{
-	setProcessor      (processor);
-}
+    size_t idx = _batchKmers.size();
+    _batchKmers.push_back (kmer);
+    for (size_t b=0; b<_batchNbBanks; b++)  { _batchCounts[b*BATCH_SIZE + idx] = count[b]; }
 
-template<size_t span>
-PartitionsCommand_multibank<span>::~PartitionsCommand_multibank()
-{
-	_globalTimeInfo += _timeInfo;
-	
-	setProcessor (0);
+    if (_batchKmers.size() == BATCH_SIZE)  { flushBatch(); }
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
 template<size_t span>
-void PartitionsCommand_multibank<span>::insert (const Type& kmer, const CounterBuilder& counter)
+void PartitionsCommand<span>::flushBatch ()
 {
-	/** We call the count processor instance with the information collected for the current kmer. */
-	_processor->process (_parti_num, kmer, counter.get());
+    size_t nbKmers = _batchKmers.size();
+    if (nbKmers == 0)  { return; }
+
+    /** For a partial batch, the columns of counts are packed in order to get a nbKmers stride. */
+    if (nbKmers < BATCH_SIZE)
+    {
+        for (size_t b=1; b<_batchNbBanks; b++)
+        {
+            std::copy (_batchCounts.begin() + b*BATCH_SIZE, _batchCounts.begin() + b*BATCH_SIZE + nbKmers, _batchCounts.begin() + b*nbKmers);
+        }
+    }
+
+    _batchSelected.assign (nbKmers, 1);
+
+    /** We call the count processor instance with the information collected for the current kmers. */
+    _processor->processBatch (_parti_num, _batchKmers.data(), nbKmers, _batchCounts.data(), _batchNbBanks, 0, _batchSelected.data());
+
+    _batchKmers.clear();
 }
-/////////////////
-	
-	
+
 	
+
 /*********************************************************************
                 #     #     #      #####   #     #
                 #     #    # #    #     #  #     #
@@ -373,6 +370,8 @@ void PartitionsByHashCommand<span>:: execute ()
 {
 	typedef typename tools::collections::impl::Hash16<Type>::cell cell_t;
 
+	TRACE_SPAN_ARG ("partition", "count_by_hash", this->_parti_num);
+
 		this->_superKstorage->openFile("r",this->_parti_num);
 	
 	this->_processor->beginPart (this->_pass_num, this->_parti_num, this->_cacheSize, this->getName());
@@ -734,6 +733,8 @@ void PartitionsByHashCommand<span>:: execute ()
 	this->_superKstorage->closeFile(this->_parti_num);
 	
 	this->_progress->inc (this->_pInfo.getNbKmer(this->_parti_num) ); // this->_pInfo->getNbKmer(this->_parti_num)  kmers.size()
+
+	this->flushBatch ();
 	
 	this->_processor->endPart (this->_pass_num, this->_parti_num);
 };
@@ -748,178 +749,8 @@ void PartitionsByHashCommand<span>:: execute ()
            #     #######   #####      #     #######  #     #
 *********************************************************************/
 
-template<size_t span>
-class SuperKReader
-{
-	typedef typename Kmer<span>::Type  Type;
-public:
-
-	void operator() (Type& elem)
-	{
-		//reading elems by pairs
-		if(_first)
-		{
-			_superk = elem;
-			_first = false;
-		}
-		else
-		{
-			_seedk = elem;
-			
-			Type compactedK;
-			
-			compactedK =  _superk;
-			u_int8_t nbK = (compactedK >> _shift_val).getVal()  & 255; // 8 bits poids fort = cpt
-			u_int8_t rem = nbK;
-			
-			Type temp = _seedk;
-			Type rev_temp = revcomp(temp,_kmerSize);
-			Type newnt ;
-			Type mink, prev_mink; prev_mink.setVal(0);
-			uint64_t idx;
-			
-#ifdef NONCANONICAL
-            bool prev_which = true;
-#else
-			bool prev_which =  (temp < rev_temp );
-#endif
-            
-			int kx_size = -1; //next loop start at ii=0, first kmer will put it at 0
-			Type radix_kxmer_forward =  (temp & _mask_radix) >> ((_kmerSize - 4)*2);
-			Type  first_revk, kinsert,radix_kxmer;
-            first_revk.setVal(0);
-			
-			if(!prev_which) first_revk = rev_temp;
-			
-			u_int8_t rid;
-
-			for (int ii=0; ii< nbK; ii++,rem--)
-			{
-#ifdef NONCANONICAL
-                bool which = true;
-                mink = temp;
-#else
-				bool which =  (temp < rev_temp );
-				mink = which ? temp : rev_temp;
-#endif
-
-				if (which != prev_which || kx_size >= _kx) // kxmer_size = 1
-				{
-					//output kxmer size kx_size,radix_kxmer
-					//kx mer is composed of superKp[ii-1] superKp[ii-2] .. superKp[ii-n] with nb elems  n  == kxmer_size +1  (un seul kmer ==k+0)
-					
-					if(prev_which)
-					{
-						radix_kxmer = radix_kxmer_forward;
-						kinsert = prev_mink;
-					}
-					else // si revcomp, le radix du kxmer est le debut du dernier kmer
-					{
-						//previous mink
-						radix_kxmer =  (prev_mink & _mask_radix) >> _shift_radix;
-						kinsert = first_revk;
-					}
-					
-					//record kxmer
-					rid = radix_kxmer.getVal();
-					//idx = _r_idx[IX(kx_size,rid)]++;
-					idx = __sync_fetch_and_add( _r_idx +  IX(kx_size,rid) ,1); // si le sync fetch est couteux, faire un mini buffer par thread
-					
-					_radix_kmers [IX(kx_size,rid)][ idx] = kinsert << ((4-kx_size)*2);  //[kx_size][rid]
-					if (_bankIdMatrix)  { _bankIdMatrix[IX(kx_size,rid)][ idx] = _bankId; }
-					
-					radix_kxmer_forward =  (mink & _mask_radix) >> _shift_radix;
-					kx_size =0;
-					
-					if(!which) first_revk = rev_temp;
-				}
-				else
-				{
-					kx_size++;
-				}
-			
-				prev_which = which ;
-				prev_mink = mink;
-				
-				if(rem < 2) break; //no more kmers in this superkmer, the last one has just been eaten
-				newnt =  ( _superk >> ( 2*(rem-2)) ) & 3 ;
-				
-				temp = ((temp << 2 ) |  newnt   ) & _kmerMask;
-				newnt.setVal(comp_NT[newnt.getVal()]) ;
-				rev_temp = ((rev_temp >> 2 ) |  (newnt << _shift) ) & _kmerMask;
-			}
-			
-			//record last kxmer prev_mink et monk ?
-			if(prev_which)
-			{
-				radix_kxmer = radix_kxmer_forward;
-				kinsert = prev_mink;
-			}
-			else // si revcomp, le radix du kxmer est le debut du dernier kmer
-			{
-				//previous mink
-				radix_kxmer =  (prev_mink & _mask_radix) >> _shift_radix;
-				kinsert = first_revk;
-			}
-			
-			//record kxmer
-			rid = radix_kxmer.getVal();
-			//idx = _r_idx[IX(kx_size,rid)]++;
-			idx = __sync_fetch_and_add( _r_idx +  IX(kx_size,rid) ,1); // si le sync fetch est couteux, faire un mini buffer par thread
-					
-
-            
-//                        if (idx >= _radix_sizes[IX(kx_size,rid)] ||  _radix_sizes[IX(kx_size,rid)]  == 0)
-//                        {  cout << "error, accessing _radix_kmers beyond bound" << endl; exit(1); }
-//                    cout << "tbl ref " << IX(kx_size,rid) << " idx " << idx << " radix sizes " <<   _radix_sizes[IX(kx_size,rid)]   << endl;
-            
-                        _radix_kmers [IX(kx_size,rid)][ idx] = kinsert << ((4-kx_size)*2);   // [kx_size][rid]
-                    //cout << "went okay " << idx << endl;
-
-			if (_bankIdMatrix)  { _bankIdMatrix[IX(kx_size,rid)][ idx] = _bankId; }
-
-			_first = true;
-		}
-	}
-	
-	SuperKReader (size_t kmerSize,  uint64_t * r_idx, Type** radix_kmers, uint64_t* radix_sizes, bank::BankIdType** bankIdMatrix, size_t bankId=0)
-	: _kmerSize (kmerSize), _kx(4), _radix_kmers(radix_kmers), _radix_sizes(radix_sizes), _bankIdMatrix(bankIdMatrix), _r_idx (r_idx), _first(true), _bankId(bankId)
-	 {
-		 Type un;
-         un.setVal(1);
-		 _kmerMask    = (un << (kmerSize*2)) - 1;
-		 _mask_radix.setVal((int64_t) 255);
-		 _mask_radix  = _mask_radix << ((_kmerSize - 4)*2);
-		 _shift       = 2*(kmerSize-1);
-		 _shift_val   = un.getSize() -8;
-		 _shift_radix = ((kmerSize - 4)*2); // radix is 4 nt long
-	}
-	
-private :
-
-	size_t _kmerSize;
-	size_t _shift ;
-	size_t _shift_val ;
-	size_t _shift_radix ;
-	int    _kx;
-	Type** _radix_kmers;
-      uint64_t*          _radix_sizes;
-
-	bank::BankIdType** _bankIdMatrix;
-	uint64_t* _r_idx ;
-	bool _first;
-	Type _superk, _seedk;
-	Type _radix, _mask_radix ;
-	Type _kmerMask;
-	size_t _bankId;
-};
-
-	
-	
-
-//pour l'instant marchera que en mode comptage simple, pas en multi jeu separes
-//car le jeu separe necessite de passer un cpt de separation des banques, a verifier, et il faut que les buffer conservent l'ordre d'entree, a verifier aussi
 //readcommand pour lecture parallele des parti superkmers
+//in case of several banks, the bank of the superkmers is given by the header of each block
 template<size_t span>
 class ReadSuperKCommand : public gatb::core::tools::dp::ICommand, public system::SmartPointer
 {
@@ -928,7 +759,7 @@ class ReadSuperKCommand : public gatb::core::tools::dp::ICommand, public system:
 public:
 	ReadSuperKCommand(tools::storage::impl::SuperKmerBinFiles* superKstorage, int fileId, int kmerSize,
 					  uint64_t * r_idx, Type** radix_kmers, uint64_t* radix_sizes, bank::BankIdType** bankIdMatrix)
-	: _superKstorage(superKstorage), _fileId(fileId),_buffer(0),_buffer_size(0), _kmerSize(kmerSize),_radix_kmers(radix_kmers), _radix_sizes(radix_sizes), _bankIdMatrix(bankIdMatrix), _r_idx (r_idx)
+	: _superKstorage(superKstorage), _fileId(fileId),_buffer(0),_buffer_size(0), _kmerSize(kmerSize),_radix_kmers(radix_kmers), _radix_sizes(radix_sizes), _bankIdMatrix(bankIdMatrix), _r_idx (r_idx), _bankId(0)
 	{
 		_kx=4;
 		Type un;
@@ -944,7 +775,7 @@ public:
 	void execute ()
 	{
 		unsigned int nb_bytes_read;
-		while(_superKstorage->readBlock(&_buffer, &_buffer_size, &nb_bytes_read, _fileId))
+		while(_superKstorage->readBlock(&_buffer, &_buffer_size, &nb_bytes_read, _fileId, &_bankId))
 		{
 			//decode block and iterate through its superkmers
 			unsigned char * ptr = _buffer;
@@ -1145,7 +976,7 @@ private:
 	size_t _shift ;
 	size_t _shift_val ;
 	size_t _shift_radix ;
-	size_t _bankId;
+	bank::BankIdType _bankId;
 	
 };
 	
@@ -1205,6 +1036,8 @@ PartitionsByVectorCommand<span>:: ~PartitionsByVectorCommand ()
 template<size_t span>
 void PartitionsByVectorCommand<span>::execute ()
 {
+    TRACE_SPAN_ARG ("partition", "count_by_vector", this->_parti_num);
+
     this->_processor->beginPart (this->_pass_num, this->_parti_num, this->_cacheSize, this->getName());
 
     /** We check that we got something. */
@@ -1235,6 +1068,8 @@ void PartitionsByVectorCommand<span>::execute ()
     /** We update the progress bar. */
     this->_progress->inc (this->_pInfo.getNbKmer(this->_parti_num) );
 
+    this->flushBatch ();
+
     this->_processor->endPart (this->_pass_num, this->_parti_num);
 };
 
@@ -1253,6 +1088,7 @@ template<size_t span>
 void PartitionsByVectorCommand<span>::executeRead ()
 {
     TIME_INFO (this->_timeInfo, "1.read");
+    TRACE_SPAN_ARG ("partition", "read", this->_parti_num);
 
 	this->_superKstorage->openFile("r",this->_parti_num);
 
@@ -1298,20 +1134,16 @@ void PartitionsByVectorCommand<span>::executeRead ()
          * On MacOs, we got some crashes with uint128 that were not aligned on 16 bytes
          */
         if (_bankIdMatrix)
-		{
-			throw Exception ("PartitionsByVectorCommand: multi-bank unsupported with new superk storage");
-
-			/*
-			for (size_t xx=0; xx< (KX+1); xx++)
-			{
-				for (int ii=0; ii< 256; ii++)
-				{
-					size_t nbKmers = this->_pInfo.getNbKmer(this->_parti_num,ii,xx);
-					_bankIdMatrix [IX(xx,ii)] = (bank::BankIdType*) this->_pool.pool_malloc (nbKmers * sizeof(bank::BankIdType), "bank ids alloc");
-				}
-			}
-			 */
-		}
+        {
+            for (size_t xx=0; xx< (KX+1); xx++)
+            {
+                for (int ii=0; ii< 256; ii++)
+                {
+                    size_t nbKmers = this->_pInfo.getNbKmer(this->_parti_num,ii,xx);
+                    _bankIdMatrix [IX(xx,ii)] = (bank::BankIdType*) this->_pool.pool_malloc (nbKmers * sizeof(bank::BankIdType), "bank ids alloc");
+                }
+            }
+        }
     }
 
     DEBUG (("PartitionsByVectorCommand<span>::executeRead:  fillsolid parti num %i  by vector  nb kxmer / nbkmers      %lli / %lli     %f   with %zu nbcores \n",
@@ -1319,61 +1151,23 @@ void PartitionsByVectorCommand<span>::executeRead ()
         (double) sum_nbxmer /  this->_pInfo.getNbKmer(this->_parti_num),this->_nbCores
     ));
 
-    /** HOW TO COUNT KMERS BY SET OF READS ?
-     * Now, we are going to read the temporary partition built during the previous phase and fill
-     * the _radix_kmers attribute. We also need to know in _radix_kmers what is the contribution of
-     * each bank. We therefore need to iterate the current partition by bank (using the information
-     * of _offsets). */
-
-    if (_bankIdMatrix)
-	{
-		throw Exception ("PartitionsByVectorCommand: multi-bank unsupported with new superk storage");
-//		/** We create an iterator over all the items. */
-//		Iterator<Type>* itGlobal = this->_partition.iterator();
-//		LOCAL (itGlobal);
-//		
-//		/** We iterate the banks. */
-//		for (size_t b=0; b<_nbItemsPerBankPerPart.size(); b++)
-//		{
-//			/** We truncate the global iterator.
-//			 * NB : we initialize (ie call 'first') the global iterator only at first call (for b==0). */
-//			Iterator<Type>* itLocal = new TruncateIterator<Type> (*itGlobal, _nbItemsPerBankPerPart[b], b==0 ? true : false);
-//			LOCAL (itLocal);
-//			
-//			/** We iterate this local iterator. */
-//			_dispatcher->iterate (itLocal, SuperKReader<span>  (this->_kmerSize, _r_idx, _radix_kmers, _radix_sizes, _bankIdMatrix, b), 10000); //must be even , reading by pairs
-//		}
-//		
-//		/** We check that the global iterator is finished. */
-//		if (itGlobal->isDone() == false)  { throw Exception ("PartitionsByVectorCommand: iteration should be finished"); }
-		
-	}
-    else
+    /** We iterate the superkmers. In case of several banks, each block of superkmers read from the
+     * partition file tells the bank it comes from, which is recorded in _bankIdMatrix for each kxmer. */
+    vector<ICommand*> cmds;
+    for (size_t tid=0; tid < this->_nbCores; tid++)
     {
-        /** We iterate the superkmers. */
-
-			vector<ICommand*> cmds;
-			for (size_t tid=0; tid < this->_nbCores; tid++)
-			{
-				cmds.push_back(new ReadSuperKCommand<span> (
-															this->_superKstorage,
-															this->_parti_num,
-															this->_kmerSize,
-															_r_idx, _radix_kmers, _radix_sizes, 0
-															)
-							   );
-			}
-			
-			_dispatcher->dispatchCommands (cmds, 0);
-
-		
-		
+        cmds.push_back(new ReadSuperKCommand<span> (
+                                                    this->_superKstorage,
+                                                    this->_parti_num,
+                                                    this->_kmerSize,
+                                                    _r_idx, _radix_kmers, _radix_sizes, _bankIdMatrix
+                                                    )
+                       );
+    }
 
-//		printf("-----done ReadSuperKCommand ---\n");
+    _dispatcher->dispatchCommands (cmds, 0);
 
-    }
-	
-		this->_superKstorage->closeFile(this->_parti_num);
+    this->_superKstorage->closeFile(this->_parti_num);
 
 }
 
@@ -1474,6 +1268,7 @@ template<size_t span>
 void PartitionsByVectorCommand<span>::executeSort ()
 {
     TIME_INFO (this->_timeInfo, "2.sort");
+    TRACE_SPAN_ARG ("partition", "sort", this->_parti_num);
 
     vector<ICommand*> cmds;
 
@@ -1600,6 +1395,7 @@ template<size_t span>
 void PartitionsByVectorCommand<span>::executeDump ()
 {
     TIME_INFO (this->_timeInfo, "3.dump");
+    TRACE_SPAN_ARG ("partition", "dump", this->_parti_num);
 
     int nbkxpointers = 453; //6 for k1 mer, 27 for k2mer, 112 for k3mer  453 for k4mer
     vector< KxmerPointer<span>*> vec_pointer (nbkxpointers);
@@ -1806,438 +1602,6 @@ void PartitionsByVectorCommand<span>::executeDump ()
 
 	
 	
-//////////////////Multi bank version of partitionbyvectorcommand //////////////////
-	
-template<size_t span>
-PartitionsByVectorCommand_multibank<span>:: PartitionsByVectorCommand_multibank (
-																				 Iterable<Type>&     partition,
-																				 CountProcessor*     processor,
-																				 size_t              cacheSize,
-																				 IteratorListener*   progress,
-																				 TimeInfo&           timeInfo,
-																				 PartiInfo<5>&       pInfo,
-																				 int                 passi,
-																				 int                 parti,
-																				 size_t              nbCores,
-																				 size_t              kmerSize,
-																				 MemAllocator&       pool,
-																				 vector<size_t>&     offsets
-																				 )
-: PartitionsCommand_multibank<span> (partition, processor, cacheSize,  progress, timeInfo, pInfo, passi, parti,nbCores,kmerSize,pool),
-_radix_kmers (0), _bankIdMatrix(0), _radix_sizes(0), _r_idx(0), _nbItemsPerBankPerPart(offsets)
-{
-	_dispatcher = new Dispatcher (this->_nbCores);
-}
-
-/*********************************************************************
- ** METHOD  :
- ** PURPOSE :
- ** INPUT   :
- ** OUTPUT  :
- ** RETURN  :
- ** REMARKS :
- *********************************************************************/
-template<size_t span>
-PartitionsByVectorCommand_multibank<span>:: ~PartitionsByVectorCommand_multibank ()
-{
-	if (_dispatcher)  { delete _dispatcher; }
-}
-
-/*********************************************************************
- ** METHOD  :
- ** PURPOSE :
- ** INPUT   :
- ** OUTPUT  :
- ** RETURN  :
- ** REMARKS :
- *********************************************************************/
-template<size_t span>
-void PartitionsByVectorCommand_multibank<span>::execute ()
-{
-	this->_processor->beginPart (this->_pass_num, this->_parti_num, this->_cacheSize, this->getName());
-	
-	/** We check that we got something. */
-
-		if (this->_partition.getNbItems() == 0)  {  return;  }
-	
-	/** We configure tables. */
-	_radix_kmers  = (Type**)     MALLOC (256*(KX+1)*sizeof(Type*)); //make the first dims static ?  5*256
-	_radix_sizes  = (uint64_t*)  MALLOC (256*(KX+1)*sizeof(uint64_t));
-	_r_idx        = (uint64_t*)  CALLOC (256*(KX+1),sizeof(uint64_t));
-	
-	/** We need extra information for kmers counting in case of several input banks. */
-	if (_nbItemsPerBankPerPart.size() > 1) { _bankIdMatrix = (bank::BankIdType**) MALLOC (256*(KX+1)*sizeof(bank::BankIdType*)); }
-	else                                   { _bankIdMatrix = 0; }
-	
-	/** We have 3 phases here: read, sort and dump. */
-	executeRead ();
-	executeSort ();
-	executeDump ();
-	
-	/** We cleanup tables. */
-	FREE (_radix_sizes) ;
-	FREE (_radix_kmers);
-	FREE (_r_idx);
-	if (_bankIdMatrix)  { FREE (_bankIdMatrix); }
-	
-	/** We update the progress bar. */
-	this->_progress->inc (this->_pInfo.getNbKmer(this->_parti_num) );
-	
-	this->_processor->endPart (this->_pass_num, this->_parti_num);
-};
-
-template<size_t span>
-void PartitionsByVectorCommand_multibank<span>::executeRead ()
-{
-	TIME_INFO (this->_timeInfo, "1.read");
-	
-
-	
-	/** Recall that the attribute _offsets has a size equals to the number of banks + 1 as input
-	 * and for each bank, it holds the number of items found for the currently processed partition.
-	 *
-	 *               bank0   bank1   ...   bankI
-	 *   offsets :    xxx     xxx           xxx
-	 *               <------------------------->
-	 *                current partition content
-	 */
-	
- DEBUG (("_offsets.size=%d  OFFSETS: ", _nbItemsPerBankPerPart.size() ));
- for (size_t j=0; j<_nbItemsPerBankPerPart.size(); j++)  {  DEBUG (("%6d ", _nbItemsPerBankPerPart[j]));  }  DEBUG (("\n"));
-	
-	uint64_t sum_nbxmer =0;
-	
-	/** We synchronize this statements block because of threads concurrent access. */
-	{
-		LocalSynchronizer synchro (this->_pool.getSynchro());
-		
-		/** We align the pool with a big alignment constraint (see below macos issue with uint128) */
-		this->_pool.align (16);
-		
-		/** FIRST: allocation for the kmers. */
-		for (size_t xx=0; xx< (KX+1); xx++)
-		{
-			for (int ii=0; ii< 256; ii++)
-			{
-				/** Shortcut. */
-				size_t nbKmers = this->_pInfo.getNbKmer(this->_parti_num,ii,xx);
-				
-				//use memory pool here to avoid memory fragmentation
-				_radix_kmers  [IX(xx,ii)] = (Type*)     this->_pool.pool_malloc (nbKmers * sizeof(Type),     "kmers alloc");
-				_radix_sizes  [IX(xx,ii)] = nbKmers;
-				
-				sum_nbxmer +=  nbKmers;
-			}
-		}
-		
-		/** SECOND: allocation for the bank ids if needed.
-		 * => NEED TO BE DONE AFTER THE KMERS BECAUSE OF MEMORY ALIGNMENT CONCERNS.
-		 * On MacOs, we got some crashes with uint128 that were not aligned on 16 bytes
-		 */
-		if (_bankIdMatrix)
-		{
-			
-			for (size_t xx=0; xx< (KX+1); xx++)
-			{
-				for (int ii=0; ii< 256; ii++)
-				{
-					size_t nbKmers = this->_pInfo.getNbKmer(this->_parti_num,ii,xx);
-					_bankIdMatrix [IX(xx,ii)] = (bank::BankIdType*) this->_pool.pool_malloc (nbKmers * sizeof(bank::BankIdType), "bank ids alloc");
-				}
-			}
-		}
-	}
-	
-	DEBUG (("PartitionsByVectorCommand<span>::executeRead:  fillsolid parti num %i  by vector  nb kxmer / nbkmers      %lli / %lli     %f   with %zu nbcores \n",
-			this->_parti_num, sum_nbxmer, this->_pInfo.getNbKmer(this->_parti_num),
-			(double) sum_nbxmer /  this->_pInfo.getNbKmer(this->_parti_num),this->_nbCores
-));
-	
-	/** HOW TO COUNT KMERS BY SET OF READS ?
-	 * Now, we are going to read the temporary partition built during the previous phase and fill
-	 * the _radix_kmers attribute. We also need to know in _radix_kmers what is the contribution of
-	 * each bank. We therefore need to iterate the current partition by bank (using the information
-	 * of _offsets). */
-	
-	if (_bankIdMatrix)
-	{
-		/** We create an iterator over all the items. */
-		Iterator<Type>* itGlobal = this->_partition.iterator();
-		LOCAL (itGlobal);
-		
-		/** We iterate the banks. */
-		for (size_t b=0; b<_nbItemsPerBankPerPart.size(); b++)
-		{
-			/** We truncate the global iterator.
-			 * NB : we initialize (ie call 'first') the global iterator only at first call (for b==0). */
-			Iterator<Type>* itLocal = new TruncateIterator<Type> (*itGlobal, _nbItemsPerBankPerPart[b], b==0 ? true : false);
-			LOCAL (itLocal);
-			
-			/** We iterate this local iterator. */
-			_dispatcher->iterate (itLocal, SuperKReader<span>  (this->_kmerSize, _r_idx, _radix_kmers, _radix_sizes, _bankIdMatrix, b), 10000); //must be even , reading by pairs
-		}
-		
-		/** We check that the global iterator is finished. */
-		if (itGlobal->isDone() == false)  { throw Exception ("PartitionsByVectorCommand: iteration should be finished"); }
-	}
-	else
-	{
-		/** We iterate the superkmers. */
-
-			_dispatcher->iterate (this->_partition.iterator(), SuperKReader<span>  (this->_kmerSize, _r_idx, _radix_kmers, _radix_sizes, 0, 0), 10000); //must be even , reading by pairs
-		
-		
-		
-		//		printf("-----done ReadSuperKCommand ---\n");
-		
-	}
-	
-
-	
-}
-
-template<size_t span>
-void PartitionsByVectorCommand_multibank<span>::executeSort ()
-{
-	TIME_INFO (this->_timeInfo, "2.sort");
-	
-	vector<ICommand*> cmds;
-	
-	int nwork = 256 / this->_nbCores;
-	
-	for (size_t xx=0; xx < (KX+1); xx++)
-	{
-		cmds.clear();
-		
-		//fill cmd work vector
-		for (size_t tid=0; tid < this->_nbCores; tid++)
-		{
-			int deb = 0 + tid * nwork;
-			int fin = (tid+1) * nwork -1; // thread will do inclusive range [begin -- end ]
-			if(tid == this->_nbCores-1)  { fin = 255; }
-			
-			// mettre dans le  SortCommand le master radix_kmers et range a traiter
-			cmds.push_back (new SortCommand<span> (
-			_radix_kmers+ IX(xx,0),
-			(_bankIdMatrix ? _bankIdMatrix+ IX(xx,0) : 0),
-			deb, fin,
-			_radix_sizes + IX(xx,0)
-												   ));
-		}
-		
-		_dispatcher->dispatchCommands (cmds, 0);
-	}
-}
-
-template<size_t span>
-void PartitionsByVectorCommand_multibank<span>::executeDump ()
-{
-	TIME_INFO (this->_timeInfo, "3.dump");
-	
-	int nbkxpointers = 453; //6 for k1 mer, 27 for k2mer, 112 for k3mer  453 for k4mer
-	vector< KxmerPointer<span>*> vec_pointer (nbkxpointers);
-	int best_p;
-	
-	std::priority_queue< kxp, std::vector<kxp>,kxpcomp > pq;
-	
-	size_t nbBanks = _nbItemsPerBankPerPart.size();
-	if (nbBanks == 0) nbBanks = 1;
-	
-	CounterBuilder solidCounter (nbBanks);
-	
-	Type previous_kmer ;
-	
-	//init the pointers to the 6 arrays
-	int pidx =0;
-	
-	////////////////////////////////////////////////
-	////-------------k0 pointers-----------/////////
-	////////////////////////////////////////////////
-	
-	vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(0,0) ,0,0,0,255,this->_kmerSize, _radix_sizes + IX(0,0), _bankIdMatrix); // vec, prefix size, kxsize , radix min, radix max ,ksize
-	
-	////////////////////////////////////////////////
-	////-------------k1 pointers-----------/////////
-	////////////////////////////////////////////////
-	
-	//prefix0
-	vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(1,0) ,0,1,0,255,this->_kmerSize, _radix_sizes + IX(1, 0), _bankIdMatrix);
-	int lowr = 0;
-	int maxr = 63;
-	
-	//prefix1
-	for(unsigned int ii=0; ii<4; ii++)
-	{
-		vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(1,0) ,1,1,lowr,maxr,this->_kmerSize, _radix_sizes + IX(1, 0), _bankIdMatrix);
-		lowr += 64;
-		maxr += 64;
-	}
-	
-	////////////////////////////////////////////////
-	////-------------k2 pointers-----------/////////
-	////////////////////////////////////////////////
-	
-	//prefix0
-	vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(2,0),0,2,0,255,this->_kmerSize, _radix_sizes + IX(2, 0), _bankIdMatrix);
-	
-	//prefix1
-	lowr = 0; maxr = 63;
-	for(unsigned int ii=0; ii<4; ii++)
-	{
-		vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(2,0),1,2,lowr,maxr,this->_kmerSize, _radix_sizes + IX(2, 0), _bankIdMatrix);
-		lowr += 64;
-		maxr += 64;
-	}
-	
-	//prefix2
-	lowr = 0; maxr = 15;
-	for(unsigned int ii=0; ii<16; ii++)
-	{
-		vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(2,0),2,2,lowr,maxr,this->_kmerSize, _radix_sizes + IX(2, 0), _bankIdMatrix);
-		lowr += 16;
-		maxr += 16;
-	}
-	
-	////////////////////////////////////////////////
-	////-------------k3 pointers-----------/////////
-	////////////////////////////////////////////////
-	
-	//prefix0
-	vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(3,0),0,3,0,255,this->_kmerSize, _radix_sizes + IX(3, 0), _bankIdMatrix);
-	
-	//prefix1
-	lowr = 0; maxr = 63;
-	for(unsigned int ii=0; ii<4; ii++)
-	{
-		vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(3,0),1,3,lowr,maxr,this->_kmerSize, _radix_sizes + IX(3, 0), _bankIdMatrix);
-		lowr += 64;
-		maxr += 64;
-	}
-	
-	//prefix2
-	lowr = 0; maxr = 15;
-	for(unsigned int ii=0; ii<16; ii++)
-	{
-		vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(3,0),2,3,lowr,maxr,this->_kmerSize, _radix_sizes + IX(3, 0), _bankIdMatrix);
-		lowr += 16;
-		maxr += 16;
-	}
-	
-	//prefix3
-	lowr = 0; maxr = 3;
-	for(unsigned int ii=0; ii<64; ii++)
-	{
-		vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(3,0),3,3,lowr,maxr,this->_kmerSize, _radix_sizes + IX(3, 0), _bankIdMatrix);
-		lowr += 4;
-		maxr += 4;
-	}
-	
-	////////////////////////////////////////////////
-	////-------------k4 pointers-----------/////////
-	////////////////////////////////////////////////
-	
-	//prefix0
-	vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(4,0),0,4,0,255,this->_kmerSize, _radix_sizes + IX(4, 0), _bankIdMatrix);
-	
-	//prefix1
-	lowr = 0; maxr = 63;
-	for(unsigned int ii=0; ii<4; ii++)
-	{
-		vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(4,0),1,4,lowr,maxr,this->_kmerSize, _radix_sizes + IX(4, 0), _bankIdMatrix);
-		lowr += 64;
-		maxr += 64;
-	}
-	
-	//prefix2
-	lowr = 0; maxr = 15;
-	for(unsigned int ii=0; ii<16; ii++)
-	{
-		vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(4,0),2,4,lowr,maxr,this->_kmerSize, _radix_sizes + IX(4, 0), _bankIdMatrix);
-		lowr += 16;
-		maxr += 16;
-	}
-	
-	//prefix3
-	lowr = 0; maxr = 3;
-	for(unsigned int ii=0; ii<64; ii++)
-	{
-		vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(4,0),3,4,lowr,maxr,this->_kmerSize, _radix_sizes + IX(4, 0), _bankIdMatrix);
-		lowr += 4;
-		maxr += 4;
-	}
-	
-	//prefix4
-	lowr = 0; maxr = 0;
-	for(unsigned int ii=0; ii<256; ii++)
-	{
-		vec_pointer[pidx++] = new KxmerPointer<span> (_radix_kmers+ IX(4,0),4,4,lowr,maxr,this->_kmerSize, _radix_sizes + IX(4, 0), _bankIdMatrix);
-		lowr += 1;
-		maxr += 1;
-	}
-	
-	//fill the  priority queue with the first elems
-	for (int ii=0; ii<nbkxpointers; ii++)
-	{
-		if(vec_pointer[ii]->next())  {  pq.push(kxp(ii,vec_pointer[ii]->value()));  }
-	}
-	
-	if (pq.size() != 0) // everything empty, no kmer at all
-	{
-		//get first pointer
-		best_p = pq.top().first ; pq.pop();
-		
-		previous_kmer = vec_pointer[best_p]->value();
-		
-		solidCounter.init (vec_pointer[best_p]->getBankId());
-		
-		//merge-scan all 'virtual' arrays and output counts
-		while (1)
-		{
-			//go forward in this array or in new array if reaches end of this one
-			if (! vec_pointer[best_p]->next())
-			{
-				//reaches end of one array
-				if(pq.size() == 0) break; //everything done
-				
-				//otherwise get new best
-				best_p = pq.top().first ; pq.pop();
-			}
-			
-			if (vec_pointer[best_p]->value() != previous_kmer )
-			{
-				//if diff, changes to new array, get new min pointer
-				pq.push(kxp(best_p,vec_pointer[best_p]->value())); //push new val of this pointer in pq, will be counted later
-				
-				best_p = pq.top().first ; pq.pop();
-				
-				//if new best is diff, this is the end of this kmer
-				if(vec_pointer[best_p]->value()!=previous_kmer )
-				{
-					this->insert (previous_kmer, solidCounter);
-					
-					solidCounter.init (vec_pointer[best_p]->getBankId());
-					previous_kmer = vec_pointer[best_p]->value();
-				}
-				else
-				{
-					solidCounter.increase (vec_pointer[best_p]->getBankId());
-				}
-			}
-			else
-			{
-				solidCounter.increase (vec_pointer[best_p]->getBankId());
-			}
-		}
-		
-		//last elem
-		this->insert (previous_kmer, solidCounter);
-	}
-	
-	/** Cleanup. */
-	for (int ii=0; ii<nbkxpointers; ii++)  {  delete vec_pointer[ii];  }
-}
-	
-	
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
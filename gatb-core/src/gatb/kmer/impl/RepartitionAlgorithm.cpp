@@ -90,6 +90,19 @@ static const char* progressFormat0 = "DSK: Collecting stats on %s ";
 
 /********************************************************************************/
 
+/* Settings of the minimizers frequency sampling (see RepartitorAlgorithm::computeFrequencies). */
+
+/** Maximal number of sampling rounds; a round takes a slice of each file of the bank. */
+static const size_t   FREQ_MAX_ROUNDS       = 100;
+
+/** Minimal number of sequences of a sampling round. */
+static const u_int64_t FREQ_MIN_ROUND_SIZE  = 10000;
+
+/** The sampling stops when a round moves the mmers distribution by less than this L1 distance. */
+static const double   FREQ_CONVERGENCE      = 0.01;
+
+/** Counts the mmers of the sequences; the counts are shared by the clones of the functor, ie. by
+ * all the threads of the dispatcher, and are atomically incremented. */
 template<size_t span>
 class MmersFrequency
 {
@@ -97,11 +110,11 @@ public:
     /** Shortcut. */
     typedef typename RepartitorAlgorithm<span>::ModelCanonical ModelCanonical;
     typedef typename ModelCanonical::Kmer                       KmerTypeCanonical;
-    typedef typename RepartitorAlgorithm<span>::ModelDirect    ModelDirect;
-    typedef typename ModelDirect::Kmer                       KmerTypeDirect;
 
     void operator() (Sequence& sequence)
     {
+        _nbLocalSeqs ++;
+
         /** We first check whether we got mmers from the sequence or not. */
         if (_minimodel.build (sequence.getData(), _mmers) == false)  { return; }
 
@@ -112,44 +125,24 @@ public:
                 continue;
 
             /** increment m-mer count */
-            _m_mer_counts[_mmers[i].value().getVal()] ++;
-        }
-
-        if (_nbProcessedMmers > 500000)   {  _progress.inc (_nbProcessedMmers);  _nbProcessedMmers = 0;  }
-
-        // see if we need to stop. 
-        // mimics SampleRepart below. but actually, as TruncatedIterator would have worked too, since all seqs are at least larger than a mmer. oh well. using CancellableIterator anyway.
-        _nbSeqsSeenSoFar ++;
-        if (_nbSeqsSeenSoFar > _nbSeqsToSee)
-        {
-            *_cancelIterator = true;
+            __sync_fetch_and_add (&_m_mer_counts[_mmers[i].value().getVal()], 1);
         }
-
     }
 
     /** Constructor. */
-    MmersFrequency (int mmerSize,  IteratorListener* progress,  uint32_t* m_mer_counts, size_t nbSeqsToSee /* for when to stop estimation*/, bool* cancelIterator)
-    :
-        _minimodel(mmerSize), _progress (progress,System::thread().newSynchronizer()),
-      _m_mer_counts(m_mer_counts),  _nbProcessedMmers(0), _nbSeqsToSee(nbSeqsToSee), _nbSeqsSeenSoFar(0), _cancelIterator(cancelIterator)
-    {
-        u_int64_t nbminim = (uint64_t)pow(4.0,mmerSize);
+    MmersFrequency (int mmerSize, uint32_t* m_mer_counts, u_int64_t* nbSeqs)
+        : _minimodel(mmerSize), _m_mer_counts(m_mer_counts), _nbSeqs(nbSeqs), _nbLocalSeqs(0)  {}
 
-        for (u_int64_t i = 0; i < nbminim; i++)  {   _m_mer_counts[i] = 0;  }
-    }
+    /** Destructor. */
+    ~MmersFrequency ()  {  __sync_fetch_and_add (_nbSeqs, _nbLocalSeqs);  }
 
 protected:
 
     ModelCanonical           _minimodel;
-    //ModelDirect                _minimodel;
     vector<KmerTypeCanonical>  _mmers;
-    //vector<KmerTypeDirect>  _mmers;
-    ProgressSynchro         _progress;
     uint32_t*               _m_mer_counts;
-    size_t                  _nbProcessedMmers;
-    size_t        _nbSeqsToSee;
-    size_t        _nbSeqsSeenSoFar;
-    bool *            _cancelIterator;
+    u_int64_t*              _nbSeqs;
+    u_int64_t               _nbLocalSeqs;
 };
 
 /********************************************************************************/
@@ -329,8 +322,8 @@ void RepartitorAlgorithm<span>::computeFrequencies (Repartitor& repartitor)
 
     _bank->estimate (estimateSeqNb, estimateSeqTotalSize, estimateSeqMaxSize);
 
+    /** Maximal number of sequences to be sampled; we usually stop before, when the frequencies are stable. */
     u_int64_t nbseq_sample = std::min ( u_int64_t (estimateSeqNb * 0.05) ,u_int64_t( 50000000ULL) ) ;
-    // TODO would be better to just stop estimating minimizer frequency when it becomes stable. not after a fixed number of reads
 
     if (nbseq_sample == 0)
         nbseq_sample = 1;
@@ -338,34 +331,92 @@ void RepartitorAlgorithm<span>::computeFrequencies (Repartitor& repartitor)
     u_int64_t rg = ((u_int64_t)1 << (2*_config._minim_size));
     //cout << "\nAllocating " << ((rg*sizeof(uint32_t))/1024) << " KB for " << _minim_size <<"-mers frequency counting (" << rg << " elements total)" << endl;
     uint32_t *m_mer_counts = new uint32_t[rg];
+    vector<uint32_t> previous_counts (rg, 0);
+    for (u_int64_t i = 0; i < rg; i++)  {   m_mer_counts[i] = 0;  }
+
+    /** The sample is stratified over the files of the bank: each sampling round takes from each file
+     * a slice proportional to its estimated number of sequences. Otherwise, sampling only the head
+     * of the bank would give the frequencies of the first file (first lane, first sample...). */
+    Iterator<Sequence>* it = _bank->iterator();
+    LOCAL(it);
+    std::vector<Iterator<Sequence>*> strata = it->getComposition();
+
+    vector<u_int64_t> weights (strata.size(), 1);
+    u_int64_t totalWeight = 0;
+    if (strata.size() > 1)
+    {
+        for (size_t i=0; i<strata.size(); i++)  {  weights[i] = std::max (_bank->estimateNbItemsBanki(i), (int64_t)1);  }
+    }
+    for (size_t i=0; i<strata.size(); i++)  { totalWeight += weights[i]; }
 
-    Model model (_config._kmerSize, _config._minim_size);
+    u_int64_t roundSize = std::max (nbseq_sample / FREQ_MAX_ROUNDS, FREQ_MIN_ROUND_SIZE);
 
-    Iterator<Sequence>* bank_it = _bank->iterator();
-    LOCAL(bank_it);
-    CancellableIterator<Sequence>* cancellable_it = new CancellableIterator<Sequence> (*bank_it);
-    LOCAL(cancellable_it);
+    IteratorListener* progress = createIteratorListener (nbseq_sample, "Approximating frequencies of minimizers");
+    LOCAL (progress);
+    progress->init ();
 
-    /** We create a sequence iterator and give it a progress message */
-    Iterator<Sequence>* it_all_reads = createIterator<Sequence> (
-            cancellable_it,
-            _bank->getNbItems(),
-             "Approximating frequencies of minimizers"
-            );
-    LOCAL (it_all_reads);
+    vector<bool> exhausted (strata.size(), false);
+    u_int64_t    nbSeqs     = 0;
+    u_int64_t    nbMmers    = 0;
+    size_t       nbRounds   = 0;
+    double       distance   = 1.0;
+    bool         converged  = false;
 
     /** We compute an estimation of minimizers frequencies from a part of the bank. */
-    
-    SerialDispatcher serialDispatcher;
-    serialDispatcher.iterate (it_all_reads,  MmersFrequency<span> (
-        _config._minim_size, 0 /*_progress*/, m_mer_counts, 
-        nbseq_sample,
-        &(cancellable_it->_cancel))// will be set to true when iteration needs to be stopped
-    );
-
-    // single threaded, for debugging
-    /*MmersFrequency<span> mmersfrequency(model, _progress, bstatsDummy, m_mer_counts);
-    it_sample->iterate(mmersfrequency);*/
+    for (nbRounds=0; nbSeqs < nbseq_sample && !converged; nbRounds++)
+    {
+        u_int64_t nbSeqsRound = 0;
+
+        for (size_t i=0; i<strata.size(); i++)
+        {
+            if (exhausted[i])  { continue; }
+
+            /** The slice of the file starts where the previous round stopped. */
+            u_int64_t sliceSize = std::max (roundSize * weights[i] / totalWeight, (u_int64_t)1);
+            Iterator<Sequence>* slice = new TruncateIterator<Sequence> (*strata[i], sliceSize, nbRounds==0);
+            LOCAL (slice);
+
+            u_int64_t nbSeqsSlice = 0;
+            getDispatcher()->iterate (slice, MmersFrequency<span> (_config._minim_size, m_mer_counts, &nbSeqsSlice));
+
+            if (nbSeqsSlice < sliceSize || strata[i]->isDone())  {  exhausted[i] = true;  }
+            nbSeqsRound += nbSeqsSlice;
+        }
+
+        nbSeqs += nbSeqsRound;
+        progress->inc (nbSeqsRound);
+
+        if (nbSeqsRound == 0)  { break; }
+
+        /** We check how much this round moved the (normalized) mmers distribution. */
+        u_int64_t nbMmersRound = 0;
+        for (u_int64_t i = 0; i < rg; i++)  {  nbMmersRound += m_mer_counts[i];  }
+
+        if (nbMmers > 0 && nbMmersRound > nbMmers)
+        {
+            distance = 0;
+            for (u_int64_t i = 0; i < rg; i++)
+            {
+                distance += fabs ((double)m_mer_counts[i] / nbMmersRound - (double)previous_counts[i] / nbMmers);
+            }
+            converged = distance < FREQ_CONVERGENCE;
+        }
+
+        nbMmers = nbMmersRound;
+        for (u_int64_t i = 0; i < rg; i++)  {  previous_counts[i] = m_mer_counts[i];  }
+    }
+
+    progress->finish ();
+
+    for (size_t i=0; i<strata.size(); i++)  {  strata[i]->finalize();  }
+
+    getInfo()->add (1, "frequencies");
+    getInfo()->add (2, "nb_files",        "%ld",  strata.size());
+    getInfo()->add (2, "nb_seqs_max",     "%lld", nbseq_sample);
+    getInfo()->add (2, "nb_seqs_sampled", "%lld", nbSeqs);
+    getInfo()->add (2, "nb_rounds",       "%ld",  nbRounds);
+    getInfo()->add (2, "last_distance",   "%.4f", distance);
+    getInfo()->add (2, "converged",       "%d",   converged);
 
     /* sort frequencies */
     for (u_int64_t i(0); i < rg; i++)
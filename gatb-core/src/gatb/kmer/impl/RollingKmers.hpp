@@ -0,0 +1,176 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file RollingKmers.hpp
+ *  \brief Computation of all the kmers of a packed sequence
+ */
+
+#ifndef _GATB_CORE_KMER_IMPL_ROLLING_KMERS_HPP_
+#define _GATB_CORE_KMER_IMPL_ROLLING_KMERS_HPP_
+
+/********************************************************************************/
+
+#include <gatb/kmer/impl/Model.hpp>
+#include <gatb/tools/misc/impl/NucleotideEncoder.hpp>
+
+#include <vector>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Rolling computation of the kmers of a sequence encoded by PackedNucleotides
+ *
+ * All the kmers of the sequence are computed in one loop over the packed codes (4 nucleotides
+ * per byte read), the validity of the kmers being computed from the mask of the invalid
+ * nucleotides instead of being tested for each nucleotide. The kmers values are the same as
+ * the ones of ModelDirect (forward) and ModelCanonical (canonical).
+ *
+ * For span up to 64, Type is LargeInt<1> or LargeInt<2>, ie. a native 64 or 128 bits integer,
+ * so the rolling is done with native shifts.
+ *
+ * Sample of use:
+ * \code
+ * PackedNucleotides packed;
+ * packed.encode (seq, strlen(seq));
+ * RollingKmers<32> rolling (31);
+ * std::vector<RollingKmers<32>::Type> kmers;
+ * std::vector<u_int64_t> invalid;
+ * size_t nb = rolling.canonical (packed, kmers, invalid);
+ * \endcode
+ */
+template<size_t span> class RollingKmers
+{
+public:
+
+    /** Type of the kmers values. */
+    typedef typename Kmer<span>::Type Type;
+
+    /** Constructor.
+     * \param[in] kmerSize : size of the kmers */
+    RollingKmers (size_t kmerSize) : _kmerSize(kmerSize)
+    {
+        if (kmerSize == 0 || kmerSize >= span)  { throw system::Exception ("RollingKmers: bad kmer size %d for span %d", kmerSize, span); }
+
+        Type one;  one.setVal (1);
+        _mask = (one << (2*_kmerSize)) - 1;
+
+        /** The complement of code c is c^2 (A=0 <-> T=2, C=1 <-> G=3). */
+        for (u_int64_t c=0; c<4; c++)
+        {
+            Type comp;  comp.setVal (c^2);
+            _revcompTable[c] = comp << (2*(_kmerSize-1));
+        }
+    }
+
+    /** Get the kmer size.
+     * \return the kmer size. */
+    size_t getKmerSize () const  { return _kmerSize; }
+
+    /** Compute the forward kmers of a sequence.
+     * \param[in] seq : the sequence
+     * \param[out] kmers : the kmers, resized to the number of kmers
+     * \param[out] invalid : bit i%64 of word i/64 is set if kmer i holds an invalid nucleotide
+     * \return the number of kmers. */
+    size_t forward (const tools::misc::impl::PackedNucleotides& seq, std::vector<Type>& kmers, std::vector<u_int64_t>& invalid) const
+    {
+        return roll<false> (seq, kmers, invalid);
+    }
+
+    /** Compute the canonical kmers of a sequence.
+     * \param[in] seq : the sequence
+     * \param[out] kmers : the kmers, resized to the number of kmers
+     * \param[out] invalid : bit i%64 of word i/64 is set if kmer i holds an invalid nucleotide
+     * \return the number of kmers. */
+    size_t canonical (const tools::misc::impl::PackedNucleotides& seq, std::vector<Type>& kmers, std::vector<u_int64_t>& invalid) const
+    {
+        return roll<true> (seq, kmers, invalid);
+    }
+
+private:
+
+    size_t _kmerSize;
+    Type   _mask;
+    Type   _revcompTable[4];
+
+    template<bool isCanonical>
+    size_t roll (const tools::misc::impl::PackedNucleotides& seq, std::vector<Type>& kmers, std::vector<u_int64_t>& invalid) const
+    {
+        size_t length = seq.size();
+
+        if (length < _kmerSize)  {  kmers.clear();  invalid.clear();  return 0;  }
+
+        size_t nbKmers = length - _kmerSize + 1;
+
+        kmers.resize (nbKmers);
+        invalid.assign ((nbKmers+63)/64, 0);
+
+        /** We use local copies so that the compiler can keep them in registers (the kmers stores may alias the attributes). */
+        const u_int8_t* codes    = (const u_int8_t*) seq.getCodes();
+        const size_t    kmerSize = _kmerSize;
+        const Type      mask     = _mask;
+        const Type      revcomp[4] = { _revcompTable[0], _revcompTable[1], _revcompTable[2], _revcompTable[3] };
+        Type*           out      = kmers.data();
+
+        Type fwd;  fwd.setVal (0);
+        Type rev;  rev.setVal (0);
+
+        /** We first read the kmerSize-1 nucleotides preceding the first kmer, then each nucleotide gives a kmer. */
+        for (size_t n=0; n+1<kmerSize; n++)
+        {
+            u_int64_t c = (codes[n>>2] >> ((3-(n&3))*2)) & 3;
+
+            fwd = ((fwd << 2) + c) & mask;
+            if (isCanonical)  {  rev = ((rev >> 2) + revcomp[c]) & mask;  }
+        }
+
+        for (size_t n=kmerSize-1, k=0; n<length; n++, k++)
+        {
+            u_int64_t c = (codes[n>>2] >> ((3-(n&3))*2)) & 3;
+
+            fwd = ((fwd << 2) + c) & mask;
+            if (isCanonical)  {  rev = ((rev >> 2) + revcomp[c]) & mask;  out[k] = rev < fwd ? rev : fwd;  }
+            else              {  out[k] = fwd;  }
+        }
+
+        /** The invalid nucleotides are rare: each one invalidates the kmers [p-kmerSize+1, p] holding it. */
+        const u_int64_t* bad = seq.getInvalidMask();
+        for (size_t w=0; w<(length+63)/64; w++)
+        {
+            for (u_int64_t bits = bad[w]; bits != 0; bits &= bits-1)
+            {
+                size_t p    = 64*w + __builtin_ctzll (bits);
+                size_t from = p+1 >= kmerSize ? p+1-kmerSize : 0;
+                size_t to   = std::min (p, nbKmers-1);
+                for (size_t k=from; k<=to; k++)  {  invalid[k/64] |= ((u_int64_t)1) << (k%64);  }
+            }
+        }
+
+        return nbKmers;
+    }
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_KMER_IMPL_ROLLING_KMERS_HPP_ */
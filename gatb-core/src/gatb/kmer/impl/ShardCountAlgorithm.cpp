@@ -0,0 +1,200 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/kmer/impl/ShardCountAlgorithm.hpp>
+#include <gatb/kmer/impl/SortingCountAlgorithm.hpp>
+#include <gatb/kmer/impl/ConfigurationAlgorithm.hpp>
+#include <gatb/kmer/impl/RepartitionAlgorithm.hpp>
+#include <gatb/kmer/impl/CountProcessorDump.hpp>
+
+#include <gatb/bank/impl/BankShard.hpp>
+
+#include <gatb/tools/misc/impl/Stringify.hpp>
+
+using namespace std;
+
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+using namespace gatb::core::bank;
+using namespace gatb::core::bank::impl;
+
+using namespace gatb::core::tools::misc;
+using namespace gatb::core::tools::misc::impl;
+
+using namespace gatb::core::tools::storage::impl;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb  {  namespace core  {   namespace kmer  {   namespace impl {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+void ShardCountAlgorithm<span>::prepare (IBank* bank, Storage& shared, IProperties* params)
+{
+    LOCAL (bank);
+
+    ConfigurationAlgorithm<span> configAlgo (bank, params);
+    configAlgo.execute();
+    Configuration config = configAlgo.getConfiguration();
+
+    shared.getGroup(configAlgo.getName()).setProperty ("xml", string("\n") + configAlgo.getInfo()->getXML());
+
+    RepartitorAlgorithm<span> repart (
+        bank,
+        shared("minimizers"),
+        config,
+        params->get(STR_NB_CORES) ? params->getInt(STR_NB_CORES) : 0
+    );
+    repart.execute();
+
+    shared.root().setProperty ("kmer_size", Stringify::format("%d", config._kmerSize));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+Configuration ShardCountAlgorithm<span>::getConfiguration (IBank* bank, Repartitor& repartitor, IProperties* params)
+{
+    params->setInt (STR_MINIMIZER_SIZE, repartitor.getMinimizerSize());
+
+    ConfigurationAlgorithm<span> configAlgo (bank, params);
+    configAlgo.execute();
+    Configuration config = configAlgo.getConfiguration();
+
+    /** The partitioning is the one of the repartition, not the one computed for this bank. */
+    size_t nbPartitions = config._nb_partitions;
+
+    config._nb_partitions = repartitor.getNbPartitions();
+    config._nb_passes     = repartitor.getNbPasses();
+    config._minim_size    = repartitor.getMinimizerSize();
+    config._minimizerType = repartitor.getMinimizerFrequencies() != 0 ? 1 : 0;
+
+    /** With more partitions, we cache fewer items per partition to keep the same memory usage. */
+    while (config._nb_cached_items_per_core_per_part > 256 && config._nb_partitions > nbPartitions)
+    {
+        config._nb_cached_items_per_core_per_part /= 2;
+        nbPartitions *= 2;
+    }
+
+    return config;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+ShardCountAlgorithm<span>::ShardCountAlgorithm (
+    IBank*       bank,
+    Storage&     shared,
+    Storage&     storage,
+    size_t       nbShards,
+    size_t       shardIndex,
+    IProperties* params,
+    size_t       blockSize
+)
+    : Algorithm("shard", -1, params), _bank(0), _shared(shared), _storage(storage), _nbShards(nbShards), _shardIndex(shardIndex), _blockSize(blockSize)
+{
+    setBank (bank);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+ShardCountAlgorithm<span>::~ShardCountAlgorithm ()
+{
+    setBank (0);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+void ShardCountAlgorithm<span>::execute ()
+{
+    string kmerSize = _shared.root().getProperty ("kmer_size");
+    if (kmerSize.empty())  { throw Exception ("ShardCountAlgorithm: the shared storage has not been prepared"); }
+
+    getInput()->setInt (STR_KMER_SIZE, atoi (kmerSize.c_str()));
+
+    IBank* shard = new BankShard (_bank, _nbShards, _shardIndex, _blockSize);
+    LOCAL (shard);
+
+    /** All the shards use the shared repartition and configuration. */
+    Repartitor repartitor (_shared("minimizers"));
+    repartitor.save (_storage("minimizers"));
+
+    _storage("configuration").setProperty ("xml", _shared("configuration").getProperty ("xml"));
+
+    Configuration config = getConfiguration (shard, repartitor, getInput());
+
+    /** All the kmers are kept: the solidity is known only once the shards are merged. */
+    Group& dskGroup = _storage("dsk");
+
+    vector<ICountProcessor<span>*> processors;
+    processors.push_back (new CountProcessorDump<span> (dskGroup, config._kmerSize));
+
+    SortingCountAlgorithm<span> sortingCount (shard, config, new Repartitor (_storage("minimizers")), processors, getInput());
+    sortingCount.execute();
+
+    dskGroup.setProperty ("xml", string("\n") + sortingCount.getInfo()->getXML());
+
+    /** We gather some statistics. */
+    getInfo()->add (1, "shard");
+    getInfo()->add (2, "nb_shards",   "%ld", _nbShards);
+    getInfo()->add (2, "shard_index", "%ld", _shardIndex);
+    getInfo()->add (2, "block_size",  "%ld", _blockSize);
+    getInfo()->add (2, "nb_kmers",    "%ld", dskGroup.getPartition<typename Kmer<span>::Count> ("solid").getNbItems());
+    getInfo()->add (1, sortingCount.getInfo());
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,125 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file ShardCountAlgorithm.hpp
+ *  \brief Counting of the kmers of one slice (shard) of the reads
+ */
+
+#ifndef _SHARD_COUNT_ALGORITHM_HPP_
+#define _SHARD_COUNT_ALGORITHM_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/misc/impl/Algorithm.hpp>
+
+#include <gatb/bank/api/IBank.hpp>
+#include <gatb/kmer/impl/Model.hpp>
+#include <gatb/kmer/impl/Configuration.hpp>
+#include <gatb/kmer/impl/PartiInfo.hpp>
+#include <gatb/tools/storage/impl/Storage.hpp>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Kmers counting of one shard of the reads
+ *
+ * The kmers counting can be split over N independent processes (possibly on different hosts):
+ *  1) 'prepare' computes once the configuration and the minimizers repartition of the whole reads
+ *     set and saves them in a shared storage
+ *  2) each process 'i' counts, with this algorithm, the kmers of shard 'i' of the reads (see BankShard)
+ *     with the shared repartition, so all the shards have the same partitioning. All the counted
+ *     kmers are kept, whatever their abundance.
+ *  3) ShardMergeAlgorithm merges the partitions of the shards into the solid kmers.
+ *
+ * Sample of use:
+ * \code
+ * // once
+ * ShardCountAlgorithm<>::prepare (bank, *shared, props);
+ * // by process 'i'
+ * ShardCountAlgorithm<> shard (bank, *shared, *storage, nbShards, i, props);
+ * shard.execute();
+ * \endcode
+ */
+template<size_t span=KMER_DEFAULT_SPAN>
+class ShardCountAlgorithm : public gatb::core::tools::misc::impl::Algorithm
+{
+public:
+
+    /** Shortcuts. */
+    typedef typename kmer::impl::Kmer<span>::Count Count;
+
+    /** Compute the configuration and the minimizers repartition shared by all the shards.
+     * \param[in] bank : the whole reads set
+     * \param[in] shared : storage where the configuration and the repartition are saved
+     * \param[in] params : kmers counting parameters (kmer size, minimizer type...) */
+    static void prepare (bank::IBank* bank, tools::storage::impl::Storage& shared, tools::misc::IProperties* params);
+
+    /** Compute a counting configuration of a bank that complies with an existing repartition.
+     * \param[in] bank : the bank to be counted
+     * \param[in] repartitor : the minimizers repartition to be used
+     * \param[in] params : kmers counting parameters
+     * \return the configuration. */
+    static Configuration getConfiguration (bank::IBank* bank, Repartitor& repartitor, tools::misc::IProperties* params);
+
+    /** Constructor.
+     * \param[in] bank : the whole reads set
+     * \param[in] shared : storage filled by 'prepare'
+     * \param[in] storage : storage where the kmers counts of the shard are written
+     * \param[in] nbShards : number of shards
+     * \param[in] shardIndex : index of the shard to be counted
+     * \param[in] params : kmers counting parameters
+     * \param[in] blockSize : number of consecutive reads dealt to a shard at once (see BankShard) */
+    ShardCountAlgorithm (
+        bank::IBank*                   bank,
+        tools::storage::impl::Storage& shared,
+        tools::storage::impl::Storage& storage,
+        size_t                         nbShards,
+        size_t                         shardIndex,
+        tools::misc::IProperties*      params,
+        size_t                         blockSize = 1024
+    );
+
+    /** Destructor. */
+    ~ShardCountAlgorithm ();
+
+    /** \copydoc tools::misc::impl::Algorithm::execute */
+    void execute ();
+
+private:
+
+    bank::IBank* _bank;
+    void setBank (bank::IBank* bank)  { SP_SETATTR(bank); }
+
+    tools::storage::impl::Storage& _shared;
+    tools::storage::impl::Storage& _storage;
+
+    size_t _nbShards;
+    size_t _shardIndex;
+    size_t _blockSize;
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _SHARD_COUNT_ALGORITHM_HPP_ */
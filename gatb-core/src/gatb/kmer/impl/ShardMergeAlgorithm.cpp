@@ -0,0 +1,261 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/kmer/impl/ShardMergeAlgorithm.hpp>
+#include <gatb/kmer/impl/PartiInfo.hpp>
+
+#include <gatb/system/impl/System.hpp>
+
+#include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
+#include <gatb/tools/misc/impl/Stringify.hpp>
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+using namespace gatb::core::tools::dp;
+using namespace gatb::core::tools::dp::impl;
+
+using namespace gatb::core::tools::misc;
+using namespace gatb::core::tools::misc::impl;
+
+using namespace gatb::core::tools::collections;
+using namespace gatb::core::tools::collections::impl;
+
+using namespace gatb::core::tools::storage::impl;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb  {  namespace core  {   namespace kmer  {   namespace impl {
+/********************************************************************************/
+
+static const char* progressFormatMerge = "Merge shards                           ";
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+ShardMergeAlgorithm<span>::ShardMergeAlgorithm (
+    const std::vector<Storage*>& shards,
+    Storage&                     storage,
+    CountNumber                  abundanceMin,
+    CountNumber                  abundanceMax,
+    size_t                       nbCores,
+    IProperties*                 options
+)
+    : Algorithm("merge", nbCores, options),
+      _shards(shards), _storage(storage), _abundanceMin(abundanceMin), _abundanceMax(abundanceMax), _solidCounts(0)
+{
+    for (size_t i=0; i<_shards.size(); i++)  { _shards[i]->use(); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+ShardMergeAlgorithm<span>::~ShardMergeAlgorithm ()
+{
+    setSolidCounts (0);
+
+    for (size_t i=0; i<_shards.size(); i++)  { _shards[i]->forget(); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+u_int64_t ShardMergeAlgorithm<span>::merge (
+    const std::vector<Iterable<Count>*>& inputs,
+    Bag<Count>&                          output,
+    CountNumber                          abundanceMin,
+    CountNumber                          abundanceMax
+)
+{
+    struct Sort  {  bool operator() (const Count& a, const Count& b) const  { return a.value < b.value; }  };
+
+    vector<Count> items;
+    for (size_t i=0; i<inputs.size(); i++)
+    {
+        Iterator<Count>* it = inputs[i]->iterator();  LOCAL (it);
+        for (it->first(); !it->isDone(); it->next())  { items.push_back (it->item()); }
+    }
+
+    /** The counted partitions may have been filled from hash tables, so they are not necessarily sorted. */
+    std::sort (items.begin(), items.end(), Sort());
+
+    vector<Count> result;
+    for (size_t i=0, j=0; i<items.size(); i=j)
+    {
+        /** We sum the abundances of the kmer (saturated). */
+        int64_t sum = 0;
+        for (j=i; j<items.size() && items[j].value == items[i].value; j++)  { sum += items[j].abundance; }
+
+        CountNumber abundance = (CountNumber) std::min (sum, (int64_t) std::numeric_limits<CountNumber>::max());
+
+        if (abundance >= abundanceMin && abundance <= abundanceMax)  { result.push_back (Count (items[i].value, abundance)); }
+    }
+
+    if (!result.empty())  {  output.insert (result.data(), result.size());  }
+    output.flush();
+
+    return result.size();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : Merge of one partition of the shards.
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+struct MergeShardsCmd : public ICommand, public SmartPointer
+{
+    typedef typename kmer::impl::Kmer<span>::Count  Count;
+
+    vector<Iterable<Count>*> inputs;
+    Bag<Count>&              output;
+    CountNumber              abundanceMin;
+    CountNumber              abundanceMax;
+    u_int64_t&               nbSolid;
+
+    MergeShardsCmd (const vector<Iterable<Count>*>& inputs, Bag<Count>& output, CountNumber abundanceMin, CountNumber abundanceMax, u_int64_t& nbSolid)
+        : inputs(inputs), output(output), abundanceMin(abundanceMin), abundanceMax(abundanceMax), nbSolid(nbSolid)
+    {}
+
+    void execute ()  {  nbSolid = ShardMergeAlgorithm<span>::merge (inputs, output, abundanceMin, abundanceMax);  }
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<size_t span>
+void ShardMergeAlgorithm<span>::execute ()
+{
+    if (_shards.empty())  { throw Exception ("ShardMergeAlgorithm: no shard to merge"); }
+
+    /** We check that the shards have been counted with the same kmer size and partitioning. */
+    string kmerSize = (*_shards[0])("dsk").getProperty ("kmer_size");
+
+    vector<Partition<Count>*> shardCounts;
+    u_int64_t nbKmers = 0;
+
+    for (size_t i=0; i<_shards.size(); i++)
+    {
+        Group& dskGroup = (*_shards[i])("dsk");
+
+        if (dskGroup.getProperty ("kmer_size") != kmerSize)  { throw Exception ("ShardMergeAlgorithm: the shards have different kmer sizes"); }
+
+        shardCounts.push_back (& dskGroup.getPartition<Count> ("solid"));
+        nbKmers += shardCounts.back()->getNbItems();
+
+        if (shardCounts.back()->size() != shardCounts[0]->size())
+        {
+            throw Exception ("ShardMergeAlgorithm: the shards have different numbers of partitions (%d and %d)", shardCounts[0]->size(), shardCounts.back()->size());
+        }
+    }
+
+    size_t nbPartitions = shardCounts[0]->size();
+
+    /** The minimizers repartition and the configuration are the ones shared by the shards. */
+    Repartitor repartitor ((*_shards[0])("minimizers"));
+    repartitor.save (_storage("minimizers"));
+
+    _storage("configuration").setProperty ("xml", (*_shards[0])("configuration").getProperty ("xml"));
+
+    Group& dskGroup = _storage("dsk");
+    setSolidCounts (& dskGroup.getPartition<Count> ("solid", nbPartitions));
+
+    vector<u_int64_t> nbSolidPerPartition (nbPartitions, 0);
+    {
+        TIME_INFO (getTimeInfo(), "merge");
+
+        /** We create an iterator for progress information. */
+        Iterator<int>* itParts = createIterator (new Range<int>::Iterator (0,nbPartitions-1), nbPartitions, progressFormatMerge);
+        LOCAL (itParts);
+
+        size_t nbCoresMax = getDispatcher()->getExecutionUnitsNumber();
+
+        /** Each core merges one partition at a time. */
+        for (itParts->first (); !itParts->isDone(); )
+        {
+            vector<ICommand*> cmds;
+
+            for ( ; !itParts->isDone() && cmds.size() < nbCoresMax; itParts->next())
+            {
+                size_t p = itParts->item();
+
+                vector<Iterable<Count>*> inputs;
+                for (size_t i=0; i<shardCounts.size(); i++)  { inputs.push_back (& (*shardCounts[i])[p]); }
+
+                cmds.push_back (new MergeShardsCmd<span> (inputs, (*_solidCounts)[p], _abundanceMin, _abundanceMax, nbSolidPerPartition[p]));
+            }
+
+            getDispatcher()->dispatchCommands (cmds);
+        }
+    }
+
+    u_int64_t nbSolid = 0;
+    for (size_t p=0; p<nbPartitions; p++)  { nbSolid += nbSolidPerPartition[p]; }
+
+    dskGroup.addProperty ("kmer_size", kmerSize);
+
+    /** We gather some statistics. */
+    getInfo()->add (1, "merge");
+    getInfo()->add (2, "nb_shards",      "%ld", _shards.size());
+    getInfo()->add (2, "nb_partitions",  "%ld", nbPartitions);
+    getInfo()->add (2, "abundance_min",  "%d",  _abundanceMin);
+    getInfo()->add (2, "abundance_max",  "%d",  _abundanceMax);
+    getInfo()->add (2, "nb_shard_kmers", "%ld", nbKmers);
+    getInfo()->add (2, "nb_solid",       "%ld", nbSolid);
+    getInfo()->add (1, getTimeInfo().getProperties("time"));
+
+    dskGroup.setProperty ("xml", string("\n") + getInfo()->getXML());
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,120 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file ShardMergeAlgorithm.hpp
+ *  \brief Merge of the kmers counted by several shards into one solid kmers partition
+ */
+
+#ifndef _SHARD_MERGE_ALGORITHM_HPP_
+#define _SHARD_MERGE_ALGORITHM_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/misc/impl/Algorithm.hpp>
+
+#include <gatb/kmer/impl/Model.hpp>
+#include <gatb/tools/storage/impl/Storage.hpp>
+
+#include <vector>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Merge of the kmers counts of several shards
+ *
+ * Each shard (see ShardCountAlgorithm) holds the counts of all the kmers of its slice of the reads,
+ * partitioned with the same minimizers repartition. So a kmer can only be found in the partitions
+ * of same index of the shards, and the partitions are merged independently (and in parallel):
+ * the abundances of a kmer are summed over the shards, and the kmer is kept if its abundance is in
+ * [abundanceMin, abundanceMax].
+ *
+ * The merged storage has the same layout as the one built by SortingCountAlgorithm (groups "dsk"
+ * with the "solid" partition, "minimizers" and "configuration"), so it can be used as input of
+ * a graph construction.
+ */
+template<size_t span=KMER_DEFAULT_SPAN>
+class ShardMergeAlgorithm : public gatb::core::tools::misc::impl::Algorithm
+{
+public:
+
+    /** Shortcuts. */
+    typedef typename kmer::impl::Kmer<span>::Count Count;
+
+    /** Constructor.
+     * \param[in] shards : storages built by ShardCountAlgorithm
+     * \param[in] storage : storage where the merged solid kmers are written
+     * \param[in] abundanceMin : min abundance (over all the shards) of a solid kmer
+     * \param[in] abundanceMax : max abundance (over all the shards) of a solid kmer
+     * \param[in] nbCores : number of cores (0 for all the cores)
+     * \param[in] options : options of the algorithm
+     */
+    ShardMergeAlgorithm (
+        const std::vector<tools::storage::impl::Storage*>& shards,
+        tools::storage::impl::Storage&                     storage,
+        CountNumber                                        abundanceMin,
+        CountNumber                                        abundanceMax,
+        size_t                                             nbCores = 0,
+        tools::misc::IProperties*                          options = 0
+    );
+
+    /** Destructor. */
+    ~ShardMergeAlgorithm ();
+
+    /** \copydoc tools::misc::impl::Algorithm::execute */
+    void execute ();
+
+    /** Get the merged solid kmers.
+     * \return the solid kmers partition. */
+    tools::storage::impl::Partition<Count>* getSolidCounts ()  { return _solidCounts; }
+
+    /** Merge some kmers counts sets: the abundances of a kmer found in several sets are summed.
+     * \param[in] inputs : the kmers counts sets (not necessarily sorted)
+     * \param[in] output : bag where the merged kmers are inserted (sorted), then flushed
+     * \param[in] abundanceMin : min abundance of a kept kmer
+     * \param[in] abundanceMax : max abundance of a kept kmer
+     * \return the number of kept kmers. */
+    static u_int64_t merge (
+        const std::vector<tools::collections::Iterable<Count>*>& inputs,
+        tools::collections::Bag<Count>&                          output,
+        CountNumber                                              abundanceMin,
+        CountNumber                                              abundanceMax
+    );
+
+private:
+
+    std::vector<tools::storage::impl::Storage*> _shards;
+
+    tools::storage::impl::Storage& _storage;
+
+    CountNumber _abundanceMin;
+    CountNumber _abundanceMax;
+
+    tools::storage::impl::Partition<Count>* _solidCounts;
+    void setSolidCounts (tools::storage::impl::Partition<Count>* solidCounts)  {  SP_SETATTR(solidCounts); }
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _SHARD_MERGE_ALGORITHM_HPP_ */
@@ -31,6 +31,10 @@
 #include <gatb/tools/misc/impl/Progress.hpp>
 #include <gatb/bank/impl/Bank.hpp>
 #include <gatb/tools/collections/impl/IterableHelpers.hpp>
+#include <gatb/tools/collections/impl/Hash16.hpp>
+#include <gatb/tools/collections/impl/IteratorPrefetch.hpp>
+#include <gatb/system/impl/Tracer.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
 #include <cmath>
 
 #define DEBUG(a)  //printf a
@@ -61,18 +65,6 @@ using namespace gatb::core::tools::math;
 
 using namespace gatb::core::kmer::impl;
 
-/********************************************************************************/
-
-//#define PROTO_COMP
-
-#ifdef PROTO_COMP
-    #define PartitionCacheType  PartitionCacheSorted
-    #define STORAGE_TYPE  STORAGE_COMPRESSED_FILE
-#else
-    #define PartitionCacheType  PartitionCache
-    #define STORAGE_TYPE  STORAGE_FILE
-#endif
-
 /********************************************************************************/
 namespace gatb  {  namespace core  {   namespace kmer  {   namespace impl {
 /********************************************************************************/
@@ -95,7 +87,7 @@ template<size_t span>
 SortingCountAlgorithm<span>::SortingCountAlgorithm (IProperties* params)
   : Algorithm("dsk", -1, params),
     _bank(0), _repartitor(0),
-    _progress (0), _tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0)
+    _progress (0), _numaLocalBytes(0), _numaRemoteBytes(0), _nbBanks(0), _overlapMemory(0), _storage(0)
 {
 }
 
@@ -111,7 +103,7 @@ template<size_t span>
 SortingCountAlgorithm<span>::SortingCountAlgorithm (IBank* bank, IProperties* params)
   : Algorithm("dsk", -1, params),
     _bank(0), _repartitor(0),
-    _progress (0),_tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0)
+    _progress (0),_numaLocalBytes(0), _numaRemoteBytes(0), _nbBanks(0), _overlapMemory(0), _storage(0)
 {
     setBank (bank);
 }
@@ -135,7 +127,7 @@ SortingCountAlgorithm<span>::SortingCountAlgorithm (
 )
   : Algorithm("dsk", config._nbCores, params),
     _config(config), _bank(0), _repartitor(0),
-    _progress (0),_tmpPartitionsStorage(0), _tmpPartitions(0), _storage(0),_superKstorage(0)
+    _progress (0),_numaLocalBytes(0), _numaRemoteBytes(0), _nbBanks(0), _overlapMemory(0), _storage(0)
 {
     setBank       (bank);
     setRepartitor (repartitor);
@@ -157,8 +149,6 @@ SortingCountAlgorithm<span>::~SortingCountAlgorithm ()
     setBank                 (0);
     setRepartitor           (0);
     setProgress             (0);
- //   setPartitionsStorage    (0);
- //   setPartitions           (0);
     setStorage              (0);
 
     for (size_t i=0; i<_processors.size(); i++)  { _processors[i]->forget(); }
@@ -182,9 +172,6 @@ SortingCountAlgorithm<span>& SortingCountAlgorithm<span>::operator= (const Sorti
         setBank                 (s._bank);
         setRepartitor           (s._repartitor);
         setProgress             (s._progress);
-        setPartitionsStorage    (s._tmpPartitionsStorage);
-	    setPartitions           (s._tmpPartitions);
-		_superKstorage = s._superKstorage;
         setStorage              (s._storage);
     }
     return *this;
@@ -229,6 +216,8 @@ IOptionsParser* SortingCountAlgorithm<span>::getOptionsParser (bool mandatory)
     devParser->push_back (new OptionOneParam (STR_MINIMIZER_TYPE,    "minimizer type (0=lexi, 1=freq)",                false, "0"));
     devParser->push_back (new OptionOneParam (STR_MINIMIZER_SIZE,    "size of a minimizer",                            false, "10"));
     devParser->push_back (new OptionOneParam (STR_REPARTITION_TYPE,  "minimizer repartition (0=unordered, 1=ordered)", false, "0"));
+    devParser->push_back (new OptionNoParam  (STR_ESTIMATE_DISTINCT_KMERS, "estimate the number of distinct kmers before counting", false));
+    devParser->push_back (new OptionOneParam (STR_OVERLAP_PASSES,    "fill the partitions of the next pass while counting the current one (0=no, 1=yes, uses the temporary disk of two passes)", false, "0"));
     parser->push_back (devParser);
 
     return parser;
@@ -606,6 +595,9 @@ void SortingCountAlgorithm<span>::execute ()
     /** We configure all required objects (bank, configuration, repartitor, count processor). */
     configure ();
 
+    /** The read-ahead statistics are global, so we keep them for computing those of the counting. */
+    PrefetchStats prefetchStart = PrefetchSettings::totals();
+
     /** We create the sequences iterator. */
     Iterator<Sequence>* itSeq = _bank->iterator();
     LOCAL (itSeq);
@@ -629,8 +621,19 @@ void SortingCountAlgorithm<span>::execute ()
         exit(1);
     }
 
-    /** We create the PartiInfo instance. */
-    PartiInfo<5> pInfo (_config._nb_partitions, _config._minim_size);
+    /** We may fill the partitions of a pass while the previous one is counted. The superkmers caches
+     * of the filling are then taken out of the memory of the counting. */
+    bool overlap = getInput()->getInt(STR_OVERLAP_PASSES) != 0 && _config._nb_passes > 1;
+    _overlapMemory = overlap ?
+        (u_int64_t)_config._nb_cached_items_per_core_per_part * _config._nb_partitions * _config._nbCores * sizeof(Type) : 0;
+
+    /** We create the data of the pass being counted, and of the next one when the passes are overlapped. */
+    std::unique_ptr<PassData> current (new PassData (_config._nb_partitions, _config._minim_size));
+    std::unique_ptr<PassData> next    (overlap ? new PassData (_config._nb_partitions, _config._minim_size) : 0);
+
+    /** The number of banks is set once here, since the partitions of a pass may be filled while
+     * the previous one is counted (which uses it through getSizeofPerItem). */
+    _nbBanks = itSeq->getComposition().size();
 
     /** We notify the count processor about the start of the main loop. */
     for (size_t i=0; i<_processors.size(); i++)  {  _processors[i]->begin (_config); }
@@ -638,20 +641,54 @@ void SortingCountAlgorithm<span>::execute ()
     /*************************************************************/
     /*                         MAIN LOOP                         */
     /*************************************************************/
+    ITime::Value passesT0 = System::time().getTimeStamp();
+
     /** We loop N times the bank. For each pass, we will consider a subset of the whole kmers set of the bank. */
     for (size_t current_pass=0; current_pass < _config._nb_passes; current_pass++)
     {
         DEBUG (("SortingCountAlgorithm<span>::execute  pass [%ld,%d] \n", current_pass+1, _config._nb_passes));
 
-        pInfo.clear();
+        /** 1) We fill the partition files, unless they were filled during the previous pass. */
+        if (current_pass == 0 || !overlap)  {  fillPartitions (current_pass, itSeq, *current, getDispatcher(), _progress, getTimeInfo());  }
 
-        /** 1) We fill the partition files. */
-        fillPartitions (current_pass, itSeq, pInfo);
+        /** In overlapped mode, the partition files of the next pass are filled in a thread, with its own dispatcher. */
+        FillPartitionsTask* task   = 0;
+        IThread*            thread = 0;
+        if (overlap && current_pass+1 < _config._nb_passes)
+        {
+            task   = new FillPartitionsTask (*this, current_pass+1, itSeq, *next);
+            thread = System::thread().newThread (FillPartitionsTask::mainloop, task);
+        }
 
         /** 2) We fill the kmers solid file from the partition files. */
-        fillSolidKmers (current_pass, pInfo);
+        try
+        {
+            fillSolidKmers (current_pass, *current);
+        }
+        catch (...)
+        {
+            if (thread != 0)  {  thread->join();  delete thread;  delete task;  }
+            throw;
+        }
+
+        if (thread != 0)
+        {
+            thread->join();
+            delete thread;
+
+            getTimeInfo() += task->timeInfo;
+
+            bool hasError = task->hasError;  Exception error = task->error;
+            delete task;
+            if (hasError)  { throw error; }
+
+            std::swap (current, next);
+        }
     }
 
+    ITime::Value passesT1 = System::time().getTimeStamp();
+    _overlapMemory = 0;
+
     /** We notify the count processor about the stop of the main loop. */
     for (size_t i=0; i<_processors.size(); i++)  {  _processors[i]->end (); }
 
@@ -668,21 +705,11 @@ void SortingCountAlgorithm<span>::execute ()
 //	pInfo.printInfo();
 	
 
-    /** We want to remove physically the partitions. */
-	if(_config._solidityKind != KMER_SOLIDITY_SUM)
-     _tmpPartitions->remove ();
-
 	u_int64_t totaltmp, biggesttmp, smallesttmp;
 	float meantmp;
-	if(_config._solidityKind == KMER_SOLIDITY_SUM)
-		_superKstorage->getFilesStats(totaltmp,biggesttmp,smallesttmp, meantmp);
-
+	current->superKstorage->getFilesStats(totaltmp,biggesttmp,smallesttmp, meantmp);
 
-	if(_superKstorage!=0)
-	{
-		delete _superKstorage; //delete files and containing dir
-		_superKstorage =0;
-	}
+	PartiInfo<5>& pInfo = current->pInfo;
 	
     /*************************************************************/
     /*                         STATISTICS                        */
@@ -720,13 +747,10 @@ void SortingCountAlgorithm<span>::execute ()
 	getInfo()->add (3, "avg_superk_length","%.2f",(nbtotalk/(float) nbtotalsuperk));
 	getInfo()->add (3, "minimizer_density","%.2f",(nbtotalsuperk/(float)nbtotalk)*(_config._kmerSize - _config._minim_size +2));
 	
-	if(_config._solidityKind == KMER_SOLIDITY_SUM)
-	{
-		getInfo()->add (3, "total_size_(MB)","%lld",totaltmp/1024LL/1024LL);
-		getInfo()->add (3, "tmp_file_biggest_(MB)","%lld",biggesttmp/1024LL/1024LL);
-		getInfo()->add (3, "tmp_file_smallest_(MB)","%lld",smallesttmp/1024LL/1024LL);
-		getInfo()->add (3, "tmp_file_mean_(MB)","%.1f",meantmp/1024LL/1024LL);
-	}
+	getInfo()->add (3, "total_size_(MB)","%lld",totaltmp/1024LL/1024LL);
+	getInfo()->add (3, "tmp_file_biggest_(MB)","%lld",biggesttmp/1024LL/1024LL);
+	getInfo()->add (3, "tmp_file_smallest_(MB)","%lld",smallesttmp/1024LL/1024LL);
+	getInfo()->add (3, "tmp_file_mean_(MB)","%.1f",meantmp/1024LL/1024LL);
     /** We dump information about count processors. */
     if (_processors.size()==1)  {  getInfo()->add (2, _processors[0]->getProperties()); }
     else
@@ -741,6 +765,35 @@ void SortingCountAlgorithm<span>::execute ()
     _fillTimeInfo /= getDispatcher()->getExecutionUnitsNumber();
     getInfo()->add (2, _fillTimeInfo.getProperties("fillsolid_time"));
 
+    /** The overlap is the time during which the partitions filling and the kmers counting of two passes
+     * ran at the same time. */
+    u_int64_t fillTime    = getTimeInfo().getEntryByKey("fill_partitions");
+    u_int64_t countTime   = getTimeInfo().getEntryByKey("fill_solid_kmers");
+    u_int64_t passesTime  = passesT1 - passesT0;
+    getInfo()->add (2, "passes");
+    getInfo()->add (3, "nb_passes",              "%ld",  _config._nb_passes);
+    getInfo()->add (3, "overlap",                "%d",   overlap);
+    getInfo()->add (3, "fill_partitions_(ms)",   "%lld", fillTime);
+    getInfo()->add (3, "fill_solid_kmers_(ms)",  "%lld", countTime);
+    getInfo()->add (3, "passes_(ms)",            "%lld", passesTime);
+    getInfo()->add (3, "overlapped_(ms)",        "%lld", fillTime + countTime > passesTime ? fillTime + countTime - passesTime : 0);
+
+    if (getDispatcher()->getNbNumaNodes() > 1)
+    {
+        getInfo()->add (2, "numa");
+        getInfo()->add (3, "nb_nodes",         "%ld",  getDispatcher()->getNbNumaNodes());
+        getInfo()->add (3, "local_pool_(MB)",  "%lld", _numaLocalBytes/MBYTE);
+        getInfo()->add (3, "remote_pool_(MB)", "%lld", _numaRemoteBytes/MBYTE);
+    }
+
+    /** The stalls are the waits of the iterations on the blocks read ahead. */
+    PrefetchStats prefetch = PrefetchSettings::totals().since (prefetchStart);
+    getInfo()->add (2, "prefetch");
+    getInfo()->add (3, "nb_blocks",        "%lld", prefetch.nbBlocks);
+    getInfo()->add (3, "nb_stalls",        "%lld", prefetch.nbStalls);
+    getInfo()->add (3, "stall_time_(ms)",  "%lld", prefetch.stallTime/1000);
+    getInfo()->add (3, "read_time_(ms)",   "%lld", prefetch.readTime/1000);
+
     getInfo()->add (1, getTimeInfo().getProperties("time"));
 }
 
@@ -752,290 +805,14 @@ void SortingCountAlgorithm<span>::execute ()
  * of the superkmer. Such a hash code can be computed in several way; actually, we use
  * a lookup table that has computed the minimizers distribution on a subset of the
  * processed bank.
+ *
+ * The superkmers are written with the index of the bank they come from, which allows
+ * to count the kmers per bank afterwards. The functor is fed by the files of all the
+ * banks at the same time, each sequence coming with the index of its file.
  */
 	
-template<size_t span, bool newSuperKmerStorage=true> //
-class FillPartitions : public Sequence2SuperKmer<span>
-{
-public:
-	/** Shortcut. */
-	typedef typename Sequence2SuperKmer<span>::Type            Type;
-	typedef typename Sequence2SuperKmer<span>::Model           Model;
-	typedef typename Model::Kmer                          KmerType;
-	typedef typename Kmer<span>::SuperKmer                SuperKmer;
-	
-	/** */
-	void processSuperkmer (SuperKmer& superKmer)
-	{
-		if ((superKmer.minimizer % this->_nbPass) == this->_pass && superKmer.isValid()) //check if falls into pass
-		{
-			/** We get the hash code for the current miminizer.
-			 * => this will give us the partition where to dump the superkmer. */
-			size_t p = this->_repartition (superKmer.minimizer);
-			
-			/** We save the superkmer into the right partition. */
-			if(newSuperKmerStorage)
-				superKmer.save (_superkmerFiles,p);
-			else
-				superKmer.save ((this->_partition)[p]);
-			
-			
-			//for debug purposes
-			_local_pInfo.incSuperKmer_per_minimBin (superKmer.minimizer, superKmer.size()); //tocheck
-			
-			/*********************************************/
-			/** Now, we compute statistics about kxmers. */
-			/*********************************************/
-			
-			Type radix_kxmer_forward ,radix_kxmer ;
-			bool prev_which = superKmer[0].which();
-			size_t kx_size =0;
-			
-			radix_kxmer_forward = getHeavyWeight (superKmer[0].value());
-			
-			for (size_t ii=1 ; ii < superKmer.size(); ii++)
-			{
-				//compute here stats on  kx mer
-				//tant que tai <= xmer et which kmer[ii] == which kmer [ii-1] --> cest un kxmer
-				//do the same in sampling : gives ram estimation
-				if (superKmer[ii].which() != prev_which || kx_size >= this->_kx) // kxmer_size = 1 //cost should diminish with larger kxmer
-				{
-					//output kxmer size kx_size,radix_kxmer
-					//kx mer is composed of _superKp[ii-1] _superKp[ii-2] .. _superKp[ii-n] with nb elems  n  == kxmer_size +1  (un seul kmer ==k+0)
-					if(prev_which)
-					{
-						radix_kxmer = radix_kxmer_forward;
-					}
-					else // si revcomp, le radix du kxmer est le debut du dernier kmer
-					{
-						radix_kxmer = getHeavyWeight (superKmer[ii-1].value());
-					}
-					
-					this->_local_pInfo.incKmer_and_rad (p, radix_kxmer.getVal(), kx_size); //nb of superkmer per x per parti per radix
-					
-					radix_kxmer_forward =  getHeavyWeight (superKmer[ii].value());
-					kx_size =0;
-				}
-				else
-				{
-					kx_size++;
-				}
-				
-				prev_which = superKmer[ii].which() ;
-			}
-			
-			//record last kx mer
-			if(prev_which)
-			{
-				radix_kxmer = radix_kxmer_forward;
-			}
-			else // si revcomp, le radix du kxmer est le debut du dernier kmer
-			{
-				radix_kxmer =  getHeavyWeight (superKmer[superKmer.size()-1].value());
-			}
-			
-			this->_local_pInfo.incKmer_and_rad(p, radix_kxmer.getVal(),kx_size );
-			
-			/** We update progression information. */
-			this->_nbWrittenKmers += superKmer.size();
-		}
-	}
-	
-	/** Constructor. */
-	FillPartitions (
-					Model&             model,
-					size_t             nbPasses,
-					size_t             currentPass,
-					size_t             nbPartitions,
-					size_t             nbCacheItems,
-					IteratorListener*  progress,
-					BankStats&         bankStats,
-					Partition<Type>*   partition,
-					Repartitor&        repartition,
-					PartiInfo<5>&      pInfo,
-					SuperKmerBinFiles* superKstorage
-					)
-	:   Sequence2SuperKmer<span> (model, nbPasses, currentPass, nbPartitions, progress, bankStats),
-	_kx(4),
-	_extern_pInfo(pInfo) , _local_pInfo(nbPartitions,model.getMmersModel().getKmerSize()),
-	_repartition (repartition)
-	,_partition (*partition, nbCacheItems, 0), _superkmerFiles(superKstorage,nbCacheItems* sizeof(Type))
-	{
-		_mask_radix.setVal((int64_t) 255);
-		_mask_radix = _mask_radix << ((this->_kmersize - 4)*2); //get first 4 nt  of the kmers (heavy weight)
-	}
-	
-	
-	/** Destructor. */
-	~FillPartitions ()
-	{
-		//printf("destruc fillparti _superkmerFiles %p \n",_superkmerFiles);
-		
-		//add to global parti_info
-		_extern_pInfo += _local_pInfo;
-	}
-	
-private:
-	
-	size_t        _kx;
-	PartiInfo<5>& _extern_pInfo;
-	PartiInfo<5>  _local_pInfo;
-	Type          _mask_radix;
-	Repartitor&   _repartition;
-	
-	/** Shared resources (must support concurrent accesses). */
-	PartitionCacheType <Type> _partition;
-		CacheSuperKmerBinFiles _superkmerFiles;
-	
-	
-	
-	Type getHeavyWeight (const Type& kmer) const  {  return (kmer & this->_mask_radix) >> ((this->_kmersize - 4)*2);  }
-};
-	
-	
-//specialization when newSuperKmerStorage = false
 template<size_t span>
-class FillPartitions <span, false>: public Sequence2SuperKmer<span>
-{
-public:
-    /** Shortcut. */
-    typedef typename Sequence2SuperKmer<span>::Type            Type;
-    typedef typename Sequence2SuperKmer<span>::Model           Model;
-    typedef typename Model::Kmer                          KmerType;
-    typedef typename Kmer<span>::SuperKmer                SuperKmer;
-
-    /** */
-    void processSuperkmer (SuperKmer& superKmer)
-    {
-        if ((superKmer.minimizer % this->_nbPass) == this->_pass && superKmer.isValid()) //check if falls into pass
-        {
-            /** We get the hash code for the current miminizer.
-             * => this will give us the partition where to dump the superkmer. */
-            size_t p = this->_repartition (superKmer.minimizer);
-
-            /** We save the superkmer into the right partition. */
-//			if(newSuperKmerStorage)
-//				superKmer.save (_superkmerFiles,p);
-//			else
-				superKmer.save ((this->_partition)[p]);
-
-	
-			//for debug purposes
-			_local_pInfo.incSuperKmer_per_minimBin (superKmer.minimizer, superKmer.size()); //tocheck
-
-            /*********************************************/
-            /** Now, we compute statistics about kxmers. */
-            /*********************************************/
-
-            Type radix_kxmer_forward ,radix_kxmer ;
-            bool prev_which = superKmer[0].which();
-            size_t kx_size =0;
-
-            radix_kxmer_forward = getHeavyWeight (superKmer[0].value());
-
-            for (size_t ii=1 ; ii < superKmer.size(); ii++)
-            {
-                //compute here stats on  kx mer
-                //tant que tai <= xmer et which kmer[ii] == which kmer [ii-1] --> cest un kxmer
-                //do the same in sampling : gives ram estimation
-                if (superKmer[ii].which() != prev_which || kx_size >= this->_kx) // kxmer_size = 1 //cost should diminish with larger kxmer
-                {
-                    //output kxmer size kx_size,radix_kxmer
-                    //kx mer is composed of _superKp[ii-1] _superKp[ii-2] .. _superKp[ii-n] with nb elems  n  == kxmer_size +1  (un seul kmer ==k+0)
-                    if(prev_which)
-                    {
-                        radix_kxmer = radix_kxmer_forward;
-                    }
-                    else // si revcomp, le radix du kxmer est le debut du dernier kmer
-                    {
-                        radix_kxmer = getHeavyWeight (superKmer[ii-1].value());
-                    }
-
-                    this->_local_pInfo.incKmer_and_rad (p, radix_kxmer.getVal(), kx_size); //nb of superkmer per x per parti per radix
-
-                    radix_kxmer_forward =  getHeavyWeight (superKmer[ii].value());
-                    kx_size =0;
-                }
-                else
-                {
-                    kx_size++;
-                }
-
-                prev_which = superKmer[ii].which() ;
-            }
-
-            //record last kx mer
-            if(prev_which)
-            {
-                radix_kxmer = radix_kxmer_forward;
-            }
-            else // si revcomp, le radix du kxmer est le debut du dernier kmer
-            {
-                radix_kxmer =  getHeavyWeight (superKmer[superKmer.size()-1].value());
-            }
-
-            this->_local_pInfo.incKmer_and_rad(p, radix_kxmer.getVal(),kx_size );
-
-            /** We update progression information. */
-            this->_nbWrittenKmers += superKmer.size();
-        }
-    }
-
-    /** Constructor. */
-    FillPartitions (
-        Model&             model,
-        size_t             nbPasses,
-        size_t             currentPass,
-        size_t             nbPartitions,
-        size_t             nbCacheItems,
-        IteratorListener*  progress,
-        BankStats&         bankStats,
-        Partition<Type>*   partition,
-        Repartitor&        repartition,
-        PartiInfo<5>&      pInfo,
-		SuperKmerBinFiles* superKstorage
-    )
-    :   Sequence2SuperKmer<span> (model, nbPasses, currentPass, nbPartitions, progress, bankStats),
-        _kx(4),
-        _extern_pInfo(pInfo) , _local_pInfo(nbPartitions,model.getMmersModel().getKmerSize()),
-        _repartition (repartition)
-	    ,_partition (*partition, nbCacheItems, 0)/*, _superkmerFiles(superKstorage,nbCacheItems* sizeof(Type))*/
-    {
-        _mask_radix.setVal((int64_t) 255);
-        _mask_radix = _mask_radix << ((this->_kmersize - 4)*2); //get first 4 nt  of the kmers (heavy weight)
-    }
-
-
-    /** Destructor. */
-    ~FillPartitions ()
-    {
-		//printf("destruc fillparti _superkmerFiles %p \n",_superkmerFiles);
-
-        //add to global parti_info
-        _extern_pInfo += _local_pInfo;
-    }
-
-private:
-
-    size_t        _kx;
-    PartiInfo<5>& _extern_pInfo;
-    PartiInfo<5>  _local_pInfo;
-    Type          _mask_radix;
-    Repartitor&   _repartition;
-	
-    /** Shared resources (must support concurrent accesses). */
-    PartitionCacheType <Type> _partition;
-//	CacheSuperKmerBinFiles _superkmerFiles;
-	
-	
-
-    Type getHeavyWeight (const Type& kmer) const  {  return (kmer & this->_mask_radix) >> ((this->_kmersize - 4)*2);  }
-};
-
-	
-	//specialization when newSuperKmerStorage = true
-	template<size_t span>
-	class FillPartitions<span, true> : public Sequence2SuperKmer<span>
+	class FillPartitions : public Sequence2SuperKmer<span>
 	{
 	public:
 		/** Shortcut. */
@@ -1056,6 +833,8 @@ private:
 				/** We save the superkmer into the right partition. */
 				superKmer.save (_superkmerFiles,p);
 
+				_local_nbKmersPerBank[_bankId][p] += superKmer.size();
+
 				//for debug purposes
 				_local_pInfo.incSuperKmer_per_minimBin (superKmer.minimizer, superKmer.size()); //tocheck
 				
@@ -1126,16 +905,19 @@ private:
 						size_t             nbCacheItems,
 						IteratorListener*  progress,
 						BankStats&         bankStats,
-						Partition<Type>*   partition,
 						Repartitor&        repartition,
 						PartiInfo<5>&      pInfo,
-						SuperKmerBinFiles* superKstorage
+						SuperKmerBinFiles* superKstorage,
+						const std::vector<size_t>&            bankIds,
+						std::vector <std::vector<size_t> >&   nbKmersPerBank
 						)
 		:   Sequence2SuperKmer<span> (model, nbPasses, currentPass, nbPartitions, progress, bankStats),
 		_kx(4),
 		_extern_pInfo(pInfo) , _local_pInfo(nbPartitions,model.getMmersModel().getKmerSize()),
 		_repartition (repartition)
-		,/*_partition (*partition, nbCacheItems, 0),*/ _superkmerFiles(superKstorage,nbCacheItems* sizeof(Type))
+		, _superkmerFiles(superKstorage,nbCacheItems* sizeof(Type),0)
+		, _bankIds(bankIds), _bankId(0)
+		, _extern_nbKmersPerBank(nbKmersPerBank), _local_nbKmersPerBank(nbKmersPerBank.size(), std::vector<size_t>(nbPartitions,0))
 		{
 			_mask_radix.setVal((int64_t) 255);
 			_mask_radix = _mask_radix << ((this->_kmersize - 4)*2); //get first 4 nt  of the kmers (heavy weight)
@@ -1149,6 +931,20 @@ private:
 			
 			//add to global parti_info
 			_extern_pInfo += _local_pInfo;
+
+			for (size_t b=0; b<_local_nbKmersPerBank.size(); b++)
+			{
+				for (size_t p=0; p<_local_nbKmersPerBank[b].size(); p++)  {  _extern_nbKmersPerBank[b][p] += _local_nbKmersPerBank[b][p];  }
+			}
+		}
+
+		/** Process a sequence of the file 'fileId'. */
+		void operator() (Sequence& sequence, size_t fileId)
+		{
+			_bankId = _bankIds[fileId];
+			_superkmerFiles.setBankId (_bankId);
+
+			Sequence2SuperKmer<span>::operator() (sequence);
 		}
 		
 	private:
@@ -1159,9 +955,16 @@ private:
 		Type          _mask_radix;
 		Repartitor&   _repartition;
 		
-		/** Shared resources (must support concurrent accesses). */
-		//PartitionCacheType <Type> _partition;
+		/** Superkmers buffers, flushed into the shared superkmers storage. */
 		CacheSuperKmerBinFiles _superkmerFiles;
+
+		/** Bank of each iterated file and bank of the current sequence. */
+		const std::vector<size_t>& _bankIds;
+		size_t                     _bankId;
+
+		/** Number of kmers per bank and per partition. */
+		std::vector <std::vector<size_t> >&  _extern_nbKmersPerBank;
+		std::vector <std::vector<size_t> >   _local_nbKmersPerBank;
 		
 		
 		
@@ -1177,43 +980,31 @@ private:
 ** REMARKS :
 *********************************************************************/
 template<size_t span>
-void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence>* itSeq, PartiInfo<5>& pInfo)
+void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence>* itSeq, PassData& data, IDispatcher* dispatcher, IteratorListener* progress, TimeInfo& timeInfo)
 	{
-		TIME_INFO (getTimeInfo(), "fill_partitions");
+		TIME_INFO (timeInfo, "fill_partitions");
+		TRACE_SPAN_ARG ("dsk", "fill_partitions", pass);
 		
 		DEBUG (("SortingCountAlgorithm<span>::fillPartitions  _kmerSize=%d _minim_size=%d \n", _config._kmerSize, _config._minim_size));
 		
-		if(_config._solidityKind != KMER_SOLIDITY_SUM)
-		{
-			/** We delete the previous partitions storage. */
-			if (_tmpPartitionsStorage)  { _tmpPartitionsStorage->remove (); }
-			
-			/** We build the temporary storage name from the output storage name. */
-			string tmpStorageName = getInput()->getStr(STR_URI_OUTPUT_TMP) + "/" + System::file().getTemporaryFilename("dsk_partitions");
-			
-			/** We create the partition files for the current pass. */
-			setPartitionsStorage (StorageFactory(STORAGE_TYPE).create (tmpStorageName, true, false));
-			setPartitions        (0); // close the partitions first, otherwise new files are opened before  closing parti from previous pass
-			setPartitions        ( & (*_tmpPartitionsStorage)().getPartition<Type> ("parts", _config._nb_partitions));
-			
-		}
-		else
+		/** We build the temporary storage name from the output storage name; the name holds the pass
+		 * since the files of two passes may exist at the same time. */
+		std::string tmpStorageName_superK = getInput()->getStr(STR_URI_OUTPUT_TMP) + "/"
+		    + System::file().getTemporaryFilename (Stringify::format ("superK_partitions_%d", pass));
+		
+		
+		if(data.superKstorage!=0)
 		{
-			/** We build the temporary storage name from the output storage name. */
-			_tmpStorageName_superK = getInput()->getStr(STR_URI_OUTPUT_TMP) + "/" + System::file().getTemporaryFilename("superK_partitions");
-			
-			
-			if(_superKstorage!=0)
-			{
-				delete _superKstorage;
-				_superKstorage =0;
-			}
-			
-			_superKstorage = new SuperKmerBinFiles(_tmpStorageName_superK,"superKparts", _config._nb_partitions) ;
-			
+			delete data.superKstorage;
+			data.superKstorage =0;
 		}
+		
+		data.superKstorage = new SuperKmerBinFiles(tmpStorageName_superK,"superKparts", _config._nb_partitions) ;
+
+		data.pInfo.clear();
+
 		/** We update the message of the progress bar. */
-		_progress->setMessage (Stringify::format(progressFormat1, pass+1, _config._nb_passes));
+		progress->setMessage (Stringify::format(progressFormat1, pass+1, _config._nb_passes));
 		
 		/** We create a kmer model; using the frequency order if we're in that mode */
 		uint32_t* freq_order = NULL;
@@ -1224,7 +1015,7 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 		Model model( _config._kmerSize, _config._minim_size, typename kmer::impl::Kmer<span>::ComparatorMinimizerFrequencyOrLex(), freq_order);
 		
 		/** We have to reinit the progress instance since it may have been used by SampleRepart before. */
-		_progress->init();
+		progress->init();
 		
 		/** We may have several input banks instead of a single one. */
 		std::vector<Iterator<Sequence>*> itBanks =  itSeq->getComposition();
@@ -1240,60 +1031,69 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 		 *
 		 *   Here xxx is the number of items found for the bank I in the partition J
 		 */
-		_nbKmersPerPartitionPerBank.clear();
-		
-		/** We launch the iteration of the sequences iterator with the created functors. */
+		data.nbKmersPerPartitionPerBank.assign (itBanks.size(), vector<size_t> (_config._nb_partitions, 0));
+
+		/** The files of all the banks are read at the same time, so we need the bank of each file. */
+		std::vector<Iterator<Sequence>*> itFiles;
+		std::vector<size_t>              bankIds;
 		for (size_t i=0; i<itBanks.size(); i++)
 		{
-			size_t groupSize   = 1000;
-			bool deleteSynchro = true;
-			
-			/** We fill the partitions. Each thread will read synchronously and will call FillPartitions
-			 * in a synchronous way (in order to have global BanksStats correctly computed). */
-			
-			if(_config._solidityKind == KMER_SOLIDITY_SUM)
-			{
-				getDispatcher()->iterate (itBanks[i], FillPartitions<span,true> (
-																			model, _config._nb_passes, pass, _config._nb_partitions, _config._nb_cached_items_per_core_per_part, _progress, _bankStats, _tmpPartitions, *_repartitor, pInfo,_superKstorage
-																			), groupSize, deleteSynchro);
-			}
-			else
-			{
-				getDispatcher()->iterate (itBanks[i], FillPartitions<span,false> (
-																				 model, _config._nb_passes, pass, _config._nb_partitions, _config._nb_cached_items_per_core_per_part, _progress, _bankStats, _tmpPartitions, *_repartitor, pInfo,_superKstorage
-																				 ), groupSize, deleteSynchro);
-			}
-			
-			
-			/** We flush the partitions in order to be sure to have the exact number of items per partition. */
-			if(_config._solidityKind != KMER_SOLIDITY_SUM)
-			{
-				_tmpPartitions->flush();
-				
-				/** We get a snapshot of items number in each partition. */
-				vector<size_t> nbItems;
-				for (size_t p=0; p<_config._nb_partitions; p++)
-				{
-				 nbItems.push_back ((*_tmpPartitions)[p].getNbItems()); //todo for multi count
-				}
-				
-				/** We add the current number of kmers in each partition for the reached ith bank. */
-				_nbKmersPerPartitionPerBank.push_back (nbItems);
-			}
-			
-			//GR: close the input bank here with call to finalize
-			itBanks[i]->finalize();
+			std::vector<Iterator<Sequence>*> leaves = itBanks[i]->getLeaves();
+			for (size_t j=0; j<leaves.size(); j++)  {  itFiles.push_back (leaves[j]);  bankIds.push_back (i);  }
 		}
-		
-		if(_config._solidityKind == KMER_SOLIDITY_SUM)
+
+		size_t groupSize   = 1000;
+		bool deleteSynchro = true;
+
+		/** We fill the partitions. Each thread reads one file at a time, and the files are read
+		 * concurrently; FillPartitions instances are deleted in a synchronous way (in order to have
+		 * global BanksStats correctly computed). */
+		dispatcher->iterate (itFiles, FillPartitions<span> (
+			model, _config._nb_passes, pass, _config._nb_partitions, _config._nb_cached_items_per_core_per_part, progress, _bankStats, *_repartitor, data.pInfo, data.superKstorage,
+			bankIds, data.nbKmersPerPartitionPerBank
+		), groupSize, deleteSynchro);
+
+		/** We make the number of kmers per partition cumulative over the banks. */
+		for (size_t i=1; i<data.nbKmersPerPartitionPerBank.size(); i++)
 		{
-			_superKstorage->flushFiles();
-			_superKstorage->closeFiles();
+			for (size_t p=0; p<_config._nb_partitions; p++)  {  data.nbKmersPerPartitionPerBank[i][p] += data.nbKmersPerPartitionPerBank[i-1][p];  }
 		}
+
+		//GR: close the input banks here with call to finalize
+		for (size_t i=0; i<itBanks.size(); i++)  {  itBanks[i]->finalize();  }
 		
+		data.superKstorage->flushFiles();
+		data.superKstorage->closeFiles();
+
 		
 	}
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the exceptions are kept, and thrown again by the thread counting the kmers.
+*********************************************************************/
+template<size_t span>
+void* SortingCountAlgorithm<span>::FillPartitionsTask::mainloop (void* arg)
+{
+    FillPartitionsTask* task = (FillPartitionsTask*) arg;
+
+    try
+    {
+        task->ref.fillPartitions (task->pass, task->itSeq, task->data, &task->dispatcher, &task->progress, task->timeInfo);
+    }
+    catch (Exception& e)
+    {
+        task->error    = e;
+        task->hasError = true;
+    }
+
+    return 0;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -1332,16 +1132,17 @@ std::vector<size_t> SortingCountAlgorithm<span>::getNbCoresList (PartiInfo<5>& p
 ** REMARKS :
 *********************************************************************/
 template<size_t span>
-void SortingCountAlgorithm<span>::fillSolidKmers (size_t pass, PartiInfo<5>& pInfo)
+void SortingCountAlgorithm<span>::fillSolidKmers (size_t pass, PassData& data)
 {
     TIME_INFO (getTimeInfo(), "fill_solid_kmers");
+    TRACE_SPAN_ARG ("dsk", "fill_solid_kmers", pass);
 
     for (size_t i=0; i<_processors.size(); i++)
     {
         /** We notify the count processor about the start of the pass. */
         _processors[i]->beginPass (pass);
 
-        fillSolidKmers_aux (_processors[i], pass, pInfo);
+        fillSolidKmers_aux (_processors[i], pass, data);
 
         /** We notify the count processor about the end of the pass. */
         _processors[i]->endPass (pass);
@@ -1357,8 +1158,10 @@ void SortingCountAlgorithm<span>::fillSolidKmers (size_t pass, PartiInfo<5>& pIn
 ** REMARKS :
 *********************************************************************/
 template<size_t span>
-void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* processor, size_t pass, PartiInfo<5>& pInfo)
+void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* processor, size_t pass, PassData& data)
 {
+    PartiInfo<5>& pInfo = data.pInfo;
+
     DEBUG (("SortingCountAlgorithm<span>::fillSolidKmers\n"));
 
     /** We update the message of the progress bar. */
@@ -1371,8 +1174,18 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
     vector<size_t> coreList = getNbCoresList(pInfo); //uses _nb_partitions_in_parallel
 
     /** We need a memory allocator. We give the cores number in order to compute an extra memory
-     * allocation for alignment constraints. */
-    MemAllocator pool (_config._nbCores);
+     * allocation for alignment constraints. In NUMA mode, the partitions dispatched together are
+     * spread over the nodes and the pool is split per node, so each partition is loaded and sorted
+     * in memory local to the cores processing it. */
+    MemAllocator pool (_config._nbCores, getDispatcher()->getNbNumaNodes());
+
+    /** The memory for counting is the max memory, unless the memory budget is already partly used by
+     * other structures; in that case, the partitions that don't fit are counted with hash tables. */
+    u_int64_t maxMemory = std::min ((u_int64_t)_config._max_memory*MBYTE, MemoryAccounting::singleton().getAvailable());
+    maxMemory = std::max (maxMemory, (u_int64_t)_config._max_memory*MBYTE/2);
+
+    /** The partitions of the next pass may be filled meanwhile: we leave the memory of their caches. */
+    maxMemory -= std::min (_overlapMemory, maxMemory/2);
 
     size_t p = 0;
     for (size_t i=0; i<coreList.size(); i++)
@@ -1387,7 +1200,7 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
 
         /** We correct the number of memory per map according to the max allowed memory.
          * Note that _max_memory has initially been divided by the user provided cores number. */
-        u_int64_t mem = (_config._max_memory*MBYTE)/currentNbCores;
+        u_int64_t mem = maxMemory/currentNbCores;
 
         /** We need to cache the solid kmers partitions.
          *  NOTE : it is important to save solid kmers by big chunks (ie cache size) in each partition.
@@ -1424,7 +1237,7 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
 
             /** If we have several input banks, we may have to compute kmer solidity for each bank, which
              * can be currently done only with sorted vector. */
-			bool forceVector  =   _nbKmersPerPartitionPerBank.size() > 1 && ( _config._solidityKind != KMER_SOLIDITY_SUM);
+			bool forceVector  =   data.nbKmersPerPartitionPerBank.size() > 1 && ( _config._solidityKind != KMER_SOLIDITY_SUM);
 
 
             ICommand* cmd = 0;
@@ -1432,19 +1245,28 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
             //still use hash if by vector would be too large even with single part at a time
 			//I thought it was not possible to have memoryPartition > _max_memory  && currentNbCores>1 , but inf fact it is possible when
 			// some partitions are of size 0 (see getNbCoresList)
-			if ( ((memoryPartition > mem && currentNbCores==1) || ( memoryPartition > (_config._max_memory*MBYTE) ) )  && !forceVector)
+			if ( ((memoryPartition > mem && currentNbCores==1) || ( memoryPartition > maxMemory ) )  && !forceVector)
             {
                 if (pool.getCapacity() != 0)  {  pool.reserve(0);  }
 
+                /** If the number of distinct kmers has been estimated, the hash table is sized for the expected
+                 * distinct kmers of the partition (with a margin) instead of the whole memory of the core. */
+                u_int64_t hashMemory = mem;
+                if (_config._estimateDistinctKmerNb > 0)
+                {
+                    typedef typename tools::collections::impl::Hash16<Type>::cell HashCell;
+                    u_int64_t expected = (u_int64_t) (pInfo.getNbKmer(p) * _config._estimateDistinctKmerRatio) * sizeof(HashCell) * 2;
+                    hashMemory = std::min (mem, std::max (expected, (u_int64_t)MBYTE));
+                }
 
 					cmd = new PartitionsByHashCommand<span>   (
 															   processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, mem,_superKstorage
+															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, hashMemory, data.superKstorage
 															   );
             }
             else
             {
-                u_int64_t memoryPoolSize = _config._max_memory*MBYTE;
+                u_int64_t memoryPoolSize = maxMemory;
 
                 /** In case of forcing sorted vector (multiple banks counting for instance), we may have a
                  * partition bigger than the max memory. */
@@ -1489,7 +1311,7 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
                 if (pool.getCapacity() == 0)  {  pool.reserve (memoryPoolSize); }
 				else if (memoryPoolSize > pool.getCapacity()) { pool.reserve(0); pool.reserve (memoryPoolSize); }
 
-                /** Recall that we got the following matrix in _nbKmersPerPartitionPerBank
+                /** Recall that we got the following matrix in data.nbKmersPerPartitionPerBank
                  *
                  *           part0  part1  part2 ... partJ
                  *   bank0    xxx    xxx    xxx       xxx
@@ -1505,26 +1327,16 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
                 vector<size_t> nbItemsPerBankPerPart;
                 if ( _config._solidityKind != KMER_SOLIDITY_SUM)
                 {
-                    for (size_t i=0; i<_nbKmersPerPartitionPerBank.size(); i++)
+                    for (size_t i=0; i<data.nbKmersPerPartitionPerBank.size(); i++)
                     {
-                        nbItemsPerBankPerPart.push_back (_nbKmersPerPartitionPerBank[i][p] - (i==0 ? 0 : _nbKmersPerPartitionPerBank[i-1][p]) );
+                        nbItemsPerBankPerPart.push_back (data.nbKmersPerPartitionPerBank[i][p] - (i==0 ? 0 : data.nbKmersPerPartitionPerBank[i-1][p]) );
                     }
                 }
 
-				if ( _config._solidityKind == KMER_SOLIDITY_SUM)
-				{
-					cmd = new PartitionsByVectorCommand<span> (
-															   processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, nbItemsPerBankPerPart,_superKstorage
-															   );
-				}
-				else
-				{
-					cmd = new PartitionsByVectorCommand_multibank<span> (
-															   (*_tmpPartitions)[p], processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, nbItemsPerBankPerPart
-															   );
-				}
+				cmd = new PartitionsByVectorCommand<span> (
+														   processorClone, cacheSize, _progress, _fillTimeInfo,
+														   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, nbItemsPerBankPerPart, data.superKstorage
+														   );
 
             }
 
@@ -1545,10 +1357,12 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
         // free internal memory of pool here
         pool.free_all();
     }
+
+    _numaLocalBytes  += pool.getLocalBytes();
+    _numaRemoteBytes += pool.getRemoteBytes();
 	
 	
-	if(_config._solidityKind == KMER_SOLIDITY_SUM)
-		_superKstorage->closeFiles();
+	data.superKstorage->closeFiles();
 
 }
 
@@ -29,6 +29,8 @@
 /********************************************************************************/
 
 #include <gatb/tools/misc/impl/Algorithm.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/misc/impl/Progress.hpp>
 #include <gatb/bank/api/IBank.hpp>
 #include <gatb/kmer/api/ICountProcessor.hpp>
 #include <gatb/kmer/impl/Model.hpp>
@@ -37,6 +39,7 @@
 #include <gatb/kmer/impl/PartiInfo.hpp>
 #include <gatb/tools/storage/impl/Storage.hpp>
 #include <string>
+#include <memory>
 
 /********************************************************************************/
 namespace gatb      {
@@ -152,6 +155,8 @@ public:
     /** Process the kmers counting. It is mainly composed of a loop over the passes, and for each pass :
      *      1) we build the partition files then
      *      2) we fill the solid kmers file from the partitions.
+     * With the -overlap-passes option, the partition files of the next pass are built (in another
+     * thread) while the kmers of the current pass are counted.
      */
     void  execute ();
 
@@ -196,21 +201,68 @@ private:
     /** Configuration of the objects used by the algorithm. */
     void configure ();
 
+    /** Data built by the partitions filling of a pass, and used by the counting of this pass. */
+    struct PassData
+    {
+        PassData (size_t nbPartitions, size_t minimSize) : pInfo(nbPartitions, minimSize), superKstorage(0) {}
+        ~PassData ()  { if (superKstorage)  { delete superKstorage; } }  // deletes the files and their directory
+
+        /** The partition files are owned by the object, which is thus not copyable. */
+        PassData (const PassData&) = delete;
+        PassData& operator= (const PassData&) = delete;
+
+        /** Statistics about the partitions. */
+        PartiInfo<5> pInfo;
+
+        /** Superkmers partition files. */
+        tools::storage::impl::SuperKmerBinFiles* superKstorage;
+
+        /** Number of kmers per bank and per partition, cumulative over the banks. */
+        std::vector <std::vector<size_t> > nbKmersPerPartitionPerBank;
+    };
+
     /** Fill partition files (for a given pass) from a sequence iterator.
      * \param[in] pass  : current pass whose value is used for choosing the partition file
      * \param[in] itSeq : sequences iterator whose sequence are cut into kmers to be split.
+     * \param[out] data : partition files and statistics of the pass
+     * \param[in] dispatcher : dispatcher of the reading threads
+     * \param[in] progress : progress of the reading
+     * \param[in] timeInfo : time information to be updated
      */
-    void fillPartitions (size_t pass, gatb::core::tools::dp::Iterator<gatb::core::bank::Sequence>* itSeq, PartiInfo<5>& pInfo);
+    void fillPartitions (size_t pass, gatb::core::tools::dp::Iterator<gatb::core::bank::Sequence>* itSeq, PassData& data,
+        tools::dp::IDispatcher* dispatcher, tools::dp::IteratorListener* progress, tools::misc::impl::TimeInfo& timeInfo);
 
     /** Fill the solid kmers bag from the partition files (one partition after another one).
-     * \param[in] solidKmers : bag to put the solid kmers into.
+     * \param[in] pass : current pass
+     * \param[in] data : partition files and statistics of the pass
      */
-    void fillSolidKmers (size_t pass, PartiInfo<5>& pInfo);
+    void fillSolidKmers (size_t pass, PassData& data);
 
     /** Fill the solid kmers bag from the partition files (one partition after another one).
-     * \param[in] solidKmers : bag to put the solid kmers into.
+     * \param[in] processor : count processor getting the counted kmers
+     * \param[in] pass : current pass
+     * \param[in] data : partition files and statistics of the pass
      */
-    void fillSolidKmers_aux (ICountProcessor<span>* processor, size_t pass, PartiInfo<5>& pInfo);
+    void fillSolidKmers_aux (ICountProcessor<span>* processor, size_t pass, PassData& data);
+
+    /** Partitions filling of the next pass, run in a thread while the current pass is counted. */
+    struct FillPartitionsTask
+    {
+        FillPartitionsTask (SortingCountAlgorithm& ref, size_t pass, gatb::core::tools::dp::Iterator<gatb::core::bank::Sequence>* itSeq, PassData& data)
+            : ref(ref), pass(pass), itSeq(itSeq), data(data), dispatcher(ref.getDispatcher()->getExecutionUnitsNumber(), 0, ref.getDispatcher()->getNbNumaNodes() > 1), hasError(false)  {}
+
+        SortingCountAlgorithm&                                      ref;
+        size_t                                                      pass;
+        gatb::core::tools::dp::Iterator<gatb::core::bank::Sequence>* itSeq;
+        PassData&                                                   data;
+        tools::dp::impl::Dispatcher                                 dispatcher;
+        tools::misc::impl::TimeInfo                                 timeInfo;
+        tools::misc::impl::ProgressNone                             progress;  // the progress bar shows the counting
+        bool                                                        hasError;
+        system::Exception                                           error;
+
+        static void* mainloop (void* arg);
+    };
 
     /** */
     std::vector <size_t> getNbCoresList (PartiInfo<5>& pInfo);
@@ -234,32 +286,27 @@ private:
     gatb::core::tools::dp::IteratorListener* _progress;
     void setProgress (gatb::core::tools::dp::IteratorListener* progress)  { SP_SETATTR(progress); }
 
-    /** Temporary partitions management. */
-    tools::storage::impl::Storage* _tmpPartitionsStorage;
-    void setPartitionsStorage (tools::storage::impl::Storage* tmpPartitionsStorage)  {  SP_SETATTR(tmpPartitionsStorage);  }
-
-    /** Temporary partitions management. */
-    tools::storage::impl::Partition<Type>* _tmpPartitions;
-    void setPartitions (tools::storage::impl::Partition<Type>* tmpPartitions)  {  SP_SETATTR(tmpPartitions);  }
-
     /** Get the memory size (in bytes) to be used by each item.
      * IMPORTANT : we may have to count both the size of Type and the size for the bank id. */
-    int getSizeofPerItem () const { return Type::getSize()/8 + ((_nbKmersPerPartitionPerBank.size()>1 && _config._solidityKind != tools::misc::KMER_SOLIDITY_SUM) ? sizeof(bank::BankIdType) : 0); }
+    int getSizeofPerItem () const { return Type::getSize()/8 + ((_nbBanks>1 && _config._solidityKind != tools::misc::KMER_SOLIDITY_SUM) ? sizeof(bank::BankIdType) : 0); }
 
     tools::misc::impl::TimeInfo _fillTimeInfo;
 
+    /** Bytes of the partitions buffers allocated on the NUMA node of their worker, or on another node. */
+    u_int64_t _numaLocalBytes;
+    u_int64_t _numaRemoteBytes;
+
     BankStats _bankStats;
 
-    std::vector <std::vector<size_t> > _nbKmersPerPartitionPerBank;
+    /** Number of input banks. */
+    size_t _nbBanks;
+
+    /** Memory of the superkmers caches of the pass being filled while another one is counted. */
+    u_int64_t _overlapMemory;
 
     tools::storage::impl::StorageMode_e _storage_type;
     tools::storage::impl::Storage* _storage;
     void setStorage (tools::storage::impl::Storage* storage)  { SP_SETATTR(storage); }
-	
-	
-	//superkmer efficient storage
-	tools::storage::impl::SuperKmerBinFiles* _superKstorage;
-	std::string _tmpStorageName_superK;
 };
 
 /********************************************************************************/
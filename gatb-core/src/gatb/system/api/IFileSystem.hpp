@@ -101,6 +101,15 @@ public:
      * \return number of  items successfully written */
     virtual size_t fread (void* ptr, size_t size, size_t nmemb) = 0;
 
+    /** Reads a buffer from the file at a given position, without using nor moving the current
+     * position of the file. Several threads can then read the same file concurrently.
+     * \param[in] ptr : the buffer to be read
+     * \param[in] size : size of the buffer
+     * \param[in] nmemb : number of elements to be read
+     * \param[in] offset : position (in bytes) in the file where to start reading
+     * \return number of  items successfully read */
+    virtual size_t pread (void* ptr, size_t size, size_t nmemb, u_int64_t offset) = 0;
+
     /** Writes a buffer into the file.
      * \param[in] ptr : the buffer to be written
      * \param[in] size : size of the buffer
@@ -273,6 +282,17 @@ public:
       * \return -1 if error, 0 otherwise. */
      virtual ssize_t setAttribute (const Path& filename, const char* key, const char* fmt, ...) = 0;
 
+     /** Map a whole file in memory, read only. An exception is thrown if the file can't be mapped.
+      * \param[in] path : path of the file
+      * \param[out] size : size of the file, ie. of the mapping
+      * \return address of the mapping, to be released with unmapFile. */
+     virtual const void* mapFile (const Path& path, u_int64_t& size) = 0;
+
+     /** Release a mapping got with mapFile.
+      * \param[in] address : address of the mapping
+      * \param[in] size : size of the mapping */
+     virtual void unmapFile (const void* address, u_int64_t size) = 0;
+
      /** Destructor. */
      virtual ~IFileSystem () {}
 };
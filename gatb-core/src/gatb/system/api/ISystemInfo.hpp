@@ -29,6 +29,7 @@
 #include <gatb/system/api/types.hpp>
 #include <gatb/system/api/ISmartPointer.hpp>
 #include <string>
+#include <vector>
 
 /********************************************************************************/
 namespace gatb      {
@@ -66,6 +67,15 @@ public:
      * \return the number of cores. */
     virtual size_t getNbCores () const = 0;
 
+    /** Returns the number of NUMA nodes.
+     * \return the number of nodes, 1 for a system without NUMA architecture. */
+    virtual size_t getNbNumaNodes () const = 0;
+
+    /** Returns the cores belonging to a NUMA node.
+     * \param[in] node : index of the node, in [0..getNbNumaNodes()-1]
+     * \return the identifiers of the cores of the node. */
+    virtual std::vector<size_t> getNumaNodeCores (size_t node) const = 0;
+
     /** Returns the host name.
      * \return the host name. */
     virtual std::string getHostName () const = 0;
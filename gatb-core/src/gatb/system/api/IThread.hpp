@@ -31,6 +31,7 @@
 #include <gatb/system/api/Exception.hpp>
 #include <string>
 #include <list>
+#include <vector>
 
 /********************************************************************************/
 namespace gatb      {
@@ -183,6 +184,12 @@ public:
     /** Return the id of the current process. */
     virtual u_int64_t getProcess () = 0;
 
+    /** Restricts the calling thread to a set of cores.
+     * \param[in] cores : identifiers of the cores the thread may run on
+     * \return true if the affinity could be set, false otherwise (not supported, unknown cores...)
+     */
+    virtual bool setAffinity (const std::vector<size_t>& cores) = 0;
+
     /** Destructor. */
     virtual ~IThreadFactory ()  {}
 };
@@ -22,6 +22,8 @@
 
 #include <sys/resource.h>
 #include <sys/statvfs.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <dirent.h>
 #include <libgen.h>
@@ -263,6 +265,47 @@ u_int64_t  FileSystemCommon::getSize (const Path& path)
     return 0;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+const void* FileSystemCommon::mapFile (const Path& path, u_int64_t& size)
+{
+    int fd = open (path.c_str(), O_RDONLY);
+    if (fd < 0)  { throw Exception ("cannot open %s %s", path.c_str(), strerror(errno)); }
+
+    struct stat st;
+    if (fstat (fd, &st) != 0)  {  close (fd);  throw Exception ("cannot stat %s %s", path.c_str(), strerror(errno));  }
+
+    size = st.st_size;
+
+    if (size == 0)  {  close (fd);  throw Exception ("cannot map empty file %s", path.c_str());  }
+
+    void* address = mmap (0, size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+
+    if (address == MAP_FAILED)  { throw Exception ("cannot map %s %s", path.c_str(), strerror(errno)); }
+
+    return address;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void FileSystemCommon::unmapFile (const void* address, u_int64_t size)
+{
+    if (address != 0 && size > 0)  {  munmap ((void*)address, size);  }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -36,6 +36,7 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <errno.h>
 
 /********************************************************************************/
 namespace gatb      {
@@ -121,6 +122,27 @@ public:
         return ::fread (ptr, size, nmemb, getHandle());
     }
 
+    /** \copydoc IFile::pread */
+    size_t pread (void* ptr, size_t size, size_t nmemb, u_int64_t offset)
+    {
+        if (size == 0)  { return 0; }
+
+        int    fd     = fileno (getHandle());
+        char*  buffer = (char*) ptr;
+        size_t total  = size * nmemb;
+        size_t nbRead = 0;
+
+        /** Note: pread may return less than asked, so we loop until EOF or error. */
+        while (nbRead < total)
+        {
+            ssize_t n = ::pread (fd, buffer + nbRead, total - nbRead, offset + nbRead);
+            if (n < 0 && errno == EINTR)  { continue; }
+            if (n <= 0)  { break; }
+            nbRead += n;
+        }
+        return nbRead / size;
+    }
+
     /** \copydoc IFile::fwrite */
     size_t fwrite (const void* ptr, size_t size, size_t nmemb)
     {
@@ -223,6 +245,12 @@ public:
     /** \copydoc IFileSystem::setAttribute */
     ssize_t setAttribute (const Path& filename, const char* key, const char* fmt, ...)   { return -1; }
 
+    /** \copydoc IFileSystem::mapFile */
+    const void* mapFile (const Path& path, u_int64_t& size);
+
+    /** \copydoc IFileSystem::unmapFile */
+    void unmapFile (const void* address, u_int64_t size);
+
 private:
 
     static const char* tmp_prefix()  { return "trashme"; }
@@ -0,0 +1,262 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file MemoryAccounting.hpp
+ *  \brief Accounting of the memory used by the main data structures
+ */
+
+#ifndef _GATB_CORE_SYSTEM_IMPL_MEMORY_ACCOUNTING_HPP_
+#define _GATB_CORE_SYSTEM_IMPL_MEMORY_ACCOUNTING_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/IMemory.hpp>
+
+#include <memory>
+#include <limits>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace system    {
+namespace impl      {
+/********************************************************************************/
+
+/** Subsystems whose memory is accounted. */
+enum MemoryCategory
+{
+    MEMORY_BANK,            // buffers of the banks readers
+    MEMORY_SUPERKMER_CACHE, // caches of the superkmers partitions
+    MEMORY_COUNTING,        // radix arrays and hash tables of the kmers counting
+    MEMORY_BLOOM,           // Bloom filters
+    MEMORY_MPHF,            // minimal perfect hash functions
+    MEMORY_UNITIGS,         // unitigs of the graphs
+    MEMORY_OTHER,
+    MEMORY_NB_CATEGORIES
+};
+
+/** \brief Counters of the memory used by the main data structures
+ *
+ * The memory blocks allocated by MALLOC are not tracked one by one; instead, the big
+ * data structures (the ones whose size depends on the data) declare the memory they hold
+ * to this accounting, by category. The accounting keeps the current and the peak usage
+ * per category and in total; all operations can be done concurrently.
+ *
+ * A memory budget (usually given by the -max-memory option) can be set; the algorithms
+ * then ask for the memory still available before sizing their structures, and back off
+ * (more passes, smaller caches...) instead of exceeding the budget.
+ *
+ * See also MemoryCharge for declaring the memory of an object for its lifetime.
+ */
+class MemoryAccounting
+{
+public:
+
+    /** Singleton.
+     * \return the accounting. */
+    static MemoryAccounting& singleton ()  { static MemoryAccounting instance; return instance; }
+
+    /** Declare some used memory.
+     * \param[in] category : category of the memory
+     * \param[in] size : size in bytes */
+    void add (MemoryCategory category, u_int64_t size)
+    {
+        if (size == 0)  { return; }
+        updatePeak (_peak[category], __sync_add_and_fetch (&_current[category], size));
+        updatePeak (_totalPeak,      __sync_add_and_fetch (&_total,             size));
+    }
+
+    /** Declare some released memory.
+     * \param[in] category : category of the memory
+     * \param[in] size : size in bytes (previously declared by 'add') */
+    void remove (MemoryCategory category, u_int64_t size)
+    {
+        if (size == 0)  { return; }
+        __sync_fetch_and_sub (&_current[category], size);
+        __sync_fetch_and_sub (&_total,             size);
+    }
+
+    /** Get the current usage of a category.
+     * \param[in] category : category of the memory
+     * \return the usage in bytes. */
+    u_int64_t getCurrentUsage (MemoryCategory category) const  { return _current[category]; }
+
+    /** Get the peak usage of a category.
+     * \param[in] category : category of the memory
+     * \return the usage in bytes. */
+    u_int64_t getMaximumUsage (MemoryCategory category) const  { return _peak[category]; }
+
+    /** Get the current usage of all the categories.
+     * \return the usage in bytes. */
+    u_int64_t getCurrentUsage () const  { return _total; }
+
+    /** Get the peak usage of all the categories.
+     * \return the usage in bytes. */
+    u_int64_t getMaximumUsage () const  { return _totalPeak; }
+
+    /** Set the memory budget.
+     * \param[in] budget : the budget in bytes, 0 for no budget. */
+    void setBudget (u_int64_t budget)  { _budget = budget; }
+
+    /** Get the memory budget.
+     * \return the budget in bytes, 0 if no budget. */
+    u_int64_t getBudget () const  { return _budget; }
+
+    /** Get the memory that can still be used without exceeding the budget.
+     * \return the available memory in bytes. */
+    u_int64_t getAvailable () const
+    {
+        if (_budget == 0)  { return std::numeric_limits<u_int64_t>::max(); }
+        u_int64_t total = _total;
+        return _budget > total ? _budget - total : 0;
+    }
+
+    /** Tell whether some memory can be used without exceeding the budget.
+     * \param[in] size : size in bytes
+     * \return true if the size fits in the budget. */
+    bool fits (u_int64_t size) const  {  return size <= getAvailable();  }
+
+    /** Get the name of a category.
+     * \param[in] category : the category
+     * \return the name. */
+    static const char* getName (MemoryCategory category)
+    {
+        static const char* names[] = { "bank", "superkmer_cache", "counting", "bloom", "mphf", "unitigs", "other" };
+        return category < MEMORY_NB_CATEGORIES ? names[category] : "?";
+    }
+
+private:
+
+    MemoryAccounting () : _total(0), _totalPeak(0), _budget(0)
+    {
+        for (size_t i=0; i<MEMORY_NB_CATEGORIES; i++)  {  _current[i] = _peak[i] = 0;  }
+    }
+
+    static void updatePeak (u_int64_t& peak, u_int64_t value)
+    {
+        for (u_int64_t p = peak;  value > p;  p = peak)
+        {
+            if (__sync_bool_compare_and_swap (&peak, p, value))  { break; }
+        }
+    }
+
+    u_int64_t _current[MEMORY_NB_CATEGORIES];
+    u_int64_t _peak   [MEMORY_NB_CATEGORIES];
+    u_int64_t _total;
+    u_int64_t _totalPeak;
+    u_int64_t _budget;
+};
+
+/********************************************************************************/
+
+/** \brief Memory declared to the MemoryAccounting for the lifetime of an object
+ *
+ * The object holding some data structure owns a MemoryCharge and sets it to the size of
+ * the structure; the memory is given back to the accounting when the charge is destroyed.
+ *
+ * Sample of use:
+ * \code
+ * class MyTable
+ * {
+ *     MyTable (size_t n) : _charge(MEMORY_OTHER)  {  _data = MALLOC (n);  _charge.set (n);  }
+ *     MemoryCharge _charge;
+ * };
+ * \endcode
+ */
+class MemoryCharge
+{
+public:
+
+    /** Constructor.
+     * \param[in] category : category of the memory
+     * \param[in] size : size in bytes */
+    MemoryCharge (MemoryCategory category=MEMORY_OTHER, u_int64_t size=0) : _category(category), _size(0)  { set (size); }
+
+    /** Copy constructor: the copy declares the same size. */
+    MemoryCharge (const MemoryCharge& other) : _category(other._category), _size(0)  { set (other._size); }
+
+    /** Destructor. */
+    ~MemoryCharge ()  { set (0); }
+
+    /** Affectation: the size is the one of the other charge. */
+    MemoryCharge& operator= (const MemoryCharge& other)
+    {
+        if (this != &other)  {  set (0);  _category = other._category;  set (other._size);  }
+        return *this;
+    }
+
+    /** Change the declared size.
+     * \param[in] size : the new size in bytes */
+    void set (u_int64_t size)
+    {
+        if      (size > _size)  { MemoryAccounting::singleton().add    (_category, size - _size); }
+        else if (size < _size)  { MemoryAccounting::singleton().remove (_category, _size - size); }
+        _size = size;
+    }
+
+    /** Get the declared size.
+     * \return the size in bytes. */
+    u_int64_t get () const  { return _size; }
+
+private:
+    MemoryCategory _category;
+    u_int64_t      _size;
+};
+
+/********************************************************************************/
+
+/** \brief STL allocator declaring its memory to the MemoryAccounting
+ *
+ * Sample of use:
+ * \code
+ * std::vector<u_int32_t, TrackedAllocator<u_int32_t,MEMORY_UNITIGS> > v;
+ * \endcode
+ */
+template <typename T, MemoryCategory category> class TrackedAllocator : public std::allocator<T>
+{
+public:
+
+    typedef typename std::allocator<T>::pointer    pointer;
+    typedef typename std::allocator<T>::size_type  size_type;
+
+    template <typename U> struct rebind  {  typedef TrackedAllocator<U,category> other;  };
+
+    TrackedAllocator () {}
+    TrackedAllocator (const TrackedAllocator& a) : std::allocator<T>(a) {}
+    template <typename U> TrackedAllocator (const TrackedAllocator<U,category>& a) : std::allocator<T>(a) {}
+
+    pointer allocate (size_type n, const void* hint=0)
+    {
+        pointer result = std::allocator<T>::allocate (n, hint);
+        MemoryAccounting::singleton().add (category, n*sizeof(T));
+        return result;
+    }
+
+    void deallocate (pointer p, size_type n)
+    {
+        MemoryAccounting::singleton().remove (category, n*sizeof(T));
+        std::allocator<T>::deallocate (p, n);
+    }
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_SYSTEM_IMPL_MEMORY_ACCOUNTING_HPP_ */
@@ -30,6 +30,7 @@
 
 #include <gatb/system/api/IMemory.hpp>
 #include <gatb/system/api/Exception.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
 
 #include <stdlib.h>
 #include <string.h>
@@ -357,8 +358,9 @@ public:
  *
  * This implementation delegates the allocation part to a referred IMemoryAllocator instance.
  *
- * It is not abstract since it implements the statistics methods but with dummy return values.
- * It could have sense in case we want fast allocators without statistic information.
+ * The blocks are not tracked one by one (which would slow down the allocators); the usage
+ * statistics are the ones of the MemoryAccounting, ie. the memory declared by the big data
+ * structures (banks buffers, kmers counting, Bloom filters, MPHF, unitigs...).
  *
  * Its main purpose is to factorize some code for concrete implementations.
  */
@@ -397,10 +399,10 @@ public:
      size_t getNbBlocks () { return 0; }
 
      /** \copydoc IMemory::getCurrentUsage */
-     TotalSize_t getCurrentUsage () { return 0; }
+     TotalSize_t getCurrentUsage () { return impl::MemoryAccounting::singleton().getCurrentUsage(); }
 
      /** \copydoc IMemory::getMaximumUsage */
-     TotalSize_t getMaximumUsage () { return 0; }
+     TotalSize_t getMaximumUsage () { return impl::MemoryAccounting::singleton().getMaximumUsage(); }
 
 protected:
 
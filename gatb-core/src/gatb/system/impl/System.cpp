@@ -25,6 +25,8 @@ namespace gatb { namespace core { namespace system { namespace impl {
 	
 std::list<ThreadGroup*> ThreadGroup::_groups;
 
+thread_local WorkerContext* WorkerContext::_current = 0;
+
 static pthread_mutex_t groupsMutex;
 static int mutex_inited = 0;
 
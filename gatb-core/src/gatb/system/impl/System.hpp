@@ -234,6 +234,117 @@ private:
 
 /********************************************************************************/
 
+/** \brief Context of a worker thread
+ *
+ * The dispatchers make a WorkerContext current in each thread running one of their
+ * commands. Code run by a worker (a command, or a functor given to IDispatcher::iterate)
+ * can then get its index among the workers in constant time and without lock, which
+ * is not the case with ThreadGroup::findThreadInfo.
+ *
+ * The context also holds a scratch buffer and some statistics owned by the worker,
+ * so they can be used without synchronization.
+ *
+ * Sample of use:
+ * \code
+ * struct Functor
+ * {
+ *     std::vector<Cache*>& caches;
+ *     void operator() (const Item& item)  {  caches[WorkerContext::get().getIndex()]->insert (item);  }
+ * };
+ * \endcode
+ */
+class WorkerContext
+{
+public:
+
+    /** Constructor.
+     * \param[in] group : thread group of the worker, 0 if the worker is the calling thread
+     * \param[in] index : index of the worker
+     * \param[in] nbWorkers : number of workers */
+    WorkerContext (IThreadGroup* group=0, size_t index=0, size_t nbWorkers=1)
+        : _group(group), _index(index), _nbWorkers(nbWorkers), _numaNode(-1)  {}
+
+    /** Get the context of the calling thread.
+     * \return the context, 0 if the calling thread is not a worker. */
+    static WorkerContext* current ()  { return _current; }
+
+    /** Get the context of the calling thread.
+     * \return the context; an exception is thrown if the calling thread is not a worker. */
+    static WorkerContext& get ()
+    {
+        if (_current == 0)  { throw Exception ("WorkerContext: calling thread is not run by a dispatcher"); }
+        return *_current;
+    }
+
+    /** Makes a context current for the calling thread during the life time of the instance. */
+    class Scope
+    {
+    public:
+        Scope (WorkerContext* context) : _previous(_current)  { _current = context;   }
+        ~Scope ()                                             { _current = _previous; }
+    private:
+        WorkerContext* _previous;
+    };
+
+    /** Reset the context for a new dispatch; the scratch buffer is kept.
+     * \param[in] group : thread group of the worker
+     * \param[in] index : index of the worker
+     * \param[in] nbWorkers : number of workers
+     * \param[in] numaNode : NUMA node the worker is bound to, -1 if not bound */
+    void reset (IThreadGroup* group, size_t index, size_t nbWorkers, int numaNode=-1)
+    {
+        _group = group;  _index = index;  _nbWorkers = nbWorkers;  _numaNode = numaNode;  _stats.clear();
+    }
+
+    /** Get the thread group of the worker.
+     * \return the group, 0 if the worker is not a thread of a group. */
+    IThreadGroup* getGroup () const  { return _group; }
+
+    /** Get the index of the worker, in [0..getNbWorkers()-1]
+     * \return the index. */
+    size_t getIndex () const  { return _index; }
+
+    /** Get the number of workers of the dispatch.
+     * \return the number of workers. */
+    size_t getNbWorkers () const  { return _nbWorkers; }
+
+    /** Get the NUMA node the worker is bound to (see Dispatcher::setNumaAware).
+     * \return the node, -1 if the worker is not bound to a node. */
+    int getNumaNode () const  { return _numaNode; }
+
+    /** Get a buffer owned by the worker; the buffer is reused from one call to another.
+     * \param[in] size : minimal size in bytes of the buffer
+     * \return the buffer. */
+    void* getScratch (size_t size)
+    {
+        if (_scratch.size() < size)  { _scratch.resize (size); }
+        return _scratch.data();
+    }
+
+    /** Increase a statistic of the worker.
+     * \param[in] key : name of the statistic
+     * \param[in] value : value to be added */
+    void increment (const std::string& key, u_int64_t value=1)  { _stats[key] += value; }
+
+    /** Get the statistics of the worker.
+     * \return the statistics values by name. */
+    const std::map<std::string,u_int64_t>& getStats () const  { return _stats; }
+
+private:
+
+    IThreadGroup* _group;
+    size_t        _index;
+    size_t        _nbWorkers;
+    int           _numaNode;
+
+    std::vector<char>                _scratch;
+    std::map<std::string,u_int64_t>  _stats;
+
+    static thread_local WorkerContext* _current;
+};
+
+/********************************************************************************/
+
 /** \brief Facility to share a common resource between several threads.
  *
  * When using multithreading, one has to take care about reads/writes on a resource T
@@ -268,7 +379,7 @@ public:
 	/** Constructor
 	 * \param[in] object : object to be shared by several threads.
 	 * 		If none, default constructor of type T is used. */
-    ThreadObject (const T& object = T()) : _object(object), _isInit(false), _synchro(0)
+    ThreadObject (const T& object = T()) : _object(object), _isInit(false), _synchro(0), _group(0)
     {
         _synchro = system::impl::System::thread().newSynchronizer();
     }
@@ -295,6 +406,8 @@ public:
 
                 if (group)
                 {
+                    _group = group;
+
                     for (size_t i=0; i<group->size(); i++)
                     {
                         IThread* thread = (*group)[i];
@@ -311,6 +424,10 @@ public:
             }
         }
 
+        /** The worker context of the thread gives directly the index of its local object. */
+        WorkerContext* context = WorkerContext::current();
+        if (context != 0 && context->getGroup() == _group)  {  return *(_vec[context->getIndex()]);  }
+
         return *(_map[System::thread().getThreadSelf()]);
     }
 
@@ -345,6 +462,8 @@ private:
 
     bool _isInit;
     system::ISynchronizer* _synchro;
+
+    IThreadGroup* _group;
 };
 
 /********************************************************************************/
@@ -105,6 +105,15 @@ std::string SystemInfoCommon::getBuildOptions () const { return STR_COMPILATION_
 
 std::string SystemInfoCommon::getBuildSystem () const { return STR_OPERATING_SYSTEM; }
 
+/********************************************************************************/
+std::vector<size_t> SystemInfoCommon::getNumaNodeCores (size_t node) const
+{
+    /** Without NUMA information, all the cores belong to a single node. */
+    std::vector<size_t> result;
+    if (node == 0)  {  for (size_t i=0; i<getNbCores(); i++)  { result.push_back (i); }  }
+    return result;
+}
+
 /*********************************************************************
                 #        ###  #     #  #     #  #     #
                 #         #   ##    #  #     #   #   #
@@ -154,6 +163,57 @@ string SystemInfoLinux::getHostName () const
     return result;
 }
 
+/********************************************************************************/
+size_t SystemInfoLinux::getNbNumaNodes () const
+{
+    /** The nodes are listed by the kernel as /sys/devices/system/node/nodeN directories. */
+    size_t result = 0;
+    char path[128];
+
+    for ( ; ; result++)
+    {
+        snprintf (path, sizeof(path), "/sys/devices/system/node/node%ld/cpulist", result);
+        if (access (path, R_OK) != 0)  { break; }
+    }
+
+    if (result==0)  { result = 1; }
+
+    return result;
+}
+
+/********************************************************************************/
+std::vector<size_t> SystemInfoLinux::getNumaNodeCores (size_t node) const
+{
+    std::vector<size_t> result;
+
+    char path[128];
+    snprintf (path, sizeof(path), "/sys/devices/system/node/node%ld/cpulist", node);
+
+    /** No NUMA information (old kernel, container...) => we use the default single node. */
+    FILE* file = fopen (path, "r");
+    if (file == 0)  { return SystemInfoCommon::getNumaNodeCores (node); }
+
+    /** The cpulist file holds ranges of cores, like "0-3,8-11". */
+    char buffer[1024];
+    if (fgets (buffer, sizeof(buffer), file))
+    {
+        char* loop = buffer;
+        while (*loop >= '0' && *loop <= '9')
+        {
+            size_t first = strtoul (loop, &loop, 10);
+            size_t last  = first;
+            if (*loop == '-')  { last = strtoul (loop+1, &loop, 10); }
+
+            for (size_t i=first; i<=last; i++)  { result.push_back (i); }
+
+            if (*loop == ',')  { loop++; }
+        }
+    }
+    fclose (file);
+
+    return result;
+}
+
 /********************************************************************************/
 u_int64_t SystemInfoLinux::getMemoryPhysicalTotal () const
 {
@@ -67,6 +67,12 @@ public:
     /** \copydoc ISystemInfo::getBuildSystem */
     std::string getBuildSystem () const;
 
+    /** \copydoc ISystemInfo::getNbNumaNodes */
+    size_t getNbNumaNodes () const  { return 1; }
+
+    /** \copydoc ISystemInfo::getNumaNodeCores */
+    std::vector<size_t> getNumaNodeCores (size_t node) const;
+
     /** \copydoc ISystemInfo::getHomeDirectory */
     std::string getHomeDirectory ()  const {  return getenv("HOME") ? getenv("HOME") : ".";  }
     
@@ -100,6 +106,12 @@ public:
     /** \copydoc ISystemInfo::getHostName */
     std::string getHostName () const ;
 
+    /** \copydoc ISystemInfo::getNbNumaNodes */
+    size_t getNbNumaNodes () const;
+
+    /** \copydoc ISystemInfo::getNumaNodeCores */
+    std::vector<size_t> getNumaNodeCores (size_t node) const;
+
     /** \copydoc ISystemInfo::getMemoryPhysicalTotal */
     u_int64_t getMemoryPhysicalTotal () const ;
 
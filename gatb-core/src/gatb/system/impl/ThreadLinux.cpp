@@ -139,6 +139,27 @@ u_int64_t ThreadFactoryLinux::getProcess ()
     return getpid ();
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool ThreadFactoryLinux::setAffinity (const std::vector<size_t>& cores)
+{
+    cpu_set_t set;
+    CPU_ZERO (&set);
+
+    size_t nb = 0;
+    for (size_t i=0; i<cores.size(); i++)  {  if (cores[i] < CPU_SETSIZE)  { CPU_SET (cores[i], &set);  nb++; }  }
+
+    if (nb == 0)  { return false; }
+
+    return pthread_setaffinity_np (pthread_self(), sizeof(set), &set) == 0;
+}
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
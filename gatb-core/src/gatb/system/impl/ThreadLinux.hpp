@@ -53,6 +53,9 @@ public:
 
     /** \copydoc IThreadFactory::getProcess */
     u_int64_t getProcess ();
+
+    /** \copydoc IThreadFactory::setAffinity */
+    bool setAffinity (const std::vector<size_t>& cores);
 };
 
 /********************************************************************************/
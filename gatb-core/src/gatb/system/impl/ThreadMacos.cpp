@@ -140,6 +140,19 @@ u_int64_t ThreadFactoryMacos::getProcess ()
     return getpid ();
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : no thread affinity API on MacOS
+*********************************************************************/
+bool ThreadFactoryMacos::setAffinity (const std::vector<size_t>& cores)
+{
+    return false;
+}
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
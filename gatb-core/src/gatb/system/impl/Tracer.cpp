@@ -0,0 +1,330 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/system/impl/Tracer.hpp>
+#include <gatb/system/impl/System.hpp>
+
+#include <chrono>
+
+/********************************************************************************/
+namespace gatb { namespace core { namespace system { namespace impl {
+/********************************************************************************/
+
+bool Tracer::_enabled = false;
+
+thread_local Tracer::LaneOwner Tracer::_owner;
+
+/** Current time of the monotonic clock, in microseconds. */
+static u_int64_t clockNow ()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds> (
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+Tracer& Tracer::singleton ()
+{
+    static Tracer instance;
+    return instance;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+Tracer::Tracer () : _synchro(0), _capacity(DEFAULT_CAPACITY), _origin(clockNow())
+{
+    _synchro = System::thread().newSynchronizer();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+Tracer::~Tracer ()
+{
+    _enabled = false;
+    for (size_t i=0; i<_lanes.size(); i++)  { delete _lanes[i]; }
+    delete _synchro;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the lane is kept for a next thread, with its spans.
+*********************************************************************/
+Tracer::LaneOwner::~LaneOwner ()
+{
+    if (lane != 0)
+    {
+        LocalSynchronizer ls (Tracer::singleton()._synchro);
+        lane->busy = false;
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void Tracer::enable (size_t capacity)
+{
+    LocalSynchronizer ls (_synchro);
+
+    _capacity = capacity>0 ? capacity : 1;
+
+    for (size_t i=0; i<_lanes.size(); i++)
+    {
+        _lanes[i]->events.resize (_capacity);
+        _lanes[i]->nbEvents = 0;
+    }
+
+    _origin  = clockNow();
+    _enabled = true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int64_t Tracer::now () const
+{
+    return clockNow() - _origin;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the lane of a thread is taken at its first span.
+*********************************************************************/
+Tracer::Lane* Tracer::getLane ()
+{
+    if (_owner.lane == 0)
+    {
+        LocalSynchronizer ls (_synchro);
+
+        for (size_t i=0; _owner.lane==0 && i<_lanes.size(); i++)
+        {
+            if (_lanes[i]->busy == false)  {  _owner.lane = _lanes[i];  _owner.lane->busy = true;  }
+        }
+
+        if (_owner.lane == 0)
+        {
+            _owner.lane = new Lane (_lanes.size(), _capacity);
+            _lanes.push_back (_owner.lane);
+        }
+    }
+
+    return _owner.lane;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void Tracer::record (const char* category, const char* name, u_int64_t start, int64_t arg)
+{
+    Lane* lane = getLane ();
+
+    u_int64_t end = now();
+
+    Event& event = lane->events [lane->nbEvents % lane->events.size()];
+    event.category = category;
+    event.name     = name;
+    event.start    = start;
+    event.duration = end > start ? end - start : 0;
+    event.arg      = arg;
+
+    lane->nbEvents++;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int64_t Tracer::getNbSpans () const
+{
+    LocalSynchronizer ls (_synchro);
+
+    u_int64_t result = 0;
+    for (size_t i=0; i<_lanes.size(); i++)  { result += _lanes[i]->nbEvents; }
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int64_t Tracer::getNbLost () const
+{
+    LocalSynchronizer ls (_synchro);
+
+    u_int64_t result = 0;
+    for (size_t i=0; i<_lanes.size(); i++)
+    {
+        if (_lanes[i]->nbEvents > _lanes[i]->events.size())  { result += _lanes[i]->nbEvents - _lanes[i]->events.size(); }
+    }
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : only the spans still in the ring buffers are taken into account.
+*********************************************************************/
+std::map<std::string,Tracer::Stats> Tracer::getStats () const
+{
+    LocalSynchronizer ls (_synchro);
+
+    std::map<std::string,Stats> result;
+
+    for (size_t i=0; i<_lanes.size(); i++)
+    {
+        const Lane& lane = *_lanes[i];
+        size_t nb = std::min (lane.nbEvents, (u_int64_t) lane.events.size());
+
+        std::map<std::string,u_int64_t> laneTotals;
+
+        for (size_t j=0; j<nb; j++)
+        {
+            const Event& event = lane.events[j];
+            std::string key = std::string(event.category) + "." + event.name;
+
+            Stats& stats = result[key];
+            stats.nb    ++;
+            stats.total += event.duration;
+            stats.max    = std::max (stats.max, event.duration);
+
+            laneTotals[key] += event.duration;
+        }
+
+        for (std::map<std::string,u_int64_t>::iterator it = laneTotals.begin(); it != laneTotals.end(); ++it)
+        {
+            Stats& stats = result[it->first];
+            stats.nbLanes ++;
+            stats.maxLane = std::max (stats.maxLane, it->second);
+        }
+    }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : see the "Trace Event Format" document for the format; we use
+**           "complete" events (ph:X), one per span, the lanes being the tids.
+*********************************************************************/
+void Tracer::dump (const std::string& uri) const
+{
+    IFile* file = System::file().newFile (uri, "w");
+    if (file == 0 || file->isOpen() == false)
+    {
+        if (file)  { delete file; }
+        throw Exception ("Unable to create trace file '%s'", uri.c_str());
+    }
+
+    LocalSynchronizer ls (_synchro);
+
+    file->print ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    bool first = true;
+
+    for (size_t i=0; i<_lanes.size(); i++)
+    {
+        const Lane& lane = *_lanes[i];
+
+        file->print ("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%ld,\"args\":{\"name\":\"lane %ld\"}}",
+            first ? "" : ",\n", (long)lane.id, (long)lane.id
+        );
+        first = false;
+
+        /** The oldest span is just after the last written one when the buffer has wrapped. */
+        size_t    capacity = lane.events.size();
+        u_int64_t nb       = std::min (lane.nbEvents, (u_int64_t) capacity);
+        u_int64_t begin    = lane.nbEvents - nb;
+
+        for (u_int64_t j=begin; j<lane.nbEvents; j++)
+        {
+            const Event& event = lane.events [j % capacity];
+
+            file->print (",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%ld,\"ts\":%lld,\"dur\":%lld",
+                event.name, event.category, (long)lane.id, (long long)event.start, (long long)event.duration
+            );
+            if (event.arg >= 0)  { file->print (",\"args\":{\"id\":%lld}", (long long)event.arg); }
+            file->print ("}");
+        }
+    }
+
+    file->print ("\n]}\n");
+    file->flush ();
+
+    delete file;
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
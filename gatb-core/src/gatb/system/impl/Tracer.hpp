@@ -0,0 +1,227 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file Tracer.hpp
+ *  \brief Tracing of the execution of the threads
+ */
+
+#ifndef _GATB_CORE_SYSTEM_IMPL_TRACER_HPP_
+#define _GATB_CORE_SYSTEM_IMPL_TRACER_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/types.hpp>
+#include <gatb/system/api/IThread.hpp>
+
+#include <string>
+#include <vector>
+#include <map>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace system    {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Recorder of the spans executed by the threads
+ *
+ * A span is a named interval of time of one thread (a dispatcher task, a phase of a
+ * partition, an I/O call...). Spans are usually recorded through the TRACE_SPAN macro,
+ * which records the enclosing instruction block; spans may be nested.
+ *
+ * Each thread records its spans into its own ring buffer, so recording needs no lock
+ * and no atomic operation; when a buffer is full, the oldest spans are overwritten.
+ * The buffer of a thread is given back to the tracer when the thread ends and is then
+ * reused by a next thread, so the buffers are the "lanes" of the trace.
+ *
+ * When the tracer is not enabled (the default), a span costs only one test.
+ *
+ * The recorded spans can be dumped in the Chrome trace event format (to be viewed with
+ * chrome://tracing or https://ui.perfetto.dev) and summarized as statistics per span name.
+ * Both operations must be done when the traced threads are over.
+ *
+ * Sample of use:
+ * \code
+ * Tracer::singleton().enable ();
+ * {
+ *     TRACE_SPAN ("io", "read");
+ *     // do something here
+ * }
+ * Tracer::singleton().dump ("trace.json");
+ * \endcode
+ */
+class Tracer
+{
+public:
+
+    /** Statistics of the spans of a given category and name. */
+    struct Stats
+    {
+        Stats () : nb(0), total(0), max(0), maxLane(0), nbLanes(0)  {}
+
+        u_int64_t nb;       // number of spans
+        u_int64_t total;    // total duration (in microseconds)
+        u_int64_t max;      // longest span
+        u_int64_t maxLane;  // biggest total duration of one lane
+        u_int64_t nbLanes;  // number of lanes having such spans
+    };
+
+    /** Singleton.
+     * \return the tracer. */
+    static Tracer& singleton ();
+
+    /** Enable the tracing; the previously recorded spans are discarded. Must not be called
+     * while traced threads are running.
+     * \param[in] capacity : number of spans kept by each lane */
+    void enable (size_t capacity = DEFAULT_CAPACITY);
+
+    /** Disable the tracing; the recorded spans are kept. */
+    void disable ()  { _enabled = false; }
+
+    /** Tell whether the tracing is enabled.
+     * \return true if enabled. */
+    static bool isEnabled ()  { return _enabled; }
+
+    /** Get the current time.
+     * \return the time in microseconds since the tracer has been enabled. */
+    u_int64_t now () const;
+
+    /** Record a span of the calling thread, ending now.
+     * \param[in] category : category of the span (must be a static string)
+     * \param[in] name : name of the span (must be a static string)
+     * \param[in] start : start of the span, as given by 'now'
+     * \param[in] arg : argument of the span (partition index for instance), -1 for none */
+    void record (const char* category, const char* name, u_int64_t start, int64_t arg=-1);
+
+    /** Get the number of recorded spans.
+     * \return the number of spans (including the overwritten ones). */
+    u_int64_t getNbSpans () const;
+
+    /** Get the number of spans lost because of the ring buffers overflow.
+     * \return the number of lost spans. */
+    u_int64_t getNbLost () const;
+
+    /** Get statistics of the recorded spans, by "category.name".
+     * \return the statistics. */
+    std::map<std::string,Stats> getStats () const;
+
+    /** Dump the recorded spans into a file in the Chrome trace event format.
+     * \param[in] uri : path of the file. */
+    void dump (const std::string& uri) const;
+
+    /** Default number of spans kept by a lane. */
+    static const size_t DEFAULT_CAPACITY = 1<<16;
+
+private:
+
+    /** A recorded span. */
+    struct Event
+    {
+        const char* category;
+        const char* name;
+        u_int64_t   start;
+        u_int64_t   duration;
+        int64_t     arg;
+    };
+
+    /** Ring buffer of a lane; only written by the thread owning it. */
+    struct Lane
+    {
+        Lane (size_t id, size_t capacity) : id(id), events(capacity), nbEvents(0), busy(true)  {}
+
+        size_t             id;
+        std::vector<Event> events;
+        u_int64_t          nbEvents;
+        bool               busy;
+    };
+
+    /** Give back its lane to the tracer at the end of a thread. */
+    struct LaneOwner
+    {
+        LaneOwner () : lane(0)  {}
+        ~LaneOwner ();
+
+        Lane* lane;
+    };
+
+    Tracer ();
+    ~Tracer ();
+
+    /** Get the lane of the calling thread, and take one if needed. */
+    Lane* getLane ();
+
+    static bool _enabled;
+    static thread_local LaneOwner _owner;
+
+    ISynchronizer*     _synchro;
+    std::vector<Lane*> _lanes;
+    size_t             _capacity;
+    u_int64_t          _origin;
+};
+
+/********************************************************************************/
+
+/** \brief Recording of the span of an instruction block
+ *
+ * See also the TRACE_SPAN and TRACE_SPAN_ARG macros that ease its usage.
+ */
+class TraceSpan
+{
+public:
+
+    /** Constructor.
+     * \param[in] category : category of the span (must be a static string)
+     * \param[in] name : name of the span (must be a static string)
+     * \param[in] arg : argument of the span, -1 for none */
+    TraceSpan (const char* category, const char* name, int64_t arg=-1)
+        : _category(category), _name(name), _arg(arg), _start(0), _active(Tracer::isEnabled())
+    {
+        if (_active)  { _start = Tracer::singleton().now(); }
+    }
+
+    /** Destructor. */
+    ~TraceSpan ()
+    {
+        if (_active)  { Tracer::singleton().record (_category, _name, _start, _arg); }
+    }
+
+private:
+    const char* _category;
+    const char* _name;
+    int64_t     _arg;
+    u_int64_t   _start;
+    bool        _active;
+};
+
+#define TRACE_SPAN_CONCAT2(a,b)  a##b
+#define TRACE_SPAN_CONCAT(a,b)   TRACE_SPAN_CONCAT2(a,b)
+
+#define TRACE_SPAN(cat,name)          gatb::core::system::impl::TraceSpan TRACE_SPAN_CONCAT(TraceSpanTmp,__LINE__) (cat,name)
+#define TRACE_SPAN_ARG(cat,name,arg)  gatb::core::system::impl::TraceSpan TRACE_SPAN_CONCAT(TraceSpanTmp,__LINE__) (cat,name,arg)
+
+/** Hook of the thirdparty BooPHF.h, called at the build of each MPHF level; it must be defined
+ * before BooPHF.h is included, which is why it lives here rather than in BooPHF.hpp. */
+#define BOOPHF_TRACE_LEVEL(level)     TRACE_SPAN_ARG ("mphf", "level", level)
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_SYSTEM_IMPL_TRACER_HPP_ */
@@ -0,0 +1,149 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file AtomicBitset.hpp
+ *  \brief Bit array that can be written by several threads
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_ATOMIC_BITSET_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_ATOMIC_BITSET_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/types.hpp>
+
+#include <vector>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Bit array packed in 64 bits words, whose bits can be set by several threads
+ *
+ * Contrary to std::vector<bool>, setting a bit doesn't overwrite the other bits of its word,
+ * so different threads can set (or clear) bits concurrently. The set method also tells
+ * whether the bit was already set, so that only one thread 'claims' a given bit.
+ *
+ * Resizing, reset and merge are not thread safe with respect to the other methods.
+ *
+ * Sample of use:
+ * \code
+ * AtomicBitset visited (nbItems);
+ * // in each thread:
+ * if (visited.set (i) == false)  { // this thread is the first one to visit i }
+ * \endcode
+ */
+class AtomicBitset
+{
+public:
+
+    /** Constructor.
+     * \param[in] nbBits : number of bits, all cleared. */
+    AtomicBitset (u_int64_t nbBits = 0)  { resize (nbBits); }
+
+    /** Set the number of bits; all the bits are cleared.
+     * \param[in] nbBits : number of bits. */
+    void resize (u_int64_t nbBits)
+    {
+        _nbBits = nbBits;
+        _words.assign ((nbBits + 63) / 64, 0);
+    }
+
+    /** Get the number of bits.
+     * \return the number of bits. */
+    u_int64_t size () const  { return _nbBits; }
+
+    /** Clear all the bits. */
+    void reset ()  { _words.assign (_words.size(), 0); }
+
+    /** Get a bit.
+     * \param[in] i : index of the bit
+     * \return the bit value. */
+    bool get (u_int64_t i) const  { return (__atomic_load_n (&_words[i/64], __ATOMIC_RELAXED) >> (i%64)) & 1; }
+
+    /** Shortcut for get. */
+    bool operator[] (u_int64_t i) const  { return get (i); }
+
+    /** Set a bit, atomically.
+     * \param[in] i : index of the bit
+     * \return the previous value of the bit. */
+    bool set (u_int64_t i)
+    {
+        u_int64_t mask = ((u_int64_t)1) << (i%64);
+        return (__sync_fetch_and_or (&_words[i/64], mask) & mask) != 0;
+    }
+
+    /** Clear a bit, atomically.
+     * \param[in] i : index of the bit
+     * \return the previous value of the bit. */
+    bool clear (u_int64_t i)
+    {
+        u_int64_t mask = ((u_int64_t)1) << (i%64);
+        return (__sync_fetch_and_and (&_words[i/64], ~mask) & mask) != 0;
+    }
+
+    /** Get the number of words.
+     * \return the number of 64 bits words. */
+    u_int64_t getNbWords () const  { return _words.size(); }
+
+    /** Set the bits of a range of words that are set in another bitset of the same size. Threads
+     * merging disjoint ranges of words don't need a synchronization.
+     * \param[in] other : bits to be set
+     * \param[in] firstWord : first word of the range
+     * \param[in] lastWord : last word of the range (excluded)
+     * \return the number of bits that were not set before. */
+    u_int64_t merge (const AtomicBitset& other, u_int64_t firstWord, u_int64_t lastWord)
+    {
+        u_int64_t nbNew = 0;
+        for (u_int64_t w=firstWord; w<lastWord && w<_words.size(); w++)
+        {
+            nbNew     += __builtin_popcountll (other._words[w] & ~_words[w]);
+            _words[w] |= other._words[w];
+        }
+        return nbNew;
+    }
+
+    /** Get the number of bits set.
+     * \return the number of set bits. */
+    u_int64_t count () const
+    {
+        u_int64_t result = 0;
+        for (size_t w=0; w<_words.size(); w++)  { result += __builtin_popcountll (_words[w]); }
+        return result;
+    }
+
+    /** Get the memory used by the bitset.
+     * \return the size in bytes. */
+    u_int64_t getMemorySize () const  { return _words.capacity() * sizeof(u_int64_t); }
+
+private:
+
+    u_int64_t              _nbBits;
+    std::vector<u_int64_t> _words;
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_ATOMIC_BITSET_HPP_ */
@@ -30,8 +30,11 @@
 
 #include <gatb/tools/collections/api/Bag.hpp>
 #include <gatb/system/impl/System.hpp>
+#include <gatb/tools/collections/impl/BlockDeltaCodec.hpp>
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include <zlib.h>
 
@@ -104,7 +107,104 @@ private:
     system::IFile* _file;
 };
 
-    
+
+/********************************************************************************/
+
+/** \brief Bag implementation for file, with the items delta compressed by blocks
+ *
+ * The items are (value,abundance) items, as the kmer counts, see BlockDeltaCodec. They are
+ * gathered into blocks of increasing values: a block is written when it is full, when an item
+ * is not bigger than the previous one, or when the bag is flushed. Sorted items, as the solid
+ * kmers of a partition, thus give full blocks; the other ones are still stored, but with a
+ * poor compression.
+ *
+ * The blocks are appended to the file; IterableDeltaFile reads them.
+ */
+template <typename Item> class BagDeltaFile : public Bag<Item>, public system::SmartPointer
+{
+public:
+
+    typedef BlockDeltaCodec<Item> Codec;
+
+    /** Constructor.
+     * \param[in] filename : name of the file
+     * \param[in] blockSize : maximum number of items of a block */
+    BagDeltaFile (const std::string& filename, size_t blockSize=BlockDeltaSettings::blockSize())
+        : _filename(filename), _file(0), _blockSize(std::max (blockSize, (size_t)1))
+    {
+        _items.reserve (_blockSize);
+    }
+
+    /** Destructor. */
+    ~BagDeltaFile ()
+    {
+        writeBlock ();
+        if (_file)  { delete _file; }
+    }
+
+    /** Get the name of the file.
+     * \return the file name.  */
+    const std::string& getName () const { return _filename; }
+
+    /**  \copydoc Bag::insert */
+    void insert (const Item& item)
+    {
+        if (!_items.empty() && !Codec::less (_items.back().value, item.value))  { writeBlock (); }
+
+        _items.push_back (item);
+
+        if (_items.size() >= _blockSize)  { writeBlock (); }
+    }
+
+    /**  \copydoc Bag::insert(const std::vector<Item>& items, size_t length) */
+    void insert (const std::vector<Item>& items, size_t length)
+    {
+        if (length == 0)  { length = items.size(); }
+        insert (items.data(), length);
+    }
+
+    /**  \copydoc Bag::insert(const Item* items, size_t length) */
+    void insert (const Item* items, size_t length)
+    {
+        for (size_t i=0; i<length; i++)  { insert (items[i]); }
+    }
+
+    /**  \copydoc Bag::flush */
+    void flush ()
+    {
+        writeBlock ();
+        if (_file)  { _file->flush(); }
+    }
+
+private:
+
+    std::string           _filename;
+    system::IFile*        _file;
+    size_t                _blockSize;
+    std::vector<Item>     _items;
+    std::vector<u_int8_t> _bytes;
+
+    /** Encodes the pending items as a block and appends it to the file. */
+    void writeBlock ()
+    {
+        if (_items.empty())  { return; }
+
+        _bytes.clear();
+
+        if (_file == 0)
+        {
+            /** The file is opened at the first block (and marked if it is a new one). */
+            bool isNew = !system::impl::System::file().doesExist (_filename) || system::impl::System::file().getSize (_filename) == 0;
+            _file = system::impl::System::file().newFile (_filename, "ab");
+            if (isNew)  { _bytes.insert (_bytes.end(), Codec::magic(), Codec::magic() + Codec::MAGIC_SIZE); }
+        }
+
+        Codec::encode (_items.data(), _items.size(), _bytes);
+        _file->fwrite (_bytes.data(), sizeof(u_int8_t), _bytes.size());
+
+        _items.clear();
+    }
+};
 
 /* \brief Bag implementation for file
  */
@@ -0,0 +1,317 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file BlockDeltaCodec.hpp
+ *  \brief Block compression of sorted (value,abundance) items
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_BLOCK_DELTA_CODEC_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_BLOCK_DELTA_CODEC_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/types.hpp>
+
+#include <cstring>
+#include <vector>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Settings of the delta compressed collections of counts */
+class BlockDeltaSettings
+{
+public:
+
+    /** Tells whether the file storages write their collections of counts delta compressed;
+     * the files already written in one format or the other are read anyway. */
+    static bool& enabled ()  { static bool value = true;  return value; }
+
+    /** Maximum number of items of a block. */
+    static size_t& blockSize ()  { static size_t value = 4096;  return value; }
+};
+
+/********************************************************************************/
+
+/** \brief Tells whether an item type can be delta compressed.
+ *
+ * The item must have a 'value' field, made of 64 bits words with the least significant one
+ * first (as u_int64_t and LargeInt), and an integral 'abundance' field of at most 64 bits,
+ * as the kmer counts Kmer<span>::Count.
+ */
+template <typename Item> class BlockDeltaSupport
+{
+    template<typename T> static char test (decltype(&T::value), decltype(&T::abundance),
+        char (*)[sizeof(((T*)0)->value) % 8 == 0 && sizeof(((T*)0)->abundance) <= 8 ? 1 : -1] = 0);
+    template<typename T> static long test (...);
+
+public:
+
+    enum { value = sizeof (test<Item> (0, 0)) == 1 };
+};
+
+/********************************************************************************/
+
+/** \brief Encoder/decoder of blocks of sorted (value,abundance) items
+ *
+ * A block holds strictly increasing values. It starts with a header giving its number of items,
+ * the size of its payload and its smallest and biggest values, so that a reader can skip the
+ * blocks that can't hold a given value. The payload gives for each item the difference with the
+ * previous value (nothing for the first one, which is the header min) and the abundance, both as
+ * variable-byte integers (7 bits per byte, the high bit telling that another byte follows).
+ *
+ * For kmers of a sorted partition, the differences are much smaller than the kmers, so an item
+ * usually takes 2 to 4 bytes instead of sizeof(Item).
+ */
+template <typename Item> class BlockDeltaCodec
+{
+public:
+
+    /** Type of the sorted values. */
+    typedef decltype(((Item*)0)->value)      Key;
+
+    /** Type of the abundances. */
+    typedef decltype(((Item*)0)->abundance)  Number;
+
+    /** Header of a block. */
+    struct Header
+    {
+        u_int32_t nbItems;   //!< number of items of the block
+        u_int32_t nbBytes;   //!< size of the payload following the header
+        Key       min;       //!< value of the first item
+        Key       max;       //!< value of the last item
+    };
+
+    /** Mark at the beginning of a file of blocks. */
+    static const char* magic ()  { return "GATBDLT1"; }
+
+    /** Size of the mark. */
+    static const size_t MAGIC_SIZE = 8;
+
+    /** Number of 64 bits words of a value. */
+    static const size_t NB_WORDS = sizeof(Key) / sizeof(u_int64_t);
+
+    /** Tells whether a value is smaller than another one.
+     * \param[in] a : first value
+     * \param[in] b : second value
+     * \return true if a < b */
+    static bool less (const Key& a, const Key& b)
+    {
+        u_int64_t wa[NB_WORDS], wb[NB_WORDS];
+        toWords (a, wa);  toWords (b, wb);
+        for (size_t w=NB_WORDS; w-- > 0; )  {  if (wa[w] != wb[w])  { return wa[w] < wb[w]; }  }
+        return false;
+    }
+
+    /** Append a block to a buffer.
+     * \param[in] items : items of the block, with strictly increasing values
+     * \param[in] nb : number of items (not 0)
+     * \param[out] out : buffer the block is appended to */
+    static void encode (const Item* items, size_t nb, std::vector<u_int8_t>& out)
+    {
+        size_t offset = out.size();
+        out.resize (offset + sizeof(Header) + nb * MAX_ITEM_BYTES);
+
+        u_int8_t* begin = out.data() + offset + sizeof(Header);
+        u_int8_t* p     = begin;
+
+        u_int64_t previous[NB_WORDS], current[NB_WORDS], delta[NB_WORDS];
+        toWords (items[0].value, previous);
+        p = writeWord (p, getAbundance (items[0]));
+
+        for (size_t i=1; i<nb; i++)
+        {
+            toWords (items[i].value, current);
+
+            u_int64_t borrow = 0;
+            for (size_t w=0; w<NB_WORDS; w++)
+            {
+                delta[w] = current[w] - previous[w] - borrow;
+                borrow   = (current[w] < previous[w]) || (current[w] == previous[w] && borrow);
+                previous[w] = current[w];
+            }
+
+            p = writeWords (p, delta);
+            p = writeWord  (p, getAbundance (items[i]));
+        }
+
+        Header header;
+        memset (&header, 0, sizeof(header));
+        header.nbItems = nb;
+        header.nbBytes = p - begin;
+        header.min     = items[0].value;
+        header.max     = items[nb-1].value;
+        memcpy (out.data() + offset, &header, sizeof(header));
+
+        out.resize (offset + sizeof(Header) + header.nbBytes);
+    }
+
+    /** Number of readable bytes the decoder needs after the end of a payload: the variable-byte
+     * integers are read by 8 bytes words. */
+    static const size_t PADDING = 8;
+
+    /** Decode the payload of a block.
+     * \param[in] payload : bytes following the header of the block, followed by PADDING readable bytes
+     * \param[in] header : header of the block
+     * \param[out] out : array of header.nbItems items to be filled */
+    static void decode (const u_int8_t* payload, const Header& header, Item* out)
+    {
+        const u_int8_t* p = payload;
+        u_int64_t previous[NB_WORDS], delta[NB_WORDS], abundance;
+
+        toWords (header.min, previous);
+        out[0].value = header.min;
+        p = readWord (p, abundance);  setAbundance (out[0], abundance);
+
+        for (size_t i=1; i<header.nbItems; i++)
+        {
+            if (NB_WORDS == 1)
+            {
+                /** Fast path for the kmers up to 32 nucleotides. */
+                p = readWord (p, delta[0]);
+                previous[0] += delta[0];
+            }
+            else
+            {
+                p = readWords (p, delta);
+                u_int64_t carry = 0;
+                for (size_t w=0; w<NB_WORDS; w++)
+                {
+                    u_int64_t sum = previous[w] + delta[w] + carry;
+                    carry = (sum < previous[w]) || (sum == previous[w] && carry);
+                    previous[w] = sum;
+                }
+            }
+
+            fromWords (previous, out[i].value);
+            p = readWord (p, abundance);  setAbundance (out[i], abundance);
+        }
+    }
+
+private:
+
+    /** Maximum size of an encoded item: the difference and the abundance. */
+    static const size_t MAX_ITEM_BYTES = (sizeof(Key)*8 + 6) / 7 + 10;
+
+    /** The values are seen as raw arrays of words (LargeInt has no word accessors). */
+    static void toWords   (const Key& key, u_int64_t* words)  { memcpy (words, static_cast<const void*> (&key), sizeof(Key)); }
+    static void fromWords (const u_int64_t* words, Key& key)  { memcpy (static_cast<void*> (&key), words, sizeof(Key)); }
+
+    static u_int64_t getAbundance (const Item& item)
+    {
+        u_int64_t result = 0;  memcpy (&result, &item.abundance, sizeof(Number));  return result;
+    }
+
+    static void setAbundance (Item& item, u_int64_t value)  {  memcpy (&item.abundance, &value, sizeof(Number));  }
+
+    static u_int8_t* writeWord (u_int8_t* p, u_int64_t value)
+    {
+        while (value >= 128)  {  *(p++) = (value & 127) | 128;  value >>= 7;  }
+        *(p++) = value;
+        return p;
+    }
+
+    /** Read the 7 bits groups of up to 8 bytes at once: the first byte without its high bit ends
+     * the integer. Returns the (up to 56) bits of the groups and sets the number of bytes read. */
+    static u_int64_t readGroups (const u_int8_t* p, size_t& nbBytes, bool& last)
+    {
+        u_int64_t x;  memcpy (&x, p, sizeof(x));
+
+        u_int64_t stop = ~x & 0x8080808080808080ULL;
+        last    = stop != 0;
+        nbBytes = last ? __builtin_ctzll (stop) / 8 + 1 : 8;
+        if (nbBytes < 8)  { x &= (((u_int64_t)1) << (8*nbBytes)) - 1; }
+
+        /** We pack the 7 bits groups together. */
+        x &= 0x7f7f7f7f7f7f7f7fULL;
+        x = (x & 0x007f007f007f007fULL) | ((x & 0x7f007f007f007f00ULL) >> 1);
+        x = (x & 0x00003fff00003fffULL) | ((x & 0x3fff00003fff0000ULL) >> 2);
+        x = (x & 0x000000000fffffffULL) | ((x & 0x0fffffff00000000ULL) >> 4);
+        return x;
+    }
+
+    static const u_int8_t* readWord (const u_int8_t* p, u_int64_t& value)
+    {
+        /** Fast path for the one byte integers (most of the abundances). */
+        if (*p < 128)  { value = *p;  return p+1; }
+
+        size_t nbBytes;  bool last;
+        value = readGroups (p, nbBytes, last);
+        p += nbBytes;
+
+        for (size_t shift=56; !last; shift+=56)
+        {
+            u_int64_t bits = readGroups (p, nbBytes, last);
+            if (shift < 64)  { value |= bits << shift; }
+            p += nbBytes;
+        }
+        return p;
+    }
+
+    static u_int8_t* writeWords (u_int8_t* p, const u_int64_t* words)
+    {
+        size_t nb = NB_WORDS;
+        while (nb > 1 && words[nb-1] == 0)  { nb--; }
+        if (nb == 1)  { return writeWord (p, words[0]); }
+
+        u_int64_t w[NB_WORDS];
+        memcpy (w, words, sizeof(w));
+
+        while (true)
+        {
+            u_int8_t b = w[0] & 127;
+
+            /** We shift the nb significant words by 7 bits. */
+            for (size_t i=0; i<nb; i++)  {  w[i] = (w[i] >> 7) | (i+1 < nb ? w[i+1] << 57 : 0);  }
+            while (nb > 1 && w[nb-1] == 0)  { nb--; }
+
+            if (nb == 1 && w[0] == 0)  { *(p++) = b;  return p; }
+            *(p++) = b | 128;
+        }
+    }
+
+    static const u_int8_t* readWords (const u_int8_t* p, u_int64_t* words)
+    {
+        memset (words, 0, sizeof(u_int64_t)*NB_WORDS);
+
+        bool last = false;
+        for (size_t shift=0; !last; shift+=56)
+        {
+            size_t nbBytes;
+            u_int64_t bits = readGroups (p, nbBytes, last);
+            p += nbBytes;
+
+            size_t w = shift / 64, s = shift % 64;
+            if (w < NB_WORDS)                  { words[w]   |= bits << s;        }
+            if (s > 8 && w+1 < NB_WORDS)       { words[w+1] |= bits >> (64-s);   }
+        }
+        return p;
+    }
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_BLOCK_DELTA_CODEC_HPP_ */
@@ -32,6 +32,7 @@
 #include <gatb/tools/collections/api/Bag.hpp>
 #include <gatb/tools/math/LargeInt.hpp>
 #include <gatb/system/impl/System.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
 #include <gatb/system/api/types.hpp>
 #include <gatb/tools/misc/api/Enums.hpp>
 #include <bitset>
@@ -182,11 +183,13 @@ public:
      * \param[in] tai_bloom : size (in bits) of the bloom filter.
      * \param[in] nbHash : number of hash functions to use */
     BloomContainer (u_int64_t tai_bloom, size_t nbHash = 4)
-        : _hash(nbHash), n_hash_func(nbHash), blooma(0), tai(tai_bloom), nchar(0), isSizePowOf2(false)
+        : _hash(nbHash), n_hash_func(nbHash), blooma(0), tai(tai_bloom), nchar(0), isSizePowOf2(false),
+          _memory(system::impl::MEMORY_BLOOM)
     {
         nchar  = (1+tai/8LL);
         blooma = (unsigned char *) MALLOC (nchar*sizeof(unsigned char)); // 1 bit per elem
         system::impl::System::memory().memset (blooma, 0, nchar*sizeof(unsigned char));
+        _memory.set (nchar*sizeof(unsigned char));
 
         /** We look whether the provided size is a power of 2 or not.
          *   => if we have a power of two, we can optimize the modulo operations. */
@@ -262,6 +265,8 @@ protected:
     u_int64_t tai;
     u_int64_t nchar;
     bool      isSizePowOf2;
+
+    system::impl::MemoryCharge _memory;
 };
 
 /********************************************************************************/
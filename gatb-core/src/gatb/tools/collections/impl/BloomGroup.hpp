@@ -174,7 +174,7 @@ private:
 
 /********************************************************************************/
 
-/* EXPERIMENTAL (not documented). */
+/* EXPERIMENTAL (not documented). See BloomGroupIndex for a multi samples index. */
 template <typename Item, size_t prec=1> class BloomGroup : public system::SmartPointer
 {
 public:
@@ -290,11 +290,7 @@ public:
         {
             u_int64_t h1 = this->_hash (item, i) % this->_size;
 
-#if 1
-            this->_blooma[h1][q] |= mask;
-#else
             __sync_fetch_and_or (this->_blooma[h1].value + q, mask);
-#endif
         }
     }
 
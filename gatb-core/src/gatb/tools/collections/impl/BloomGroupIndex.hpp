@@ -0,0 +1,326 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file BloomGroupIndex.hpp
+ *  \brief Bit-sliced index of the Bloom filters of several samples
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_BLOOM_GROUP_INDEX_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_BLOOM_GROUP_INDEX_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/collections/impl/Bloom.hpp>
+#include <gatb/system/impl/System.hpp>
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Bit-sliced group of Bloom filters, one per sample
+ *
+ * This is the production version of the BloomGroup idea: N samples share the same
+ * hash functions and the same number of slots, and the bits of the N Bloom filters
+ * for one slot are stored contiguously. The index is therefore made of rows (one per
+ * slot) of ceil(N/64) words, bit j of a row telling whether slot is set in the filter
+ * of sample j.
+ *
+ * Looking for an item in all the samples at once needs only the nbHash rows of the item,
+ * each row being read in one contiguous (cache friendly) access; the AND of these rows
+ * gives the set of samples that may contain the item.
+ *
+ * Insertions are atomic, so several threads can fill the index at the same time (for
+ * instance one thread per sample or per partition of a sample).
+ *
+ * The index can be saved into a file whose layout is a header followed by the rows;
+ * such a file is mapped in memory (read only) by the constructor taking an uri, so
+ * big indexes can be queried without being loaded.
+ *
+ * Sample of use:
+ * \code
+ * BloomGroupIndex<NativeInt64> index (1000000, nbSamples);
+ * index.insert (item, 3);
+ * vector<u_int32_t> hits (nbSamples);
+ * index.count (items, nbItems, hits.data());
+ * \endcode
+ */
+template <typename Item> class BloomGroupIndex : public system::SmartPointer
+{
+public:
+
+    /** Constructor.
+     * \param[in] nbRows : number of slots of each Bloom filter
+     * \param[in] nbSamples : number of samples (ie. of Bloom filters)
+     * \param[in] nbHash : number of hash functions */
+    BloomGroupIndex (u_int64_t nbRows, size_t nbSamples, size_t nbHash=4)
+        : _hash(nbHash), _nbHash(nbHash), _nbRows(std::max (nbRows, (u_int64_t)1)), _nbSamples(nbSamples),
+          _nbWords((nbSamples+63)/64), _rows(0), _mapped(0), _mappedSize(0)
+    {
+        if (_nbHash == 0 || _nbHash > MAX_NB_HASH)  { throw system::Exception ("BloomGroupIndex: bad number of hash functions %d", _nbHash); }
+        if (_nbSamples == 0)                        { throw system::Exception ("BloomGroupIndex: no sample"); }
+
+        _rows = (u_int64_t*) CALLOC (_nbRows*_nbWords, sizeof(u_int64_t));
+    }
+
+    /** Constructor. The index is mapped (read only) from a file created by the 'save' method.
+     * \param[in] uri : file of the index */
+    BloomGroupIndex (const std::string& uri)
+        : _hash(0), _nbHash(0), _nbRows(0), _nbSamples(0), _nbWords(0), _rows(0), _mapped(0), _mappedSize(0)
+    {
+        _mapped = system::impl::System::file().mapFile (uri, _mappedSize);
+
+        if (_mappedSize < sizeof(Header))  {  unmap();  throw system::Exception ("BloomGroupIndex: bad file '%s'", uri.c_str());  }
+
+        const Header* header = (const Header*) _mapped;
+
+        if (header->magic != MAGIC || header->nbHash == 0 || header->nbHash > MAX_NB_HASH ||
+            header->nbWords != (header->nbSamples+63)/64 ||
+            _mappedSize != sizeof(Header) + header->nbRows*header->nbWords*sizeof(u_int64_t))
+        {
+            unmap();
+            throw system::Exception ("BloomGroupIndex: bad file '%s'", uri.c_str());
+        }
+
+        _nbHash    = header->nbHash;
+        _nbRows    = header->nbRows;
+        _nbSamples = header->nbSamples;
+        _nbWords   = header->nbWords;
+        _hash      = HashFunctors<Item> (_nbHash);
+        _rows      = (u_int64_t*) ((const char*)_mapped + sizeof(Header));
+    }
+
+    /** Destructor. */
+    ~BloomGroupIndex ()
+    {
+        if (_mapped)  { unmap(); }
+        else          { FREE (_rows); }
+    }
+
+    /** */
+    std::string getName () const { return "BloomGroupIndex"; }
+
+    /** Get the number of samples of the index.
+     * \return the number of samples. */
+    size_t getNbSamples () const { return _nbSamples; }
+
+    /** Get the number of hash functions.
+     * \return the number of hash functions. */
+    size_t getNbHash () const { return _nbHash; }
+
+    /** Get the number of rows (slots of each Bloom filter).
+     * \return the number of rows. */
+    u_int64_t getNbRows () const { return _nbRows; }
+
+    /** Return the size (in bytes). */
+    u_int64_t getMemSize () const { return _nbRows*_nbWords*sizeof(u_int64_t); }
+
+    /** Insert an item in the Bloom filter of a sample. Can be called concurrently.
+     * \param[in] item : item to be inserted
+     * \param[in] sampleIdx : index of the sample */
+    void insert (const Item& item, size_t sampleIdx)
+    {
+        if (_mapped)  { throw system::Exception ("BloomGroupIndex: cannot insert into a mapped index"); }
+
+        size_t    q    = sampleIdx / 64;
+        u_int64_t mask = ((u_int64_t)1) << (sampleIdx % 64);
+
+        for (size_t i=0; i<_nbHash; i++)
+        {
+            u_int64_t* word = _rows + (_hash (item,i) % _nbRows) * _nbWords + q;
+            if ((*word & mask) == 0)  {  __sync_fetch_and_or (word, mask);  }
+        }
+    }
+
+    /** Tell whether an item may be in the Bloom filter of a sample.
+     * \param[in] item : item to be looked for
+     * \param[in] sampleIdx : index of the sample
+     * \return false if the item is not in the sample, true if it may be. */
+    bool contains (const Item& item, size_t sampleIdx) const
+    {
+        size_t    q    = sampleIdx / 64;
+        u_int64_t mask = ((u_int64_t)1) << (sampleIdx % 64);
+
+        for (size_t i=0; i<_nbHash; i++)
+        {
+            if ((_rows [(_hash (item,i) % _nbRows) * _nbWords + q] & mask) == 0)  { return false; }
+        }
+        return true;
+    }
+
+    /** Get the set of samples that may contain an item.
+     * \param[in] item : item to be looked for
+     * \param[out] samples : bit set of getNbWords() words, bit j being set if sample j may contain the item */
+    void contains (const Item& item, u_int64_t* samples) const
+    {
+        const u_int64_t* rows[MAX_NB_HASH];
+        getRows (item, rows);
+
+        for (size_t w=0; w<_nbWords; w++)
+        {
+            u_int64_t res = rows[0][w];
+            for (size_t i=1; i<_nbHash; i++)  {  res &= rows[i][w];  }
+            samples[w] = res;
+        }
+    }
+
+    /** Get the number of samples that may contain an item.
+     * \param[in] item : item to be looked for
+     * \return the number of samples. */
+    size_t getNbSamples (const Item& item) const
+    {
+        const u_int64_t* rows[MAX_NB_HASH];
+        getRows (item, rows);
+
+        size_t result = 0;
+        for (size_t w=0; w<_nbWords; w++)
+        {
+            u_int64_t res = rows[0][w];
+            for (size_t i=1; i<_nbHash; i++)  {  res &= rows[i][w];  }
+            result += __builtin_popcountll (res);
+        }
+        return result;
+    }
+
+    /** Get the number of words of a bit set of samples.
+     * \return the number of words. */
+    size_t getNbWords () const { return _nbWords; }
+
+    /** Count, for each sample, the number of items that may belong to it. This is typically
+     * used with all the kmers of a read for knowing which samples contain the read.
+     *
+     * The counters are kept in bit-sliced form (one bit plane per bit of the counters), so
+     * adding the samples set of one item to the 64 counters of one word costs a few bitwise
+     * operations instead of 64 increments.
+     * \param[in] items : items to be looked for
+     * \param[in] nbItems : number of items
+     * \param[out] hits : array of getNbSamples() counters. */
+    void count (const Item* items, size_t nbItems, u_int32_t* hits) const
+    {
+        memset (hits, 0, _nbSamples*sizeof(u_int32_t));
+        if (nbItems == 0)  { return; }
+
+        /** Number of bit planes needed for counting up to nbItems. */
+        size_t nbPlanes = 64 - __builtin_clzll ((u_int64_t)nbItems);
+
+        std::vector<u_int64_t> planes (nbPlanes*_nbWords, 0);
+        std::vector<u_int64_t> samples (_nbWords);
+
+        for (size_t n=0; n<nbItems; n++)
+        {
+            contains (items[n], samples.data());
+
+            /** We add the samples set to the counters: ripple carry through the planes. */
+            for (size_t w=0; w<_nbWords; w++)
+            {
+                u_int64_t carry = samples[w];
+                for (size_t p=0; carry!=0 && p<nbPlanes; p++)
+                {
+                    u_int64_t& plane = planes[p*_nbWords+w];
+                    u_int64_t  tmp   = plane & carry;
+                    plane ^= carry;
+                    carry  = tmp;
+                }
+            }
+        }
+
+        /** We get back the counters from the bit planes. */
+        for (size_t p=0; p<nbPlanes; p++)
+        {
+            for (size_t w=0; w<_nbWords; w++)
+            {
+                for (u_int64_t plane = planes[p*_nbWords+w];  plane != 0;  plane &= plane-1)
+                {
+                    hits [w*64 + __builtin_ctzll(plane)] += ((u_int32_t)1) << p;
+                }
+            }
+        }
+    }
+
+    /** Save the index into a file that can be mapped afterwards.
+     * \param[in] uri : file of the index */
+    void save (const std::string& uri) const
+    {
+        system::IFile* file = system::impl::System::file().newFile (uri, "wb+");
+
+        Header header;
+        memset (&header, 0, sizeof(header));
+        header.magic     = MAGIC;
+        header.nbHash    = _nbHash;
+        header.nbRows    = _nbRows;
+        header.nbSamples = _nbSamples;
+        header.nbWords   = _nbWords;
+
+        file->fwrite (&header, sizeof(header), 1);
+        file->fwrite (_rows, sizeof(u_int64_t), _nbRows*_nbWords);
+        file->flush ();
+
+        delete file;
+    }
+
+private:
+
+    /** Header of the index file; its size keeps the rows aligned on a cache line. */
+    struct Header
+    {
+        u_int64_t magic;
+        u_int64_t nbHash;
+        u_int64_t nbRows;
+        u_int64_t nbSamples;
+        u_int64_t nbWords;
+        u_int64_t reserved[3];
+    };
+
+    static const u_int64_t MAGIC       = 0x3149474242544147ULL;  // "GATBBGI1"
+    static const size_t    MAX_NB_HASH = 10;
+
+    mutable HashFunctors<Item> _hash;
+    size_t             _nbHash;
+    u_int64_t          _nbRows;
+    size_t             _nbSamples;
+    size_t             _nbWords;
+    u_int64_t*         _rows;
+
+    const void*        _mapped;
+    u_int64_t          _mappedSize;
+
+    void getRows (const Item& item, const u_int64_t** rows) const
+    {
+        for (size_t i=0; i<_nbHash; i++)  {  rows[i] = _rows + (_hash (item,i) % _nbRows) * _nbWords;  }
+    }
+
+    void unmap ()
+    {
+        system::impl::System::file().unmapFile (_mapped, _mappedSize);
+        _mapped = 0;
+    }
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_BLOOM_GROUP_INDEX_HPP_ */
@@ -29,6 +29,8 @@
 #include <gatb/tools/storage/impl/Storage.hpp>
 #include <gatb/tools/misc/impl/Stringify.hpp>
 #include <gatb/tools/misc/impl/Progress.hpp>
+#include <gatb/system/impl/Tracer.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
 
 #include <BooPHF/BooPHF.h>
 
@@ -265,7 +267,7 @@ public:
     typedef u_int64_t Code;
 
     /** Constructor. */
-    BooPHF () : isBuilt(false), nbKeys(0)  {}
+    BooPHF () : isBuilt(false), nbKeys(0), _memory(system::impl::MEMORY_MPHF)  {}
 
     /** Build the hash function from a set of items.
      * \param[in] iterable : keys iterator
@@ -292,6 +294,8 @@ public:
 
         isBuilt = true;
         nbKeys  = iterable->getNbItems();
+
+        _memory.set (bphf.memoryBitSize() / 8);
     }
 
     /** Returns the hash code for the given key. WARNING : default implementation here will
@@ -314,6 +318,7 @@ public:
         tools::storage::impl::Storage::istream is (group, name);
 		bphf =  boophf_t();
         bphf.load (is);
+        _memory.set (bphf.memoryBitSize() / 8);
         return size();
     }
 
@@ -335,6 +340,8 @@ private:
     bool      isBuilt;
     size_t    nbKeys;
 
+    system::impl::MemoryCharge _memory;
+
 private:
 
     class iterator_adaptator : public std::iterator<std::forward_iterator_tag, const Key>
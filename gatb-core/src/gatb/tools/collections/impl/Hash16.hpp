@@ -32,6 +32,7 @@
 #include <gatb/tools/collections/api/Bag.hpp>
 #include <gatb/tools/misc/impl/Pool.hpp>
 #include <gatb/system/impl/System.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
 
 #include <set>
 #include <algorithm>
@@ -78,6 +79,9 @@ protected:
     /** Shortcut */
     system::IMemory& _memory;
 
+    /** Memory of the hash table declared to the accounting. */
+    system::impl::MemoryCharge _charge;
+
 public:
 
 
@@ -85,7 +89,8 @@ public:
     /** Constructor.
      * \param[in] sizeMB : approx max memory to be used by the hash table
      */
-    Hash16 (size_t sizeMB) : datah(0), mask(0), tai(0), nb_elem(0), max_nb_elem(0), _memory(system::impl::System::memory())
+    Hash16 (size_t sizeMB) : datah(0), mask(0), tai(0), nb_elem(0), max_nb_elem(0), _memory(system::impl::System::memory()),
+        _charge(system::impl::MEMORY_COUNTING)
     {
         int tai_Hash16 = std::max (
             (size_t) ceilf (log2f ((0.1*sizeMB*1024L*1024L)/sizeof(cell_ptr_t))),
@@ -108,13 +113,15 @@ public:
 		//printf("Hash 16 cell %lli   graine %i suiv %i val %i\n",sizeof(cell),sizeof(pcell.graine),sizeof(pcell.suiv),sizeof(pcell.val));
 
         _memory.memset (datah,0, tai * sizeof(cell_ptr_t));
+        _charge.set (tai * sizeof(cell_ptr_t));
     }
 
 	/** Constructor with directly number of entries wished, return really created in nb_created
 	 * \param[in] nb_entries : number of entries.
      * \param[in] nb_created : number of created items.
 	 */
-	Hash16 (u_int64_t nb_entries, u_int64_t * nb_created) : datah(0), mask(0), tai(0), nb_elem(0), max_nb_elem(0), _memory(system::impl::System::memory())
+	Hash16 (u_int64_t nb_entries, u_int64_t * nb_created) : datah(0), mask(0), tai(0), nb_elem(0), max_nb_elem(0), _memory(system::impl::System::memory()),
+        _charge(system::impl::MEMORY_COUNTING)
     {
         int tai_Hash16 = std::max (
 								   (size_t) ceilf (log2f (nb_entries)),
@@ -135,6 +142,7 @@ public:
 		//printf("Hash16 size asked in MB %zu  tai_Hash16 %i  nb entries %llu \n",sizeMB,tai_Hash16,tai);
 		
         _memory.memset (datah,0, tai * sizeof(cell_ptr_t));
+        _charge.set (tai * sizeof(cell_ptr_t));
     }
 	
 	u_int64_t getByteSize()
@@ -31,9 +31,13 @@
 #include <gatb/tools/designpattern/api/Iterator.hpp>
 #include <gatb/tools/collections/api/Iterable.hpp>
 #include <gatb/system/impl/System.hpp>
+#include <gatb/tools/collections/impl/IteratorPrefetch.hpp>
+#include <gatb/tools/collections/impl/BlockDeltaCodec.hpp>
 
 #include <string>
 #include <vector>
+#include <atomic>
+#include <memory>
 #include <zlib.h>
 
 /********************************************************************************/
@@ -169,7 +173,8 @@ public:
      */
     IterableFile (const std::string& filename, size_t cacheItemsNb=10000)
         :   _filename(filename), _cacheItemsNb (cacheItemsNb), 
-        _file(0)  // hacking my own iterator, for getItems, separate from IteratorFile. dirty, but nothing used to work at all. _file is used in getItems() only
+        _file(0),  // hacking my own iterator, for getItems, separate from IteratorFile. dirty, but nothing used to work at all. _file is used in getItems() only
+        _synchro(system::impl::System::thread().newSynchronizer())
     {
         // if the file doesn't exist (meaning that BagFile hasn't created it yet), let's create it just for the sake of it. but then we'll open it just for reading
         if (!system::impl::System::file().doesExist(filename))
@@ -185,10 +190,16 @@ public:
     /** Destructor. */
     ~IterableFile () {
         if (_file)  { delete _file;  }
+        delete _synchro;
     }
 
-    /** \copydoc Iterable::iterator */
-    dp::Iterator<Item>* iterator ()  { return new IteratorFile<Item> (_filename, _cacheItemsNb); }
+    /** \copydoc Iterable::iterator
+     * Large files are read ahead in a background thread (see PrefetchSettings). */
+    dp::Iterator<Item>* iterator ()
+    {
+        if (PrefetchSettings::enabled (getNbItems(), _cacheItemsNb))  { return new IteratorPrefetch<Item> (this, _cacheItemsNb, PrefetchSettings::depth()); }
+        return new IteratorFile<Item> (_filename, _cacheItemsNb);
+    }
 
     /** \copydoc Iterable::getNbItems */
     int64_t getNbItems ()   {  
@@ -206,16 +217,17 @@ public:
     /* from ../src/gatb/tools/collections/api/Iterable.hpp:
        Return a buffer of items.
         * \param[out] buffer : the buffer
-        * \param[in] start : index where to start in the buffer --> NOTE: it is ignored here because we're not buffering anything (this ties in with a different behavior in istream of Storage with CurrentIdx, depending on STORAGE_FILE or STORAGE_HDF5, currentIdx should be set to 0 when calling getItems, which in turns calls this function)
+        * \param[in] start : index (in the file) of the first item to be retrieved; same semantics as in IterableHDF5
         * \param[in] nb : number of items to be retrieved
         * \return the number of items retrieved 
+       items are read with a positional read (no shared file position), so several threads
+       may call getItems on the same file at the same time without any lock.
     */
     size_t getItems (Item*& buffer, size_t start, size_t nb)
     {
-        if (_file == 0) 
-            _file = system::impl::System::file().newFile (_filename, "rb"); 
-        DEBUG_ITERATORFILE(std::cout << "want to read " << nb << " elements of size " << sizeof(Item) << " at position " << _file->tell() << " file size " << _file->getSize() /*<< " then write them to buffer at position " << (sizeof(Item) * start) << std::endl*/;)
-        size_t n = _file->fread (buffer /*+ sizeof(Item) * start*/, sizeof(Item), nb);
+        system::IFile* file = getFile();
+        DEBUG_ITERATORFILE(std::cout << "want to read " << nb << " elements of size " << sizeof(Item) << " at index " << start << " file size " << file->getSize() << std::endl;)
+        size_t n = file->pread (buffer, sizeof(Item), nb, (u_int64_t)start * sizeof(Item));
         DEBUG_ITERATORFILE(std::cout << "read " << n << " elements" << std::endl;)
         return n;
     }
@@ -223,7 +235,304 @@ public:
 private:
     std::string     _filename;
     size_t          _cacheItemsNb;
-    system::IFile*  _file;
+    std::atomic<system::IFile*>  _file;
+    system::ISynchronizer*       _synchro;
+
+    /** The file used by getItems is opened lazily (it is not needed when only iterating);
+     * the synchronizer is only taken the first time. */
+    system::IFile* getFile ()
+    {
+        if (_file == 0)
+        {
+            system::LocalSynchronizer ls (_synchro);
+            if (_file == 0)  { _file = system::impl::System::file().newFile (_filename, "rb"); }
+        }
+        return _file;
+    }
+};
+
+/********************************************************************************/
+
+template <class Item> class IteratorDeltaFile;
+
+/** \brief Implementation of the Iterable interface for a file written by BagDeltaFile
+ *
+ * The headers of the blocks are read once into an index, which gives the number of items and
+ * the block holding a given item index without decoding anything. The file size is checked
+ * again (and the index built again if the file grew) only after a call to 'refresh', which
+ * CollectionDeltaFile does when its bag is flushed, or when an item after the last indexed one
+ * is requested. A value can be looked for with 'find', which only decodes the blocks whose
+ * [min,max] range holds the value.
+ *
+ * Big files are iterated with an IteratorPrefetch (see PrefetchSettings), so the blocks are
+ * read and decoded by a background thread while the previous ones are iterated.
+ */
+template <class Item> class IterableDeltaFile : public tools::collections::Iterable<Item>, public virtual system::SmartPointer
+{
+public:
+
+    typedef BlockDeltaCodec<Item>     Codec;
+    typedef typename Codec::Key       Key;
+    typedef typename Codec::Header    Header;
+
+    /** Location of a block in the file. */
+    struct Block
+    {
+        u_int64_t offset;     //!< offset of the payload in the file
+        u_int64_t firstItem;  //!< index of the first item of the block
+        Header    header;
+    };
+
+    /** Blocks of the file, for a given file size. */
+    struct Index
+    {
+        Index () : nbItems(0), fileSize(0) {}
+        std::vector<Block> blocks;
+        u_int64_t          nbItems;
+        u_int64_t          fileSize;
+    };
+
+    /** Constructor
+     * \param[in] filename : name of the file to be iterated. */
+    IterableDeltaFile (const std::string& filename)
+        :   _filename(filename), _file(0), _synchro(system::impl::System::thread().newSynchronizer()), _checkSize(true)  {}
+
+    /** Destructor. */
+    ~IterableDeltaFile ()
+    {
+        if (_file)  { delete _file;  }
+        delete _synchro;
+    }
+
+    /** \copydoc Iterable::iterator */
+    dp::Iterator<Item>* iterator ()
+    {
+        size_t blockSize = BlockDeltaSettings::blockSize();
+        if (PrefetchSettings::enabled (getNbItems(), blockSize))  { return new IteratorPrefetch<Item> (this, blockSize, PrefetchSettings::depth()); }
+        return new IteratorDeltaFile<Item> (this);
+    }
+
+    /** \copydoc Iterable::getNbItems */
+    int64_t getNbItems ()  { return getIndex()->nbItems; }
+
+    /** \copydoc Iterable::estimateNbItems */
+    int64_t estimateNbItems ()   {  return getNbItems(); }
+
+    /** \copydoc Iterable::getItems(Item*& buffer, size_t start, size_t nb)
+     * Only the blocks holding the requested items are read. */
+    size_t getItems (Item*& buffer, size_t start, size_t nb)
+    {
+        std::shared_ptr<const Index> index = getIndex();
+
+        /** The file may have grown since the index was built. */
+        if (start >= index->nbItems)  {  refresh();  index = getIndex();  }
+
+        const std::vector<Block>& blocks = index->blocks;
+
+        /** We look for the block holding the item 'start'. */
+        size_t k = std::upper_bound (blocks.begin(), blocks.end(), (u_int64_t)start, FirstItemLess()) - blocks.begin();
+        if (k == 0)  { return 0; }
+
+        std::vector<u_int8_t> bytes;
+        std::vector<Item>     items;
+        size_t n = 0;
+
+        for (k--; k<blocks.size() && n<nb; k++)
+        {
+            const Block& block = blocks[k];
+            size_t from  = start + n - block.firstItem;
+            size_t count = std::min ((size_t)block.header.nbItems - from, nb - n);
+
+            if (from == 0 && count == block.header.nbItems)  {  readBlock (block, bytes, buffer + n);  }
+            else
+            {
+                items.resize (block.header.nbItems);
+                readBlock (block, bytes, items.data());
+                std::copy (items.begin() + from, items.begin() + from + count, buffer + n);
+            }
+            n += count;
+        }
+        return n;
+    }
+
+    /** Look for an item given its value.
+     * \param[in] value : the value to look for
+     * \param[out] result : the item, if found
+     * \return true if the value is found */
+    bool find (const Key& value, Item& result)
+    {
+        std::shared_ptr<const Index> index = getIndex();
+
+        std::vector<u_int8_t> bytes;
+        std::vector<Item>     items;
+
+        for (size_t k=0; k<index->blocks.size(); k++)
+        {
+            const Block& block = index->blocks[k];
+            if (Codec::less (value, block.header.min) || Codec::less (block.header.max, value))  { continue; }
+
+            items.resize (block.header.nbItems);
+            readBlock (block, bytes, items.data());
+
+            typename std::vector<Item>::iterator it = std::lower_bound (items.begin(), items.end(), value, ValueLess());
+            if (it != items.end() && !Codec::less (value, it->value))  { result = *it;  return true; }
+        }
+        return false;
+    }
+
+    /** Get the index of the blocks. It is built at the first call, and built again if the file
+     * size changed since the last call to 'refresh'.
+     * \return the index */
+    std::shared_ptr<const Index> getIndex ()
+    {
+        system::LocalSynchronizer ls (_synchro);
+
+        if (_checkSize)
+        {
+            u_int64_t size = system::impl::System::file().doesExist(_filename) ? system::impl::System::file().getSize(_filename) : 0;
+
+            if (!_index || _index->fileSize != size)  {  _index = buildIndex (size);  }
+
+            _checkSize = false;
+        }
+
+        return _index;
+    }
+
+    /** Tells that the file may have changed: its size is checked again at the next getIndex. */
+    void refresh ()
+    {
+        system::LocalSynchronizer ls (_synchro);
+        _checkSize = true;
+    }
+
+    /** Read and decode a block.
+     * \param[in] block : the block to be read
+     * \param[in,out] bytes : buffer for the payload
+     * \param[out] items : array of block.header.nbItems items
+     * \return the number of items */
+    size_t readBlock (const Block& block, std::vector<u_int8_t>& bytes, Item* items)
+    {
+        /** The decoder reads a few bytes after the payload. */
+        bytes.resize (block.header.nbBytes + Codec::PADDING);
+        if (getFile()->pread (bytes.data(), sizeof(u_int8_t), block.header.nbBytes, block.offset) != block.header.nbBytes)
+        {
+            throw system::Exception ("Unable to read a block of %s", _filename.c_str());
+        }
+        Codec::decode (bytes.data(), block.header, items);
+        return block.header.nbItems;
+    }
+
+private:
+
+    std::string                   _filename;
+    std::atomic<system::IFile*>   _file;
+    system::ISynchronizer*        _synchro;
+    std::shared_ptr<const Index>  _index;
+    bool                          _checkSize;
+
+    struct FirstItemLess  {  bool operator() (u_int64_t idx, const Block& b) const  { return idx < b.firstItem; }  };
+    struct ValueLess      {  bool operator() (const Item& item, const Key& value) const  { return Codec::less (item.value, value); }  };
+
+    /** The file is opened lazily, since it may not exist yet when the iterable is built. */
+    system::IFile* getFile ()
+    {
+        if (_file == 0)
+        {
+            system::LocalSynchronizer ls (_synchro);
+            if (_file == 0)  { _file = system::impl::System::file().newFile (_filename, "rb"); }
+        }
+        return _file;
+    }
+
+    /** Reads the headers of the blocks; a block not entirely written yet is ignored. */
+    std::shared_ptr<const Index> buildIndex (u_int64_t size)
+    {
+        std::shared_ptr<Index> result (new Index());
+        result->fileSize = size;
+
+        if (size == 0)  { return result; }
+
+        system::IFile* file = system::impl::System::file().newFile (_filename, "rb");
+
+        char mark[Codec::MAGIC_SIZE];
+        if (file->pread (mark, 1, Codec::MAGIC_SIZE, 0) != Codec::MAGIC_SIZE || memcmp (mark, Codec::magic(), Codec::MAGIC_SIZE) != 0)
+        {
+            delete file;
+            throw system::Exception ("File %s is not a delta compressed file", _filename.c_str());
+        }
+
+        Block block;
+        for (u_int64_t offset = Codec::MAGIC_SIZE; offset + sizeof(Header) <= size; )
+        {
+            if (file->pread (&block.header, sizeof(Header), 1, offset) != 1)  { break; }
+
+            block.offset    = offset + sizeof(Header);
+            block.firstItem = result->nbItems;
+            if (block.offset + block.header.nbBytes > size)  { break; }
+
+            result->blocks.push_back (block);
+            result->nbItems += block.header.nbItems;
+            offset = block.offset + block.header.nbBytes;
+        }
+
+        delete file;
+        return result;
+    }
+};
+
+/** \brief Iterator over a file written by BagDeltaFile; the blocks are decoded one after the other. */
+template <class Item> class IteratorDeltaFile : public dp::Iterator<Item>
+{
+public:
+
+    /** Constructor.
+     * \param[in] ref : the iterable, which must outlive the iterator */
+    IteratorDeltaFile (IterableDeltaFile<Item>* ref) : _ref(ref), _block(0), _size(0), _idx(0), _isDone(true)  {}
+
+    /** \copydoc dp::Iterator::first */
+    void first()
+    {
+        _index  = _ref->getIndex();
+        _block  = 0;
+        _size   = 0;
+        _idx    = 0;
+        _isDone = false;
+        next ();
+    }
+
+    /** \copydoc dp::Iterator::next */
+    void next()
+    {
+        if (_idx >= _size)
+        {
+            if (_block >= _index->blocks.size())  { _isDone = true;  return; }
+
+            const typename IterableDeltaFile<Item>::Block& block = _index->blocks[_block++];
+            if (_items.size() < block.header.nbItems)  { _items.resize (block.header.nbItems); }
+
+            _size = _ref->readBlock (block, _bytes, _items.data());
+            _idx  = 0;
+        }
+        *(this->_item) = _items[_idx++];
+    }
+
+    /** \copydoc dp::Iterator::isDone */
+    bool isDone()  { return _isDone; }
+
+    /** \copydoc dp::Iterator::item */
+    Item& item ()  { return *(this->_item); }
+
+private:
+
+    IterableDeltaFile<Item>*  _ref;
+    std::shared_ptr<const typename IterableDeltaFile<Item>::Index> _index;
+    size_t                    _block;
+    std::vector<u_int8_t>     _bytes;
+    std::vector<Item>         _items;
+    size_t                    _size;
+    size_t                    _idx;
+    bool                      _isDone;
 };
     
 /********************************************************************************/
@@ -0,0 +1,333 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file IteratorPrefetch.hpp
+ *  \brief Iterator reading ahead the items of an iterable in a background thread
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_ITERATOR_PREFETCH_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_ITERATOR_PREFETCH_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/designpattern/api/Iterator.hpp>
+#include <gatb/tools/collections/api/Iterable.hpp>
+#include <gatb/system/impl/System.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Statistics of the read-ahead iterators */
+struct PrefetchStats
+{
+    PrefetchStats () : nbBlocks(0), nbStalls(0), stallTime(0), readTime(0) {}
+
+    u_int64_t nbBlocks;   //!< number of blocks read
+    u_int64_t nbStalls;   //!< number of times the iteration waited for a block
+    u_int64_t stallTime;  //!< time spent by the iteration waiting for blocks (usec)
+    u_int64_t readTime;   //!< time spent by the background thread in the reads (usec)
+
+    /** Statistics gathered since a previous copy of the statistics.
+     * \param[in] start : the previous copy
+     * \return the difference */
+    PrefetchStats since (const PrefetchStats& start) const
+    {
+        PrefetchStats result;
+        result.nbBlocks  = nbBlocks  - start.nbBlocks;
+        result.nbStalls  = nbStalls  - start.nbStalls;
+        result.stallTime = stallTime - start.stallTime;
+        result.readTime  = readTime  - start.readTime;
+        return result;
+    }
+
+    /** Add the statistics of an iterator; may be called by several threads. */
+    void add (const PrefetchStats& other)
+    {
+        __sync_fetch_and_add (&nbBlocks,  other.nbBlocks);
+        __sync_fetch_and_add (&nbStalls,  other.nbStalls);
+        __sync_fetch_and_add (&stallTime, other.stallTime);
+        __sync_fetch_and_add (&readTime,  other.readTime);
+    }
+};
+
+/** \brief Settings of the read-ahead of IterableFile and IterableHDF5 iterators
+ *
+ * The iterators of these iterables read ahead when the depth is not 0 and the iterated
+ * collection holds at least minNbBlocks blocks; smaller collections are read directly,
+ * since there is nothing to overlap there.
+ */
+class PrefetchSettings
+{
+public:
+
+    /** Number of blocks read ahead, 0 disabling the read-ahead. */
+    static size_t& depth ()        { static size_t value = 2;  return value; }
+
+    /** Minimum number of blocks of a collection for reading it ahead. */
+    static size_t& minNbBlocks ()  { static size_t value = 4;  return value; }
+
+    /** Statistics of all the read-ahead iterators, updated when they stop. */
+    static PrefetchStats& totals ()  { static PrefetchStats value;  return value; }
+
+    /** Tells whether a collection is read ahead.
+     * \param[in] nbItems : number of items of the collection
+     * \param[in] blockSize : number of items of a block
+     * \return true if the collection is to be read ahead */
+    static bool enabled (u_int64_t nbItems, size_t blockSize)  { return depth() > 0 && nbItems >= (u_int64_t)minNbBlocks() * blockSize; }
+};
+
+/********************************************************************************/
+
+/** \brief Iterator reading ahead the items of an iterable in a background thread
+ *
+ * The items are read by blocks with the positional Iterable::getItems (buffer, start, nb), which
+ * IterableFile and IterableHDF5 implement, into a ring of 'depth' blocks: while the items of a
+ * block are iterated, the next blocks are read by the background thread. The thread is started
+ * by first() and stopped when the iteration is over, when first() is called again, or when the
+ * iterator is deleted.
+ *
+ * The iterator holds a token on the iterable (use/forget), which is released once the background
+ * thread is stopped. The getItems method of the iterable must be callable from another thread.
+ */
+template <class Item> class IteratorPrefetch : public dp::Iterator<Item>
+{
+public:
+
+    /** Constructor.
+     * \param[in] ref : iterable to be read
+     * \param[in] blockSize : number of items of a block
+     * \param[in] depth : number of blocks of the ring */
+    IteratorPrefetch (Iterable<Item>* ref, size_t blockSize=10000, size_t depth=2)
+        : _ref(0), _blockSize(std::max (blockSize, (size_t)1)), _depth(std::max (depth, (size_t)1)),
+          _sizes(_depth, 0), _thread(0), _stop(false), _nbReady(0), _hasError(false),
+          _total(0), _slot(0), _block(0), _size(0), _idx(0), _hasBlock(false), _isDone(true)
+    {
+        setRef (ref);
+        for (size_t i=0; i<_depth; i++)  { _blocks.push_back ((Item*) MALLOC (sizeof(Item) * _blockSize)); }
+    }
+
+    /** Destructor. */
+    ~IteratorPrefetch ()
+    {
+        stop (false);
+        for (size_t i=0; i<_blocks.size(); i++)  { FREE (_blocks[i]); }
+        setRef (0);
+    }
+
+    /** \copydoc dp::Iterator::first */
+    void first()
+    {
+        stop ();
+
+        _total    = _ref->getNbItems();
+        _stop     = false;
+        _nbReady  = 0;
+        _hasError = false;
+        _slot     = 0;
+        _size     = 0;
+        _idx      = 0;
+        _hasBlock = false;
+        _isDone   = false;
+        _stats    = PrefetchStats();
+
+        _thread = system::impl::System::thread().newThread (mainloop, this);
+
+        next ();
+    }
+
+    /** \copydoc dp::Iterator::next */
+    void next()
+    {
+        if (_idx >= _size)
+        {
+            nextBlock ();
+            if (_isDone)  { return; }
+        }
+        *(this->_item) = _block[_idx++];
+    }
+
+    /** \copydoc dp::Iterator::isDone */
+    bool isDone()  { return _isDone; }
+
+    /** \copydoc dp::Iterator::item */
+    Item& item ()  { return *(this->_item); }
+
+    /** Get the statistics of the last iteration, once it is over.
+     * \return the statistics */
+    const PrefetchStats& getStats () const  { return _stats; }
+
+private:
+
+    Iterable<Item>*  _ref;
+    void setRef (Iterable<Item>* ref)  { SP_SETATTR(ref); }
+
+    size_t           _blockSize;
+    size_t           _depth;
+
+    /** Ring of blocks, shared with the background thread. */
+    std::vector<Item*>       _blocks;
+    std::vector<size_t>      _sizes;    // 0 marks the end of the items
+    system::IThread*         _thread;
+    std::mutex               _mutex;
+    std::condition_variable  _cond;
+    bool                     _stop;
+    size_t                   _nbReady;
+    bool                     _hasError;
+    system::Exception        _error;
+    u_int64_t                _total;
+
+    /** Consumer side. */
+    size_t  _slot;
+    Item*   _block;
+    size_t  _size;
+    size_t  _idx;
+    bool    _hasBlock;
+    bool    _isDone;
+
+    PrefetchStats _stats;
+
+    static u_int64_t elapsed (std::chrono::steady_clock::time_point t0)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now() - t0).count();
+    }
+
+    /** Gives back the current block to the background thread and waits for the next one. */
+    void nextBlock ()
+    {
+        std::unique_lock<std::mutex> lock (_mutex);
+
+        if (_hasBlock)
+        {
+            _slot = (_slot + 1) % _depth;
+            _nbReady--;
+            _cond.notify_all();
+        }
+
+        if (_nbReady == 0)
+        {
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            _cond.wait (lock, [this] { return _nbReady > 0; });
+            _stats.nbStalls  ++;
+            _stats.stallTime += elapsed (t0);
+        }
+
+        _hasBlock = true;
+        _block    = _blocks[_slot];
+        _size     = _sizes [_slot];
+        _idx      = 0;
+
+        if (_size == 0)
+        {
+            lock.unlock ();
+            _isDone = true;
+            stop ();
+        }
+    }
+
+    /** Stops the background thread and records its statistics; a read error is thrown here. */
+    void stop (bool rethrow=true)
+    {
+        if (_thread == 0)  { return; }
+
+        {
+            std::unique_lock<std::mutex> lock (_mutex);
+            _stop = true;
+            _cond.notify_all();
+        }
+        _thread->join();
+        delete _thread;
+        _thread = 0;
+
+        PrefetchSettings::totals().add (_stats);
+
+        if (_hasError && rethrow)  { _hasError = false;  throw _error; }
+    }
+
+    /** Background thread: reads the blocks as long as the ring has a free slot. */
+    void readLoop ()
+    {
+        u_int64_t pos  = 0;
+        size_t    slot = 0;
+
+        while (true)
+        {
+            u_int64_t readTime = 0;
+
+            {
+                std::unique_lock<std::mutex> lock (_mutex);
+                _cond.wait (lock, [this] { return _stop || _nbReady < _depth; });
+                if (_stop)  { return; }
+            }
+
+            size_t n = 0;
+            if (pos < _total)
+            {
+                std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+                try
+                {
+                    Item* buffer = _blocks[slot];
+                    n = _ref->getItems (buffer, pos, std::min ((u_int64_t)_blockSize, _total - pos));
+                }
+                catch (system::Exception& e)
+                {
+                    std::unique_lock<std::mutex> lock (_mutex);
+                    _error = e;  _hasError = true;  n = 0;
+                }
+                readTime = elapsed (t0);
+            }
+
+            {
+                std::unique_lock<std::mutex> lock (_mutex);
+                _stats.readTime += readTime;
+                if (n > 0)  { _stats.nbBlocks ++; }
+                _sizes[slot] = n;
+                _nbReady++;
+                _cond.notify_all();
+            }
+
+            if (n == 0)  { return; }
+
+            pos += n;
+            slot = (slot + 1) % _depth;
+        }
+    }
+
+    static void* mainloop (void* arg)
+    {
+        ((IteratorPrefetch<Item>*) arg)->readLoop();
+        return 0;
+    }
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_ITERATOR_PREFETCH_HPP_ */
@@ -0,0 +1,286 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file RibbonFilter.hpp
+ *  \brief Static approximate membership filter (ribbon filter)
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_RIBBON_FILTER_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_RIBBON_FILTER_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/collections/api/Container.hpp>
+#include <gatb/tools/math/LargeInt.hpp>
+#include <gatb/system/impl/System.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
+#include <gatb/system/api/types.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Ribbon filter with fingerprints of 1 to 16 bits
+ *
+ * Static set of items: all the items are known when the filter is built and no item can
+ * be added afterwards. The filter has a false positive rate of 1/2^nbBits and uses about
+ * 1.07 to 1.15 times nbBits bits per item (the ratio growing slowly with the number of items).
+ *
+ * Each item has a start slot and a 64 bits coefficient; its fingerprint is the XOR of the
+ * solution rows of the 64 slots following the start slot, selected by the coefficient. The
+ * solution is stored by blocks of 64 slots, one word per fingerprint bit, so a query reads
+ * 2*nbBits consecutive words (48 bytes for 3 bits fingerprints) instead of slots scattered
+ * over the whole array.
+ *
+ * The filter is built from the hash codes of the items (see hashItem), so the hash codes
+ * can be computed in parallel by the caller before the (sequential) construction.
+ *
+ * Sample of use:
+ * \code
+ * std::vector<u_int64_t> keys;
+ * for (...)  { keys.push_back (RibbonFilter<Type>::hashItem (item)); }
+ * RibbonFilter<Type> filter (keys.size(), 8);
+ * filter.build (keys);
+ * bool b = filter.contains (item);
+ * \endcode
+ */
+template <typename Item> class RibbonFilter : public Container<Item>, public system::SmartPointer
+{
+public:
+
+    /** Maximum number of bits of the fingerprints. */
+    static const size_t MAX_NB_BITS = 16;
+
+    /** Constructor.
+     * \param[in] nbItems : number of items to be put in the filter.
+     * \param[in] nbBits : number of bits of the fingerprints. */
+    RibbonFilter (u_int64_t nbItems, size_t nbBits) : _nbSlots(0), _nbBits(nbBits), _seed(0)
+    {
+        if (_nbBits < 1 || _nbBits > MAX_NB_BITS)  { throw system::Exception ("RibbonFilter: bad number of bits (%ld)", _nbBits); }
+        setNbSlots ((u_int64_t) (getSlotsPerItem(nbItems) * nbItems));
+    }
+
+    /** Constructor of a filter whose solution is set through getArray (loading from a storage).
+     * \param[in] nbSlots : number of slots of the filter
+     * \param[in] nbBits : number of bits of the fingerprints
+     * \param[in] seed : seed used for building the filter. */
+    RibbonFilter (u_int64_t nbSlots, size_t nbBits, u_int64_t seed) : _nbSlots(0), _nbBits(nbBits), _seed(seed)
+    {
+        if (_nbBits < 1 || _nbBits > MAX_NB_BITS)  { throw system::Exception ("RibbonFilter: bad number of bits (%ld)", _nbBits); }
+        setNbSlots (nbSlots);
+    }
+
+    /** Number of slots per item needed for building the filter with a good probability.
+     * \param[in] nbItems : number of items of the filter
+     * \return the number of slots per item. */
+    static double getSlotsPerItem (u_int64_t nbItems)
+    {
+        return nbItems <= 10000 ? 1.07 : 1.07 + 0.02 * log10 ((double)nbItems / 10000);
+    }
+
+    /** Get the hash code of an item, as expected by the build method.
+     * \param[in] item : the item
+     * \return the hash code. */
+    static u_int64_t hashItem (const Item& item)  { return hash1 (item, 0); }
+
+    /** Build the filter. The hash codes are sorted and their duplicates removed.
+     * \param[in] keys : hash codes (see hashItem) of the items of the filter. */
+    void build (std::vector<u_int64_t>& keys)
+    {
+        std::sort (keys.begin(), keys.end());
+        keys.erase (std::unique (keys.begin(), keys.end()), keys.end());
+
+        if (keys.size() > _nbSlots)  { throw system::Exception ("RibbonFilter: too many items (%ld)", keys.size()); }
+
+        std::vector<u_int64_t> hashes (keys.size());
+        std::vector<u_int64_t> coeffs;
+        std::vector<u_int16_t> results;
+
+        /** The banding fails with a small probability; we then try another seed, and we
+         * add some slots after a few failures. */
+        for (size_t attempt=0; ; attempt++)
+        {
+            if (attempt > 40)  { throw system::Exception ("RibbonFilter: unable to build the filter"); }
+
+            if (attempt > 0)
+            {
+                _seed = mix (_seed + attempt);
+                if (attempt % 4 == 0)  { setNbSlots (_nbSlots + _nbSlots/50); }
+            }
+
+            /** The start slot grows with the hash code, so sorting the hash codes makes the
+             * banding go through the slots in order. */
+            for (size_t i=0; i<keys.size(); i++)  {  hashes[i] = mix (keys[i] + _seed);  }
+            std::sort (hashes.begin(), hashes.end());
+
+            coeffs.assign  (_nbSlots, 0);
+            results.assign (_nbSlots, 0);
+
+            if (band (hashes, coeffs, results))  { break; }
+        }
+
+        /** We solve the system by back substitution, from the last slot to the first one.
+         * state[b] holds the bit b of the solution rows of the 64 slots starting at slot i. */
+        u_int64_t state[MAX_NB_BITS];
+        for (size_t b=0; b<_nbBits; b++)  { state[b] = 0; }
+
+        std::fill (_solution.begin(), _solution.end(), 0);
+
+        for (u_int64_t i=_nbSlots; i>0; i--)
+        {
+            u_int64_t slot  = i-1;
+            u_int64_t coeff = coeffs[slot];
+
+            for (size_t b=0; b<_nbBits; b++)
+            {
+                state[b] <<= 1;
+                u_int64_t bit = ((results[slot] >> b) & 1) ^ __builtin_parityll (coeff & state[b]);
+                state[b] |= bit;
+            }
+
+            if ((slot & 63) == 0)
+            {
+                for (size_t b=0; b<_nbBits; b++)  { _solution[(slot>>6)*_nbBits + b] = state[b]; }
+            }
+        }
+    }
+
+    /** \copydoc Container::contains */
+    bool contains (const Item& item)
+    {
+        u_int64_t h     = mix (hashItem(item) + _seed);
+        u_int64_t start = getStart (h);
+        u_int64_t coeff = getCoeff (h);
+
+        const u_int64_t* w0 = _solution.data() + (start>>6) * _nbBits;
+        const u_int64_t* w1 = w0 + _nbBits;
+        size_t shift = start & 63;
+
+        u_int64_t result = 0;
+        for (size_t b=0; b<_nbBits; b++)
+        {
+            /** Bits of the 64 slots from the start slot; the last block is followed by an empty block. */
+            u_int64_t word = (w0[b] >> shift) | ((w1[b] << 1) << (63-shift));
+            result |= ((u_int64_t) __builtin_parityll (word & coeff)) << b;
+        }
+
+        return result == getFingerprint (h);
+    }
+
+    /** Get the solution array.
+     * \return the array. */
+    u_int64_t* getArray ()  { return _solution.data(); }
+
+    /** Get the size of the solution array.
+     * \return the size in bytes. */
+    u_int64_t getSize ()  { return _solution.size() * sizeof(u_int64_t); }
+
+    /** Get the size of the filter.
+     * \return the size in bits. */
+    u_int64_t getBitSize ()  { return 8*getSize(); }
+
+    /** Get the number of slots of the filter.
+     * \return the number of slots. */
+    u_int64_t getNbSlots () const  { return _nbSlots; }
+
+    /** Get the number of bits of the fingerprints.
+     * \return the number of bits. */
+    size_t getNbBits () const  { return _nbBits; }
+
+    /** Get the seed used for building the filter.
+     * \return the seed. */
+    u_int64_t getSeed () const  { return _seed; }
+
+private:
+
+    u_int64_t _nbSlots;
+    size_t    _nbBits;
+    u_int64_t _seed;
+
+    /** Solution rows, by blocks of 64 slots: word b of a block holds the bit b of its 64 rows. */
+    std::vector<u_int64_t, system::impl::TrackedAllocator<u_int64_t,system::impl::MEMORY_BLOOM> > _solution;
+
+    /** Set the number of slots: a multiple of 64, with one more empty block for the queries. */
+    void setNbSlots (u_int64_t nbSlots)
+    {
+        _nbSlots = std::max ((u_int64_t)64, (nbSlots + 63) & ~((u_int64_t)63));
+        _solution.assign ((_nbSlots/64 + 1) * _nbBits, 0);
+    }
+
+    /** Finalizer of MurmurHash3. */
+    static u_int64_t mix (u_int64_t h)
+    {
+        h ^= h >> 33;  h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;  h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /** Start slot of a hash code, in [0, nbSlots-64]; it grows with the hash code. */
+    u_int64_t getStart (u_int64_t h) const  {  return (u_int64_t) (((__uint128_t)h * (_nbSlots-63)) >> 64);  }
+
+    /** Coefficient of a hash code; its first bit is set so that the start slot is always used. */
+    static u_int64_t getCoeff (u_int64_t h)  {  return mix (h ^ 0x9e3779b97f4a7c15ULL) | 1;  }
+
+    /** Fingerprint of a hash code, from its low bits (the start slot comes from its high bits). */
+    u_int64_t getFingerprint (u_int64_t h) const  {  return h & ((((u_int64_t)1) << _nbBits) - 1);  }
+
+    /** Gaussian elimination of the items (sorted hash codes) into a band of 64 coefficients
+     * per slot, each row being kept with its first coefficient bit on its slot.
+     * \return false if the system has no solution. */
+    bool band (const std::vector<u_int64_t>& hashes, std::vector<u_int64_t>& coeffs, std::vector<u_int16_t>& results) const
+    {
+        for (size_t i=0; i<hashes.size(); i++)
+        {
+            u_int64_t h      = hashes[i];
+            u_int64_t slot   = getStart (h);
+            u_int64_t coeff  = getCoeff (h);
+            u_int16_t result = getFingerprint (h);
+
+            for (;;)
+            {
+                if (coeffs[slot] == 0)  {  coeffs[slot] = coeff;  results[slot] = result;  break;  }
+
+                coeff  ^= coeffs[slot];
+                result ^= results[slot];
+
+                if (coeff == 0)  {  if (result != 0)  { return false; }  break;  }
+
+                size_t tz = __builtin_ctzll (coeff);
+                slot  += tz;
+                coeff >>= tz;
+            }
+        }
+        return true;
+    }
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_RIBBON_FILTER_HPP_ */
@@ -32,6 +32,7 @@
 #include <gatb/system/api/ISmartPointer.hpp>
 #include <gatb/system/api/IThread.hpp>
 #include <gatb/system/impl/System.hpp>
+#include <gatb/system/impl/Tracer.hpp>
 #include <gatb/tools/designpattern/api/Iterator.hpp>
 
 #include <vector>
@@ -160,6 +161,11 @@ public:
      */
     virtual size_t getExecutionUnitsNumber () = 0;
 
+    /** Returns the number of NUMA nodes the execution units are spread over.
+     *  \return the number of nodes, 1 if the execution units are not bound to NUMA nodes.
+     */
+    virtual size_t getNbNumaNodes () const = 0;
+
     /** Iterate a provided instance. The provided functor is cloned N times, where N is the number of threads to
      * be created; each thread will use its own instance of functor.
      *
@@ -222,6 +228,56 @@ public:
         return status;
     }
 
+    /** Iterate several iterators at the same time, typically the iterators of the files of a composite bank.
+     * The provided functor is cloned N times, where N is the number of threads to be created.
+     *
+     * Each iterator has its own synchronizer, so threads reading different iterators don't wait for each
+     * other. A scheduler gives an iterator to each thread: while some iterators have not been started and
+     * less than 'nbOpened' iterators are being read, a thread starts a new one; otherwise it joins the
+     * started iterator having the fewest readers. An iterator is finalized (ie. its files are closed) as
+     * soon as it is finished and its last reader leaves it.
+     *
+     * The functor is called as 'functor (item, idx)', where idx is the index in 'iterators' of the iterator
+     * the item comes from.
+     *
+     * \param[in] iterators : the iterators to be iterated
+     * \param[in] functor : functor object to be cloned N times, one per thread
+     * \param[in] groupSize : number of items to be retrieved in a single lock/unlock block
+     * \param[in] deleteSynchro : if false, destructor of functors are called in each thread; if true, destructor of functors are called synchronously
+     * \param[in] nbOpened : max number of iterators started and not finished at the same time (0 means the number of execution units)
+     */
+    template <typename Item, typename Functor>
+    Status iterate (const std::vector<Iterator<Item>*>& iterators, const Functor& functor, size_t groupSize = 1000, bool deleteSynchro = false, size_t nbOpened = 0)
+    {
+        /** If the dispatcher has a defined group size, we overwrite the one provided by the caller. */
+        if (getGroupSize() > 0)  { groupSize = getGroupSize(); }
+
+        Status status;
+
+        for (size_t i=0; i<iterators.size(); i++)  { iterators[i]->use(); }
+
+        /** We create the scheduler shared by the threads. */
+        IteratorScheduler<Item> scheduler (iterators, nbOpened>0 ? nbOpened : getExecutionUnitsNumber(), *this);
+
+        /** We create N MultiIteratorCommand instances, each one with its copy of the functor. */
+        std::vector<ICommand*> commands;
+        for (size_t i=0; i<getExecutionUnitsNumber(); i++)
+        {
+            commands.push_back (new MultiIteratorCommand<Item,Functor> (scheduler, new Functor (functor), groupSize, deleteSynchro));
+        }
+
+        /** We dispatch the commands. */
+        status.time = dispatchCommands (commands);
+
+        /** We reset the iterators (in case they would be used again). */
+        for (size_t i=0; i<iterators.size(); i++)  { iterators[i]->reset();  iterators[i]->forget(); }
+
+        status.nbCores   = commands.size();
+        status.groupSize = groupSize;
+
+        return status;
+    }
+
     /** Set the number of items to be retrieved from the iterator by one thread in a synchronized way.
      * \param[in] groupSize : number of items to be retrieved. */
     virtual void   setGroupSize (size_t groupSize) = 0;
@@ -309,14 +365,19 @@ protected:
             /** We begin the iteration. */
             for (bool isRunning=true;  isRunning ; )
             {
-                /** We lock the shared synchronizer before accessing the iterator. */
-                 _synchro.lock ();
+                {
+                    /** The fetch span shows both the wait for the iterator and its reading. */
+                    TRACE_SPAN ("dispatcher", "fetch");
 
-                 /** We retrieve some items from the iterator. */
-                 isRunning = _it->get (items);
+                    /** We lock the shared synchronizer before accessing the iterator. */
+                    _synchro.lock ();
 
-                 /** We unlock the shared synchronizer after accessing the iterator. */
-                 _synchro.unlock ();
+                    /** We retrieve some items from the iterator. */
+                    isRunning = _it->get (items);
+
+                    /** We unlock the shared synchronizer after accessing the iterator. */
+                    _synchro.unlock ();
+                }
 
                  /** We have retrieved some items from the iterator.
                   * Now, we don't need any more to be synchronized, so we can call the current functor
@@ -337,6 +398,137 @@ protected:
         size_t                 _groupSize;
         bool                   _deleteSynchro;
     };
+
+    /* Scheduler giving the iterators of a multiple iteration to the threads. */
+    template <typename Item> class IteratorScheduler
+    {
+    public:
+
+        /** Constructor.
+         * \param[in] iterators : iterators to be scheduled
+         * \param[in] nbOpened : max number of iterators read at the same time
+         * \param[in] dispatcher : factory for the synchronizers */
+        IteratorScheduler (const std::vector<Iterator<Item>*>& iterators, size_t nbOpened, IDispatcher& dispatcher)
+            : _iterators(iterators), _nbReaders(iterators.size(),0), _isFinished(iterators.size(),false),
+              _nbOpened(nbOpened), _nbStarted(0), _nbRunning(0), _synchro(dispatcher.newSynchro())
+        {
+            for (size_t i=0; i<_iterators.size(); i++)  { _synchros.push_back (dispatcher.newSynchro()); }
+        }
+
+        /** Destructor. */
+        ~IteratorScheduler ()
+        {
+            for (size_t i=0; i<_synchros.size(); i++)  { delete _synchros[i]; }
+            delete _synchro;
+        }
+
+        /** Get an iterator to be read.
+         * \param[in] previous : index of the iterator the caller has finished to read (-1 if none)
+         * \return index of the iterator to be read, -1 if the iteration is over. */
+        int acquire (int previous)
+        {
+            system::LocalSynchronizer ls (_synchro);
+
+            if (previous >= 0)
+            {
+                _nbReaders[previous]--;
+
+                if (_isFinished[previous] == false)  {  _isFinished[previous] = true;  _nbRunning--;  }
+
+                /** The last reader closes the iterator. */
+                if (_nbReaders[previous] == 0)  { _iterators[previous]->finalize(); }
+            }
+
+            int result = -1;
+
+            /** We start a new iterator if possible, otherwise we help the least read one. */
+            if (_nbStarted < _iterators.size() && _nbRunning < _nbOpened)
+            {
+                result = _nbStarted++;
+                _nbRunning++;
+            }
+            else
+            {
+                for (size_t i=0; i<_nbStarted; i++)
+                {
+                    if (_isFinished[i] == false && (result < 0 || _nbReaders[i] < _nbReaders[result]))  { result = i; }
+                }
+            }
+
+            if (result >= 0)  { _nbReaders[result]++; }
+
+            return result;
+        }
+
+        /** Get some items from an iterator.
+         * \param[in] idx : index of the iterator
+         * \param[in] items : vector to be filled with the items
+         * \return true if the iterator is not finished, false otherwise. */
+        bool get (size_t idx, std::vector<Item>& items)
+        {
+            system::LocalSynchronizer ls (_synchros[idx]);
+            return _iterators[idx]->get (items);
+        }
+
+        /** Get the synchronizer of the scheduler.
+         * \return the synchronizer. */
+        system::ISynchronizer& getSynchro ()  { return *_synchro; }
+
+    private:
+        std::vector<Iterator<Item>*>         _iterators;
+        std::vector<system::ISynchronizer*>  _synchros;
+        std::vector<size_t>                  _nbReaders;
+        std::vector<bool>                    _isFinished;
+        size_t                               _nbOpened;
+        size_t                               _nbStarted;
+        size_t                               _nbRunning;
+        system::ISynchronizer*               _synchro;
+    };
+
+    /* Command reading in one thread the iterators given by a scheduler. */
+    template <typename Item, typename Functor> class MultiIteratorCommand : public ICommand, public system::SmartPointer
+    {
+    public:
+        /** Constructor.
+         * \param[in] scheduler : scheduler of the iterators (shared by several MultiIteratorCommand instances)
+         * \param[in] fct : functor fed with the iterated items, deleted at the end of the command
+         * \param[in] groupSize : number of items got from an iterator in one synchronized block.
+         * \param[in] deleteSynchro : tells whether the functor deletion must be synchronized */
+        MultiIteratorCommand (IteratorScheduler<Item>& scheduler, Functor* fct, size_t groupSize, bool deleteSynchro)
+            : _scheduler(scheduler), _fct(fct), _groupSize(groupSize), _deleteSynchro(deleteSynchro)  {}
+
+        /** Implementation of the ICommand interface.*/
+        void execute ()
+        {
+            std::vector<Item> items;
+
+            for (int idx = _scheduler.acquire(-1);  idx >= 0;  idx = _scheduler.acquire(idx))
+            {
+                for (bool isRunning=true;  isRunning; )
+                {
+                    items.resize (_groupSize);
+
+                    {
+                        TRACE_SPAN_ARG ("dispatcher", "fetch", idx);
+                        isRunning = _scheduler.get (idx, items);
+                    }
+
+                    for (size_t i=0; i<items.size(); i++)  {   (*_fct) (items[i], idx); }
+                }
+            }
+
+            /** We do not need the functor after that, delete it here to have parallel delete */
+            if (_deleteSynchro)  { _scheduler.getSynchro().lock (); }
+            delete _fct;
+            if (_deleteSynchro)  { _scheduler.getSynchro().unlock (); }
+        }
+
+    private:
+        IteratorScheduler<Item>& _scheduler;
+        Functor*                 _fct;
+        size_t                   _groupSize;
+        bool                     _deleteSynchro;
+    };
 };
 
 /********************************************************************************/
@@ -196,6 +196,22 @@ public:
     /** Get a vector holding the composite structure of the iterator. */
     virtual std::vector<Iterator<Item>*> getComposition()   {   std::vector<Iterator<Item>*> res;  res.push_back (this);  return res;    }
 
+    /** Get the leaves of the composite structure of the iterator, ie. the iterators that are not
+     * composed of other ones (typically one iterator per file for a bank). */
+    std::vector<Iterator<Item>*> getLeaves ()
+    {
+        std::vector<Iterator<Item>*> res;
+        std::vector<Iterator<Item>*> composition = getComposition();
+        for (size_t i=0; i<composition.size(); i++)
+        {
+            if (composition[i] == this)  { res.push_back (this); continue; }
+
+            std::vector<Iterator<Item>*> leaves = composition[i]->getLeaves();
+            res.insert (res.end(), leaves.begin(), leaves.end());
+        }
+        return res;
+    }
+
 protected:
     Item* _item;
 
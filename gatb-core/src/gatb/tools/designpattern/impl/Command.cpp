@@ -19,7 +19,9 @@
 
 #include <gatb/tools/designpattern/impl/Command.hpp>
 #include <gatb/system/impl/System.hpp>
+#include <gatb/system/impl/Tracer.hpp>
 #include <gatb/tools/misc/impl/TimeInfo.hpp>
+#include <algorithm>
 
 using namespace std;
 using namespace gatb::core::tools::dp;
@@ -60,6 +62,37 @@ private:
     system::ISynchronizer* _synchro;
 };
 
+/********************************************************************************/
+/** Data given to the main loop of a worker thread. */
+struct WorkerInfo : public IThreadGroup::Info
+{
+    WorkerInfo (IThreadGroup* group, void* data, size_t idx, system::impl::WorkerContext* context, const std::vector<size_t>* cores=0)
+        : IThreadGroup::Info (group, data, idx), context(context), cores(cores)  {}
+
+    system::impl::WorkerContext* context;
+
+    /** Cores the worker has to be bound to, 0 for no binding. */
+    const std::vector<size_t>* cores;
+};
+
+/********************************************************************************/
+/** Cores of each NUMA node, retrieved once. Nodes without cores (memory only) are skipped. */
+static const std::vector<std::vector<size_t> >& getNumaTopology ()
+{
+    static const std::vector<std::vector<size_t> > topology = [] ()
+    {
+        std::vector<std::vector<size_t> > result;
+        for (size_t i=0; i<system::impl::System::info().getNbNumaNodes(); i++)
+        {
+            std::vector<size_t> cores = system::impl::System::info().getNumaNodeCores(i);
+            if (!cores.empty())  { result.push_back (cores); }
+        }
+        return result;
+    } ();
+
+    return topology;
+}
+
 /********************************************************************************/
 class SynchronizerNull : public system::ISynchronizer, public system::SmartPointer
 {
@@ -80,8 +113,16 @@ size_t SerialDispatcher::dispatchCommands (std::vector<ICommand*>& commands, ICo
 {
     TIME_START (ti, "compute");
 
-    for (std::vector<ICommand*>::iterator it = commands.begin(); it != commands.end(); it++)
+    size_t idx = 0;
+
+    for (std::vector<ICommand*>::iterator it = commands.begin(); it != commands.end(); it++, idx++)
     {
+        /** Each command is run with its own worker context, as it would be in a Dispatcher. */
+        system::impl::WorkerContext        context (0, idx, commands.size());
+        system::impl::WorkerContext::Scope scope   (&context);
+
+        TRACE_SPAN_ARG ("dispatcher", "task", idx);
+
         if (*it != 0)  {  (*it)->use ();  (*it)->execute ();  (*it)->forget ();  }
     }
 
@@ -114,7 +155,20 @@ system::ISynchronizer* SerialDispatcher::newSynchro ()
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-Dispatcher::Dispatcher (size_t nbUnits, size_t groupSize) : _nbUnits(nbUnits), _groupSize(groupSize)
+size_t Dispatcher::getNbNumaNodes () const
+{
+    return _numaAware ? std::max (getNumaTopology().size(), (size_t)1) : 1;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+Dispatcher::Dispatcher (size_t nbUnits, size_t groupSize, bool numaAware) : _nbUnits(nbUnits), _groupSize(groupSize), _numaAware(numaAware)
 {
     if (_nbUnits==0)  { _nbUnits = system::impl::System::info().getNbCores(); }
 }
@@ -135,6 +189,23 @@ size_t Dispatcher::dispatchCommands (std::vector<ICommand*>& commands, ICommand*
 
     size_t idx = 0;
 
+    /** In NUMA mode, the workers are spread over the nodes, unless we are ourself run by a worker
+     * bound to a node: the nested workers then stay on this node. */
+    system::impl::WorkerContext* parent = system::impl::WorkerContext::current();
+    bool bound = parent != 0 && parent->getNumaNode() >= 0;
+    const std::vector<std::vector<size_t> >* topology = (_numaAware || bound) ? &getNumaTopology() : 0;
+    bool numa = topology != 0 && !topology->empty();
+
+    /** We prepare one context per worker. */
+    _contexts.resize (commands.size());
+    for (size_t i=0; i<_contexts.size(); i++)
+    {
+        int node = -1;
+        if (numa)  {  node = (parent != 0 && parent->getNumaNode() >= 0) ? parent->getNumaNode() : i % topology->size();  }
+
+        _contexts[i].reset (threadGroup, i, _contexts.size(), node);
+    }
+
     /** We create threads and add them to the thread group. */
     for (std::vector<ICommand*>::iterator it = commands.begin(); it != commands.end(); it++, idx++)
     {
@@ -142,12 +213,14 @@ size_t Dispatcher::dispatchCommands (std::vector<ICommand*>& commands, ICommand*
          *  - the main loop function to be called by the thread
          *  - the information to be provided to the main loop.
          *
-         *  Note that we provide here a IThreadGroup::Info instance as data for the main loop
+         *  Note that we provide here a WorkerInfo instance as data for the main loop
          *  => it is important that at the beginning of the main loop we retrieved the correct
          *  type from the void* data. */
         threadGroup->add (
             mainloop,
-            new IThreadGroup::Info (threadGroup,  new CommandStartSynchro (*it, threadGroup->getSynchro()), idx )
+            new WorkerInfo (threadGroup,  new CommandStartSynchro (*it, threadGroup->getSynchro()), idx, &_contexts[idx],
+                numa ? &(*topology)[_contexts[idx].getNumaNode()] : 0
+            )
         );
     }
 
@@ -202,9 +275,15 @@ system::IThread* Dispatcher::newThread (ICommand* command)
 *********************************************************************/
 void* Dispatcher::mainloop (void* data)
 {
-    IThreadGroup::Info* info = (IThreadGroup::Info*) data;
+    WorkerInfo* info = (WorkerInfo*) data;
     LOCAL (info);
 
+    /** The worker context is current for the whole life of the thread. */
+    system::impl::WorkerContext::Scope scope (info->context);
+
+    /** We may have to bind the worker to the cores of its NUMA node. */
+    if (info->cores != 0)  {  system::impl::System::thread().setAffinity (*info->cores);  }
+
     IThreadGroup* threadGroup = info->group;
     ICommand*    cmd          = (ICommand*) info->data;
 
@@ -215,6 +294,8 @@ void* Dispatcher::mainloop (void* data)
      * and keep it to re-throw it in the main thread. */
     try
     {
+        TRACE_SPAN_ARG ("dispatcher", "task", info->idx);
+
         cmd->use ();
         cmd->execute();
         cmd->forget ();
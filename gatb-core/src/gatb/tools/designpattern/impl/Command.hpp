@@ -61,6 +61,9 @@ public:
     /** \copydoc IDispatcher::getExecutionUnitsNumber */
     size_t getExecutionUnitsNumber () { return 1; }
 
+    /** \copydoc IDispatcher::getNbNumaNodes */
+    size_t getNbNumaNodes () const  { return 1; }
+
     /** \copydoc IDispatcher::setGroupSize */
     void setGroupSize (size_t groupSize)  { }
 
@@ -99,8 +102,9 @@ public:
     /** Constructor.
      * \param[in] nbUnits : number of threads to be used. If 0 is provided, one tries to guess the number of available cores.
      * \param[in] groupSize : number of items to be retrieved from the iterator by one thread in a synchronized way
+     * \param[in] numaAware : true for binding the workers to the NUMA nodes (see setNumaAware)
      */
-    Dispatcher (size_t nbUnits=0, size_t groupSize=0);
+    Dispatcher (size_t nbUnits=0, size_t groupSize=0, bool numaAware=false);
 
     /** \copydoc IDispatcher::dispatchCommands */
     size_t dispatchCommands (std::vector<ICommand*>& commands, ICommand* postTreatment=0);
@@ -114,6 +118,26 @@ public:
     /** \copydoc IDispatcher::getGroupSize */
     size_t getGroupSize () const  { return _groupSize; }
 
+    /** Get the contexts of the workers of the last dispatch, one per dispatched command.
+     * They can be used for instance for gathering the statistics of each worker.
+     * \return the workers contexts. */
+    const std::vector<system::impl::WorkerContext>& getWorkerContexts () const  { return _contexts; }
+
+    /** Activate the NUMA placement of the workers of this dispatcher. Each worker is then bound to
+     * the cores of one NUMA node, the workers being spread over the nodes. Note that the workers of any
+     * dispatcher used by a bound worker are bound to the node of this worker, whatever their own setting.
+     * The node of a worker is available through its WorkerContext, for instance for allocating memory
+     * local to the node.
+     * \param[in] numaAware : true for binding the workers to the NUMA nodes. */
+    void setNumaAware (bool numaAware)  { _numaAware = numaAware; }
+
+    /** Tells whether the workers are bound to NUMA nodes.
+     * \return true if the NUMA placement is active. */
+    bool isNumaAware () const  { return _numaAware; }
+
+    /** \copydoc IDispatcher::getNbNumaNodes */
+    size_t getNbNumaNodes () const;
+
 private:
 
     /** */
@@ -130,6 +154,12 @@ private:
 
     /** Group size */
     size_t _groupSize;
+
+    /** Contexts of the workers, kept from one dispatch to another. */
+    std::vector<system::impl::WorkerContext> _contexts;
+
+    /** NUMA placement of the workers. */
+    bool _numaAware;
 };
 
 /********************************************************************************/
@@ -33,6 +33,10 @@
 #include <gatb/tools/misc/api/Abundance.hpp>
 #include <hdf5/hdf5.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 extern const unsigned char revcomp_4NT[];
 extern const unsigned char comp_NT    [];
 extern const u_int64_t random_values    [256];
@@ -187,6 +191,50 @@ public:
         return hash;
     }
 
+    /** Hash several values with hash64, two by two with SSE2.
+     * \param[in] keys : values to be hashed
+     * \param[in] nb : number of values
+     * \param[in] seed : seed of the hash function
+     * \param[out] hashes : hash values, hashes[i] being hash64 (keys[i], seed) */
+    inline static void hash64 (const u_int64_t* keys, size_t nb, u_int64_t seed, u_int64_t* hashes)
+    {
+        size_t i = 0;
+
+#ifdef __SSE2__
+        /** With a given seed, the first step is a function of the key made of a multiplication by a
+         * constant, done on 32 bits halves since SSE2 has no 64 bits multiplication. */
+        const __m128i c0   = _mm_set1_epi64x (seed ^ (seed << 7));
+        const __m128i mLo  = _mm_set1_epi64x ((seed >> 3) & 0xFFFFFFFF);
+        const __m128i mHi  = _mm_set1_epi64x ((seed >> 3) >> 32);
+        const __m128i a    = _mm_set1_epi64x (seed << 11);
+        const __m128i b    = _mm_set1_epi64x (seed >> 5);
+        const __m128i ones = _mm_set1_epi32 (-1);
+
+        for ( ; i+2 <= nb; i+=2)
+        {
+            __m128i key = _mm_loadu_si128 ((const __m128i*) (keys+i));
+
+            __m128i mul = _mm_add_epi64 (
+                _mm_mul_epu32 (key, mLo),
+                _mm_slli_epi64 (_mm_add_epi64 (_mm_mul_epu32 (_mm_srli_epi64 (key, 32), mLo), _mm_mul_epu32 (key, mHi)), 32)
+            );
+            __m128i h = _mm_xor_si128 (_mm_xor_si128 (c0, mul), _mm_xor_si128 (_mm_add_epi64 (a, _mm_xor_si128 (key, b)), ones));
+
+            h = _mm_add_epi64 (_mm_xor_si128 (h, ones), _mm_slli_epi64 (h, 21));
+            h = _mm_xor_si128 (h, _mm_srli_epi64 (h, 24));
+            h = _mm_add_epi64 (_mm_add_epi64 (h, _mm_slli_epi64 (h, 3)), _mm_slli_epi64 (h, 8));
+            h = _mm_xor_si128 (h, _mm_srli_epi64 (h, 14));
+            h = _mm_add_epi64 (_mm_add_epi64 (h, _mm_slli_epi64 (h, 2)), _mm_slli_epi64 (h, 4));
+            h = _mm_xor_si128 (h, _mm_srli_epi64 (h, 28));
+            h = _mm_add_epi64 (h, _mm_slli_epi64 (h, 31));
+
+            _mm_storeu_si128 ((__m128i*) (hashes+i), h);
+        }
+#endif
+
+        for ( ; i<nb; i++)  {  hashes[i] = hash64 (keys[i], seed);  }
+    }
+
     /********************************************************************************/
     inline static u_int64_t oahash64 (u_int64_t elem)
     {
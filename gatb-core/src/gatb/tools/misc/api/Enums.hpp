@@ -120,6 +120,8 @@ enum DebloomKind
     DEBLOOM_ORIGINAL,
     /** Save cFP with cascading Bloom filters. */
     DEBLOOM_CASCADING,
+    /** Save cFP with cascading ribbon filters. */
+    DEBLOOM_RIBBON,
     DEBLOOM_DEFAULT
 };
 
@@ -131,6 +133,7 @@ static void parse (const std::string& s, DebloomKind& kind)
          if (s == "none")       { kind = DEBLOOM_NONE;      }
     else if (s == "original")   { kind = DEBLOOM_ORIGINAL;  }
     else if (s == "cascading")  { kind = DEBLOOM_CASCADING; }
+    else if (s == "ribbon")     { kind = DEBLOOM_RIBBON;    }
     else if (s == "default")    { kind = DEBLOOM_CASCADING; }
     else   { throw system::Exception ("bad debloom kind '%s'", s.c_str()); }
 }
@@ -145,6 +148,7 @@ static std::string toString (DebloomKind kind)
         case DEBLOOM_NONE:      return "none";
         case DEBLOOM_ORIGINAL:  return "original";
         case DEBLOOM_CASCADING: return "cascading";
+        case DEBLOOM_RIBBON:    return "ribbon";
         case DEBLOOM_DEFAULT:   return "cascading";
         default:        throw system::Exception ("bad debloom kind %d", kind);
     }
@@ -103,6 +103,16 @@ public:
      * \param[in] index : the X value. */
     virtual void inc (u_int16_t index) = 0;
 
+    /** Increase the number of kmers occurring X time for a batch of X values. Only the values
+     * whose flag is set are taken into account.
+     * \param[in] values : the X values.
+     * \param[in] selected : flags telling which values are to be used.
+     * \param[in] nb : number of values. */
+    virtual void inc (const CountNumber* values, const u_int8_t* selected, size_t nb)
+    {
+        for (size_t i=0; i<nb; i++)  {  if (selected[i])  { inc ((u_int16_t)values[i]); }  }
+    }
+
 	/** Increase the number of kmers occurring X time in genome and Y times in read
 	 * \param[in] index1 : the X value.
 	 * \param[in] index2 : the Y value. */
@@ -94,6 +94,8 @@ public:
     const char* prefix         ()  { return "-prefix";         }
     const char* progress_bar   ()  { return "-bargraph";       }
     const char* nb_cores       ()  { return "-nb-cores";       }
+    const char* numa           ()  { return "-numa";           }
+    const char* trace          ()  { return "-trace";          }
     const char* partition_type ()  { return "-partition-type"; }
     const char* histogram_max  ()  { return "-histo-max";      }
     const char* uri_debloom    ()  { return "-debloom";        }
@@ -111,6 +113,7 @@ public:
     const char* branching_type ()  { return "-branching-nodes";}
     const char* topology_stats ()  { return "-topology-stats";}
     const char* uri_solid_kmers()  { return "-solid-kmers-out";    }
+    const char* uri_update     ()  { return "-update";         }
     const char* bank_convert_type ()  { return "-bank-convert";   }
     const char* integer_precision ()  { return "-integer-precision";}
     const char* solidity_kind  ()  { return "-solidity-kind"; }
@@ -121,6 +124,8 @@ public:
     const char* repartition_type() { return "-repartition-type"; }
     const char* compress_level()   { return "-out-compress"; }
     const char* config_only()      { return "-config-only"; }
+    const char* estimate_distinct_kmers() { return "-estimate-distinct-kmers"; }
+    const char* overlap_passes()   { return "-overlap-passes"; }
     const char* storage_type()     { return "-storage-type"; }
 
     const char* attr_uri_input      ()  { return "input";           }
@@ -150,6 +155,8 @@ public:
 #define STR_PREFIX              gatb::core::tools::misc::StringRepository::singleton().prefix ()
 #define STR_PROGRESS_BAR        gatb::core::tools::misc::StringRepository::singleton().progress_bar ()
 #define STR_NB_CORES            gatb::core::tools::misc::StringRepository::singleton().nb_cores ()
+#define STR_NUMA                gatb::core::tools::misc::StringRepository::singleton().numa ()
+#define STR_TRACE               gatb::core::tools::misc::StringRepository::singleton().trace ()
 #define STR_PARTITION_TYPE      gatb::core::tools::misc::StringRepository::singleton().partition_type ()
 #define STR_HISTOGRAM_MAX       gatb::core::tools::misc::StringRepository::singleton().histogram_max ()
 #define STR_URI_DEBLOOM         gatb::core::tools::misc::StringRepository::singleton().uri_debloom ()
@@ -167,6 +174,7 @@ public:
 #define STR_BRANCHING_TYPE      gatb::core::tools::misc::StringRepository::singleton().branching_type()
 #define STR_TOPOLOGY_STATS      gatb::core::tools::misc::StringRepository::singleton().topology_stats()
 #define STR_URI_SOLID_KMERS     gatb::core::tools::misc::StringRepository::singleton().uri_solid_kmers()
+#define STR_URI_UPDATE          gatb::core::tools::misc::StringRepository::singleton().uri_update()
 #define STR_BANK_CONVERT_TYPE   gatb::core::tools::misc::StringRepository::singleton().bank_convert_type()
 #define STR_SOLIDITY_KIND       gatb::core::tools::misc::StringRepository::singleton().solidity_kind()
 #define STR_SOLIDITY_CUSTOM     gatb::core::tools::misc::StringRepository::singleton().solidity_custom()
@@ -176,6 +184,8 @@ public:
 #define STR_REPARTITION_TYPE    gatb::core::tools::misc::StringRepository::singleton().repartition_type()
 #define STR_COMPRESS_LEVEL      gatb::core::tools::misc::StringRepository::singleton().compress_level()
 #define STR_CONFIG_ONLY         gatb::core::tools::misc::StringRepository::singleton().config_only()
+#define STR_ESTIMATE_DISTINCT_KMERS gatb::core::tools::misc::StringRepository::singleton().estimate_distinct_kmers()
+#define STR_OVERLAP_PASSES      gatb::core::tools::misc::StringRepository::singleton().overlap_passes()
 #define STR_STORAGE_TYPE        gatb::core::tools::misc::StringRepository::singleton().storage_type ()
 
 /********************************************************************************/
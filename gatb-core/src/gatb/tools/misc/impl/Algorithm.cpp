@@ -53,7 +53,8 @@ Algorithm::Algorithm (const std::string& name, int nbCores, gatb::core::tools::m
     setSystemInfo (new Properties());
 
     if (nbCores < 0)  {  nbCores = _input->get(STR_NB_CORES)  ? _input->getInt(STR_NB_CORES) : 0;  }
-    setDispatcher (new Dispatcher (nbCores) );
+    /** We may have to bind the workers of the dispatcher to the NUMA nodes. */
+    setDispatcher (new Dispatcher (nbCores, 0, _input->get(STR_NUMA) != 0) );
 
     _info->add (0, _name);
 }
@@ -90,6 +90,16 @@ public:
     /** \copydoc IHistogram::inc */
     void inc (u_int16_t index)  { _histogram [(index >= _length) ? _length : index].abundance ++; }
 
+    /** \copydoc IHistogram::inc(const CountNumber*,const u_int8_t*,size_t) */
+    void inc (const CountNumber* values, const u_int8_t* selected, size_t nb)
+    {
+        for (size_t i=0; i<nb; i++)
+        {
+            u_int16_t index = (u_int16_t) values[i];
+            _histogram [(index >= _length) ? _length : index].abundance += selected[i];
+        }
+    }
+
 	/** \copydoc IHistogram::inc2D */
 	void inc2D (u_int16_t index1, u_int16_t index2)
 	{
@@ -158,6 +168,9 @@ public:
     /** \copydoc IHistogram::inc */
     void inc (u_int16_t index) {}
 
+    /** \copydoc IHistogram::inc(const CountNumber*,const u_int8_t*,size_t) */
+    void inc (const CountNumber* values, const u_int8_t* selected, size_t nb)  {}
+
 	/** \copydoc IHistogram::inc2D */
 	void inc2D (u_int16_t index1, u_int16_t index2) {}
 	
@@ -237,6 +250,9 @@ public:
     /** \copydoc IHistogram::inc */
     void inc (u_int16_t index)  { _localHisto.inc (index); }
 
+    /** \copydoc IHistogram::inc(const CountNumber*,const u_int8_t*,size_t) */
+    void inc (const CountNumber* values, const u_int8_t* selected, size_t nb)  { _localHisto.inc (values, selected, nb); }
+
 	/** \copydoc IHistogram::inc2D */
 	void inc2D (u_int16_t index1, u_int16_t index2)
 	{
@@ -0,0 +1,83 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file MemoryInfo.hpp
+ *  \brief Memory usage information
+ */
+
+#ifndef _GATB_CORE_TOOLS_MISC_IMPL_MEMORY_INFO_HPP_
+#define _GATB_CORE_TOOLS_MISC_IMPL_MEMORY_INFO_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/impl/System.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
+#include <gatb/tools/misc/impl/Property.hpp>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace tools     {
+namespace misc      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Memory usage information
+ *
+ * Gives the current and peak usages (in MB) of the memory accounting (see system::impl::MemoryAccounting),
+ * per category and in total, together with the budget and the peak resident memory of the process.
+ */
+class MemoryInfo
+{
+public:
+
+    /** Get information about the memory usage
+     * \param[in] root : root name of the properties to be returned.
+     * \return information as a IProperties instance
+     */
+    static IProperties* getInfo (const std::string& root = "memory")
+    {
+        system::impl::MemoryAccounting& accounting = system::impl::MemoryAccounting::singleton();
+
+        IProperties* props = new Properties();
+
+        props->add (0, root);
+        props->add (1, "budget",       "%.1f", (double)accounting.getBudget()       / (double)system::MBYTE);
+        props->add (1, "current",      "%.1f", (double)accounting.getCurrentUsage() / (double)system::MBYTE);
+        props->add (1, "peak",         "%.1f", (double)accounting.getMaximumUsage() / (double)system::MBYTE);
+        props->add (1, "process_peak", "%.1f", (double)system::impl::System::info().getMemorySelfMaxUsed() / (double)system::KBYTE);
+
+        for (size_t i=0; i<system::impl::MEMORY_NB_CATEGORIES; i++)
+        {
+            system::impl::MemoryCategory category = (system::impl::MemoryCategory) i;
+
+            props->add (1, system::impl::MemoryAccounting::getName (category));
+            props->add (2, "current", "%.1f", (double)accounting.getCurrentUsage(category) / (double)system::MBYTE);
+            props->add (2, "peak",    "%.1f", (double)accounting.getMaximumUsage(category) / (double)system::MBYTE);
+        }
+
+        return props;
+    }
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_MISC_IMPL_MEMORY_INFO_HPP_ */
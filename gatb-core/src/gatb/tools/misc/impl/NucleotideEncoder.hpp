@@ -0,0 +1,216 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file NucleotideEncoder.hpp
+ *  \brief Bulk conversion of ASCII nucleotides into 2 bits codes
+ */
+
+#ifndef _GATB_CORE_TOOLS_MISC_IMPL_NUCLEOTIDE_ENCODER_HPP_
+#define _GATB_CORE_TOOLS_MISC_IMPL_NUCLEOTIDE_ENCODER_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/misc/api/Data.hpp>
+
+#include <vector>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace tools     {
+namespace misc      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Sequence of nucleotides encoded on 2 bits, with the mask of its invalid nucleotides
+ *
+ * The 'encode' method converts a whole ASCII sequence at once, 16 nucleotides per step when
+ * SSE2 is available, instead of one nucleotide at a time with Data::ConvertASCII. The codes are
+ * the ones of Data::ConvertASCII (A=0, C=1, T=2, G=3, the code of an invalid nucleotide being
+ * computed the same way) and are packed in the Data::BINARY layout (4 nucleotides per byte, the
+ * first one in the high bits), so they can be read with Data::ConvertBinary.
+ *
+ * The invalid nucleotides (ie. not in ACGTacgt) are given by a bit mask, bit i%64 of word i/64
+ * being set if nucleotide i is invalid.
+ *
+ * Sample of use:
+ * \code
+ * PackedNucleotides packed;
+ * packed.encode (seq, strlen(seq));
+ * for (size_t i=0; i<packed.size(); i++)  {  if (packed.isValid(i))  { u_int8_t code = packed[i]; } }
+ * \endcode
+ */
+class PackedNucleotides
+{
+public:
+
+    /** Constructor. */
+    PackedNucleotides () : _size(0)  {}
+
+    /** Encode an ASCII sequence; the previous content is replaced.
+     * \param[in] seq : the ASCII nucleotides
+     * \param[in] length : number of nucleotides */
+    void encode (const char* seq, size_t length)
+    {
+        _size = length;
+
+        /** We allocate a few more bytes so that the vectorized loop can write by 32 bits words. */
+        if (_codes.size() < length/4 + 8)  {  _codes.resize (length/4 + 8);  }
+        if (_mask.size()  < length/64 + 1) {  _mask.resize  (length/64 + 1); }
+
+        memset (_mask.data(), 0, (length/64 + 1) * sizeof(u_int64_t));
+
+        size_t i = 0;
+
+#ifdef __SSE2__
+        const __m128i maskCase = _mm_set1_epi8 ((char)0xDF);
+        const __m128i maskCode = _mm_set1_epi8 (3);
+        const __m128i low2     = _mm_set1_epi16 (0x0003);
+        const __m128i low4     = _mm_set1_epi16 (0x000F);
+        const __m128i nA = _mm_set1_epi8 ('A'), nC = _mm_set1_epi8 ('C'), nG = _mm_set1_epi8 ('G'), nT = _mm_set1_epi8 ('T');
+
+        for ( ; i+16 <= length; i+=16)
+        {
+            __m128i x = _mm_loadu_si128 ((const __m128i*) (seq+i));
+
+            /** The upper case letters ACGT are the only ones matching once the bit 5 is cleared. */
+            __m128i up    = _mm_and_si128 (x, maskCase);
+            __m128i valid = _mm_or_si128 (
+                _mm_or_si128 (_mm_cmpeq_epi8 (up, nA), _mm_cmpeq_epi8 (up, nC)),
+                _mm_or_si128 (_mm_cmpeq_epi8 (up, nG), _mm_cmpeq_epi8 (up, nT))
+            );
+            u_int64_t invalid = (~_mm_movemask_epi8 (valid)) & 0xFFFF;
+            _mask[i/64] |= invalid << (i%64);
+
+            /** Codes (c>>1)&3, one per byte. */
+            __m128i codes = _mm_and_si128 (_mm_srli_epi16 (x, 1), maskCode);
+
+            /** We merge the bytes two by two (the first one in the high bits), twice: 16 codes -> 4 bytes. */
+            __m128i n4 = _mm_or_si128 (_mm_slli_epi16 (_mm_and_si128 (codes, low2), 2), _mm_srli_epi16 (codes, 8));
+            n4 = _mm_packus_epi16 (n4, _mm_setzero_si128());
+            __m128i n8 = _mm_or_si128 (_mm_slli_epi16 (_mm_and_si128 (n4, low4), 4), _mm_srli_epi16 (n4, 8));
+            n8 = _mm_packus_epi16 (n8, _mm_setzero_si128());
+
+            int32_t packed = _mm_cvtsi128_si32 (n8);
+            memcpy (_codes.data() + i/4, &packed, sizeof(packed));
+        }
+#endif
+
+        /** Remaining nucleotides (or all of them without SSE2). */
+        for ( ; i<length; i++)
+        {
+            if ((i&3) == 0)  { _codes[i/4] = 0; }
+
+            unsigned char c = seq[i];
+            _codes[i/4] |= ((c>>1) & 3) << ((3-(i&3))*2);
+
+            if (Data::validNucleotide[c])  { _mask[i/64] |= ((u_int64_t)1) << (i%64); }
+        }
+    }
+
+    /** Tell whether all the nucleotides of an ASCII sequence are valid (ie. in ACGTacgt).
+     * \param[in] seq : the ASCII nucleotides
+     * \param[in] length : number of nucleotides
+     * \return true if all the nucleotides are valid. */
+    static bool isValid (const char* seq, size_t length)
+    {
+        size_t i = 0;
+
+#ifdef __SSE2__
+        const __m128i maskCase = _mm_set1_epi8 ((char)0xDF);
+        const __m128i nA = _mm_set1_epi8 ('A'), nC = _mm_set1_epi8 ('C'), nG = _mm_set1_epi8 ('G'), nT = _mm_set1_epi8 ('T');
+
+        for ( ; i+16 <= length; i+=16)
+        {
+            __m128i up    = _mm_and_si128 (_mm_loadu_si128 ((const __m128i*) (seq+i)), maskCase);
+            __m128i valid = _mm_or_si128 (
+                _mm_or_si128 (_mm_cmpeq_epi8 (up, nA), _mm_cmpeq_epi8 (up, nC)),
+                _mm_or_si128 (_mm_cmpeq_epi8 (up, nG), _mm_cmpeq_epi8 (up, nT))
+            );
+            if (_mm_movemask_epi8 (valid) != 0xFFFF)  { return false; }
+        }
+#endif
+
+        for ( ; i<length; i++)  {  if (Data::validNucleotide[(unsigned char)seq[i]])  { return false; }  }
+
+        return true;
+    }
+
+    /** Get the number of nucleotides.
+     * \return the number of nucleotides. */
+    size_t size () const  { return _size; }
+
+    /** Get the code of a nucleotide.
+     * \param[in] idx : index of the nucleotide
+     * \return the 2 bits code. */
+    u_int8_t operator[] (size_t idx) const  {  return (_codes[idx>>2] >> ((3-(idx&3))*2)) & 3;  }
+
+    /** Tell whether a nucleotide is valid.
+     * \param[in] idx : index of the nucleotide
+     * \return true if valid. */
+    bool isValid (size_t idx) const  {  return ((_mask[idx/64] >> (idx%64)) & 1) == 0;  }
+
+    /** Get the packed codes, in the Data::BINARY layout.
+     * \return the codes. */
+    const char* getCodes () const  { return (const char*) _codes.data(); }
+
+    /** Get the mask of the invalid nucleotides.
+     * \return the mask, 64 nucleotides per word. */
+    const u_int64_t* getInvalidMask () const  { return _mask.data(); }
+
+    /** Get the last invalid nucleotide of a range.
+     * \param[in] begin : first nucleotide of the range
+     * \param[in] end : last nucleotide of the range (excluded)
+     * \return the index of the last invalid nucleotide, -1 if all the nucleotides are valid. */
+    int64_t lastInvalid (size_t begin, size_t end) const
+    {
+        while (end > begin)
+        {
+            size_t    w    = (end-1) / 64;
+            u_int64_t bits = _mask[w];
+
+            /** We keep the bits of [max(begin,64w), end) only. */
+            size_t hi = end - 64*w;
+            if (hi < 64)  { bits &= (((u_int64_t)1) << hi) - 1; }
+            if (begin > 64*w)  { bits &= ~((((u_int64_t)1) << (begin - 64*w)) - 1); }
+
+            if (bits != 0)  { return 64*w + 63 - __builtin_clzll (bits); }
+
+            end = 64*w;
+        }
+        return -1;
+    }
+
+private:
+
+    std::vector<u_int8_t>  _codes;
+    std::vector<u_int64_t> _mask;
+    size_t                 _size;
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_MISC_IMPL_NUCLEOTIDE_ENCODER_HPP_ */
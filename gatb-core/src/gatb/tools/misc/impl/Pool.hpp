@@ -29,7 +29,10 @@
 /********************************************************************************/
 
 #include <gatb/system/impl/System.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
 #include <queue>          // std::priority_queue
+#include <vector>
+#include <algorithm>
 
 /********************************************************************************/
 namespace gatb      {
@@ -57,7 +60,7 @@ public:
      * \param[in] tai :  2^20  1 M cells *16 o    blocs de 16 Mo
      * \param[in] N : 2^12  soit 4 G cells max
      * */
-    Pool (size_t tai=1048576, size_t N=4096) : TAI_POOL(tai), N_POOL(N)
+    Pool (size_t tai=1048576, size_t N=4096) : TAI_POOL(tai), N_POOL(N), _memory(system::impl::MEMORY_COUNTING)
     {
         n_pools = 0; n_cells=0;
         //allocation table de pool :
@@ -69,6 +72,8 @@ public:
         pool_courante =(cell*)  MALLOC (TAI_POOL*sizeof(cell) );
         tab_pool[n_pools] = pool_courante;
         n_pools++;
+
+        _memory.set (N_POOL*sizeof(cell*) + TAI_POOL*sizeof(cell));
     }
 
     /**  Destructeur  */
@@ -112,6 +117,8 @@ public:
             n_pools++;
             n_cells = 1;
 
+            _memory.set (_memory.get() + TAI_POOL*sizeof(cell));
+
             internal_adress = n_pools -1;
             // 20 high bits are 0
 
@@ -141,6 +148,8 @@ public:
         pool_courante = tab_pool[1];
         n_cells=0;
         n_pools=2;
+
+        _memory.set (N_POOL*sizeof(cell*) + TAI_POOL*sizeof(cell));
     }
 
 
@@ -335,11 +344,22 @@ private:
 
     size_t TAI_POOL;
     size_t N_POOL;
+
+    system::impl::MemoryCharge _memory;
 };
 
 /********************************************************************************/
 
 //make it an allocator usable by std vector ?
+/** Pool of memory in which blocks are allocated without being freed one by one.
+ *
+ * When built with several NUMA nodes, the pool is split into one region per node; a worker
+ * bound to a node (see system::impl::WorkerContext::getNumaNode) allocates its blocks in the
+ * region of its node, and the pages of the region are then first touched, so physically
+ * allocated, on this node. A worker uses the region of another node only when its own region
+ * is full; such allocations are accounted as remote ones. A block too big for any region is
+ * allocated over adjacent regions, so the pool accepts the same blocks as the non NUMA one.
+ */
 class MemAllocator
 {
 public:
@@ -352,20 +372,41 @@ public:
             FREE (mainbuffer);
             capacity = used_space = 0;
             mainbuffer = NULL ;
+            _regions.clear();
+            _memory.set (0);
         }
 
         /** We add a little bit of memory in case "align" method is called often.
          * We allow max alignment of 16 bytes per core, plus some extra memory. */
         size_t extraMem = 16*_nbCores + 1024;
 
+        /** In NUMA mode, each block is aligned and each region starts on a page. */
+        if (_nbNodes > 1)  {  extraMem += _nbNodes * (PAGE_SIZE + NUMA_EXTRA_MEM);  }
+
         capacity   = size+extraMem;
         mainbuffer = (char*) CALLOC(capacity,1);
         used_space = 0;
+        _memory.set (capacity);
+
+        if (_nbNodes > 1)
+        {
+            _regions.resize (_nbNodes);
+
+            u_int64_t regionSize = capacity / _nbNodes;
+            for (size_t i=0; i<_nbNodes; i++)
+            {
+                _regions[i].begin = alignPtr (mainbuffer + i*regionSize, PAGE_SIZE);
+                _regions[i].end   = i+1 < _nbNodes ? alignPtr (mainbuffer + (i+1)*regionSize, PAGE_SIZE) : mainbuffer + capacity;
+                _regions[i].used_space = 0;
+            }
+        }
     }
 
     //should be thread safe
     char* pool_malloc(u_int64_t requested_size, const char* message="")
     {
+        if (!_regions.empty())  {  return pool_malloc_numa (requested_size, message);  }
+
         u_int64_t synced_used_space = __sync_fetch_and_add(&used_space, requested_size);
 
         if (requested_size > (capacity - synced_used_space))
@@ -390,6 +431,14 @@ public:
     /** Force alignment. */
     void align (u_int8_t alignBytes)
     {
+        if (!_regions.empty())
+        {
+            /** The regions start on a page, so aligning the used space aligns the next block. */
+            Region& region = _regions[getLocalNode() % _regions.size()];
+            region.used_space = (region.used_space + alignBytes-1) & ~(u_int64_t)(alignBytes-1);
+            return;
+        }
+
         size_t offset = alignBytes-1 + sizeof(char*);
         char* current = mainbuffer + used_space;
         char* buffer  =  (char*)(((size_t)(current)+offset)&~(alignBytes-1));
@@ -400,15 +449,38 @@ public:
 
     u_int64_t getCapacity ()  {  return capacity;   }
 
-    u_int64_t getUsedSpace()  {  return used_space; }
+    u_int64_t getUsedSpace()
+    {
+        u_int64_t result = used_space;
+        for (size_t i=0; i<_regions.size(); i++)  { result += _regions[i].used_space; }
+        return result;
+    }
 
 
     void free_all()
     {
         used_space = 0;
+        for (size_t i=0; i<_regions.size(); i++)  { _regions[i].used_space = 0; }
     }
 
-    MemAllocator(size_t nbCores=0) : mainbuffer(NULL),capacity(0),used_space(0), _nbCores(nbCores), _synchro(0)
+    /** Get the number of NUMA nodes the pool is split for.
+     * \return the number of nodes, 1 if the pool is not split. */
+    size_t getNbNodes () const  { return _nbNodes; }
+
+    /** Get the number of bytes allocated by workers in the region of their own NUMA node.
+     * \return the number of bytes. */
+    u_int64_t getLocalBytes () const  { return _localBytes; }
+
+    /** Get the number of bytes allocated by workers in the region of another NUMA node.
+     * \return the number of bytes. */
+    u_int64_t getRemoteBytes () const  { return _remoteBytes; }
+
+    /** Constructor.
+     * \param[in] nbCores : number of cores using the pool, for computing an extra memory for alignment constraints
+     * \param[in] nbNodes : number of NUMA nodes the pool is split for */
+    MemAllocator(size_t nbCores=0, size_t nbNodes=1)
+        : mainbuffer(NULL),capacity(0),used_space(0), _nbCores(nbCores), _nbNodes(std::max(nbNodes,(size_t)1)),
+          _localBytes(0), _remoteBytes(0), _synchro(0), _memory(system::impl::MEMORY_COUNTING)
     {
         setSynchro (system::impl::System::thread().newSynchronizer());
     }
@@ -422,14 +494,118 @@ public:
     system::ISynchronizer* getSynchro()  { return _synchro; }
 
 private :
+
+    static const size_t PAGE_SIZE      = 4096;
+    static const size_t NUMA_ALIGN     = 16;
+    static const size_t NUMA_EXTRA_MEM = 1024*1024;
+
+    /** Part of the pool dedicated to one NUMA node. */
+    struct Region
+    {
+        char*     begin;
+        char*     end;
+        u_int64_t used_space;
+    };
+
+    static char* alignPtr (char* ptr, size_t alignBytes)  {  return (char*) (((size_t)ptr + alignBytes-1) & ~(alignBytes-1));  }
+
+    /** NUMA node of the calling worker, 0 if the calling thread is not bound to a node. */
+    static size_t getLocalNode ()
+    {
+        system::impl::WorkerContext* context = system::impl::WorkerContext::current();
+        return (context != 0 && context->getNumaNode() >= 0) ? context->getNumaNode() : 0;
+    }
+
+    char* pool_malloc_numa (u_int64_t requested_size, const char* message)
+    {
+        /** All the blocks are aligned, so the regions can be shared by allocations of any type. */
+        u_int64_t size  = (requested_size + NUMA_ALIGN-1) & ~(u_int64_t)(NUMA_ALIGN-1);
+        size_t    local = getLocalNode() % _regions.size();
+
+        /** We try the region of the local node first, then the other ones. */
+        for (size_t i=0; i<_regions.size(); i++)
+        {
+            Region& region = _regions[(local+i) % _regions.size()];
+
+            u_int64_t synced_used_space = __sync_fetch_and_add (&region.used_space, size);
+
+            if (size <= (u_int64_t)(region.end - region.begin) - std::min (synced_used_space, (u_int64_t)(region.end - region.begin)))
+            {
+                __sync_fetch_and_add (i==0 ? &_localBytes : &_remoteBytes, size);
+                return region.begin + synced_used_space;
+            }
+
+            __sync_fetch_and_add (&region.used_space, -size);
+        }
+
+        /** No region alone can hold the block: we may still have enough room in adjacent regions. */
+        char* result = pool_malloc_spanning (size, local);
+        if (result != 0)  {  return result;  }
+
+        throw system::Exception ("Pool allocation failed for %lld bytes (%s). Current usage is %lld and capacity is %lld",
+            requested_size, message, getUsedSpace(), capacity
+        );
+    }
+
+    /** Allocate a block over the free tail of a region followed by unused regions; since the regions
+     * are contiguous, such a block is as valid as one of the non NUMA pool. The regions are claimed
+     * with compare-and-swap, so the concurrent allocations of pool_malloc_numa stay lock free.
+     * \param[in] size : aligned size of the block
+     * \param[in] local : region of the local node
+     * \return the block, 0 if there is no room for it. */
+    char* pool_malloc_spanning (u_int64_t size, size_t local)
+    {
+        system::LocalSynchronizer sync (_synchro);
+
+        for (size_t first=0; first<_regions.size(); first++)
+        {
+            u_int64_t used = _regions[first].used_space;
+            if (used >= (u_int64_t)(_regions[first].end - _regions[first].begin))  { continue; }
+
+            char*  begin = _regions[first].begin + used;
+            size_t last  = first;
+            while ((u_int64_t)(_regions[last].end - begin) < size && last+1 < _regions.size() && _regions[last+1].used_space == 0)  { last++; }
+            if ((u_int64_t)(_regions[last].end - begin) < size)  { continue; }
+
+            /** We claim the regions: the first and the middle ones up to their end, the last one up to the block end. */
+            std::vector<u_int64_t> claims;
+            for (size_t k=first; k<=last; k++)
+            {
+                u_int64_t previous = k==first ? used : 0;
+                u_int64_t claim    = k==last  ? (u_int64_t)(begin + size - _regions[k].begin) : (u_int64_t)(_regions[k].end - _regions[k].begin);
+
+                if (!__sync_bool_compare_and_swap (&_regions[k].used_space, previous, claim))  { break; }
+                claims.push_back (claim - previous);
+            }
+
+            if (claims.size() == last-first+1)
+            {
+                __sync_fetch_and_add (first==local ? &_localBytes : &_remoteBytes, size);
+                return begin;
+            }
+
+            /** A concurrent allocation got in: we give back what we claimed. */
+            for (size_t k=0; k<claims.size(); k++)  {  __sync_fetch_and_add (&_regions[first+k].used_space, -claims[k]);  }
+        }
+
+        return 0;
+    }
+
     char*     mainbuffer;
     u_int64_t capacity; //in bytes
     u_int64_t used_space;
 
     size_t _nbCores;
+    size_t _nbNodes;
+
+    std::vector<Region> _regions;
+    u_int64_t           _localBytes;
+    u_int64_t           _remoteBytes;
 
     system::ISynchronizer* _synchro;
     void setSynchro (system::ISynchronizer* synchro) { SP_SETATTR(synchro); }
+
+    system::impl::MemoryCharge _memory;
 };
 
 /********************************************************************************/
@@ -269,6 +269,26 @@ private:
 
 /********************************************************************************/
 
+/* \brief Progress shared by several iterators iterated at the same time
+ *
+ * The increments notified by the iterators are synchronized. Each iterator would also notify
+ * its own init and finish, so they are ignored: the owner calls them once on the referred listener.
+ */
+class ProgressShared : public ProgressSynchro
+{
+public:
+
+    ProgressShared (dp::IteratorListener* ref, system::ISynchronizer* synchro) : ProgressSynchro (ref, synchro)  {}
+
+    /** \copydoc dp::IteratorListener::init */
+    void init ()  {}
+
+    /** \copydoc dp::IteratorListener::finish */
+    void finish ()  {}
+};
+
+/********************************************************************************/
+
 /** We define a default class for progress information. */
 typedef ProgressTimerAndSystem  ProgressDefault;
 
@@ -20,6 +20,7 @@
 #include <gatb/tools/misc/impl/TimeInfo.hpp>
 #include <gatb/tools/misc/impl/Property.hpp>
 #include <gatb/system/impl/System.hpp>
+#include <gatb/system/impl/Tracer.hpp>
 
 #define DEBUG(a)  //printf a
 
@@ -196,6 +197,43 @@ tools::misc::IProperties* TimeInfo::getProperties (const std::string& root)
     return props;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the durations are given in seconds.
+*********************************************************************/
+tools::misc::IProperties* TimeInfo::getTraceProperties (const std::string& root)
+{
+    Tracer& tracer = Tracer::singleton();
+
+    std::map<std::string,Tracer::Stats> stats = tracer.getStats();
+
+    tools::misc::IProperties* props = new tools::misc::impl::Properties();
+
+    props->add (0, root, "");
+    props->add (1, "nb_spans", "%lld", (long long) tracer.getNbSpans());
+    props->add (1, "nb_lost",  "%lld", (long long) tracer.getNbLost());
+
+    for (std::map<std::string,Tracer::Stats>::iterator it = stats.begin(); it != stats.end(); ++it)
+    {
+        const Tracer::Stats& s = it->second;
+
+        double mean = s.nbLanes > 0 ? (double)s.total / (double)s.nbLanes : 0;
+
+        props->add (1, it->first.c_str(), "");
+        props->add (2, "nb",        "%lld", (long long) s.nb);
+        props->add (2, "total",     "%.3f", (double)s.total   / 1000000.0);
+        props->add (2, "max",       "%.3f", (double)s.max     / 1000000.0);
+        props->add (2, "threads",   "%lld", (long long) s.nbLanes);
+        props->add (2, "imbalance", "%.2f", mean > 0 ? (double)s.maxLane / mean : 1.0);
+    }
+
+    return props;
+}
+
 /********************************************************************************/
 } } } } } /* end of namespaces. */
 /********************************************************************************/
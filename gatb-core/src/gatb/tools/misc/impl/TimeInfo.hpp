@@ -124,6 +124,14 @@ public:
      */
     virtual tools::misc::IProperties* getProperties (const std::string& root);
 
+    /** Creates and return as a IProperties instance a summary of the spans recorded by the
+     * tracer (see system::impl::Tracer). For each span name, the 'imbalance' entry is the ratio
+     * between the biggest and the mean time spent by one thread in such spans.
+     * \param[in] root : root name of the properties to be returned.
+     * \return the created IProperties instance.
+     */
+    static tools::misc::IProperties* getTraceProperties (const std::string& root);
+
 private:
 
     system::ITime&  _time;
@@ -22,7 +22,9 @@
 #include <gatb/tools/misc/impl/Property.hpp>
 #include <gatb/tools/misc/impl/Progress.hpp>
 #include <gatb/tools/misc/impl/LibraryInfo.hpp>
+#include <gatb/tools/misc/impl/MemoryInfo.hpp>
 #include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/system/impl/Tracer.hpp>
 
 #define DEBUG(a)  //printf a
 
@@ -56,7 +58,9 @@ Tool::Tool (const std::string& name) : userDisplayHelp(0), _helpTarget(0),userDi
     setParser (new OptionsParser(name));
 
     getParser()->push_back (new OptionOneParam (STR_NB_CORES,    "number of cores",      false, "0"  ));
+    getParser()->push_back (new OptionNoParam  (STR_NUMA,        "bind the threads and their memory to the NUMA nodes", false));
     getParser()->push_back (new OptionOneParam (STR_VERBOSE,     "verbosity level",      false, "1"  ));
+    getParser()->push_back (new OptionOneParam (STR_TRACE,       "dump a trace of the threads into a file (Chrome trace event format)", false));
 	
 	getParser()->push_back (new OptionNoParam (STR_VERSION, "version", false));
 	getParser()->push_back (new OptionNoParam (STR_HELP, "help", false));
@@ -159,6 +163,9 @@ IProperties* Tool::run (IProperties* input)
         return _output;
     }
 
+    /** We may have to trace the execution. */
+    if (_input->get(STR_TRACE) != 0)  {  Tracer::singleton().enable ();  }
+
     /** We define one dispatcher. */
     if (_input->getInt(STR_NB_CORES) == 1)
     {
@@ -166,7 +173,7 @@ IProperties* Tool::run (IProperties* input)
     }
     else
     {
-        setDispatcher (new Dispatcher (_input->getInt(STR_NB_CORES)) );
+        setDispatcher (new Dispatcher (_input->getInt(STR_NB_CORES), 0, _input->get(STR_NUMA) != 0) );
     }
 
     /** We may have some pre processing. */
@@ -232,6 +239,17 @@ void Tool::postExecute ()
 //        _info->accept (&visit);
 //    }
 
+    /** We may have to dump the trace of the execution and add its summary to the statistics. */
+    if (_input->get(STR_TRACE) != 0)
+    {
+        Tracer::singleton().disable ();
+        Tracer::singleton().dump (_input->getStr(STR_TRACE));
+        _info->add (1, TimeInfo::getTraceProperties ("trace"));
+    }
+
+    /** We add the memory usage of the main data structures. */
+    _info->add (1, MemoryInfo::getInfo ("memory"));
+
     /** We may have to dump execution information to stdout. */
     if (_input->get(STR_VERBOSE) && _input->getInt(STR_VERBOSE) > 0)
     {
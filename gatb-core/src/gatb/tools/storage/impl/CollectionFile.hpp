@@ -131,12 +131,72 @@ public:
         return result;
     }
 
+protected:
+
+    /** Constructor for the files of another format.
+     * \param[in] filename : name of the file
+     * \param[in] bag : writer of the file
+     * \param[in] iterable : reader of the file */
+    CollectionFile (const std::string& filename, collections::Bag<Item>* bag, collections::Iterable<Item>* iterable)
+        : collections::impl::CollectionAbstract<Item> (bag, iterable),  _name(filename), _propertiesName(filename+".props")
+    {}
+
 private:
 
     std::string _name;
     std::string _propertiesName;
 };
 
+/********************************************************************************/
+
+/** \brief Implementation of the Collection interface with a file of (value,abundance) items
+ * delta compressed by blocks (see BlockDeltaCodec).
+ *
+ * StorageFileFactory uses it for the collections of counts, as the solid kmers partitions.
+ */
+template <class Item> class CollectionDeltaFile : public CollectionFile<Item>
+{
+public:
+
+    /** Constructor.
+     * \param[in] filename : name of the file */
+    CollectionDeltaFile (const std::string& filename)
+        : CollectionFile<Item> (filename,
+             new collections::impl::BagDeltaFile<Item>      (filename),
+             new collections::impl::IterableDeltaFile<Item> (filename)
+          )
+    {}
+
+    /** \copydoc Bag::flush
+     * The reader checks the file size again only after a flush. */
+    void flush ()
+    {
+        CollectionFile<Item>::flush ();
+        static_cast<collections::impl::IterableDeltaFile<Item>*> (this->iterable())->refresh ();
+    }
+
+    /** Tells whether a file is to be handled by this class: it is a delta compressed file, or it
+     * is still empty and BlockDeltaSettings::enabled() is true.
+     * \param[in] filename : name of the file
+     * \return true if the file is to be handled by this class */
+    static bool accepts (const std::string& filename)
+    {
+        typedef collections::impl::BlockDeltaCodec<Item> Codec;
+
+        if (!system::impl::System::file().doesExist(filename) || system::impl::System::file().getSize(filename) == 0)
+        {
+            return collections::impl::BlockDeltaSettings::enabled();
+        }
+
+        char mark[Codec::MAGIC_SIZE];
+        system::IFile* file = system::impl::System::file().newFile (filename, "rb");
+        bool result = file->pread (mark, 1, Codec::MAGIC_SIZE, 0) == Codec::MAGIC_SIZE && memcmp (mark, Codec::magic(), Codec::MAGIC_SIZE) == 0;
+        delete file;
+
+        return result;
+    }
+};
+
 /********************************************************************************/
 /* Experimental (not documented). */
 template <class Item> class CollectionGzFile : public collections::impl::CollectionAbstract<Item>, public system::SmartPointer
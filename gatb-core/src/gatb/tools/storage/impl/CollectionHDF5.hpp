@@ -33,6 +33,7 @@
 #include <gatb/tools/collections/api/Collection.hpp>
 #include <gatb/tools/collections/impl/BagFile.hpp>
 #include <gatb/tools/collections/impl/IteratorFile.hpp>
+#include <gatb/tools/collections/impl/IteratorPrefetch.hpp>
 #include <gatb/tools/collections/impl/CollectionAbstract.hpp>
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 #include <gatb/system/impl/System.hpp>
@@ -144,8 +145,12 @@ public:
     /** */
     ~IterableHDF5 ()  {}
 
-    /** */
-    dp::Iterator<Item>* iterator ()  {  return new HDF5Iterator<Item> (this);  }
+    /** Large datasets are read ahead in a background thread (see PrefetchSettings). */
+    dp::Iterator<Item>* iterator ()
+    {
+        if (collections::impl::PrefetchSettings::enabled (_nbItems, 4096))  {  return new collections::impl::IteratorPrefetch<Item> (this, 4096, collections::impl::PrefetchSettings::depth());  }
+        return new HDF5Iterator<Item> (this);
+    }
 
     /** */
     int64_t getNbItems ()
@@ -33,6 +33,7 @@
 #include <gatb/tools/collections/api/Collection.hpp>
 #include <gatb/tools/collections/impl/BagFile.hpp>
 #include <gatb/tools/collections/impl/IteratorFile.hpp>
+#include <gatb/tools/collections/impl/IteratorPrefetch.hpp>
 #include <gatb/tools/collections/impl/CollectionAbstract.hpp>
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 #include <gatb/system/impl/System.hpp>
@@ -331,8 +332,15 @@ public:
     /** */
     ~IterableHDF5Patch ()  { setCommon(0);}
 
-    /** */
-    dp::Iterator<Item>* iterator ()  {  return new HDF5IteratorPatch<Item> (this);  }
+    /** Large datasets are read ahead in a background thread (see PrefetchSettings). */
+    dp::Iterator<Item>* iterator ()
+    {
+        if (collections::impl::PrefetchSettings::enabled (getNbItems(), GATB_HDF5_NB_ITEMS_PER_BLOCK))
+        {
+            return new collections::impl::IteratorPrefetch<Item> (this, GATB_HDF5_NB_ITEMS_PER_BLOCK, collections::impl::PrefetchSettings::depth());
+        }
+        return new HDF5IteratorPatch<Item> (this);
+    }
 
     /** */
     int64_t getNbItems ()  {  
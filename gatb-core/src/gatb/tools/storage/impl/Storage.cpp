@@ -20,6 +20,7 @@
 /********************************************************************************/
 
 #include <gatb/tools/storage/impl/Storage.hpp>
+#include <gatb/system/impl/Tracer.hpp>
 
 /********************************************************************************/
 namespace gatb { namespace core {  namespace tools {  namespace storage {  namespace impl {
@@ -225,7 +226,7 @@ class Storage_istreambuf : public std::streambuf
             {
                 std::cout << "Error: trying to read more elements " << (start - base) << " = (" << start << " - " << base << ") than the buffer size" << std::endl; exit(1);
             }
-            size_t offset = currentIdx ; // in hdf5: needs to be currentIdx; in file: needs to be 0 (but it will be fixed in IteratorFile, ok, not here)
+            size_t offset = currentIdx ; // index of the first item to read, both in hdf5 and in file
             size_t n = _collection->getItems (start2, offset, buffer_.size() - (start - base));
             currentIdx += n;
 
@@ -357,8 +358,10 @@ std::string SuperKmerBinFiles::getFileName(int fileId)
 }
 
 	
-int SuperKmerBinFiles::readBlock(unsigned char ** block, unsigned int* max_block_size, unsigned int* nb_bytes_read, int file_id)
+int SuperKmerBinFiles::readBlock(unsigned char ** block, unsigned int* max_block_size, unsigned int* nb_bytes_read, int file_id, u_int16_t* bank_id)
 {
+	TRACE_SPAN_ARG ("io", "read_superkmers", file_id);
+
 	_synchros[file_id]->lock();
 	
 	//block header
@@ -371,6 +374,11 @@ int SuperKmerBinFiles::readBlock(unsigned char ** block, unsigned int* max_block
 		return 0;
 	}
 	
+	u_int16_t block_bank_id = 0;
+	_files[file_id]->fread(&block_bank_id, sizeof(block_bank_id),1);
+	if(bank_id != 0)
+		*bank_id = block_bank_id;
+	
 	if(*nb_bytes_read > *max_block_size)
 	{
 		*block = (unsigned char *) realloc(*block, *nb_bytes_read);
@@ -415,15 +423,17 @@ void SuperKmerBinFiles::getFilesStats(u_int64_t & total, u_int64_t & biggest, u_
 }
 	
 	
-void SuperKmerBinFiles::writeBlock(unsigned char * block, unsigned int block_size, int file_id, int nbkmers)
+void SuperKmerBinFiles::writeBlock(unsigned char * block, unsigned int block_size, int file_id, int nbkmers, u_int16_t bank_id)
 {
+	TRACE_SPAN_ARG ("io", "write_superkmers", file_id);
 
 	_synchros[file_id]->lock();
 	
 	_nbKmerperFile[file_id]+=nbkmers;
-	_FileSize[file_id] += block_size+sizeof(block_size);
+	_FileSize[file_id] += block_size+sizeof(block_size)+sizeof(bank_id);
 	//block header
 	_files[file_id]->fwrite(&block_size, sizeof(block_size),1);
+	_files[file_id]->fwrite(&bank_id, sizeof(bank_id),1);
 
 	//block
 	_files[file_id]->fwrite(block, sizeof(unsigned char),block_size);
@@ -502,9 +512,11 @@ int SuperKmerBinFiles::nbFiles()
 
 
 	
-CacheSuperKmerBinFiles::CacheSuperKmerBinFiles(SuperKmerBinFiles * ref, int buffsize )
+CacheSuperKmerBinFiles::CacheSuperKmerBinFiles(SuperKmerBinFiles * ref, int buffsize, u_int16_t bank_id )
+	: _memory(system::impl::MEMORY_SUPERKMER_CACHE)
 {
 	_ref = ref;
+	_bank_id = bank_id;
 
 	_nb_files = _ref->nbFiles();
 	_nbKmerperFile.resize(_nb_files,0);
@@ -514,25 +526,35 @@ CacheSuperKmerBinFiles::CacheSuperKmerBinFiles(SuperKmerBinFiles * ref, int buff
 
 	_max_superksize= 255; // this is extra size from regular kmer; ie total max superksize is kmersize +  _max_superksize
 	
-	_buffers.resize(_nb_files);
-	_buffers_idx.resize(_nb_files,0);
-	
-	for(unsigned int ii=0; ii<_buffers.size();ii++ )
-	{
-		_buffers[ii] = (u_int8_t*) MALLOC (sizeof(u_int8_t) * _buffer_max_capacity);
-	}
+	allocateBuffers();
 	
 }
 	
 //copy construc : alloc own buffer for new object
 CacheSuperKmerBinFiles::CacheSuperKmerBinFiles (const CacheSuperKmerBinFiles& p)
+	: _memory(system::impl::MEMORY_SUPERKMER_CACHE)
 {
 	_ref = p._ref;
+	_bank_id = p._bank_id;
 	_nb_files= p._nb_files;
 	_buffer_max_capacity= p._buffer_max_capacity;
 	_max_superksize= p._max_superksize;
 	_nbKmerperFile.resize(_nb_files,0);
 
+	allocateBuffers();
+}
+	
+//each thread has its own cache, so the buffers are shrunk when the caches of all the threads
+//don't fit into the memory budget ; we only get more (smaller) writes in that case
+void CacheSuperKmerBinFiles::allocateBuffers()
+{
+	u_int64_t available = system::impl::MemoryAccounting::singleton().getAvailable();
+
+	if ((u_int64_t)_buffer_max_capacity * _nb_files > available)
+	{
+		_buffer_max_capacity = std::max ((u_int64_t)MIN_BUFFER_SIZE, available / std::max (_nb_files, 1));
+	}
+
 	_buffers.resize(_nb_files);
 	_buffers_idx.resize(_nb_files,0);
 	
@@ -540,8 +562,10 @@ CacheSuperKmerBinFiles::CacheSuperKmerBinFiles (const CacheSuperKmerBinFiles& p)
 	{
 		_buffers[ii] = (u_int8_t*) MALLOC (sizeof(u_int8_t) * _buffer_max_capacity);
 	}
+
+	_memory.set ((u_int64_t)_buffer_max_capacity * _nb_files);
 }
-	
+
 void CacheSuperKmerBinFiles::flushAll()
 {
 	//printf("flush all buffers\n");
@@ -556,7 +580,7 @@ void CacheSuperKmerBinFiles::flush(int file_id)
 {
 	if(_buffers_idx[file_id]!=0)
 	{
-		_ref->writeBlock(_buffers[file_id],_buffers_idx[file_id],file_id,_nbKmerperFile[file_id]);
+		_ref->writeBlock(_buffers[file_id],_buffers_idx[file_id],file_id,_nbKmerperFile[file_id],_bank_id);
 		
 		_buffers_idx[file_id]=0;
 		_nbKmerperFile[file_id] = 0;
@@ -579,6 +603,15 @@ void CacheSuperKmerBinFiles::insertSuperkmer(u_int8_t* superk, int nb_bytes, u_i
 	
 }
 	
+void CacheSuperKmerBinFiles::setBankId (u_int16_t bank_id)
+{
+	if (bank_id == _bank_id)  { return; }
+
+	/** The blocks hold superkmers of a single bank. */
+	this->flushAll();
+	_bank_id = bank_id;
+}
+
 CacheSuperKmerBinFiles::~CacheSuperKmerBinFiles()
 {
 	this->flushAll();
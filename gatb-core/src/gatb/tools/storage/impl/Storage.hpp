@@ -41,6 +41,7 @@
 #include <gatb/tools/collections/impl/CollectionCache.hpp>
 
 #include <gatb/tools/misc/api/IProperty.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
 
 #include <gatb/tools/math/NativeInt8.hpp>
 
@@ -238,10 +239,12 @@ protected:
 
 	
 	
-//block header = 4B = block size
+//block header = 4B = block size , 2B = index of the bank the superkmers of the block come from
 //puis block = liste de couple  < superk length = 1B  , superkmer = nB  >
 //the  block structure makes it easier for buffered read,
 //otherwise we would not know how to read a big chunk without stopping in the middle of superkmer
+//a block never mixes superkmers of several banks (one cache per bank and per thread), so the bank
+//index is stored once per block rather than once per superkmer
 
 class SuperKmerBinFiles
 {
@@ -263,8 +266,9 @@ public:
 
 	//read/write block of superkmers to filefile_id
 	//readBlock will re-allocate the block buffer if needed (current size passed by max_block_size)
-	int readBlock(unsigned char ** block, unsigned int* max_block_size, unsigned int* nb_bytes_read, int file_id);
-	void writeBlock(unsigned char * block, unsigned int block_size, int file_id, int nbkmers);
+	//and gives the bank index of the block superkmers if bank_id is not null
+	int readBlock(unsigned char ** block, unsigned int* max_block_size, unsigned int* nb_bytes_read, int file_id, u_int16_t* bank_id=0);
+	void writeBlock(unsigned char * block, unsigned int block_size, int file_id, int nbkmers, u_int16_t bank_id=0);
 
 	int nbFiles();
 	int getNbItems(int fileId);
@@ -293,7 +297,7 @@ private:
 class CacheSuperKmerBinFiles
 {
 	public:
-	CacheSuperKmerBinFiles(SuperKmerBinFiles * ref, int buffsize);
+	CacheSuperKmerBinFiles(SuperKmerBinFiles * ref, int buffsize, u_int16_t bank_id=0);
 	
 	CacheSuperKmerBinFiles (const CacheSuperKmerBinFiles& p);
 
@@ -302,16 +306,29 @@ class CacheSuperKmerBinFiles
 	void flush(int file_id);
 	~CacheSuperKmerBinFiles();
 
+	/** Change the bank of the next inserted superkmers; the buffers are flushed first if the bank changes. */
+	void setBankId (u_int16_t bank_id);
+
+	/** Get the size of the buffer of each file; it may be smaller than the asked one if the memory budget is short. */
+	int getBufferSize () const  { return _buffer_max_capacity; }
+
+	/** Minimum size of the buffers when they are shrunk for fitting the memory budget. */
+	static const int MIN_BUFFER_SIZE = 4096;
+
 private:
+	void allocateBuffers ();
+
 	SuperKmerBinFiles * _ref;
 	int _max_superksize;
 	int _buffer_max_capacity;
 	int _nb_files;
+	u_int16_t _bank_id;
 	
 	std::vector< u_int8_t* > _buffers;
 	std::vector<int> _buffers_idx;
 	std::vector<int> _nbKmerperFile;
 
+	system::impl::MemoryCharge _memory;
 };
 	
 	
@@ -31,6 +31,7 @@
 /********************************************************************************/
 
 #include <cassert>
+#include <type_traits>
 #include <gatb/tools/storage/impl/CollectionFile.hpp>
 #include <json/json.hpp>
 #include <iostream>
@@ -179,7 +180,12 @@ public:
      */
     static bool exists (const std::string& name)
     {
-        return false;
+        /** A file storage is a folder holding one file per collection (and per partition item),
+         * plus json files for the properties. */
+        std::string folder = name;
+        if (!system::impl::System::file().isFolderEndingWith(name,"_gatb"))
+            folder += "_gatb/";
+        return system::impl::System::file().doesExistDirectory(folder);
     }
 
     /** Create a Group instance and attach it to a cell in a storage.
@@ -229,7 +235,8 @@ public:
            int nb_partitions=0;
            for (auto filename : system::impl::System::file().listdir(folder))
             {
-                if (!filename.compare(0, prefix.size(), prefix)) // startswith
+                if (!filename.compare(0, prefix.size(), prefix) // startswith
+                    && system::impl::System::file().getExtension(filename) != "props") // properties of a collection, not a collection
                 {
                     nb_partitions++;
                 }
@@ -293,7 +300,30 @@ public:
 
 		DEBUG_STORAGE (("StorageFileFactory::createCollection  name='%s'  actualName='%s' \n", name.c_str(), actualName.c_str() ));
 
-        return new CollectionNode<Type> (storage->getFactory(), parent, name, new CollectionFile<Type>(actualName));
+        return new CollectionNode<Type> (storage->getFactory(), parent, name, newCollection<Type> (actualName));
+    }
+
+private:
+
+    /** The collections of counts (as the solid kmers partitions) are delta compressed, see CollectionDeltaFile;
+     * the other ones hold the raw items. */
+    template<typename Type>
+    static collections::Collection<Type>* newCollection (const std::string& filename)
+    {
+        return newCollection<Type> (filename, std::integral_constant<bool, collections::impl::BlockDeltaSupport<Type>::value>());
+    }
+
+    template<typename Type>
+    static collections::Collection<Type>* newCollection (const std::string& filename, std::true_type)
+    {
+        if (CollectionDeltaFile<Type>::accepts (filename))  { return new CollectionDeltaFile<Type> (filename); }
+        return new CollectionFile<Type> (filename);
+    }
+
+    template<typename Type>
+    static collections::Collection<Type>* newCollection (const std::string& filename, std::false_type)
+    {
+        return new CollectionFile<Type> (filename);
     }
 };
 
@@ -36,6 +36,7 @@
 #include <gatb/tools/storage/impl/Storage.hpp>
 #include <gatb/tools/collections/impl/Bloom.hpp>
 #include <gatb/tools/collections/impl/ContainerSet.hpp>
+#include <gatb/tools/collections/impl/RibbonFilter.hpp>
 
 
 /********************************************************************************/
@@ -156,6 +157,50 @@ public:
         return bloom;
     }
 
+    /** Save a ribbon filter into a group
+     * \param[in] group : group where the filter has to be saved
+     * \param[in] name : name of the filter in the group
+     * \param[in] filter : filter to be saved
+     */
+    template<typename T>  void saveRibbonFilter (Group& group, const std::string& name, collections::impl::RibbonFilter<T>* filter)
+    {
+        collections::Collection<math::NativeInt8>* filterCollection = & group.getCollection<math::NativeInt8> (name);
+
+        tools::storage::impl::Storage::ostream os (group, name);
+        os.write (reinterpret_cast<char const*>(filter->getArray()), filter->getSize()*sizeof(char));
+        os.flush();
+
+        std::stringstream ss1;  ss1 <<  filter->getNbSlots();
+        std::stringstream ss2;  ss2 <<  filter->getNbBits();
+        std::stringstream ss3;  ss3 <<  filter->getSeed();
+
+        filterCollection->addProperty ("nb_slots", ss1.str());
+        filterCollection->addProperty ("nb_bits",  ss2.str());
+        filterCollection->addProperty ("seed",     ss3.str());
+        filterCollection->flush ();
+    }
+
+    /** Load a ribbon filter from a group
+     * \param[in] group : group where the filter is
+     * \param[in] name : name of the filter in the group
+     * \return the filter
+     */
+    template<typename T>  collections::impl::RibbonFilter<T>*  loadRibbonFilter (Group& group, const std::string& name)
+    {
+        collections::Collection<math::NativeInt8>* filterCollection = & group.getCollection<math::NativeInt8> (name);
+
+        collections::impl::RibbonFilter<T>* filter = new collections::impl::RibbonFilter<T> (
+            (u_int64_t) strtoull (filterCollection->getProperty("nb_slots").c_str(), NULL, 10),
+            (size_t)    atoi     (filterCollection->getProperty("nb_bits").c_str()),
+            (u_int64_t) strtoull (filterCollection->getProperty("seed").c_str(),     NULL, 10)
+        );
+
+        tools::storage::impl::Storage::istream is (group, name);
+        is.read (reinterpret_cast<char*>(filter->getArray()), filter->getSize()*sizeof(char));
+
+        return filter;
+    }
+
 private:
 
     /** We keep the possibility to load/save Bloom filters in two different ways.
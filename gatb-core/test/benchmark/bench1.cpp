@@ -16,25 +16,24 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *****************************************************************************/
 
+/* Benchmark of the conversion of ASCII nucleotides into 2 bits codes and of the
+ * computation of the kmers of the sequences: per nucleotide (Data::ConvertASCII and
+ * ModelCanonical::codeSeedRight) versus bulk (PackedNucleotides and RollingKmers). The
+ * Model::iterate timing uses the whole sequence validity check of PackedNucleotides::isValid.
+ *
+ * Usage: bench1 kmerSize [FASTA bank]  (random sequences are used if no bank is given)
+ */
+
 #include <gatb/system/impl/System.hpp>
 
-#include <gatb/bank/impl/Bank.hpp>
-#include <gatb/bank/impl/BankBinary.hpp>
-#include <gatb/bank/impl/BankHelpers.hpp>
+#include <gatb/bank/impl/BankFasta.hpp>
+#include <gatb/bank/impl/BankRandom.hpp>
 
 #include <gatb/kmer/impl/Model.hpp>
-#include <gatb/kmer/impl/BankKmerIterator.hpp>
-
-#include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
+#include <gatb/kmer/impl/RollingKmers.hpp>
 
-#include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/misc/impl/NucleotideEncoder.hpp>
 
-#include <gatb/tools/misc/impl/Property.hpp>
-#include <gatb/tools/misc/impl/Progress.hpp>
-
-#include <gatb/tools/misc/impl/Progress.hpp>
-#include <gatb/tools/math/LargeInt.hpp>
-#include <gatb/tools/math/Integer.hpp>
 #include <iostream>
 #include <string.h>
 
@@ -47,317 +46,182 @@ using namespace gatb::core::bank::impl;
 using namespace gatb::core::kmer;
 using namespace gatb::core::kmer::impl;
 using namespace gatb::core::tools::dp;
-using namespace gatb::core::tools::dp::impl;
 using namespace gatb::core::tools::misc;
 using namespace gatb::core::tools::misc::impl;
-using namespace gatb::core::tools::math;
-using namespace gatb::core::tools::misc::impl;
 
 /********************************************************************************/
 
-struct Hash  {   kmer_type operator () (kmer_type& lkmer)
-{
-    kmer_type kmer_hash;
+static const size_t span = 32;
 
-    kmer_hash = lkmer ^ (lkmer >> 14);
-    kmer_hash = (~kmer_hash) + (kmer_hash << 18);
-    kmer_hash = kmer_hash ^ (kmer_hash >> 31);
-    kmer_hash = kmer_hash * 21;
-    kmer_hash = kmer_hash ^ (kmer_hash >> 11);
-    kmer_hash = kmer_hash + (kmer_hash << 6);
-    kmer_hash = kmer_hash ^ (kmer_hash >> 22);
+typedef Kmer<span>::ModelCanonical  ModelCanonical;
+typedef Kmer<span>::Type            Type;
 
-    return kmer_hash;
-}};
-
-Hash theHash;
-
-/********************************************************************************/
-
-struct FunctorIter1
+/** We keep all the sequences in memory, so the benchmark doesn't time the reading of the bank. */
+static void loadSequences (IBank& bank, vector<string>& sequences, u_int64_t& nbNucleotides)
 {
-    void operator() (Sequence& sequence)
-    {
-        nbSeq++;
-        dataSeq += sequence.getData().size();
+    Iterator<Sequence>* it = bank.iterator();
+    LOCAL (it);
 
-        model->build (sequence.getData(), kmers);
-
-        size_t size = kmers.size();
-
-        for (size_t i=0; i<size; i++)
-        {
-            kmer_type h = theHash(kmers[i]);
-
-            if ((h % nbPass) != pass)  { continue; }
-
-            nbKmers ++;
-            checksumKmers = checksumKmers + h;
-        }
+    nbNucleotides = 0;
+    for (it->first(); !it->isDone(); it->next())
+    {
+        sequences.push_back (it->item().toString());
+        nbNucleotides += sequences.back().size();
     }
+}
 
-    FunctorIter1 () : nbSeq(0), dataSeq(0), nbKmers(0), checksumKmers(0), pass(0), nbPass(0), model(0) {}
-
-    vector<kmer_type> kmers;
-
-    u_int64_t nbSeq;
-    u_int64_t dataSeq;
-    u_int64_t nbKmers;
-    kmer_type checksumKmers;
-
-    size_t pass;
-    size_t nbPass;
-    KmerModel* model;
-};
+/********************************************************************************/
 
-template <typename Functor> void iter1 (
-    IDispatcher& dispatcher,
-    IBank& bank,
-    KmerModel& model,
-    Functor& hash,
-    IteratorListener* progress=0
-)
+static void reportTime (const char* label, ITime::Value t0, ITime::Value t1, u_int64_t nb, u_int64_t checksum)
 {
-    // We use the provided listener if any
-    LOCAL (progress);
-
-    // We need an iterator on the FASTA bank.
-    Iterator<Sequence>* itBank = bank.iterator();
-    LOCAL (itBank);
-
-    // We declare two kmer iterators for the two banks and a paired one that links them.
-    KmerModel::Iterator itKmer (model);
-
-    // We create an iterator over the paired iterator on sequences
-    SubjectIterator<Sequence> itSeq (itBank, 5*1000);
-
-    if (progress)  {  itSeq.addObserver (progress);  }
-
-    u_int64_t total_nbKmers       = 0;
-    kmer_type total_checksumKmers = 0;
-
-    size_t nbPasses = 10;
+    cout << label << " : " << (t1-t0) << " msec  (" << (double)nb / (double) (t1>t0 ? t1-t0 : 1) << " per msec)  "
+         << "checksum " << hex << checksum << dec << endl;
+}
 
-    // We get some information about the kmers.
-    u_int64_t nbSeq[nbPasses];
-    u_int64_t dataSeq[nbPasses];
-    u_int64_t nbKmers[nbPasses];
-    kmer_type checksumKmers[nbPasses];
+/********************************************************************************/
 
-    for (size_t p=0; p<nbPasses; p++)
+static void benchEncoding (const vector<string>& sequences, u_int64_t nbNucleotides)
+{
+    ITime::Value t0, t1;
+    u_int64_t checksum;
+
+    /** Per nucleotide conversion. */
+    vector<char> codes;
+    checksum = 0;
+    t0 = System::time().getTimeStamp();
+    for (size_t s=0; s<sequences.size(); s++)
     {
-        // We get current time stamp
-        ITime::Value t0 = System::time().getTimeStamp();
-
-        vector<FunctorIter1> functors (dispatcher.getExecutionUnitsNumber());
-
-        for (size_t i=0; i<functors.size(); i++)
-        {
-            functors[i].pass   = p;
-            functors[i].nbPass = nbPasses;
-            functors[i].model  = &model;
-        }
-
-        nbSeq[p]         = 0;
-        dataSeq[p]       = 0;
-        nbKmers[p]       = 0;
-        checksumKmers[p] = 0;
-
-#if 0
-        dispatcher.iterate (itSeq, functors);
-#endif
-
-        for (size_t i=0; i<functors.size(); i++)
+        const char* seq = sequences[s].data();
+        size_t      len = sequences[s].size();
+        codes.resize (len);
+        for (size_t i=0; i<len; i++)
         {
-            nbSeq[p]         += functors[i].nbSeq;
-            dataSeq[p]       += functors[i].dataSeq;
-            nbKmers[p]       += functors[i].nbKmers;
-            checksumKmers[p] = checksumKmers[p] + functors[i].checksumKmers;
-
-            total_nbKmers       += functors[i].nbKmers;
-            total_checksumKmers = total_checksumKmers + functors[i].checksumKmers;
+            Data::ConvertChar c = Data::ConvertASCII::get (seq, i);
+            codes[i]  = c.first;
+            checksum += c.second;
         }
-
-        // We get current time stamp
-        ITime::Value t1 = System::time().getTimeStamp();
-
-        // We dump some information about the iterated kmers;
-        cout << "FOUND " << nbKmers[p] << " kmers  for " << nbSeq[p] << " sequences  (" << dataSeq[p] << " bytes)  "
-            << "in " << (t1-t0) << " msec (rate " << (double)nbKmers[p] / (double) (t1>t0 ? t1-t0 : 1) << " kmers/msec),  "
-            << "checksum is " << checksumKmers[p]
-            << endl;
+        checksum += codes[len/2];
     }
-    cout << endl;
-    cout << "TOTAL KMERS " << total_nbKmers << "  WITH CHECKSUM " << hex << total_checksumKmers << "  WITH " << Integer::getName()  <<  endl;
-
-    for (size_t p=0; p<nbPasses; p++)
+    t1 = System::time().getTimeStamp();
+    reportTime ("encoding   scalar ", t0, t1, nbNucleotides, checksum);
+
+    /** Bulk conversion. */
+    PackedNucleotides packed;
+    checksum = 0;
+    t0 = System::time().getTimeStamp();
+    for (size_t s=0; s<sequences.size(); s++)
     {
-        cout << "   [" << p << "]  " << 100.0 * (double)nbKmers[p] / (double) total_nbKmers << endl;
+        size_t len = sequences[s].size();
+        packed.encode (sequences[s].data(), len);
+        for (size_t w=0; w<(len+63)/64; w++)  { checksum += __builtin_popcountll (packed.getInvalidMask()[w]); }
+        checksum += packed[len/2];
     }
+    t1 = System::time().getTimeStamp();
+    reportTime ("encoding   bulk   ", t0, t1, nbNucleotides, checksum);
 }
 
 /********************************************************************************/
 
-template <typename Functor> void iter2 (IBank& bank, KmerModel& model, Functor& hash, IteratorListener* progress=0)
+struct SumFunctor
 {
-#if 1
-    // We use the provided listener if any
-    LOCAL (progress);
-
-    BankKmerIterator itKmerBank (bank, model);
-
-    // We get some information about the kmers.
-    u_int64_t nbKmers       = 0;
-    kmer_type checksumKmers = 0;
-
-    // We get current time stamp
-    ITime::Value t0 = System::time().getTimeStamp();
-
-    if (progress)  {  itKmerBank.addObserver (progress);  }
-
-    for (itKmerBank.first(); !itKmerBank.isDone();  itKmerBank.next())
-    {
-        nbKmers      += 1;
-        checksumKmers = checksumKmers + hash (*itKmerBank);
-    }
-
-    // We get current time stamp
-    ITime::Value t1 = System::time().getTimeStamp();
+    u_int64_t& checksum;
+    SumFunctor (u_int64_t& checksum) : checksum(checksum) {}
+    void operator() (const ModelCanonical::Kmer& kmer, size_t idx)  {  if (kmer.isValid())  { checksum += kmer.value().getVal(); }  }
+};
 
-    // We dump some information about the iterated kmers;
-    cout << "FOUND " << nbKmers << " kmers "
-         << "in " << (t1-t0) << " msec (rate " << (double)nbKmers / (double) (t1-t0) << " kmers/msec),  "
-         << "checksum is " << checksumKmers
-         << endl;
-#endif
-}
+static void benchRolling (const vector<string>& sequences, size_t kmerSize)
+{
+    ITime::Value t0, t1;
+    u_int64_t checksum, nbKmers;
 
-/********************************************************************************/
+    ModelCanonical model (kmerSize);
 
-struct FunctorIter3
-{
-    void operator() (std::vector<kmer_type>& kmers)
+    /** Per nucleotide rolling. */
+    checksum = nbKmers = 0;
+    t0 = System::time().getTimeStamp();
+    for (size_t s=0; s<sequences.size(); s++)
     {
-        Hash hash;
+        const char* seq = sequences[s].data();
+        size_t      len = sequences[s].size();
+        if (len < kmerSize)  { continue; }
 
-        size_t size = kmers.size();
+        ModelCanonical::Kmer kmer = model.codeSeed (seq, Data::ASCII);
+        if (kmer.isValid())  { checksum += kmer.value().getVal(); }
 
-        for (size_t i=0; i<size; i++)
+        for (size_t i=kmerSize; i<len; i++)
         {
-            nbKmers ++;
-            checksumKmers = checksumKmers + hash (kmers[i]);
+            kmer = model.codeSeedRight (kmer, seq[i], Data::ASCII);
+            if (kmer.isValid())  { checksum += kmer.value().getVal(); }
         }
+        nbKmers += len - kmerSize + 1;
     }
+    t1 = System::time().getTimeStamp();
+    reportTime ("rolling    scalar ", t0, t1, nbKmers, checksum);
 
-    u_int64_t nbKmers;
-    kmer_type checksumKmers;
-};
-
-template <typename Functor> void iter3 (IBank& bank, KmerModel& model, Functor& hash, IteratorListener* progress=0)
-{
-    // We use the provided listener if any
-    LOCAL (progress);
-
-    BankVectorKmerIterator<kmer_type> itKmerBank (bank, model);
-
-    // We get some information about the kmers.
-    u_int64_t nbKmers       = 0;
-    kmer_type checksumKmers = 0;
-
-    // We get current time stamp
-    ITime::Value t0 = System::time().getTimeStamp();
-
-    if (progress)  {  itKmerBank.addObserver (progress);  }
-
-    ParallelCommandDispatcher dispatcher (8);
-
-    vector<FunctorIter3> functors (dispatcher.getExecutionUnitsNumber());
-
-#if 0
-    dispatcher.iterate (itKmerBank, functors, 1);
-#endif
-
-    for (size_t i=0; i<functors.size(); i++)
+    /** Model::iterate (bulk encoding of the sequence, then rolling over the packed codes). */
+    checksum = 0;
+    t0 = System::time().getTimeStamp();
+    for (size_t s=0; s<sequences.size(); s++)
     {
-        nbKmers       += functors[i].nbKmers;
-        checksumKmers = checksumKmers + functors[i].checksumKmers;
+        Data data (Data::ASCII);
+        data.setRef ((char*) sequences[s].data(), sequences[s].size());
+        model.iterate (data, SumFunctor(checksum));
     }
-
-    // We get current time stamp
-    ITime::Value t1 = System::time().getTimeStamp();
-
-    // We dump some information about the iterated kmers;
-    cout << "FOUND " << nbKmers << " kmers "
-         << "in " << (t1-t0) << " msec (rate " << (double)nbKmers / (double) (t1-t0) << " kmers/msec),  "
-         << "checksum is " << checksumKmers
-         << endl;
+    t1 = System::time().getTimeStamp();
+    reportTime ("rolling    iterate", t0, t1, nbKmers, checksum);
+
+    /** RollingKmers over the packed codes. */
+    PackedNucleotides      packed;
+    RollingKmers<span>     rolling (kmerSize);
+    vector<Type>           kmers;
+    vector<u_int64_t>      invalid;
+
+    checksum = 0;
+    t0 = System::time().getTimeStamp();
+    for (size_t s=0; s<sequences.size(); s++)
+    {
+        packed.encode (sequences[s].data(), sequences[s].size());
+        size_t nb = rolling.canonical (packed, kmers, invalid);
+        for (size_t i=0; i<nb; i++)  {  if (((invalid[i/64] >> (i%64)) & 1) == 0)  { checksum += kmers[i].getVal(); }  }
+    }
+    t1 = System::time().getTimeStamp();
+    reportTime ("rolling    bulk   ", t0, t1, nbKmers, checksum);
 }
 
 /********************************************************************************/
 
 int main (int argc, char* argv[])
 {
-    if (argc < 3)
+    if (argc < 2)
     {
-        cerr << "you must provide at least 2 arguments. Arguments are:" << endl;
-        cerr << "   1) kmer size"  << endl;
-        cerr << "   2) FASTA  bank" << endl;
-        cerr << "   3) binary bank" << endl;
+        cerr << "you must provide at least 1 argument. Arguments are:" << endl;
+        cerr << "   1) kmer size (< " << span << ")" << endl;
+        cerr << "   2) FASTA bank (optional, random sequences otherwise)" << endl;
         return EXIT_FAILURE;
     }
 
-    // We define the max size of a data line in the FASTA output file
     size_t kmerSize = atoi(argv[1]);
 
-    // We get the URI of the FASTA bank
-    string filename (argv[2]);
-    string filenameBin = argc <=3 ? (filename + ".bin") : argv[3];
-
-#if 1
-    // We define a try/catch block in case some method fails (bad filename for instance)
     try
     {
-        ParallelCommandDispatcher dispatcher (8);
-
-        // We declare a kmer model with a given span size.
-        KmerModel model (kmerSize);
+        IBank* bank = argc >= 3 ? (IBank*) new BankFasta (argv[2]) : (IBank*) new BankRandom (200*1000, 150);
+        LOCAL (bank);
 
-        // We declare the FASTA bank
-        BankFasta bank (filename);
+        vector<string> sequences;
+        u_int64_t      nbNucleotides = 0;
+        loadSequences (*bank, sequences, nbNucleotides);
 
-        // We declare a binary bank
-        BankBinary bankBin (filenameBin);
+        cout << sequences.size() << " sequences, " << nbNucleotides << " nucleotides, k=" << kmerSize << endl;
 
-        if (System::file().doesExist(filenameBin) == false)
-        {
-            // We declare some job listener.
-            Progress progress (bank.estimateNbSequences(), "FASTA to binary conversion");
-
-            // We convert the FASTA bank in binary format
-            IProperties* props = BankHelper::singleton().convert (bank, bankBin, &progress);
-            LOCAL (props);
-        }
-
-        //HashNull hash;
-        Hash hash;
-
-        // TEST 1
-        iter1 (dispatcher, bankBin, model, hash, new Progress (bank.estimateNbSequences(), "Iterating 1"));
-
-        // TEST 2
-        //iter2 (bankBin, model, hash, new Progress (bank.estimateNbSequences(), "Iterating 2"));
-
-        // TEST 3
-        //iter3 (bankBin, model, hash, new Progress (bank.estimateNbSequences(), "Iterating 3"));
-
-        // We remove the binary bank
-        //System::file().remove (filename + ".bin");
+        benchEncoding (sequences, nbNucleotides);
+        benchRolling  (sequences, kmerSize);
     }
 
     catch (gatb::core::system::Exception& e)
     {
         cerr << "EXCEPTION: " << e.getMessage() << endl;
+        return EXIT_FAILURE;
     }
-#endif
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,115 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/* Benchmark of the cFP containers: the graph is built with each debloom kind, then we time
+ * the neighbors() and isBranching() queries (which query the cFP container) on all the nodes.
+ *
+ * Usage: bench_debloom reads [kmerSize]
+ */
+
+#include <gatb/system/impl/System.hpp>
+#include <gatb/debruijn/impl/Graph.hpp>
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+using namespace gatb::core::debruijn;
+using namespace gatb::core::debruijn::impl;
+using namespace gatb::core::tools::misc;
+
+/********************************************************************************/
+
+static void bench (const string& reads, size_t kmerSize, const char* kind)
+{
+    ITime::Value t0, t1;
+
+    string args = "-in " + reads + " -kmer-size " + std::to_string(kmerSize)
+        + " -abundance-min 1 -verbose 0 -max-memory 500 -debloom " + kind + " -out bench_debloom_" + kind;
+
+    t0 = System::time().getTimeStamp();
+    Graph graph = Graph::create (args.c_str());
+    t1 = System::time().getTimeStamp();
+
+    cout << "[" << kind << "]  build : " << (t1-t0) << " msec" << endl;
+
+    /** The debloom bits per kmer count the Bloom filter and the cFP structures. */
+    u_int64_t nbKmers = graph.getInfo().getInt ("kmers_nb_solid");
+    cout << "[" << kind << "]  debloom bits per kmer : " << graph.getInfo().getStr ("debloom.nbits_per_kmer")
+         << "  (cFP structures " << (double)graph.getInfo().getInt ("debloom.cfp") / nbKmers << ")" << endl;
+
+    /** We don't want to time the node state checks. */
+    graph.disableNodeState();
+
+    GraphIterator<Node> nodes = graph.iterator();
+
+    /** The nodes are Bloom positives, so each probe queries the cFP structures. */
+    u_int64_t nbProbes = 0;
+    t0 = System::time().getTimeStamp();
+    for (size_t i=0; i<10; i++)  {  for (nodes.first(); !nodes.isDone(); nodes.next())  {  if (graph.contains (nodes.item()))  { nbProbes++; }  }  }
+    t1 = System::time().getTimeStamp();
+
+    cout << "[" << kind << "]  contains()    on " << nbProbes << " nodes : " << (t1-t0) << " msec  (" << 1e6*(t1-t0)/nbProbes << " nsec per probe)" << endl;
+
+    u_int64_t nbNeighbors = 0;
+    t0 = System::time().getTimeStamp();
+    for (nodes.first(); !nodes.isDone(); nodes.next())  {  nbNeighbors += graph.neighbors (nodes.item()).size();  }
+    t1 = System::time().getTimeStamp();
+
+    cout << "[" << kind << "]  neighbors()   on " << nodes.size() << " nodes : " << (t1-t0) << " msec  (" << nbNeighbors << " neighbors)" << endl;
+
+    u_int64_t nbBranching = 0;
+    t0 = System::time().getTimeStamp();
+    for (nodes.first(); !nodes.isDone(); nodes.next())  {  if (graph.isBranching (nodes.item()))  { nbBranching++; }  }
+    t1 = System::time().getTimeStamp();
+
+    cout << "[" << kind << "]  isBranching() on " << nodes.size() << " nodes : " << (t1-t0) << " msec  (" << nbBranching << " branching)" << endl;
+
+    graph.remove ();
+}
+
+/********************************************************************************/
+
+int main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "you must provide at least 1 argument. Arguments are:" << endl;
+        cerr << "   1) reads file" << endl;
+        cerr << "   2) kmer size (optional, 31 by default)" << endl;
+        return EXIT_FAILURE;
+    }
+
+    size_t kmerSize = argc >= 3 ? atoi(argv[2]) : 31;
+
+    try
+    {
+        bench (argv[1], kmerSize, "cascading");
+        bench (argv[1], kmerSize, "ribbon");
+    }
+
+    catch (Exception& e)
+    {
+        cerr << "EXCEPTION: " << e.getMessage() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/* Benchmark of the kmer locator of GraphUnitigs: the unitigs graph is built from the reads,
+ * then we time the building of the locator and the localization of the kmers of the reads
+ * (batch queries), and compare with the linear scan of debugBuildNode on a few unitigs ends.
+ *
+ * Usage: bench_locator reads [kmerSize] [nbCores]
+ */
+
+#include <gatb/system/impl/System.hpp>
+#include <gatb/debruijn/impl/GraphUnitigs.hpp>
+#include <gatb/bank/impl/Bank.hpp>
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+using namespace gatb::core::bank;
+using namespace gatb::core::bank::impl;
+using namespace gatb::core::debruijn;
+using namespace gatb::core::debruijn::impl;
+using namespace gatb::core::tools::dp;
+
+typedef GraphUnitigsTemplate<32> GraphUnitigs;
+
+/********************************************************************************/
+
+int main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "you must provide at least 1 argument. Arguments are:" << endl;
+        cerr << "   1) reads file" << endl;
+        cerr << "   2) kmer size (optional, 31 by default)" << endl;
+        cerr << "   3) number of cores (optional, 1 by default)" << endl;
+        return EXIT_FAILURE;
+    }
+
+    size_t       kmerSize = argc >= 3 ? atoi(argv[2]) : 31;
+    unsigned int nbCores  = argc >= 4 ? atoi(argv[3]) : 1;
+
+    try
+    {
+        ITime::Value t0, t1;
+
+        GraphUnitigs graph = GraphUnitigs::create ("-in %s -kmer-size %d -abundance-min 1 -verbose 0 -nb-cores %d -out bench_locator",
+            argv[1], kmerSize, nbCores
+        );
+
+        cout << "unitigs: " << graph.nb_unitigs << endl;
+
+        t0 = System::time().getTimeStamp();
+        graph.buildLocator (nbCores, true);
+        t1 = System::time().getTimeStamp();
+
+        cout << "locator : " << (t1-t0) << " msec" << endl;
+
+        /** We query all the kmers of the reads. */
+        vector<string> kmers;
+        IBank* bank = Bank::open (argv[1]);  LOCAL (bank);
+        Iterator<Sequence>* itSeq = bank->iterator();  LOCAL (itSeq);
+        for (itSeq->first(); !itSeq->isDone(); itSeq->next())
+        {
+            string seq = itSeq->item().toString();
+            for (size_t i=0; i+kmerSize<=seq.size(); i++)  { kmers.push_back (seq.substr (i, kmerSize)); }
+        }
+
+        vector<KmerLocationGU> locations;
+        vector<bool>           found;
+
+        t0 = System::time().getTimeStamp();
+        graph.locateKmers (kmers, locations, found, nbCores);
+        t1 = System::time().getTimeStamp();
+
+        size_t nbFound = 0;
+        for (size_t i=0; i<found.size(); i++)  { if (found[i]) { nbFound++; } }
+
+        cout << "locateKmers on " << kmers.size() << " kmers : " << (t1-t0) << " msec  ("
+             << (kmers.size() ? (t1-t0)*1000000.0/kmers.size() : 0) << " nsec/kmer, " << nbFound << " found)" << endl;
+
+        /** The linear scan, on a few unitigs ends only. */
+        size_t nbScan = min ((size_t)100, (size_t)graph.nb_unitigs);
+        vector<string> ends;
+        for (size_t u=0; u<nbScan; u++)  { ends.push_back (graph.internal_get_unitig_sequence (graph.nb_unitigs-1-u).substr (0, kmerSize)); }
+
+        vector<NodeGU> nodes;
+        t0 = System::time().getTimeStamp();
+        graph.buildNodes (ends, nodes, found, 1);
+        t1 = System::time().getTimeStamp();
+        cout << "buildNodes     on " << ends.size() << " unitigs ends : " << (t1-t0) << " msec" << endl;
+
+        t0 = System::time().getTimeStamp();
+        size_t checksum = 0;
+        for (size_t u=0; u<ends.size(); u++)
+        {
+            /** Same linear scan as debugBuildNode. */
+            for (uint64_t v=0; v<graph.nb_unitigs; v++)
+            {
+                if (graph.internal_get_unitig_sequence(v).compare (0, kmerSize, ends[u]) == 0)  { checksum += v;  break; }
+            }
+        }
+        t1 = System::time().getTimeStamp();
+        cout << "linear scan    on " << ends.size() << " unitigs ends : " << (t1-t0) << " msec  (" << checksum << ")" << endl;
+
+        graph.remove ();
+    }
+
+    catch (Exception& e)
+    {
+        cerr << "EXCEPTION: " << e.getMessage() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/* benchmarks the lock-free union-find used by bglue, over synthetic glue inputs
+ * mimics bglue's createUF: elements are (MPHF indices of) marked kmers, and each glue sequence
+ * with both extremities marked unites its two kmers. here, sequences form random chains, given in shuffled order.
+ *
+ * usage: bench_uf [nb_elements] [max_nb_threads]
+ * unite+compress is timed for 1,2,4,.. up to max_nb_threads threads
+ * */
+
+#include <chrono>
+#define get_wtime() chrono::system_clock::now()
+#define diff_wtime(x,y) chrono::duration_cast<chrono::nanoseconds>(y - x).count()
+
+#include <gatb/system/impl/System.hpp>
+
+#include <gatb/bcalm2/unionFind.hpp>
+
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+/* synthetic glue input: nb_elts elements cut into chains of random length (1 to 2*mean_chain_length),
+ * a chain of n elements being glued by n-1 sequences. returns the number of chains (i.e. of expected UF classes) */
+static uint64_t make_glue_pairs(uint32_t nb_elts, uint32_t mean_chain_length, vector<pair<uint32_t,uint32_t>> &pairs)
+{
+    std::mt19937_64 rng(37); // deterministic seed
+
+    // elements are relabeled randomly, as MPHF indices of kmers would be
+    vector<uint32_t> label(nb_elts);
+    for (uint32_t i = 0; i < nb_elts; i++)
+        label[i] = i;
+    shuffle(label.begin(), label.end(), rng);
+
+    uniform_int_distribution<uint32_t> chain_length(1, 2*mean_chain_length);
+    uint64_t nb_chains = 0;
+    pairs.clear();
+    for (uint32_t start = 0; start < nb_elts; )
+    {
+        uint32_t end = min(nb_elts, start + chain_length(rng));
+        for (uint32_t i = start; i + 1 < end; i++)
+            pairs.push_back(make_pair(label[i], label[i+1]));
+        nb_chains++;
+        start = end;
+    }
+
+    // sequences in the glue file aren't in chain order
+    shuffle(pairs.begin(), pairs.end(), rng);
+    return nb_chains;
+}
+
+static void doit(uint32_t nb_elts, int max_nb_threads)
+{
+    double unit = 1000000000;
+    cout.setf(ios_base::fixed);
+    cout.precision(3);
+
+    vector<pair<uint32_t,uint32_t>> pairs;
+    uint64_t nb_chains = make_glue_pairs(nb_elts, 10, pairs);
+    cout << "synthetic glue input: " << nb_elts << " elements, " << pairs.size() << " unions, " << nb_chains << " expected classes" << endl;
+
+    double time_1thread = 0;
+    for (int nb_threads = 1; nb_threads <= max_nb_threads; nb_threads *= 2)
+    {
+        auto start_t = get_wtime();
+        unionFind uf(nb_elts);
+        auto alloc_t = get_wtime();
+
+        // same as the Dispatcher in bglue: threads grab the glue sequences (here, by interleaved chunks) and unite concurrently
+        size_t chunk = 10000;
+        auto unite = [&uf, &pairs, chunk, nb_threads](int thread_id)
+        {
+            for (size_t start = thread_id * chunk; start < pairs.size(); start += nb_threads * chunk)
+            {
+                size_t end = min(pairs.size(), start + chunk);
+                for (size_t i = start; i < end; i++)
+                    uf.union_(pairs[i].first, pairs[i].second);
+            }
+        };
+        vector<thread> threads;
+        for (int t = 0; t < nb_threads; t++)
+            threads.emplace_back(unite, t);
+        for (auto &th : threads)
+            th.join();
+        auto unite_t = get_wtime();
+
+        uf.compress(nb_threads);
+        auto compress_t = get_wtime();
+
+        // check: number of classes, i.e. of roots
+        uint64_t nb_classes = 0;
+        for (uint32_t i = 0; i < nb_elts; i++)
+            if (uf.parent(i) == i)
+                nb_classes++;
+
+        double unite_time = diff_wtime(alloc_t, unite_t) / unit;
+        double total_time = diff_wtime(start_t, compress_t) / unit;
+        if (nb_threads == 1)
+            time_1thread = total_time;
+
+        cout << nb_threads << " thread(s): alloc " << diff_wtime(start_t, alloc_t) / unit << "s, unite " << unite_time
+             << "s (" << (pairs.size() / unite_time / 1000000) << " M unions/s), compress " << diff_wtime(unite_t, compress_t) / unit
+             << "s, total " << total_time << "s, speedup " << (time_1thread / total_time)
+             << (nb_classes == nb_chains ? "" : "   WRONG NUMBER OF CLASSES: " + to_string(nb_classes)) << endl;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    uint32_t nb_elts = 50000000;
+    int max_nb_threads = System::info().getNbCores();
+
+    if (argc > 1)
+        nb_elts = stoul(argv[1]);
+    if (argc > 2)
+        max_nb_threads = stoi(argv[2]);
+
+    try
+    {
+        doit(nb_elts, max_nb_threads);
+    }
+    catch (Exception& e)
+    {
+        cerr << "EXCEPTION: " << e.getMessage() << endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,128 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/* Benchmark of the unitigs reordering of GraphUnitigs: the unitigs graph is built from the reads,
+ * then we time a traversal of the graph (a BFS following the links, which reads the neighbors,
+ * the length and the abundance of each unitig) before and after reorderUnitigs. We also give
+ * the mean distance between the ids of linked unitigs, which doesn't depend on the cache sizes.
+ *
+ * Usage: bench_unitigs_layout reads [kmerSize] [nbCores]
+ */
+
+#include <gatb/system/impl/System.hpp>
+#include <gatb/debruijn/impl/GraphUnitigs.hpp>
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+using namespace gatb::core::debruijn;
+using namespace gatb::core::debruijn::impl;
+
+typedef GraphUnitigsTemplate<32> GraphUnitigs;
+
+/********************************************************************************/
+
+static void traversal (GraphUnitigs& graph, const char* label)
+{
+    double distance = 0;  u_int64_t nbLinks = 0;
+    double checksum = 0;
+
+    ITime::Value t0 = System::time().getTimeStamp();
+
+    /** BFS over the unitigs, started from the unitigs in the original order. */
+    vector<bool> visited (graph.nb_unitigs, false);
+    vector<u_int64_t> queue;
+    for (u_int64_t seed = 0; seed < graph.nb_unitigs; seed++)
+    {
+        if (visited[seed])  { continue; }
+        visited[seed] = true;
+        queue.assign (1, seed);
+
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            u_int64_t u = queue[head];
+            checksum += graph.internal_get_unitig_length (u) * graph.unitigs_mean_abundance[u];
+
+            NodeGU extremities[2] = { NodeGU (u, UNITIG_BEGIN), NodeGU (u, UNITIG_END) };
+            for (size_t e = 0; e < 2; e++)
+            {
+                GraphVector<NodeGU> neighbors = graph.neighbors (extremities[e]);
+                for (size_t i = 0; i < neighbors.size(); i++)
+                {
+                    u_int64_t v = neighbors[i].unitig;
+                    distance += (u > v) ? u - v : v - u;  nbLinks++;
+                    if (!visited[v])  { visited[v] = true;  queue.push_back (v); }
+                }
+            }
+        }
+    }
+
+    ITime::Value t1 = System::time().getTimeStamp();
+
+    cout << "[" << label << "]  traversal : " << (t1-t0) << " msec  (" << nbLinks << " links, mean id distance "
+         << (nbLinks ? distance / nbLinks : 0) << ", checksum " << (u_int64_t)checksum << ")" << endl;
+}
+
+/********************************************************************************/
+
+int main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "you must provide at least 1 argument. Arguments are:" << endl;
+        cerr << "   1) reads file" << endl;
+        cerr << "   2) kmer size (optional, 31 by default)" << endl;
+        cerr << "   3) number of cores (optional, 1 by default)" << endl;
+        return EXIT_FAILURE;
+    }
+
+    size_t       kmerSize = argc >= 3 ? atoi(argv[2]) : 31;
+    unsigned int nbCores  = argc >= 4 ? atoi(argv[3]) : 1;
+
+    try
+    {
+        GraphUnitigs graph = GraphUnitigs::create ("-in %s -kmer-size %d -abundance-min 1 -verbose 0 -nb-cores %d -out bench_unitigs_layout",
+            argv[1], kmerSize, nbCores
+        );
+
+        cout << "unitigs: " << graph.nb_unitigs << endl;
+
+        traversal (graph, "file order");
+
+        ITime::Value t0 = System::time().getTimeStamp();
+        graph.reorderUnitigs (nbCores, true);
+        ITime::Value t1 = System::time().getTimeStamp();
+
+        cout << "reorderUnitigs : " << (t1-t0) << " msec" << endl;
+
+        traversal (graph, "reordered ");
+
+        graph.remove ();
+    }
+
+    catch (Exception& e)
+    {
+        cerr << "EXCEPTION: " << e.getMessage() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -64,6 +64,7 @@ class TestBcalm : public Test
     CPPUNIT_TEST_SUITE_GATB (TestBcalm);
 
         CPPUNIT_TEST_GATB (bcalm_test1); 
+        CPPUNIT_TEST_GATB (bcalm_test2); 
         CPPUNIT_TEST_SUITE_GATB_END();
 
 public:
@@ -115,6 +116,39 @@ public:
 
     }
 
+    /********************************************************************************/
+    void bcalm_test2 () // concurrent unions, then parallel compression: all elements of a class must point to the same root
+    {
+        int nb_uf_elts = 3000000;
+        int nb_classes = 7;
+        unionFind uf(nb_uf_elts);
+
+        // element i belongs to class i % nb_classes
+        auto doJoins = [&uf, nb_uf_elts, nb_classes](int thread_id, int nb_threads)
+        {
+            for (int i = thread_id; i + nb_classes < nb_uf_elts; i += nb_threads)
+                uf.union_(i, i + nb_classes);
+        };
+
+        int nb_threads = 4;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nb_threads; t++)
+            threads.emplace_back(doJoins, t, nb_threads);
+        for (auto &th : threads)
+            th.join();
+
+        uf.compress(nb_threads);
+
+        for (int i = 0; i < nb_uf_elts; i++)
+        {
+            CPPUNIT_ASSERT (uf.parent(i) == uf.find(i));
+            CPPUNIT_ASSERT (uf.parent(i) == uf.parent(i % nb_classes));
+        }
+        for (int i = 0; i < nb_classes; i++)
+            for (int j = i + 1; j < nb_classes; j++)
+                CPPUNIT_ASSERT (uf.parent(i) != uf.parent(j));
+    }
+
 };
 
 /********************************************************************************/
@@ -45,6 +45,7 @@
 #include <gatb/tools/storage/impl/Storage.hpp>
 
 #include <iostream>
+#include <fstream>
 #include <memory>
 
 using namespace std;
@@ -105,7 +106,9 @@ class TestDebruijn : public Test
         CPPUNIT_TEST_GATB (debruijn_test13);
 //        CPPUNIT_TEST_GATB (debruijn_mutation); // has been removed due to it crashing clang, and since mutate() isn't really used in apps, i didn't bother.
         CPPUNIT_TEST_GATB (debruijn_build);
+        CPPUNIT_TEST_GATB (debruijn_update);
         CPPUNIT_TEST_GATB (debruijn_checkbranching);
+        CPPUNIT_TEST_GATB (debruijn_iterateNodes);
         CPPUNIT_TEST_GATB (debruijn_mphf);
         CPPUNIT_TEST_GATB (debruijn_mphf_nodeindex);
         CPPUNIT_TEST_GATB (debruijn_traversal1);
@@ -957,6 +960,61 @@ public:
         debruijn_build_aux (sequences, ARRAY_SIZE(sequences));
     }
 
+    /********************************************************************************/
+    void debruijn_update ()
+    {
+        const char* seqsOld[] =
+        {
+            "GAATTCCAGGAGGACCAGGAGAACGTCAATCCCGAGAAGGCGGCGCCCGCCCAGCAGCCCCGGACCCGGGCTGGACTGGC",
+            "GGTACTGAGGGCCGGAAACTCGCGGGGTCCAGCTCCCCAGAGGCCTAAGACGCGACGGGTTGCACCTCTTAAGGATCTTC",
+            "CTATAAATGATGAGTATGTCCCTGTTCCTCCCTGGAAAGCAAACAATAAACAGCCTGCATTTACCATACATGTGGATGAA"
+        };
+        const char* seqsNew[] =
+        {
+            "GCAGAAGAAATTCAAAAGAGGCCAACTGAATCTAAAAAATCAGAAAGTGAAGATGTCTTGGCCTTTAATTCAGCTGTTAC",
+            "CCCAGCAGCCCCGGACCCGGGCTGGACTGGCTTTACCAGGACCAAGAAAGCCACTGGCACCTCTTGATTACCCAATGGAT"
+        };
+
+        /** We build the graph of the first reads. */
+        Graph::create (new BankStrings (seqsOld, ARRAY_SIZE(seqsOld)),
+            "-kmer-size 31 -out %s -abundance-min 1 -verbose 0 -max-memory %d", "gupd_old", MAX_MEMORY
+        );
+
+        /** We write the new reads in a FASTA file, the -update option needing a file. */
+        string newReads = "gupd_new.fa";
+        {
+            ofstream out (newReads.c_str());
+            for (size_t i=0; i<ARRAY_SIZE(seqsNew); i++)  { out << ">read" << i << endl << seqsNew[i] << endl; }
+        }
+
+        /** We update the graph with the new reads and we build the graph of all the reads. */
+        Graph updated = Graph::create ("-in %s -update %s -out %s -abundance-min 1 -verbose 0 -max-memory %d",
+            "gupd_old.h5", newReads.c_str(), "gupd_updated", MAX_MEMORY
+        );
+
+        vector<const char*> seqsAll (seqsOld, seqsOld + ARRAY_SIZE(seqsOld));
+        seqsAll.insert (seqsAll.end(), seqsNew, seqsNew + ARRAY_SIZE(seqsNew));
+        Graph full = Graph::create (new BankStrings (seqsAll.data(), seqsAll.size()),
+            "-kmer-size 31 -abundance-min 1 -verbose 0 -max-memory %d", MAX_MEMORY
+        );
+
+        CPPUNIT_ASSERT (updated.getInfo().getInt ("nb_old_solid") > 0);
+        CPPUNIT_ASSERT (updated.getInfo().getInt ("nb_solid")     == full.getInfo().getInt ("kmers_nb_solid"));
+
+        /** The two graphs must have the same nodes. */
+        size_t nbNodes = 0;
+        GraphIterator<Node> it = full.iterator();
+        for (it.first(); !it.isDone(); it.next(), nbNodes++)  {  CPPUNIT_ASSERT (updated.contains (it.item()));  }
+
+        CPPUNIT_ASSERT (nbNodes == updated.iterator().size());
+        CPPUNIT_ASSERT (updated.getInfo().getInt ("nb_branching") == full.getInfo().getInt ("nb_branching"));
+
+        updated.remove ();
+        full.remove ();
+        System::file().remove (newReads);
+        System::file().remove ("gupd_old.h5");
+    }
+
     /********************************************************************************/
     void debruijn_checksum_aux2 (
         const string& readfile,
@@ -1104,6 +1162,50 @@ public:
 
     /********************************************************************************/
 
+    /** Check that the parallel iteration by partitions gives each node once. */
+    void debruijn_iterateNodes ()
+    {
+        string filepath = DBPATH("reads3.fa.gz");
+
+        /** We create a graph. */
+        Graph graph = Graph::create ("-verbose 0 -in %s -max-memory %d", filepath.c_str(), MAX_MEMORY);
+
+        std::set<Node::Value> expected;
+        size_t nbBranching = 0;
+        GraphIterator<Node> it = graph.iterator();
+        for (it.first(); !it.isDone(); it.next())
+        {
+            expected.insert (it->kmer);
+            if (graph.isBranching (it.item()))  { nbBranching++; }
+        }
+
+        std::vector<Iterator<Node>*> partitions = graph.iteratorPartitions();
+        CPPUNIT_ASSERT (partitions.size() > 0);
+        for (size_t p=0; p<partitions.size(); p++)  { delete partitions[p]; }
+
+        std::set<Node::Value> found;
+        size_t nbNodes = 0, nbFoundBranching = 0;
+
+        ISynchronizer* synchro = System::thread().newSynchronizer();
+        LOCAL (synchro);
+
+        Dispatcher dispatcher (4);
+        graph.iterateNodes (dispatcher, [&] (Node& node)
+        {
+            if (graph.isBranching (node))  { __sync_fetch_and_add (&nbFoundBranching, 1); }
+
+            LocalSynchronizer ls (synchro);
+            found.insert (node.kmer);
+            nbNodes++;
+        });
+
+        CPPUNIT_ASSERT (nbNodes == expected.size());
+        CPPUNIT_ASSERT (found   == expected);
+        CPPUNIT_ASSERT (nbFoundBranching == nbBranching);
+    }
+
+    /********************************************************************************/
+
     void debruijn_traversal1_aux_aux (bool useCopyTerminator, size_t kmerSize, const char** seqs, size_t seqsSize,
 		TraversalKind traversalKind, const char* checkStr
 	)
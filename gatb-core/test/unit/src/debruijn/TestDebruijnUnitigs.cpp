@@ -105,6 +105,8 @@ class TestDebruijnUnitigs : public Test
         CPPUNIT_TEST_GATB (debruijn_unitigs_test6);
         CPPUNIT_TEST_GATB (debruijn_unitigs_test13);
         CPPUNIT_TEST_GATB (debruijn_unitigs_build);
+        CPPUNIT_TEST_GATB (debruijn_unitigs_locator);
+        CPPUNIT_TEST_GATB (debruijn_unitigs_reorder);
         //CPPUNIT_TEST_GATB (debruijn_unitigs_traversal1); // would need to be fixed
         
         CPPUNIT_TEST_SUITE_GATB_END();
@@ -843,6 +845,161 @@ public:
         debruijn_unitigs_build_aux (sequences, ARRAY_SIZE(sequences));
     }
 
+    /********************************************************************************/
+    void debruijn_unitigs_locator ()
+    {
+        // same data as test12
+        GraphUnitigs graph = GraphUnitigs::create (new BankStrings (
+            "CATCGATGCGAGACGCCTGTCGCGGGGAATTGTGGGGCGGACCACGCTCTGGCTAACGAGCTACCGTTTCCTTTAACCTGCCAGACGGTGACCAGGGCCGTTCGGCGTTGCATCGAGCGGTGTCGCTAGCGCAATGCGCAAGATTTTGACATTTACAAGGCAACATTGCAGCGTCCGATGGTCCGGTGGCCTCCAGATAGTGTCCAGTCGCTCTAACTGTATGGAGACCATAGGCATTTACCTTATTCTCATCGCCACGCCCCAAGATCTTTAGGACCCAGCATTCCTTTAACCACTAACATAACGCGTGTCATCTAGTTCAACAACC",
+            "TGTCATCTAGTTCAACAACCAAAAAAA",
+            "TGTCATCTAGTTCAACAACCGTTATGCCGTCCGACTCTTGCGCTCGGATGTCCGCAATGGGTTATCCCTATGTTCCGGTAATCTCTCATCTACTAAGCGCCCTAAAGGTCGTATGGTTGGAGGGCGGTTACACACCCTTAAGTACCGAACGATAGAGCACCCGTCTAGGAGGGCGTGCAGGGTCTCCCGCTAGCTAATGGTCACGGCCTCTCTGGGAAAGCTGAACAACGGATGATACCCATACTGCCACTCCAGTACCTGGGCCGCGTGTTGTACGCTGTGTATCTTGAGAGCGTTTCCAGCAGATAGAACAGGATCACATGTACATG"
+            ,(char*)0),
+                "-kmer-size 21  -abundance-min 1  -verbose 0 -max-memory %d -out dummy -nb-cores 1", MAX_MEMORY);
+
+        size_t k = 21;
+        CPPUNIT_ASSERT (graph.hasLocator() == false);
+
+        std::vector<std::string> kmers;
+        std::vector<KmerLocationGU> expected;
+        std::vector<NodeGU> extremities; // nodes given by the linear scan, before the locator is built
+
+        for (uint64_t u = 0; u < graph.nb_unitigs; u++)
+        {
+            std::string seq = graph.internal_get_unitig_sequence(u);
+            for (size_t offset = 0; offset + k <= seq.size(); offset++)
+            {
+                std::string kmer = seq.substr(offset, k);
+                std::string rev (kmer.rbegin(), kmer.rend());
+                for (size_t i = 0; i < rev.size(); i++)  { rev[i] = (rev[i]=='A' ? 'T' : rev[i]=='C' ? 'G' : rev[i]=='G' ? 'C' : 'A'); }
+
+                KmerLocationGU location;
+                location.unitig = u;
+                location.offset = offset;
+
+                location.strand = STRAND_FORWARD;  kmers.push_back (kmer);  expected.push_back (location);
+                location.strand = STRAND_REVCOMP;  kmers.push_back (rev);   expected.push_back (location);
+
+                if (offset == 0 || offset + k == seq.size())
+                {
+                    extremities.push_back (graph.debugBuildNode (kmer));
+                    extremities.push_back (graph.debugBuildNode (rev));
+                }
+            }
+        }
+        kmers.push_back ("ACGTACGTACGTACGTACGTA"); // not in the graph
+
+        graph.buildLocator (2);
+        CPPUNIT_ASSERT (graph.hasLocator() == true);
+
+        std::vector<KmerLocationGU> locations;
+        std::vector<NodeGU> nodes;
+        std::vector<bool> found;
+        graph.locateKmers (kmers, locations, found, 2);
+
+        CPPUNIT_ASSERT (found.size() == kmers.size());
+        CPPUNIT_ASSERT (found.back() == false);
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            CPPUNIT_ASSERT (found[i]);
+            CPPUNIT_ASSERT (locations[i].unitig == expected[i].unitig);
+            CPPUNIT_ASSERT (locations[i].offset == expected[i].offset);
+            CPPUNIT_ASSERT (locations[i].strand == expected[i].strand);
+        }
+
+        graph.buildNodes (kmers, nodes, found, 2);
+        size_t nbExtremities = 0;
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            std::string seq = graph.internal_get_unitig_sequence(expected[i].unitig);
+            if (expected[i].offset == 0 || expected[i].offset + k == seq.size())
+            {
+                NodeGU& node = extremities[nbExtremities++];
+                CPPUNIT_ASSERT (nodes[i] == node);
+                CPPUNIT_ASSERT (nodes[i].strand == node.strand);
+                CPPUNIT_ASSERT (graph.toString(nodes[i]) == kmers[i]);
+            }
+            else
+            {
+                CPPUNIT_ASSERT (nodes[i].pos == UNITIG_INSIDE);
+            }
+        }
+        CPPUNIT_ASSERT (nbExtremities == extremities.size());
+    }
+
+    /** Describes a unitig by its sequence, abundance, deleted flag and the neighbors of its extremities. */
+    std::string debruijn_unitigs_describe (GraphUnitigs& graph, uint64_t u)
+    {
+        std::stringstream ss;
+        ss << graph.internal_get_unitig_sequence(u) << " " << graph.unitigs_mean_abundance[u] << " " << graph.unitigs_deleted[u];
+
+        NodeGU extremities[2] = { NodeGU(u, UNITIG_BEGIN), NodeGU(u, UNITIG_END) };
+        for (size_t e = 0; e < 2; e++)
+        {
+            std::vector<std::string> neighbors;
+            GraphVector<NodeGU> nodes = graph.neighbors (extremities[e]);
+            for (size_t i = 0; i < nodes.size(); i++)  { neighbors.push_back (graph.toString (nodes[i])); }
+            std::sort (neighbors.begin(), neighbors.end());
+            for (size_t i = 0; i < neighbors.size(); i++)  { ss << " " << neighbors[i]; }
+            ss << " |";
+        }
+        return ss.str();
+    }
+
+    void debruijn_unitigs_reorder ()
+    {
+        // same data as test12, plus a bubble
+        GraphUnitigs graph = GraphUnitigs::create (new BankStrings (
+            "CATCGATGCGAGACGCCTGTCGCGGGGAATTGTGGGGCGGACCACGCTCTGGCTAACGAGCTACCGTTTCCTTTAACCTGCCAGACGGTGACCAGGGCCGTTCGGCGTTGCATCGAGCGGTGTCGCTAGCGCAATGCGCAAGATTTTGACATTTACAAGGCAACATTGCAGCGTCCGATGGTCCGGTGGCCTCCAGATAGTGTCCAGTCGCTCTAACTGTATGGAGACCATAGGCATTTACCTTATTCTCATCGCCACGCCCCAAGATCTTTAGGACCCAGCATTCCTTTAACCACTAACATAACGCGTGTCATCTAGTTCAACAACC",
+            "TGTCATCTAGTTCAACAACCAAAAAAA",
+            "TGTCATCTAGTTCAACAACCGTTATGCCGTCCGACTCTTGCGCTCGGATGTCCGCAATGGGTTATCCCTATGTTCCGGTAATCTCTCATCTACTAAGCGCCCTAAAGGTCGTATGGTTGGAGGGCGGTTACACACCCTTAAGTACCGAACGATAGAGCACCCGTCTAGGAGGGCGTGCAGGGTCTCCCGCTAGCTAATGGTCACGGCCTCTCTGGGAAAGCTGAACAACGGATGATACCCATACTGCCACTCCAGTACCTGGGCCGCGTGTTGTACGCTGTGTATCTTGAGAGCGTTTCCAGCAGATAGAACAGGATCACATGTACATG",
+            "TGTCATCTAGTTCAACAACCGTTATGACGTCCGACTCTTGCGCTCGGATGTCCG"
+            ,(char*)0),
+                "-kmer-size 21  -abundance-min 1  -verbose 0 -max-memory %d -out dummy -nb-cores 1", MAX_MEMORY);
+
+        size_t k = 21;
+        CPPUNIT_ASSERT (graph.nb_unitigs > 3);
+
+        NodeGU deleted (1, UNITIG_BEGIN);
+        graph.unitigDelete (deleted);
+        graph.buildLocator (2);
+
+        std::vector<std::string> before;
+        for (uint64_t u = 0; u < graph.nb_unitigs; u++)  { before.push_back (debruijn_unitigs_describe (graph, u)); }
+
+        // a copy shares the locator of the graph, and must still locate the kmers in its own unitigs
+        GraphUnitigs copy;
+        copy = graph;
+
+        graph.reorderUnitigs (2);
+
+        for (uint64_t u = 0; u < copy.nb_unitigs; u++)
+        {
+            std::string seq = copy.internal_get_unitig_sequence(u);
+            KmerLocationGU location;
+            CPPUNIT_ASSERT (copy.locateKmer (seq.substr (seq.size() - k), location));
+            CPPUNIT_ASSERT (location.unitig == u && location.offset + k == seq.size());
+        }
+
+        std::vector<bool> seen (graph.nb_unitigs, false);
+        for (uint64_t u = 0; u < graph.nb_unitigs; u++)
+        {
+            uint64_t original = graph.originalUnitigId (u);
+            CPPUNIT_ASSERT (original < graph.nb_unitigs && !seen[original]);
+            seen[original] = true;
+
+            CPPUNIT_ASSERT (debruijn_unitigs_describe (graph, u) == before[original]);
+
+            std::string seq = graph.internal_get_unitig_sequence(u);
+            KmerLocationGU location;
+            CPPUNIT_ASSERT (graph.locateKmer (seq.substr (seq.size() - k), location));
+            CPPUNIT_ASSERT (location.unitig == u && location.offset + k == seq.size());
+        }
+
+        // a second reordering composes with the first one
+        graph.reorderUnitigs (1);
+        for (uint64_t u = 0; u < graph.nb_unitigs; u++)  { CPPUNIT_ASSERT (debruijn_unitigs_describe (graph, u) == before[graph.originalUnitigId (u)]); }
+    }
+
     /********************************************************************************/
 
     void debruijn_unitigs_traversal1_aux_aux (bool useCopyTerminator, size_t kmerSize, const char** seqs, size_t seqsSize,
@@ -93,6 +93,7 @@ class TestSimplifications : public Test
         CPPUNIT_TEST_GATB (debruijn_simpl_tip);
         CPPUNIT_TEST_GATB (debruijn_simpl_bubble);
         CPPUNIT_TEST_GATB (debruijn_simpl_ec);
+        CPPUNIT_TEST_GATB (debruijn_simpl_worklist);
     CPPUNIT_TEST_SUITE_GATB_END();
 
 public:
@@ -350,6 +351,42 @@ public:
         debruijn_traversal (graph, sequences[3], "GGTGAACAGCACATCTTTTCGTCCTGAGGCCATATTAATTCTACTCAGATTGTCTGTAACCGGAGCTTCGGGCGTATTTTTGCGTAAGACACTGCCTAAAGGGAACATATGTGTCCAGAATAGGGTTCAACGGTGTATGAGCAAACTAGTTCAACAACCAAAAAAATTGTGTGCAAGCTACTTCTAGACCTTATTAAGTGCCCAGGAATTCCTAGGAAGGCGCGCAGCTCAAGCAATCATACATGGCGGAATGCCTGTCCACCGGGGGTTCTACTGTACCACAGTGGCCTGGATAGCTAAGCAGGTCCTGGATTGGCATGTCATCCGGAGTGATAGGCACTGCTCACGACCAGCTTGCGGACAAACGGGGTGCCCGCGCCTGCGTCCGGTAGACGAGCGATGGATTTAGACCGTTCACTGAACCCTCTAATAGGACCTCTTGCCCATCCGAGGCTTAAGC");
     }
 
+
+    /********************************************************************************/
+    void debruijn_simpl_worklist ()
+    {
+        /** The incremental rounds (only the nodes close to previous deletions are examined again)
+         * must give the same simplified graph than full passes. */
+        size_t  nbNonDeletedNodes[2];
+        Integer checksumNonDeletedNodes[2];
+        string  removals[2];
+
+        for (size_t i=0; i<2; i++)
+        {
+            Graph graph = Graph::create ("-in %s -kmer-size 21 -abundance-min 1 -verbose 0 -max-memory %d",
+                DBPATH("reads1.fa").c_str(), MAX_MEMORY
+            );
+
+            Simplifications<Graph,Node,Edge> graphSimplifications (&graph, 1, false);
+            graphSimplifications._useWorklist = (i == 0);
+            graphSimplifications.simplify();
+
+            removals[i] = graphSimplifications.tipRemoval + " / " + graphSimplifications.bubbleRemoval + " / " + graphSimplifications.ECRemoval;
+
+            nbNonDeletedNodes[i] = 0;
+            GraphIterator<Node> iterNodes = graph.iterator();
+            for (iterNodes.first(); !iterNodes.isDone(); iterNodes.next())
+            {
+                if (! graph.isNodeDeleted(*iterNodes))  { nbNonDeletedNodes[i]++;  checksumNonDeletedNodes[i] += iterNodes.item().kmer; }
+            }
+
+            graph.remove();
+        }
+
+        CPPUNIT_ASSERT (removals[0] == removals[1]);
+        CPPUNIT_ASSERT (nbNonDeletedNodes[0] == nbNonDeletedNodes[1]);
+        CPPUNIT_ASSERT (checksumNonDeletedNodes[0] == checksumNonDeletedNodes[1]);
+    }
 };
 
 /********************************************************************************/
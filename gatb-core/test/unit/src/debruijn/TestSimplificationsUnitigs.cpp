@@ -92,6 +92,7 @@ class TestSimplificationsUnitigs : public Test
     /********************************************************************************/
     CPPUNIT_TEST_SUITE_GATB (TestSimplificationsUnitigs);
         CPPUNIT_TEST_GATB (debruijn_simplunitigs_ec);
+        CPPUNIT_TEST_GATB (debruijn_simplunitigs_ec_parallel);
         CPPUNIT_TEST_GATB (debruijn_simplunitigs_X);
         CPPUNIT_TEST_GATB (debruijn_simplunitigs_tip);
         CPPUNIT_TEST_GATB (debruijn_simplunitigs_bubble);
@@ -180,6 +181,9 @@ public:
         string sequence = graph.simplePathBothDirections(node, isolatedLeft, isolatedRight, true, coverage);
         string rev_seq = revcomp(sequence);
 
+        /** The traversal claimed the unitigs of the path, so they can't be claimed again. */
+        CPPUNIT_ASSERT (graph.unitigIsMarked(node) && !graph.unitigTryMark(node));
+
         if ((sequence.compare(checkStr) != 0 && rev_seq.compare(checkStr) != 0 && checkStr2 == nullptr) || 
                 (checkStr2 != nullptr && (sequence.compare(checkStr2) != 0 && rev_seq.compare(checkStr2) != 0)))
         {
@@ -354,7 +358,7 @@ public:
     }
  
 
-    void debruijn_simplunitigs_ec ()
+    void debruijn_simplunitigs_ec_aux (unsigned int nbCores)
     {
         size_t kmerSize = 21;
 
@@ -392,7 +396,7 @@ public:
         CPPUNIT_ASSERT (r.nbNonDeletedNodes == 10);
 
         // simplify it
-        graph.simplify(1, false); // one core, no verbose
+        graph.simplify(nbCores, false); // no verbose
 
 
         // how many nodes left? should be as many as initially. it's a negative test: graph shouldn't be simplified
@@ -408,6 +412,17 @@ public:
         debruijn_traversal (graph, sequences[3], "GGTGAACAGCACATCTTTTCGTCCTGAGGCCATATTAATTCTACTCAGATTGTCTGTAACCGGAGCTTCGGGCGTATTTTTGCGTAAGACACTGCCTAAAGGGAACATATGTGTCCAGAATAGGGTTCAACGGTGTATGAGCAAACTAGTTCAACAACCAAAAAAATTGTGTGCAAGCTACTTCTAGACCTTATTAAGTGCCCAGGAATTCCTAGGAAGGCGCGCAGCTCAAGCAATCATACATGGCGGAATGCCTGTCCACCGGGGGTTCTACTGTACCACAGTGGCCTGGATAGCTAAGCAGGTCCTGGATTGGCATGTCATCCGGAGTGATAGGCACTGCTCACGACCAGCTTGCGGACAAACGGGGTGCCCGCGCCTGCGTCCGGTAGACGAGCGATGGATTTAGACCGTTCACTGAACCCTCTAATAGGACCTCTTGCCCATCCGAGGCTTAAGC");
     }
 
+    void debruijn_simplunitigs_ec ()
+    {
+        debruijn_simplunitigs_ec_aux (1);
+    }
+
+    /** Several threads simplify concurrently (by ranges of unitigs), and must end up with the same graph. */
+    void debruijn_simplunitigs_ec_parallel ()
+    {
+        debruijn_simplunitigs_ec_aux (4);
+    }
+
 };
 
 /********************************************************************************/
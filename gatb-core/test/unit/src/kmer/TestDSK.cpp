@@ -28,10 +28,18 @@
 #include <gatb/kmer/impl/SortingCountAlgorithm.hpp>
 #include <gatb/kmer/impl/Model.hpp>
 #include <gatb/kmer/impl/BankKmers.hpp>
+#include <gatb/kmer/impl/KmerCountIndex.hpp>
+#include <gatb/kmer/impl/CountProcessorSolidity.hpp>
+#include <gatb/kmer/impl/BloomGroupIndexBuilder.hpp>
+#include <gatb/kmer/impl/ShardCountAlgorithm.hpp>
+#include <gatb/kmer/impl/ShardMergeAlgorithm.hpp>
+#include <gatb/kmer/impl/ConfigurationAlgorithm.hpp>
+#include <gatb/kmer/impl/RepartitionAlgorithm.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 #include <gatb/tools/misc/impl/Property.hpp>
 #include <gatb/tools/misc/impl/Histogram.hpp>
+#include <gatb/tools/misc/impl/Stringify.hpp>
 
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 
@@ -102,6 +110,11 @@ class TestDSK : public Test
         CPPUNIT_TEST_GATB (DSK_perBank2);
         CPPUNIT_TEST_GATB (DSK_perBankKmer);
         CPPUNIT_TEST_GATB (DSK_multibank);
+        CPPUNIT_TEST_GATB (DSK_countIndex);
+        CPPUNIT_TEST_GATB (DSK_processBatch);
+        CPPUNIT_TEST_GATB (DSK_bloomGroupIndex);
+        CPPUNIT_TEST_GATB (DSK_sharded);
+        CPPUNIT_TEST_GATB (DSK_overlapPasses);
 		 
 
     CPPUNIT_TEST_SUITE_GATB_END();
@@ -703,6 +716,355 @@ public:
 
         boost::mpl::for_each<gatb::core::tools::math::IntegerList>(DSK_multibank_aux());
     }
+
+    /********************************************************************************/
+    template<size_t span>
+    void DSK_countIndex_aux (IBank* bank, size_t kmerSize, size_t nks, size_t samplingRate, const char* storageType="hdf5")
+    {
+        /** Shortcuts. */
+        typedef typename KmerCountIndex<span>::Type  Type;
+        typedef typename KmerCountIndex<span>::Model Model;
+
+        LOCAL (bank);
+
+        /** We configure parameters for a SortingCountAlgorithm object. */
+        IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();  LOCAL (params);
+        params->setInt (STR_KMER_SIZE,          kmerSize);
+        params->setInt (STR_MAX_MEMORY,         MAX_MEMORY);
+        params->setInt (STR_KMER_ABUNDANCE_MIN, nks);
+        params->setStr (STR_URI_OUTPUT,         "foo");
+        params->setStr (STR_STORAGE_TYPE,       storageType);
+
+        /** We create a DSK instance. */
+        SortingCountAlgorithm<span> sortingCount (bank, params);
+
+        /** We launch DSK. */
+        sortingCount.execute();
+
+        /** We build the index over the solid kmers of the storage. */
+        KmerCountIndex<span> index (*sortingCount.getStorage(), 0, samplingRate);
+        CPPUNIT_ASSERT (index.getKmerSize() == kmerSize);
+        CPPUNIT_ASSERT ((int)index.getNbKmers() == sortingCount.getInfo()->getInt("kmers_nb_solid"));
+
+        /** We compute the expected counts by ourself. */
+        std::map<Type,CountNumber> expected;
+        const Model& model = index.getModel();
+        Iterator<Sequence>* itSeq = bank->iterator();  LOCAL (itSeq);
+        for (itSeq->first(); !itSeq->isDone(); itSeq->next())
+        {
+            model.iterate ((*itSeq)->getData(), [&] (const typename Model::Kmer& kmer, size_t idx)  {  expected[kmer.value()] ++;  });
+        }
+
+        /** Solid kmers must have their exact count, other ones a null count. */
+        vector<Type>        kmers;
+        vector<CountNumber> counts;
+        for (typename std::map<Type,CountNumber>::iterator it = expected.begin(); it != expected.end(); ++it)
+        {
+            CountNumber check = it->second >= (CountNumber)nks ? it->second : 0;
+            CPPUNIT_ASSERT (index.lookup (it->first) == check);
+            kmers.push_back (it->first);
+        }
+
+        /** The batch lookup must give the same results. */
+        index.lookup (kmers, counts);
+        CPPUNIT_ASSERT (counts.size() == kmers.size());
+        for (size_t i=0; i<kmers.size(); i++)  {  CPPUNIT_ASSERT (counts[i] == index.lookup (kmers[i]));  }
+    }
+
+    /** */
+    void DSK_countIndex ()
+    {
+        const char* s1 =
+            "CGCTACAGCAGCTAGTTCATCATTGTTTATCAATGATAAAATATAATAAGCTAAAAGGAAACTATAAATA"
+            "ACCATGTATAATTATAAGTAGGTACCTATTTTTTTATTTTAAACTGAAATTCAATATTATATAGGCAAAG"
+            "ACTTAGATGTAAGATTTCGAAGACTTGGATGTAAACAACAAATAAGATAATAACCATAAAAATAGAAATG";
+        const char* s2 =
+            "AACGATATTAAAATTAAAAAATACGAAAAAACTAACACGTATTGTGTCCAATAAATTCGATTTGATAATT"
+            "AGGTAACAATTTAACGTTAAAACCTATTCTTTTATTATCCGAAAATCCGTCGTGGAATTTGTATTAGCTT";
+        const char* s3 = "ACCATGTATAATTATAAGTAGGTACCTATTTTTTTATTTTAAACTGAAATTCAATATTATATAGGCAAAG";
+
+        const char* seqs[] = { s1, s2, s3 };
+
+        /** s3 is the only part of the bank seen twice. */
+        for (size_t samplingRate=1; samplingRate<=64; samplingRate*=8)
+        {
+            DSK_countIndex_aux<KSIZE_1> (new BankStrings (seqs, ARRAY_SIZE(seqs)), 15, 1, samplingRate);
+            DSK_countIndex_aux<KSIZE_1> (new BankStrings (seqs, ARRAY_SIZE(seqs)), 15, 2, samplingRate);
+        }
+
+        /** The blocks are read from the partition files in file storage. */
+        DSK_countIndex_aux<KSIZE_1> (new BankStrings (seqs, ARRAY_SIZE(seqs)), 15, 1, 8, "file");
+#if KSIZE_32
+#else
+        DSK_countIndex_aux<KSIZE_2> (new BankStrings (seqs, ARRAY_SIZE(seqs)), 41, 1, 8);
+        DSK_countIndex_aux<KSIZE_2> (new BankStrings (seqs, ARRAY_SIZE(seqs)), 41, 2, 8);
+#endif
+    }
+
+    /********************************************************************************/
+    template<class Processor>
+    void DSK_processBatch_aux (size_t nbKmers, size_t nbBanks)
+    {
+        typedef typename Kmer<KSIZE_1>::Type Type;
+
+        vector<CountRange> thresholds;
+        vector<bool>       solidVec;
+        for (size_t b=0; b<nbBanks; b++)  {  thresholds.push_back (CountRange (2+b%2, 4));  solidVec.push_back (b%3 != 1);  }
+
+        Processor single (thresholds, solidVec);
+        Processor batch  (thresholds, solidVec);
+
+        vector<Type>        kmers (nbKmers);
+        vector<CountNumber> counts (nbKmers*nbBanks);
+        vector<u_int8_t>    selected (nbKmers);
+        vector<u_int8_t>    expected (nbKmers);
+
+        srand (nbKmers + nbBanks);
+        for (size_t i=0; i<nbKmers; i++)
+        {
+            kmers[i].setVal (i);
+            CountVector count (nbBanks);
+            CountNumber sum = 0;
+            for (size_t b=0; b<nbBanks; b++)  {  count[b] = counts[b*nbKmers+i] = rand() % 7;  sum += count[b];  }
+
+            /** Some kmers are not selected before the processor, ie. rejected by a previous one in a chain. */
+            selected[i] = (rand() % 4) != 0;
+            expected[i] = selected[i] && single.process (0, kmers[i], count, sum);
+        }
+
+        batch.processBatch (0, kmers.data(), nbKmers, counts.data(), nbBanks, 0, selected.data());
+
+        for (size_t i=0; i<nbKmers; i++)  {  CPPUNIT_ASSERT (selected[i] == expected[i]);  }
+
+        /** Both ways must give the same statistics. */
+        CPPUNIT_ASSERT (batch.getProperties().getInt("kmers_nb_distinct") == single.getProperties().getInt("kmers_nb_distinct"));
+        CPPUNIT_ASSERT (batch.getProperties().getInt("kmers_nb_solid")    == single.getProperties().getInt("kmers_nb_solid"));
+    }
+
+    /** Check that the batched (columnar) solidity checks give the same results as the kmer per kmer ones. */
+    void DSK_processBatch ()
+    {
+        size_t nbBanksTable[] = { 1, 2, 5 };
+
+        for (size_t i=0; i<ARRAY_SIZE(nbBanksTable); i++)
+        {
+            size_t nbBanks = nbBanksTable[i];
+
+            DSK_processBatch_aux <CountProcessorSoliditySum    <KSIZE_1> > (1000, nbBanks);
+            DSK_processBatch_aux <CountProcessorSolidityMax    <KSIZE_1> > (1000, nbBanks);
+            DSK_processBatch_aux <CountProcessorSolidityMin    <KSIZE_1> > (1000, nbBanks);
+            DSK_processBatch_aux <CountProcessorSolidityAll    <KSIZE_1> > (1000, nbBanks);
+            DSK_processBatch_aux <CountProcessorSolidityOne    <KSIZE_1> > (1000, nbBanks);
+            DSK_processBatch_aux <CountProcessorSolidityCustom <KSIZE_1> > (1000, nbBanks);
+        }
+    }
+
+    /********************************************************************************/
+    void DSK_bloomGroupIndex ()
+    {
+        typedef Kmer<KSIZE_1>::Type            Type;
+        typedef Kmer<KSIZE_1>::ModelCanonical  Model;
+
+        size_t kmerSize = 21;
+
+        const char* samplesSeqs[] =
+        {
+            "CGCTACAGCAGCTAGTTCATCATTGTTTATCAATGATAAAATATAATAAGCTAAAAGGAAACTATAAATA",
+            "AACGATATTAAAATTAAAAAATACGAAAAAACTAACACGTATTGTGTCCAATAAATTCGATTTGATAATT",
+            "ACCATGTATAATTATAAGTAGGTACCTATTTTTTTATTTTAAACTGAAATTCAATATTATATAGGCAAAG"
+        };
+        size_t nbSamples = ARRAY_SIZE(samplesSeqs);
+
+        /** We count the kmers of each sample. */
+        vector<SortingCountAlgorithm<KSIZE_1>*> countings;
+        vector<Storage*> storages;
+        for (size_t s=0; s<nbSamples; s++)
+        {
+            IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();  LOCAL (params);
+            params->setInt (STR_KMER_SIZE,          kmerSize);
+            params->setInt (STR_MAX_MEMORY,         MAX_MEMORY);
+            params->setInt (STR_KMER_ABUNDANCE_MIN, 1);
+            params->setStr (STR_URI_OUTPUT,         Stringify::format ("sample%d", s));
+
+            countings.push_back (new SortingCountAlgorithm<KSIZE_1> (new BankStrings (samplesSeqs+s, 1), params));
+            countings.back()->execute();
+            storages.push_back (countings.back()->getStorage());
+        }
+
+        BloomGroupIndexBuilder<KSIZE_1> builder (storages, 32);
+        BloomGroupIndex<Type>* index = builder.build();
+        LOCAL (index);
+
+        CPPUNIT_ASSERT (builder.getKmerSize() == kmerSize);
+        CPPUNIT_ASSERT (index->getNbSamples() == nbSamples);
+
+        /** Querying a sample with its own sequence must give a hit for each of its kmers. */
+        Model model (kmerSize);
+        for (size_t s=0; s<nbSamples; s++)
+        {
+            vector<Type> kmers;
+            Data data ((char*)samplesSeqs[s]);
+            model.iterate (data, [&] (const Model::Kmer& kmer, size_t idx)  {  kmers.push_back (kmer.value());  });
+
+            vector<u_int32_t> hits (nbSamples);
+            index->count (kmers.data(), kmers.size(), hits.data());
+
+            for (size_t t=0; t<nbSamples; t++)
+            {
+                if (t==s)  { CPPUNIT_ASSERT (hits[t] == kmers.size()); }
+                else       { CPPUNIT_ASSERT (hits[t] <  kmers.size()/2); }
+            }
+        }
+
+        for (size_t s=0; s<nbSamples; s++)  { delete countings[s]; }
+    }
+
+    /********************************************************************************/
+    void DSK_sharded ()
+    {
+        typedef Kmer<KSIZE_1>::Type   Type;
+        typedef Kmer<KSIZE_1>::Count  Count;
+
+        size_t      kmerSize = 21;
+        size_t      nbShards = 3;
+        CountNumber nks      = 3;
+
+        /** The reads are drawn from a random genome, so a kmer is seen several times and by several shards. */
+        srand (17);
+        string genome;
+        for (size_t i=0; i<6000; i++)  { genome += "ACGT"[rand()%4]; }
+
+        vector<string> reads;
+        for (size_t i=0; i<5000; i++)  { reads.push_back (genome.substr ((i*37) % (genome.size()-100), 100)); }
+
+        IBank* bank = new BankStrings (reads);
+        LOCAL (bank);
+
+        IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();  LOCAL (params);
+        params->setInt (STR_KMER_SIZE,          kmerSize);
+        params->setInt (STR_MAX_MEMORY,         MAX_MEMORY);
+        params->setInt (STR_KMER_ABUNDANCE_MIN, nks);
+        params->setStr (STR_URI_OUTPUT,         "shard_ref");
+
+        /** We count the shards, each one with its own storage, then we merge them. */
+        Storage* shared = StorageFactory(STORAGE_HDF5).create ("shard_shared", true, true);
+        LOCAL (shared);
+        ShardCountAlgorithm<KSIZE_1>::prepare (bank, *shared, params);
+
+        vector<Storage*> shards;
+        for (size_t i=0; i<nbShards; i++)
+        {
+            shards.push_back (StorageFactory(STORAGE_HDF5).create (Stringify::format ("shard%d", i), true, true));
+            shards.back()->use();
+
+            ShardCountAlgorithm<KSIZE_1> shard (bank, *shared, *shards.back(), nbShards, i, params, 256);
+            shard.execute();
+
+            /** A shard keeps all its kmers and only sees a part of the reads. */
+            CPPUNIT_ASSERT (shard.getInfo()->getInt ("nb_kmers") > 0);
+        }
+
+        Storage* merged = StorageFactory(STORAGE_HDF5).create ("shard_merged", true, true);
+        LOCAL (merged);
+
+        ShardMergeAlgorithm<KSIZE_1> merge (shards, *merged, nks, std::numeric_limits<CountNumber>::max());
+        merge.execute();
+
+        /** The merged solid kmers must be the ones of a counting of the whole reads set. */
+        SortingCountAlgorithm<KSIZE_1> sortingCount (bank, params);
+        sortingCount.execute();
+
+        std::map<Type,CountNumber> expected;
+        Iterator<Count>* itRef = sortingCount.getSolidCounts()->iterator();  LOCAL (itRef);
+        for (itRef->first(); !itRef->isDone(); itRef->next())  { expected[itRef->item().value] = itRef->item().abundance; }
+
+        CPPUNIT_ASSERT (expected.size() > 0);
+        CPPUNIT_ASSERT (merge.getSolidCounts()->getNbItems() == (int64_t)expected.size());
+        CPPUNIT_ASSERT (merge.getInfo()->getInt ("nb_solid") == (int64_t)expected.size());
+
+        Iterator<Count>* itMerged = merge.getSolidCounts()->iterator();  LOCAL (itMerged);
+        for (itMerged->first(); !itMerged->isDone(); itMerged->next())
+        {
+            CPPUNIT_ASSERT (expected.find (itMerged->item().value) != expected.end());
+            CPPUNIT_ASSERT (expected[itMerged->item().value] == itMerged->item().abundance);
+        }
+
+        /** The merged storage has the layout of a counting storage. */
+        CPPUNIT_ASSERT (merged->getGroup("dsk").getProperty ("kmer_size") == Stringify::format ("%d", kmerSize));
+
+        for (size_t i=0; i<nbShards; i++)  { shards[i]->forget(); }
+    }
+
+    /********************************************************************************/
+    void DSK_overlapPasses ()
+    {
+        typedef Kmer<KSIZE_1>::Type   Type;
+        typedef Kmer<KSIZE_1>::Count  Count;
+
+        size_t      kmerSize = 21;
+        size_t      nbPasses = 3;
+        CountNumber nks      = 2;
+
+        srand (23);
+        string genome;
+        for (size_t i=0; i<6000; i++)  { genome += "ACGT"[rand()%4]; }
+
+        vector<string> reads;
+        for (size_t i=0; i<3000; i++)  { reads.push_back (genome.substr ((i*41) % (genome.size()-100), 100)); }
+
+        IBank* bank = new BankStrings (reads);
+        LOCAL (bank);
+
+        IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();  LOCAL (params);
+        params->setInt (STR_KMER_SIZE,          kmerSize);
+        params->setInt (STR_MAX_MEMORY,         MAX_MEMORY);
+        params->setInt (STR_KMER_ABUNDANCE_MIN, nks);
+        params->setStr (STR_URI_OUTPUT,         "overlap_ref");
+
+        /** The reference counting is done in a single pass. */
+        SortingCountAlgorithm<KSIZE_1> reference (bank, params);
+        reference.execute();
+        CPPUNIT_ASSERT (reference.getInfo()->getInt ("nb_passes") == 1);
+
+        std::map<Type,CountNumber> expected;
+        Iterator<Count>* itRef = reference.getSolidCounts()->iterator();  LOCAL (itRef);
+        for (itRef->first(); !itRef->isDone(); itRef->next())  { expected[itRef->item().value] = itRef->item().abundance; }
+        CPPUNIT_ASSERT (expected.size() > 0);
+
+        /** We force several passes, and count them one after another, then overlapped. */
+        for (int overlap=0; overlap<=1; overlap++)
+        {
+            params->setInt (STR_OVERLAP_PASSES, overlap);
+
+            ConfigurationAlgorithm<KSIZE_1> configAlgo (bank, params);
+            configAlgo.execute();
+            Configuration config = configAlgo.getConfiguration();
+            config._nb_passes = nbPasses;
+
+            Storage* storage = StorageFactory(STORAGE_HDF5).create (Stringify::format ("overlap%d", overlap), true, true);
+            LOCAL (storage);
+
+            RepartitorAlgorithm<KSIZE_1> repart (bank, (*storage)("minimizers"), config, 1);
+            repart.execute();
+
+            SortingCountAlgorithm<KSIZE_1> sortingCount (bank, config, new Repartitor ((*storage)("minimizers")),
+                SortingCountAlgorithm<KSIZE_1>::getDefaultProcessorVector (config, params, storage, storage), params
+            );
+            sortingCount.execute();
+
+            CPPUNIT_ASSERT (sortingCount.getInfo()->getInt ("nb_passes") == (int64_t)nbPasses);
+            CPPUNIT_ASSERT (sortingCount.getInfo()->getInt ("overlap")   == overlap);
+
+            CPPUNIT_ASSERT (sortingCount.getSolidCounts()->getNbItems() == (int64_t)expected.size());
+
+            Iterator<Count>* it = sortingCount.getSolidCounts()->iterator();  LOCAL (it);
+            for (it->first(); !it->isDone(); it->next())
+            {
+                CPPUNIT_ASSERT (expected.find (it->item().value) != expected.end());
+                CPPUNIT_ASSERT (expected[it->item().value] == it->item().abundance);
+            }
+        }
+    }
 };
 
 /********************************************************************************/
@@ -68,6 +68,7 @@ class TestDebloom : public Test
     CPPUNIT_TEST_SUITE_GATB (TestDebloom);
 
         CPPUNIT_TEST_GATB (Debloom_check1);
+        CPPUNIT_TEST_GATB (Debloom_checkRibbon);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -160,6 +161,68 @@ public:
 
         CPPUNIT_ASSERT (checkValues.size() == okValues.size());
     }
+
+    /********************************************************************************/
+    void Debloom_checkRibbon ()
+    {
+        size_t kmerSize = 11;
+        size_t miniSize = 8;
+        size_t nks      = 1;
+
+        const char* seqs[] = {
+            "CGCTACAGCAGCTAGTTCATCATTGTTTATCAATGATAAAATATAATAAGCTAAAAGGAAACTATAAATA"
+            "ACCATGTATAATTATAAGTAGGTACCTATTTTTTTATTTTAAACTGAAATTCAATATTATATAGGCAAAG"
+        } ;
+
+        /** We configure parameters for a SortingCountAlgorithm object. */
+        IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();  LOCAL (params);
+        params->setInt (STR_KMER_SIZE,          kmerSize);
+        params->setInt (STR_MINIMIZER_SIZE,     miniSize);
+        params->setInt (STR_MAX_MEMORY,         MAX_MEMORY);
+        params->setInt (STR_KMER_ABUNDANCE_MIN, nks);
+        params->setStr (STR_URI_OUTPUT,         "foo");
+
+        /** We create a SortingCountAlgorithm object and launch DSK. */
+        SortingCountAlgorithm<> sortingCount (new BankStrings (seqs, ARRAY_SIZE(seqs)), params);
+        sortingCount.execute();
+
+        Storage* storage = sortingCount.getStorage();
+        LOCAL (storage);
+
+        Partition<SortingCountAlgorithm<>::Count>& counts = storage->getGroup("dsk").getPartition<Kmer<>::Count> ("solid");
+
+        /** We create the bloom and launch the debloom with ribbon filters for the cFP. */
+        float nbitsPerKmer = DebloomAlgorithm<>::getNbBitsPerKmer (kmerSize, DEBLOOM_RIBBON);
+        BloomAlgorithm<> bloom (*storage, &counts, kmerSize, nbitsPerKmer, 0, BLOOM_BASIC);
+        bloom.execute ();
+
+        DebloomAlgorithm<> debloom (
+            storage->getGroup("bloom"),
+            storage->getGroup("debloom"),
+            &counts, kmerSize, miniSize, 1000, 0, BLOOM_BASIC, DEBLOOM_RIBBON
+        );
+        debloom.execute();
+
+        CPPUNIT_ASSERT (storage->getGroup("debloom").getProperty("kind") == "ribbon");
+
+        gatb::core::debruijn::IContainerNode<Kmer<>::Type>* container = debloom.getContainerNode();
+
+        /** The solid kmers are in the container. */
+        Iterator<Kmer<>::Count>* itSolid = counts.iterator();  LOCAL (itSolid);
+        for (itSolid->first(); !itSolid->isDone(); itSolid->next())  {  CPPUNIT_ASSERT (container->contains (itSolid->item().value));  }
+
+        /** The cFP computed with the original minia (see Debloom_check1) are not. */
+        u_int64_t values[] =
+        {
+            0xc0620,    0x288f40,   0x188f40,   0x2aaa29,   0x8000b,    0x200881,   0x288081,   0x820db,    0x52e23,    0x2888f,
+            0xaaa8b,    0x28838d,   0x20000,    0xa93ab,    0x2c18d,    0x2ba89,    0x183600,   0xea00b,    0x1a4ea0,   0xf8585
+        };
+        for (unsigned int i = 0; i < ARRAY_SIZE(values); i++)
+        {
+            Kmer<>::Type val; val.setVal(values[i]);
+            CPPUNIT_ASSERT (container->contains (val) == false);
+        }
+    }
 };
 
 /********************************************************************************/
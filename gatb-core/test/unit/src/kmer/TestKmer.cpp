@@ -24,6 +24,9 @@
 #include <gatb/bank/api/Sequence.hpp>
 #include <gatb/bank/impl/Alphabet.hpp>
 #include <gatb/kmer/impl/Model.hpp>
+#include <gatb/kmer/impl/HyperLogLog.hpp>
+#include <gatb/kmer/impl/RollingKmers.hpp>
+#include <gatb/tools/misc/impl/NucleotideEncoder.hpp>
 
 #include <gatb/tools/math/LargeInt.hpp>
 #include <gatb/tools/math/Integer.hpp>
@@ -78,6 +81,8 @@ class TestKmer : public Test
         CPPUNIT_TEST_GATB (kmer_minimizer2); // with ModelDirect
         CPPUNIT_TEST_GATB (kmer_minimizer3); // with ModelCanonical
         CPPUNIT_TEST_GATB (kmer_badchar);
+        CPPUNIT_TEST_GATB (kmer_rolling);
+        CPPUNIT_TEST_GATB (kmer_hyperloglog);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -568,6 +573,90 @@ public:
         model.iterate (data, fct);
     }
 
+    /********************************************************************************/
+    void kmer_rolling (void)
+    {
+        typedef Kmer<>::ModelDirect     ModelDirect;
+        typedef Kmer<>::ModelCanonical  ModelCanonical;
+        typedef Kmer<>::Type            Type;
+
+        const char alphabet[] = "ACGTacgtNn-";
+
+        srand (0);
+
+        size_t kmerSizes[] = { 5, 21, 31 };
+
+        for (size_t len=0; len<300; len+=7)
+        {
+            /** We build a sequence with some lower case and invalid nucleotides. */
+            string seq;
+            for (size_t i=0; i<len; i++)  {  seq += alphabet[rand() % (rand()%10==0 ? 11 : 4)];  }
+
+            gatb::core::tools::misc::impl::PackedNucleotides packed;
+            packed.encode (seq.data(), seq.size());
+
+            CPPUNIT_ASSERT (packed.size() == len);
+
+            int64_t lastBad = -1;
+            for (size_t i=0; i<len; i++)
+            {
+                Data::ConvertChar c = Data::ConvertASCII::get (seq.data(), i);
+                CPPUNIT_ASSERT (packed[i] == c.first);
+                CPPUNIT_ASSERT (packed.isValid(i) == (c.second == 0));
+                CPPUNIT_ASSERT (Data::ConvertBinary::get (packed.getCodes(), i).first == c.first);
+                if (c.second)  { lastBad = i; }
+            }
+            CPPUNIT_ASSERT (packed.lastInvalid (0, len) == lastBad);
+            CPPUNIT_ASSERT (gatb::core::tools::misc::impl::PackedNucleotides::isValid (seq.data(), len) == (lastBad < 0));
+
+            for (size_t k=0; k<ARRAY_SIZE(kmerSizes); k++)
+            {
+                size_t kmerSize = kmerSizes[k];
+                if (len < kmerSize)  { continue; }
+
+                ModelDirect    modelDirect    (kmerSize);
+                ModelCanonical modelCanonical (kmerSize);
+                RollingKmers<KMER_SPAN(0)> rolling (kmerSize);
+
+                Data data (Data::ASCII);
+                data.set ((char*)seq.data(), seq.size());
+
+                vector<ModelDirect::Kmer>    direct;
+                vector<ModelCanonical::Kmer> canonical;
+                modelDirect.build    (data, direct);
+                modelCanonical.build (data, canonical);
+
+                vector<Type>      kmers;
+                vector<u_int64_t> invalid;
+
+                CPPUNIT_ASSERT (rolling.forward (packed, kmers, invalid) == direct.size());
+                for (size_t i=0; i<direct.size(); i++)
+                {
+                    bool isInvalid = (invalid[i/64] >> (i%64)) & 1;
+                    CPPUNIT_ASSERT (isInvalid == !direct[i].isValid());
+                    CPPUNIT_ASSERT (kmers[i] == direct[i].value());
+
+                    /** The iterated kmers must be the ones computed from scratch (per nucleotide conversion). */
+                    CPPUNIT_ASSERT (modelDirect.codeSeed (seq.data(), Data::ASCII, i).value()   == direct[i].value());
+                    CPPUNIT_ASSERT (modelDirect.codeSeed (seq.data(), Data::ASCII, i).isValid() == direct[i].isValid());
+                }
+
+                CPPUNIT_ASSERT (rolling.canonical (packed, kmers, invalid) == canonical.size());
+                for (size_t i=0; i<canonical.size(); i++)
+                {
+                    bool isInvalid = (invalid[i/64] >> (i%64)) & 1;
+                    CPPUNIT_ASSERT (isInvalid == !canonical[i].isValid());
+                    CPPUNIT_ASSERT (kmers[i] == canonical[i].value());
+
+                    /** The iterated kmers must be the ones computed from scratch (per nucleotide conversion). */
+                    CPPUNIT_ASSERT (modelCanonical.codeSeed (seq.data(), Data::ASCII, i).value()   == canonical[i].value());
+                    CPPUNIT_ASSERT (modelCanonical.codeSeed (seq.data(), Data::ASCII, i).isValid() == canonical[i].isValid());
+                }
+            }
+        }
+    }
+
+    /********************************************************************************/
     void kmer_tostring (void)
     {
 #if KSIZE_32
@@ -586,6 +675,54 @@ public:
         CPPUNIT_ASSERT (model.toString(kmer.value()) == kmer_str);
 #endif
     }
+
+    /********************************************************************************/
+    void kmer_hyperloglog (void)
+    {
+        /** We use distinct kmers values, hashed as in the ConfigurationAlgorithm. */
+        typedef Kmer<KMER_SPAN(0)>::Type Type;
+
+        size_t nbItems = 200*1000;
+
+        HyperLogLog h1, h2, h12;
+
+        for (size_t i=0; i<nbItems; i++)
+        {
+            Type kmer;  kmer.setVal (i);
+            u_int64_t h = hash1 (kmer, 0x5f3759df);
+
+            /** The two sketches share a half of their items, which are added twice. */
+            if (i <  2*nbItems/3)  { h1.add (h); h1.add (h); }
+            if (i >=   nbItems/3)  { h2.add (h); }
+            h12.add (h);
+        }
+
+        /** The batch hashing (vectorized) gives the hash values of the items one by one. */
+        vector<u_int64_t> keys (1001), hashes (keys.size());
+        for (size_t i=0; i<keys.size(); i++)  { keys[i] = i * 0x9E3779B97F4A7C15ULL; }
+        NativeInt64::hash64 (keys.data(), keys.size(), 0x5f3759df, hashes.data());
+        for (size_t i=0; i<keys.size(); i++)  { CPPUNIT_ASSERT (hashes[i] == NativeInt64::hash64 (keys[i], 0x5f3759df)); }
+
+        double error = 4 * h1.getRelativeError();
+
+        CPPUNIT_ASSERT (std::abs ((double)h1.estimate()  - 2.0*nbItems/3) < error * 2.0*nbItems/3);
+        CPPUNIT_ASSERT (std::abs ((double)h12.estimate() - nbItems)       < error * nbItems);
+
+        /** The merged sketch must be the sketch of the union. */
+        h1.merge (h2);
+        CPPUNIT_ASSERT (h1.estimate() == h12.estimate());
+
+        /** Small cardinalities are (nearly) exact. */
+        HyperLogLog h3;
+        for (u_int64_t i=0; i<100; i++)  { Type kmer;  kmer.setVal (i);  h3.add (hash1 (kmer, 0)); }
+        CPPUNIT_ASSERT (h3.estimate() >= 98 && h3.estimate() <= 102);
+
+        /** Sketches of different precisions can't be merged. */
+        HyperLogLog h4 (10);
+        bool hasThrown = false;
+        try  { h4.merge (h3); }  catch (Exception& e)  { hasThrown = true; }
+        CPPUNIT_ASSERT (hasThrown);
+    }
 };
 
 /********************************************************************************/
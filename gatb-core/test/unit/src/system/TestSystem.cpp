@@ -23,6 +23,8 @@
 #include <gatb/system/impl/MemoryCommon.hpp>
 #include <gatb/system/impl/TimeCommon.hpp>
 #include <gatb/system/impl/FileSystemCommon.hpp>
+#include <gatb/system/impl/Tracer.hpp>
+#include <gatb/system/impl/MemoryAccounting.hpp>
 
 #include <list>
 #include <stdlib.h>     /* srand, rand */
@@ -62,6 +64,7 @@ class TestSystem : public Test
         CPPUNIT_TEST_GATB (memory_memset);
         CPPUNIT_TEST_GATB (memory_memcpy);
         CPPUNIT_TEST_GATB (memory_memcmp);
+        CPPUNIT_TEST_GATB (memory_accounting);
         // CPPUNIT_TEST_GATB (memory_allocateAll);
 
         CPPUNIT_TEST_GATB (time_checkSensibility);
@@ -71,6 +74,7 @@ class TestSystem : public Test
         CPPUNIT_TEST_GATB (thread_checkTime);
         CPPUNIT_TEST_GATB (thread_checkSynchro);
         CPPUNIT_TEST_GATB (thread_exception);
+        CPPUNIT_TEST_GATB (thread_tracer);
 
         CPPUNIT_TEST_GATB (filesystem_info);
         CPPUNIT_TEST_GATB (filesystem_create_delete);
@@ -494,6 +498,68 @@ public:
         System::memory().free (ptr2);
     }
 
+    /********************************************************************************/
+    /** \brief Check the accounting of the memory by category, and the memory budget
+     *
+     * Test of \ref gatb::core::system::impl::MemoryAccounting \n
+     * Test of \ref gatb::core::system::impl::MemoryCharge \n
+     * Test of \ref gatb::core::system::impl::TrackedAllocator \n
+     */
+    void memory_accounting ()
+    {
+        MemoryAccounting& accounting = MemoryAccounting::singleton();
+
+        u_int64_t budget0 = accounting.getBudget();
+        u_int64_t total0  = accounting.getCurrentUsage();
+        u_int64_t bloom0  = accounting.getCurrentUsage (MEMORY_BLOOM);
+        u_int64_t other0  = accounting.getCurrentUsage (MEMORY_OTHER);
+
+        {
+            MemoryCharge c1 (MEMORY_BLOOM, 1000);
+            CPPUNIT_ASSERT (accounting.getCurrentUsage (MEMORY_BLOOM) - bloom0 == 1000);
+            CPPUNIT_ASSERT (accounting.getCurrentUsage ()             - total0 == 1000);
+
+            /** A copy declares the same memory again. */
+            MemoryCharge c2 (c1);
+            CPPUNIT_ASSERT (accounting.getCurrentUsage (MEMORY_BLOOM) - bloom0 == 2000);
+
+            c2.set (500);
+            CPPUNIT_ASSERT (accounting.getCurrentUsage (MEMORY_BLOOM) - bloom0 == 1500);
+            CPPUNIT_ASSERT (accounting.getMaximumUsage (MEMORY_BLOOM) >= bloom0 + 2000);
+
+            /** The memory system gives the accounted usage. */
+            CPPUNIT_ASSERT (System::memory().getCurrentUsage() == accounting.getCurrentUsage());
+        }
+
+        /** The charges give back their memory when destroyed. */
+        CPPUNIT_ASSERT (accounting.getCurrentUsage (MEMORY_BLOOM) == bloom0);
+        CPPUNIT_ASSERT (accounting.getCurrentUsage ()             == total0);
+
+        {
+            std::vector<u_int64_t, TrackedAllocator<u_int64_t,MEMORY_OTHER> > v (1000);
+            CPPUNIT_ASSERT (accounting.getCurrentUsage (MEMORY_OTHER) - other0 == 1000*sizeof(u_int64_t));
+        }
+        CPPUNIT_ASSERT (accounting.getCurrentUsage (MEMORY_OTHER) == other0);
+
+        /** We check the budget. */
+        accounting.setBudget (0);
+        CPPUNIT_ASSERT (accounting.fits (~(u_int64_t)0));
+
+        accounting.setBudget (total0 + 10000);
+        CPPUNIT_ASSERT (accounting.getAvailable() == 10000);
+        CPPUNIT_ASSERT (accounting.fits (10000) == true);
+        CPPUNIT_ASSERT (accounting.fits (10001) == false);
+        {
+            MemoryCharge c (MEMORY_OTHER, 20000);
+            CPPUNIT_ASSERT (accounting.getAvailable() == 0);
+        }
+        CPPUNIT_ASSERT (accounting.getAvailable() == 10000);
+
+        accounting.setBudget (budget0);
+
+        CPPUNIT_ASSERT (string(MemoryAccounting::getName (MEMORY_UNITIGS)) == "unitigs");
+    }
+
     /********************************************************************************/
     void memory_allocateAll ()
     {
@@ -773,6 +839,77 @@ public:
         ThreadGroup::destroy(threadGroup);
     }
 
+    /********************************************************************************/
+    static void* thread_tracer_mainloop (void* arg)
+    {
+        size_t nbIter = *(size_t*)arg;
+
+        for (size_t i=0; i<nbIter; i++)
+        {
+            TRACE_SPAN_ARG ("test", "outer", i);
+            {   TRACE_SPAN ("test", "inner");  }
+        }
+        return 0;
+    }
+
+    /** \brief check the recording of spans by several threads
+     */
+    void thread_tracer ()
+    {
+        Tracer& tracer = Tracer::singleton();
+
+        size_t nbThreads = 4;
+        size_t nbIter    = 100;
+
+        /** No span is recorded when the tracer is disabled. */
+        tracer.enable ();
+        tracer.disable ();
+        thread_tracer_mainloop (&nbIter);
+        CPPUNIT_ASSERT (tracer.getNbSpans() == 0);
+
+        tracer.enable ();
+
+        IThread* threads [nbThreads];
+        for (size_t i=0; i<nbThreads; i++)   {  threads[i] = System::thread().newThread (thread_tracer_mainloop, &nbIter);  }
+        for (size_t i=0; i<nbThreads; i++)   {  threads[i]->join();    delete threads[i];  }
+
+        tracer.disable ();
+
+        CPPUNIT_ASSERT (tracer.getNbSpans() == 2*nbThreads*nbIter);
+        CPPUNIT_ASSERT (tracer.getNbLost()  == 0);
+
+        std::map<std::string,Tracer::Stats> stats = tracer.getStats();
+        CPPUNIT_ASSERT (stats.size() == 2);
+        CPPUNIT_ASSERT (stats["test.outer"].nb == nbThreads*nbIter);
+        CPPUNIT_ASSERT (stats["test.inner"].nb == nbThreads*nbIter);
+        CPPUNIT_ASSERT (stats["test.outer"].nbLanes >= 1 && stats["test.outer"].nbLanes <= nbThreads);
+        CPPUNIT_ASSERT (stats["test.outer"].total   >= stats["test.inner"].total);
+        CPPUNIT_ASSERT (stats["test.outer"].maxLane <= stats["test.outer"].total);
+
+        /** We dump the trace and check it holds the spans. */
+        string filename = System::file().getTemporaryDirectory() + "/test_trace.json";
+        tracer.dump (filename);
+
+        IFile* file = System::file().newFile (filename, "r");
+        CPPUNIT_ASSERT (file != 0 && file->isOpen());
+        size_t nbSpans = 0;
+        char line[1024];
+        while (file->gets (line, sizeof(line)) > 0)  {  if (strstr (line, "\"ph\":\"X\"") != 0)  { nbSpans++; }  }
+        delete file;
+        System::file().remove (filename);
+
+        CPPUNIT_ASSERT (nbSpans == 2*nbThreads*nbIter);
+
+        /** Only the last spans are kept when a ring buffer is full. */
+        tracer.enable (10);
+        thread_tracer_mainloop (&nbIter);
+        tracer.disable ();
+
+        CPPUNIT_ASSERT (tracer.getNbSpans() == 2*nbIter);
+        CPPUNIT_ASSERT (tracer.getNbLost()  == 2*nbIter - 10);
+        CPPUNIT_ASSERT (tracer.getStats()["test.outer"].nb == 5);
+    }
+
     /********************************************************************************/
     /** \brief check information from the file system.
      *
@@ -20,6 +20,8 @@
 
 #define USE_LARGEINT_CONSTRUCTOR 1 // one of the only cases where LargeInt should be using its constructor; but got lazy to want to change the unit tests here.
 #include <gatb/tools/collections/impl/Bloom.hpp>
+#include <gatb/tools/collections/impl/BloomGroupIndex.hpp>
+#include <gatb/tools/collections/impl/RibbonFilter.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 
@@ -36,6 +38,7 @@ using namespace std;
 using namespace gatb::core::tools::collections;
 using namespace gatb::core::tools::collections::impl;
 using namespace gatb::core::tools::math;
+using namespace gatb::core::system::impl;
 
 /********************************************************************************/
 namespace gatb  {  namespace tests  {
@@ -51,6 +54,8 @@ class TestContainer : public Test
     CPPUNIT_TEST_SUITE_GATB (TestContainer);
 
         CPPUNIT_TEST_GATB (bloom_checkContains);
+        CPPUNIT_TEST_GATB (bloomGroupIndex_check);
+        CPPUNIT_TEST_GATB (ribbonFilter_check);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -132,6 +137,110 @@ public:
         bloom_checkContains_aux<LargeInt<5> > (values2, ARRAY_SIZE(values2));
         bloom_checkContains_aux<LargeInt<5> > (values3, ARRAY_SIZE(values3));
     }
+
+    /********************************************************************************/
+    void bloomGroupIndex_check_aux (size_t nbSamples, size_t nbItems)
+    {
+        typedef NativeInt64 Item;
+
+        BloomGroupIndex<Item> index (nbItems*16, nbSamples);
+
+        /** Item i belongs to the samples s such as i%(s+1)==0. */
+        for (size_t i=0; i<nbItems; i++)
+        {
+            for (size_t s=0; s<nbSamples; s++)  {  if (i%(s+1)==0)  { index.insert (Item(i), s); }  }
+        }
+
+        vector<Item> items;
+        for (size_t i=0; i<nbItems; i++)  { items.push_back (Item(i)); }
+
+        vector<u_int32_t> hits (nbSamples);
+        index.count (items.data(), items.size(), hits.data());
+
+        /** No false negative: each sample has at least its own items. */
+        size_t nbPositives = 0;
+        for (size_t s=0; s<nbSamples; s++)
+        {
+            size_t expected = (nbItems + s) / (s+1);
+            CPPUNIT_ASSERT (hits[s] >= expected);
+            nbPositives += expected;
+
+            CPPUNIT_ASSERT (index.contains (Item(0), s) == true);
+        }
+
+        /** The per sample counts must agree with the per item queries. */
+        size_t nbFound = 0;
+        for (size_t i=0; i<nbItems; i++)  { nbFound += index.getNbSamples (items[i]); }
+
+        size_t nbHits = 0;
+        for (size_t s=0; s<nbSamples; s++)  { nbHits += hits[s]; }
+
+        CPPUNIT_ASSERT (nbFound == nbHits);
+
+        /** We check the false positive rate is reasonable. */
+        CPPUNIT_ASSERT (nbHits - nbPositives < nbPositives / 10 + 1);
+
+        /** The mapped copy of the index must give the same results. */
+        string filename = "bloomgroupindex.bin";
+        index.save (filename);
+        {
+            BloomGroupIndex<Item> mapped (filename);
+            CPPUNIT_ASSERT (mapped.getNbSamples() == nbSamples);
+            CPPUNIT_ASSERT (mapped.getNbRows()    == index.getNbRows());
+
+            vector<u_int32_t> hits2 (nbSamples);
+            mapped.count (items.data(), items.size(), hits2.data());
+            CPPUNIT_ASSERT (hits == hits2);
+        }
+        System::file().remove (filename);
+    }
+
+    /** */
+    void bloomGroupIndex_check ()
+    {
+        bloomGroupIndex_check_aux (1,    1000);
+        bloomGroupIndex_check_aux (10,   1000);
+        bloomGroupIndex_check_aux (64,   500);
+        bloomGroupIndex_check_aux (200,  300);
+    }
+
+    /********************************************************************************/
+    template<typename Item> void ribbonFilter_check_aux (size_t nbItems, size_t nbBits)
+    {
+        /** We put the even values in the filter. */
+        std::vector<u_int64_t> keys;
+        for (size_t i=0; i<nbItems; i++)  {  Item item; item.setVal (2*i);  keys.push_back (RibbonFilter<Item>::hashItem (item));  }
+
+        RibbonFilter<Item> filter (nbItems, nbBits);
+        filter.build (keys);
+
+        /** No false negatives. */
+        for (size_t i=0; i<nbItems; i++)  {  Item item; item.setVal (2*i);  CPPUNIT_ASSERT (filter.contains (item) == true);  }
+
+        /** The false positive rate of the odd values should be close to 1/2^nbBits. */
+        size_t nbFP = 0;
+        for (size_t i=0; i<nbItems; i++)  {  Item item; item.setVal (2*i+1);  if (filter.contains (item))  { nbFP++; }  }
+
+        CPPUNIT_ASSERT (nbFP < 2*(nbItems>>nbBits) + 10);
+
+        /** About 1.07 to 1.15 times nbBits bits per item, with one more block of 64 slots. */
+        CPPUNIT_ASSERT (filter.getBitSize() < 1.16*nbBits*nbItems + 2*64*nbBits);
+
+        /** A filter loaded from the solution array gives the same answers. */
+        RibbonFilter<Item> other (filter.getNbSlots(), filter.getNbBits(), filter.getSeed());
+        memcpy (other.getArray(), filter.getArray(), filter.getSize());
+        for (size_t i=0; i<2*nbItems; i++)  {  Item item; item.setVal (i);  CPPUNIT_ASSERT (other.contains (item) == filter.contains (item));  }
+    }
+
+    /** */
+    void ribbonFilter_check ()
+    {
+        ribbonFilter_check_aux<NativeInt64>  (1,          8);
+        ribbonFilter_check_aux<NativeInt64>  (1000,       3);
+        ribbonFilter_check_aux<NativeInt64>  (100*1000,   8);
+        ribbonFilter_check_aux<NativeInt64>  (100*1000,   16);
+        ribbonFilter_check_aux<LargeInt<2> > (100*1000,   5);
+    }
 };
 
 /********************************************************************************/
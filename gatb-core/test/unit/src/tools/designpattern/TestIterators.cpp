@@ -19,6 +19,9 @@
 #include <CppunitCommon.hpp>
 
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/misc/api/Range.hpp>
+#include <gatb/tools/misc/impl/Pool.hpp>
 
 #include <gatb/tools/math/Integer.hpp>
 
@@ -33,6 +36,8 @@ using namespace std;
 using namespace gatb::core::tools::dp;
 using namespace gatb::core::tools::dp::impl;
 using namespace gatb::core::tools::math;
+using namespace gatb::core::tools::misc;
+using namespace gatb::core::system::impl;
 
 /********************************************************************************/
 namespace gatb  {  namespace tests  {
@@ -55,6 +60,9 @@ class TestIterators : public Test
         CPPUNIT_TEST_GATB (iterators_checkVariant1);
         CPPUNIT_TEST_GATB (iterators_checkVariant2);
         CPPUNIT_TEST_GATB (iterators_adaptator);
+        CPPUNIT_TEST_GATB (dispatcher_workerContext);
+        CPPUNIT_TEST_GATB (dispatcher_numa);
+        CPPUNIT_TEST_GATB (dispatcher_multiIterators);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -360,6 +368,183 @@ public:
             CPPUNIT_ASSERT (itAdapt.item() == table[i].x);
         }
     }
+
+    /********************************************************************************/
+    struct WorkerContextFunctor
+    {
+        vector<size_t>& counts;
+        WorkerContextFunctor (vector<size_t>& counts) : counts(counts)  {}
+
+        void operator() (size_t item)
+        {
+            WorkerContext& context = WorkerContext::get();
+
+            CPPUNIT_ASSERT (context.getNbWorkers() == counts.size());
+            CPPUNIT_ASSERT (context.getIndex()     <  counts.size());
+
+            /** Each worker only touches its own slot. */
+            counts[context.getIndex()] ++;
+            context.increment ("items");
+
+            size_t* scratch = (size_t*) context.getScratch (sizeof(size_t));
+            *scratch = item;
+        }
+    };
+
+    void dispatcher_workerContext ()
+    {
+        size_t nbItems = 10000;
+
+        /** No context outside a dispatcher. */
+        CPPUNIT_ASSERT (WorkerContext::current() == 0);
+
+        for (size_t nbCores=1; nbCores<=8; nbCores*=2)
+        {
+            vector<size_t> counts (nbCores, 0);
+
+            Dispatcher dispatcher (nbCores, 100);
+            Range<size_t>::Iterator it (0, nbItems-1);
+            dispatcher.iterate (it, WorkerContextFunctor (counts));
+
+            size_t total = 0;
+            for (size_t i=0; i<counts.size(); i++)  { total += counts[i]; }
+            CPPUNIT_ASSERT (total == nbItems);
+
+            /** The statistics of the workers are available after the dispatch. */
+            CPPUNIT_ASSERT (dispatcher.getWorkerContexts().size() == nbCores);
+
+            total = 0;
+            for (size_t i=0; i<nbCores; i++)
+            {
+                const WorkerContext& context = dispatcher.getWorkerContexts()[i];
+                CPPUNIT_ASSERT (context.getIndex() == i);
+
+                map<string,u_int64_t>::const_iterator stat = context.getStats().find ("items");
+                if (stat != context.getStats().end())  { total += stat->second; }
+            }
+            CPPUNIT_ASSERT (total == nbItems);
+        }
+
+        /** A serial dispatcher also provides a worker context. */
+        vector<size_t> counts (1, 0);
+        Range<size_t>::Iterator it (0, nbItems-1);
+        SerialDispatcher().iterate (it, WorkerContextFunctor (counts));
+        CPPUNIT_ASSERT (counts[0] == nbItems);
+
+        CPPUNIT_ASSERT (WorkerContext::current() == 0);
+    }
+
+    /********************************************************************************/
+    struct NumaFunctor
+    {
+        void operator() (size_t item)
+        {
+            int node = WorkerContext::get().getNumaNode();
+            CPPUNIT_ASSERT (node >= 0 && node < (int)System::info().getNbNumaNodes());
+
+            /** The workers of a nested dispatcher stay on the node of their parent. */
+            Range<size_t>::Iterator it (0, 9);
+            Dispatcher(2).iterate (it, [node] (size_t i)  {  CPPUNIT_ASSERT (WorkerContext::get().getNumaNode() == node);  });
+        }
+    };
+
+    void dispatcher_numa ()
+    {
+        CPPUNIT_ASSERT (System::info().getNbNumaNodes() >= 1);
+        CPPUNIT_ASSERT (System::info().getNumaNodeCores(0).empty() == false);
+
+        /** Without NUMA placement, the workers are not bound to a node. */
+        Range<size_t>::Iterator it (0, 99);
+        Dispatcher(4).iterate (it, [] (size_t i)  {  CPPUNIT_ASSERT (WorkerContext::get().getNumaNode() == -1);  });
+
+        Dispatcher numaDispatcher (4, 0, true);
+        CPPUNIT_ASSERT (numaDispatcher.getNbNumaNodes() >= 1);
+        numaDispatcher.iterate (it, NumaFunctor());
+
+        /** The NUMA placement is a setting of a dispatcher, so the other ones are not bound. */
+        Dispatcher(4).iterate (it, [] (size_t i)  {  CPPUNIT_ASSERT (WorkerContext::get().getNumaNode() == -1);  });
+        CPPUNIT_ASSERT (Dispatcher(4).getNbNumaNodes() == 1);
+
+        /** A pool split over two nodes; the calling thread is not bound, so it allocates in the
+         * region of the first node, then in the region of the second one when the first is full. */
+        gatb::core::tools::misc::impl::MemAllocator pool (1, 2);
+        pool.reserve (1024*1024);
+
+        char* a = pool.pool_malloc (100);
+        CPPUNIT_ASSERT ((size_t)a % 16 == 0);
+        CPPUNIT_ASSERT (pool.getLocalBytes() == 112);
+        CPPUNIT_ASSERT (pool.getRemoteBytes() == 0);
+
+        pool.pool_malloc (1024*1024);
+        CPPUNIT_ASSERT (pool.getRemoteBytes() == 0);
+
+        pool.pool_malloc (1024*1024);
+        CPPUNIT_ASSERT (pool.getRemoteBytes() == 1024*1024);
+
+        pool.free_all();
+        CPPUNIT_ASSERT (pool.getUsedSpace() == 0);
+
+        /** A block bigger than a region is allocated over the two regions, as in a non split pool. */
+        u_int64_t big = pool.getCapacity() * 3 / 4;
+        u_int64_t localBytes = pool.getLocalBytes();
+        char* b = pool.pool_malloc (big);
+        CPPUNIT_ASSERT (b != 0);
+        CPPUNIT_ASSERT (pool.getLocalBytes() >= localBytes + big);
+        CPPUNIT_ASSERT (pool.getUsedSpace() >= big);
+        memset (b, 1, big);
+
+        pool.free_all();
+        CPPUNIT_ASSERT (pool.getUsedSpace() == 0);
+    }
+
+    /********************************************************************************/
+    struct MultiIteratorsFunctor
+    {
+        vector<size_t>& counts;  vector<size_t>& sums;
+        MultiIteratorsFunctor (vector<size_t>& counts, vector<size_t>& sums) : counts(counts), sums(sums) {}
+        void operator() (size_t item, size_t idx)
+        {
+            __sync_fetch_and_add (&counts[idx], 1);
+            __sync_fetch_and_add (&sums[idx],   item);
+        }
+    };
+
+    void dispatcher_multiIterators ()
+    {
+        size_t sizes[] = { 1000, 0, 1, 5000, 20, 333, 0, 4096 };
+        size_t nbIterators = ARRAY_SIZE(sizes);
+
+        /** The leaves of a composite iterator are its non composite sub iterators. */
+        vector<Iterator<size_t>*> iterators;
+        for (size_t i=0; i<nbIterators; i++)  {  iterators.push_back (new Range<size_t>::Iterator (i*10000, i*10000 + sizes[i] - 1));  }
+
+        vector<Iterator<size_t>*> part1 (iterators.begin(),   iterators.begin()+3);
+        vector<Iterator<size_t>*> part2 (iterators.begin()+3, iterators.end());
+        vector<Iterator<size_t>*> parts;
+        parts.push_back (new CompositeIterator<size_t> (part1));
+        parts.push_back (new CompositeIterator<size_t> (part2));
+        CompositeIterator<size_t> composite (parts);
+
+        CPPUNIT_ASSERT (composite.getLeaves() == iterators);
+
+        /** All the items of all the iterators must be processed, whatever the scheduling. */
+        for (size_t nbCores=1; nbCores<=8; nbCores*=2)
+        {
+            for (size_t nbOpened=0; nbOpened<=3; nbOpened++)
+            {
+                vector<size_t> counts (nbIterators, 0);
+                vector<size_t> sums   (nbIterators, 0);
+
+                Dispatcher(nbCores, 100).iterate (iterators, MultiIteratorsFunctor (counts, sums), 100, true, nbOpened);
+
+                for (size_t i=0; i<nbIterators; i++)
+                {
+                    CPPUNIT_ASSERT (counts[i] == sizes[i]);
+                    CPPUNIT_ASSERT (sums[i]   == sizes[i]*(i*10000) + sizes[i]*(sizes[i]-1)/2);
+                }
+            }
+        }
+    }
 };
 
 /********************************************************************************/
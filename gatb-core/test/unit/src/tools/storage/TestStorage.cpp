@@ -22,12 +22,14 @@
 
 #include <gatb/tools/storage/impl/Storage.hpp>
 #include <gatb/tools/collections/impl/CollectionCache.hpp>
+#include <gatb/tools/collections/impl/IteratorPrefetch.hpp>
 
 #include <gatb/tools/misc/api/Range.hpp>
 
 #include <gatb/tools/designpattern/impl/Command.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
+#include <gatb/tools/misc/api/Abundance.hpp>
 #include <gatb/tools/math/NativeInt64.hpp>
 #include <gatb/tools/math/LargeInt.hpp>
 
@@ -71,6 +73,9 @@ class TestStorage : public Test
         CPPUNIT_TEST_GATB (storage_check2);
         CPPUNIT_TEST_GATB (storage_check3);
         CPPUNIT_TEST_GATB (storage_check4);
+        CPPUNIT_TEST_GATB (storage_check5);
+        CPPUNIT_TEST_GATB (storage_prefetch);
+        CPPUNIT_TEST_GATB (storage_delta);
 
         CPPUNIT_TEST_GATB (storage_HDF5_check_collection);
         CPPUNIT_TEST_GATB (storage_HDF5_check_partition);
@@ -260,6 +265,178 @@ public:
         storage.remove ();
     }
 
+    /********************************************************************************/
+    struct GetItemsFunctor
+    {
+        Collection<NativeInt64>& collection;  size_t nbItems;  size_t chunk;
+        GetItemsFunctor (Collection<NativeInt64>& collection, size_t nbItems, size_t chunk) : collection(collection), nbItems(nbItems), chunk(chunk) {}
+        void operator() (size_t i)
+        {
+            /** We read a chunk at some arbitrary position; all threads share the same collection. */
+            size_t start = (i * 7919) % nbItems;
+            vector<NativeInt64> items (chunk);
+            NativeInt64* buffer = items.data();
+            size_t n = collection.getItems (buffer, start, chunk);
+            CPPUNIT_ASSERT (n == std::min (chunk, nbItems - start));
+            for (size_t j=0; j<n; j++)  {  CPPUNIT_ASSERT (buffer[j] == start + j);  }
+        }
+    };
+
+    void storage_check5 ()
+    {
+        size_t nbItems = 100000;
+
+        /** We create a storage. */
+        Storage storage (STORAGE_FILE, "graph");
+
+        /** We fill a collection with 0..nbItems-1 */
+        Collection<NativeInt64>& collection = storage().getCollection<NativeInt64> ("items");
+        for (size_t i=0; i<nbItems; i++)  {  collection.insert (i);  }
+        collection.flush ();
+
+        /** We read it concurrently with random accesses. */
+        Range<size_t>::Iterator it (0, 9999);
+        Dispatcher().iterate (it, GetItemsFunctor (collection, nbItems, 100));
+
+        /** We delete the storage. */
+        storage.remove ();
+    }
+
+    /********************************************************************************/
+    size_t storage_prefetch_iterate (Iterator<NativeInt64>* it, size_t nbMax)
+    {
+        size_t nb = 0;
+        for (it->first(); !it->isDone() && nb < nbMax; it->next(), nb++)  {  CPPUNIT_ASSERT (it->item() == nb);  }
+        return nb;
+    }
+
+    void storage_prefetch_aux (StorageMode_e mode)
+    {
+        size_t nbItems = 100000;
+
+        /** We create a storage. */
+        Storage* storage = StorageFactory(mode).create ("prefetch", true, false);
+        LOCAL (storage);
+
+        /** We fill a collection with 0..nbItems-1 */
+        Collection<NativeInt64>& collection = (*storage)().getCollection<NativeInt64> ("items");
+        for (size_t i=0; i<nbItems; i++)  {  collection.insert (i);  }
+        collection.flush ();
+
+        /** The collection is large enough to be read ahead by its iterator. */
+        u_int64_t nbBlocks = PrefetchSettings::totals().nbBlocks;
+        {
+            Iterator<NativeInt64>* it = collection.iterator();  LOCAL (it);
+            CPPUNIT_ASSERT (storage_prefetch_iterate (it, nbItems+1) == nbItems);
+            CPPUNIT_ASSERT (storage_prefetch_iterate (it, nbItems+1) == nbItems);   // the iteration can be restarted
+            CPPUNIT_ASSERT (storage_prefetch_iterate (it, 5000)      == 5000);      // and left before its end
+        }
+        CPPUNIT_ASSERT (PrefetchSettings::totals().nbBlocks > nbBlocks);
+
+        /** Small blocks and a deeper ring. */
+        {
+            IteratorPrefetch<NativeInt64> it (&collection, 1000, 3);
+            CPPUNIT_ASSERT (storage_prefetch_iterate (&it, nbItems+1) == nbItems);
+            CPPUNIT_ASSERT (it.getStats().nbBlocks == nbItems / 1000);
+        }
+
+        /** Without read-ahead. */
+        size_t depth = PrefetchSettings::depth();
+        PrefetchSettings::depth() = 0;
+        {
+            Iterator<NativeInt64>* it = collection.iterator();  LOCAL (it);
+            CPPUNIT_ASSERT (storage_prefetch_iterate (it, nbItems+1) == nbItems);
+        }
+        PrefetchSettings::depth() = depth;
+
+        /** We delete the storage. */
+        storage->remove ();
+    }
+
+    void storage_prefetch ()
+    {
+        storage_prefetch_aux (STORAGE_FILE);
+        storage_prefetch_aux (STORAGE_HDF5);
+    }
+
+    /********************************************************************************/
+    template<typename Count>
+    void storage_delta_check (Collection<Count>& collection, const vector<Count>& items)
+    {
+        CPPUNIT_ASSERT (collection.getNbItems() == (int64_t)items.size());
+
+        size_t nb = 0;
+        Iterator<Count>* it = collection.iterator();  LOCAL (it);
+        for (it->first(); !it->isDone(); it->next(), nb++)  {  CPPUNIT_ASSERT (nb < items.size() && it->item() == items[nb]);  }
+        CPPUNIT_ASSERT (nb == items.size());
+
+        /** We read a range starting in the middle of a block. */
+        vector<Count> range (20000);
+        Count* buffer = range.data();
+        CPPUNIT_ASSERT (collection.getItems (buffer, 12345, range.size()) == range.size());
+        for (size_t i=0; i<range.size(); i++)  {  CPPUNIT_ASSERT (range[i] == items[12345+i]);  }
+    }
+
+    template<typename Type>
+    void storage_delta_aux (size_t shift)
+    {
+        typedef Abundance<Type,CountNumber> Count;
+
+        CPPUNIT_ASSERT (BlockDeltaSupport<Count>::value);
+        CPPUNIT_ASSERT (BlockDeltaSupport<NativeInt64>::value == false);
+
+        /** We build increasing values with some big gaps, then a few values not sorted any more. */
+        vector<Count> items;
+        Type value;  value.setVal (1);
+        for (size_t i=0; i<100000; i++)
+        {
+            Type step;  step.setVal (1 + (i*7919) % 1000);
+            if (i % 5000 == 0)  { step = step << shift; }
+            value = value + step;
+            items.push_back (Count (value, 1 + i % 300));
+        }
+        for (size_t i=0; i<100; i++)  {  items.push_back (items[i*3]);  }
+
+        /** We check the file of the collection. */
+        {
+            CollectionDeltaFile<Count> collection ("delta_counts");
+            collection.insert (items.data(), items.size());
+            collection.flush ();
+
+            CPPUNIT_ASSERT (System::file().getSize ("delta_counts") < items.size() * sizeof(Count) / 2);
+            storage_delta_check (collection, items);
+
+            /** The blocks min/max are used for looking for values. */
+            IterableDeltaFile<Count>* iterable = dynamic_cast<IterableDeltaFile<Count>*> (collection.iterable());
+            CPPUNIT_ASSERT (iterable != 0);
+
+            Count found;
+            Type  one;  one.setVal (1);
+            CPPUNIT_ASSERT (iterable->find (items[54321].value, found) && found == items[54321]);
+            CPPUNIT_ASSERT (iterable->find (items[54321].value + one, found) == false);
+
+            collection.remove ();
+        }
+
+        /** The collections of counts of a file storage are delta compressed. */
+        Storage* storage = StorageFactory(STORAGE_FILE).create ("delta", true, false);
+        LOCAL (storage);
+
+        Collection<Count>& collection = (*storage)().getCollection<Count> ("counts");
+        collection.insert (items.data(), items.size());
+        collection.flush ();
+        storage_delta_check (collection, items);
+
+        collection.remove ();
+        storage->remove ();
+    }
+
+    void storage_delta ()
+    {
+        storage_delta_aux<LargeInt<1> > (40);
+        storage_delta_aux<LargeInt<3> > (100);
+    }
+
     /********************************************************************************/
     template<typename T>
     void collection_HDF5_check_collection_aux (T* values, size_t len)
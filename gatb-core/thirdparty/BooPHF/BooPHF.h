@@ -17,6 +17,10 @@
 #include <string.h>
 #include <memory> // for make_shared
 
+// hook called at the beginning of the build of each level (for tracing); may be defined by the includer
+#ifndef BOOPHF_TRACE_LEVEL
+#define BOOPHF_TRACE_LEVEL(level)
+#endif
 
 namespace boomphf {
 
@@ -755,6 +759,8 @@ we need this 2-functors scheme because HashFunctors won't work with unordered_ma
 			uint64_t offset = 0;
 			for(int ii = 0; ii< _nb_levels; ii++)
 			{
+				BOOPHF_TRACE_LEVEL(ii);
+
 				_tempBitset =  new bitVector(_levels[ii].hash_domain); // temp collision bitarray for this level
 
 				processLevel(input_range,ii);
@@ -825,6 +831,17 @@ we need this 2-functors scheme because HashFunctors won't work with unordered_ma
             return _nelem;
         }
 
+		// same as totalBitSize, without the report on stdout
+		uint64_t memoryBitSize() const
+		{
+			uint64_t totalsize = _final_hash.size()*42*8;
+			for(int ii=0; ii<_nb_levels; ii++)
+			{
+				totalsize += _levels[ii].bitset.bitSize();
+			}
+			return totalsize;
+		}
+
 		uint64_t totalBitSize()
 		{
 
@@ -0,0 +1,164 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+#include <gatb/gatb_core.hpp>
+#include <gatb/kmer/impl/ShardCountAlgorithm.hpp>
+#include <gatb/kmer/impl/ShardMergeAlgorithm.hpp>
+
+using namespace std;
+
+/********************************************************************************/
+/* Kmers counting split over several processes:
+ *   dskshard -prepare -in reads.fa -out shared [-kmer-size k ...]
+ *   dskshard -in reads.fa -shared shared.h5 -shard-count N -shard-index i -out shard_i    (for i in [0..N-1])
+ *   dskshard -merge shard_0.h5,shard_1.h5,... -out solid [-abundance-min a]
+ * The merged storage has the layout of a DSK output; the shards can be counted on different hosts.
+ */
+static const char* STR_PREPARE     = "-prepare";
+static const char* STR_SHARED      = "-shared";
+static const char* STR_SHARD_COUNT = "-shard-count";
+static const char* STR_SHARD_INDEX = "-shard-index";
+static const char* STR_SHARD_BLOCK = "-shard-block";
+static const char* STR_MERGE       = "-merge";
+
+struct Parameter
+{
+    Parameter (IProperties* options) : options(options) {}
+    IProperties* options;
+};
+
+/********************************************************************************/
+template<size_t span> struct PrepareShards  {  void operator ()  (Parameter p)
+{
+    Storage* shared = StorageFactory(STORAGE_HDF5).create (p.options->getStr(STR_URI_OUTPUT), true, false);
+    LOCAL (shared);
+
+    ShardCountAlgorithm<span>::prepare (Bank::open (p.options->getStr(STR_URI_INPUT)), *shared, p.options);
+}};
+
+/********************************************************************************/
+template<size_t span> struct CountShard  {  void operator ()  (Parameter p)
+{
+    Storage* shared = StorageFactory(STORAGE_HDF5).create (p.options->getStr(STR_SHARED), false, false);
+    LOCAL (shared);
+
+    Storage* storage = StorageFactory(STORAGE_HDF5).create (p.options->getStr(STR_URI_OUTPUT), true, false);
+    LOCAL (storage);
+
+    ShardCountAlgorithm<span> shard (
+        Bank::open (p.options->getStr(STR_URI_INPUT)),
+        *shared,
+        *storage,
+        p.options->getInt(STR_SHARD_COUNT),
+        p.options->getInt(STR_SHARD_INDEX),
+        p.options,
+        p.options->getInt(STR_SHARD_BLOCK)
+    );
+    shard.execute();
+
+    cout << *shard.getInfo();
+}};
+
+/********************************************************************************/
+template<size_t span> struct MergeShards  {  void operator ()  (Parameter p)
+{
+    vector<Storage*> shards;
+
+    TokenizerIterator it (p.options->getStr(STR_MERGE).c_str(), ",");
+    for (it.first(); !it.isDone(); it.next())
+    {
+        shards.push_back (StorageFactory(STORAGE_HDF5).create (it.item(), false, false));
+    }
+
+    Storage* storage = StorageFactory(STORAGE_HDF5).create (p.options->getStr(STR_URI_OUTPUT), true, false);
+    LOCAL (storage);
+
+    ShardMergeAlgorithm<span> merge (
+        shards,
+        *storage,
+        p.options->getInt(STR_KMER_ABUNDANCE_MIN),
+        p.options->getInt(STR_KMER_ABUNDANCE_MAX),
+        p.options->getInt(STR_NB_CORES),
+        p.options
+    );
+    merge.execute();
+
+    cout << *merge.getInfo();
+}};
+
+/********************************************************************************/
+int main (int argc, char* argv[])
+{
+    /** We create a command line parser. */
+    OptionsParser parser ("dskshard");
+    parser.push_back (new OptionNoParam  (STR_PREPARE,     "compute the configuration and minimizers repartition shared by the shards", false));
+    parser.push_back (new OptionOneParam (STR_SHARED,      "shared storage built with -prepare",              false));
+    parser.push_back (new OptionOneParam (STR_SHARD_COUNT, "number of shards",                                false, "1"));
+    parser.push_back (new OptionOneParam (STR_SHARD_INDEX, "index of the shard to be counted",               false, "0"));
+    parser.push_back (new OptionOneParam (STR_SHARD_BLOCK, "number of consecutive reads dealt to a shard at once", false, "1024"));
+    parser.push_back (new OptionOneParam (STR_MERGE,       "comma separated list of shards storages to be merged", false));
+    parser.push_back (new OptionOneParam (STR_NB_CORES,    "number of cores",                                 false, "0"));
+    parser.push_back (SortingCountAlgorithm<>::getOptionsParser (false));
+
+    try
+    {
+        /** We parse the user options. */
+        IProperties* options = parser.parse (argc, argv);
+
+        if (options->get(STR_URI_OUTPUT) == 0)  { throw Exception ("an output (%s) must be provided", STR_URI_OUTPUT); }
+
+        if (options->get(STR_PREPARE))
+        {
+            Integer::apply<PrepareShards, Parameter> (options->getInt(STR_KMER_SIZE), Parameter (options));
+        }
+        else if (options->get(STR_MERGE))
+        {
+            /** The kmer size is the one of the shards. */
+            TokenizerIterator it (options->getStr(STR_MERGE).c_str(), ",");
+            it.first();
+            if (it.isDone())  { throw Exception ("no shard to be merged"); }
+
+            Storage* first = StorageFactory(STORAGE_HDF5).create (it.item(), false, false);
+            LOCAL (first);
+            size_t kmerSize = atol (first->getGroup("dsk").getProperty("kmer_size").c_str());
+
+            Integer::apply<MergeShards, Parameter> (kmerSize, Parameter (options));
+        }
+        else
+        {
+            if (options->get(STR_SHARED) == 0)  { throw Exception ("a shared storage (%s) must be provided", STR_SHARED); }
+
+            Storage* shared = StorageFactory(STORAGE_HDF5).create (options->getStr(STR_SHARED), false, false);
+            LOCAL (shared);
+            size_t kmerSize = atol (shared->root().getProperty("kmer_size").c_str());
+
+            Integer::apply<CountShard, Parameter> (kmerSize, Parameter (options));
+        }
+    }
+    catch (OptionFailure& e)
+    {
+        return e.displayErrors (std::cout);
+    }
+    catch (Exception& e)
+    {
+        cerr << "ERROR : " << e.getMessage() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/gatb_core.hpp>
+#include <gatb/kmer/impl/KmerCountIndex.hpp>
+#include <fstream>
+
+using namespace std;
+
+/********************************************************************************/
+static const char* STR_URI_QUERY     = "-query";
+static const char* STR_SAMPLING_RATE = "-sampling";
+
+/** Number of kmers looked up in one batch. */
+static const size_t BATCH_SIZE = 1<<22;
+
+struct Parameter
+{
+    Parameter (Storage& storage, IProperties* options) : storage(storage), options(options) {}
+    Storage&     storage;
+    IProperties* options;
+};
+
+/********************************************************************************/
+template<size_t span> struct QueryKmers  {  void operator ()  (Parameter p)
+{
+    typedef typename KmerCountIndex<span>::Type  Type;
+    typedef typename KmerCountIndex<span>::Model Model;
+
+    TimeInfo ti;
+
+    /** We build the index over the solid kmers partitions. */
+    KmerCountIndex<span>* index = 0;
+    {
+        TIME_INFO (ti, "load");
+        index = new KmerCountIndex<span> (p.storage, p.options->getInt(STR_NB_CORES), p.options->getInt(STR_SAMPLING_RATE));
+    }
+    LOCAL (index);
+
+    const Model& model = index->getModel();
+
+    /** The results go to the standard output unless an output file is provided. */
+    ofstream file;
+    if (p.options->get(STR_URI_OUTPUT))  {  file.open (p.options->getStr(STR_URI_OUTPUT).c_str());  }
+    ostream& os = file.is_open() ? file : cout;
+
+    IBank* bank = Bank::open (p.options->getStr(STR_URI_QUERY));
+    LOCAL (bank);
+
+    Iterator<Sequence>* itSeq = bank->iterator();
+    LOCAL (itSeq);
+
+    vector<Type>        kmers;
+    vector<CountNumber> counts;
+    kmers.reserve (BATCH_SIZE);
+
+    u_int64_t nbKmers = 0;
+    u_int64_t nbFound = 0;
+
+    /** We look up the kmers by batches, the lookups of a batch being dispatched on the cores. */
+    auto flush = [&] ()
+    {
+        {
+            TIME_INFO (ti, "lookup");
+            index->lookup (kmers, counts);
+        }
+        for (size_t i=0; i<kmers.size(); i++)
+        {
+            os << model.toString(kmers[i]) << "\t" << counts[i] << "\n";
+            if (counts[i] > 0)  { nbFound++; }
+        }
+        nbKmers += kmers.size();
+        kmers.clear();
+    };
+
+    for (itSeq->first(); !itSeq->isDone(); itSeq->next())
+    {
+        model.iterate ((*itSeq)->getData(), [&] (const typename Model::Kmer& kmer, size_t idx)
+        {
+            if (!kmer.isValid())  { return; }
+            kmers.push_back (kmer.value());
+            if (kmers.size() == BATCH_SIZE)  { flush(); }
+        });
+    }
+    flush();
+
+    double lookupTime = ti.get("lookup");
+
+    Properties stats ("kmerquery");
+    stats.add (1, "kmer_size",        "%ld",   index->getKmerSize());
+    stats.add (1, "nb_solid_kmers",   "%lld",  index->getNbKmers());
+    stats.add (1, "nb_queried_kmers", "%lld",  nbKmers);
+    stats.add (1, "nb_found_kmers",   "%lld",  nbFound);
+    stats.add (1, "load_time",        "%.3f",  ti.get("load"));
+    stats.add (1, "lookup_time",      "%.3f",  lookupTime);
+    stats.add (1, "lookups_per_sec",  "%.0f",  lookupTime > 0 ? nbKmers / lookupTime : 0.0);
+    cerr << stats;
+}};
+
+/********************************************************************************/
+int main (int argc, char* argv[])
+{
+    /** We create a command line parser. */
+    OptionsParser parser ("kmerquery");
+    parser.push_back (new OptionOneParam (STR_URI_INPUT,     "kmer counting storage (h5 file or _gatb folder)", true));
+    parser.push_back (new OptionOneParam (STR_URI_QUERY,     "sequences whose kmers are queried",               true));
+    parser.push_back (new OptionOneParam (STR_URI_OUTPUT,    "output file (kmer and count per line), stdout if not set", false));
+    parser.push_back (new OptionOneParam (STR_NB_CORES,      "number of cores",                                 false, "0"));
+    parser.push_back (new OptionOneParam (STR_SAMPLING_RATE, "one kmer out of N is sampled in the partitions index", false, "64"));
+
+    try
+    {
+        /** We parse the user options. */
+        IProperties* options = parser.parse (argc, argv);
+
+        string input = options->getStr(STR_URI_INPUT);
+
+        StorageMode_e mode;
+        if      (System::file().getExtension(input) == "h5")           { mode = STORAGE_HDF5; }
+        else if (System::file().isFolderEndingWith(input, "_gatb"))    { mode = STORAGE_FILE; }
+        else  { throw Exception ("input '%s' is neither a h5 file nor a _gatb folder", input.c_str()); }
+
+        Storage* storage = StorageFactory(mode).create (input, false, false);
+        LOCAL (storage);
+
+        size_t kmerSize = atol (storage->getGroup("dsk").getProperty("kmer_size").c_str());
+
+        Integer::apply<QueryKmers, Parameter> (kmerSize, Parameter (*storage, options));
+    }
+    catch (OptionFailure& e)
+    {
+        return e.displayErrors (std::cout);
+    }
+    catch (Exception& e)
+    {
+        cerr << "ERROR : " << e.getMessage() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}